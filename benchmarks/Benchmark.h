@@ -0,0 +1,61 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace Benchmarks
+{
+
+// Keeps a computed value observable so the optimizer cannot discard the benchmarked work.
+template <typename Value> void keep(const Value &value)
+{
+    static volatile Value sink{};
+    sink = value;
+    static_cast<void>(sink);
+}
+
+// Runs and prints benchmarks whose name contains the command-line filter.
+class Runner
+{
+  public:
+    explicit Runner(std::string_view filter) : m_filter{filter} {}
+
+    // `body` performs `operations` units of work; the report is nanoseconds per unit.
+    template <typename Body> void run(std::string_view name, std::uint64_t operations, Body &&body)
+    {
+        if (!matches(name))
+        {
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto elapsed = std::chrono::duration<double, std::nano>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+        const auto per_operation = elapsed / static_cast<double>(operations);
+        std::cout << std::left << std::setw(48) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << per_operation << " ns/op"
+                  << std::setw(14) << std::setprecision(1) << 1e3 / per_operation << " Mop/s\n";
+    }
+
+    [[nodiscard]] bool matches(std::string_view name) const noexcept
+    {
+        return m_filter.empty() || name.find(m_filter) != std::string_view::npos;
+    }
+
+  private:
+    std::string m_filter;
+};
+
+void runGridBenchmarks(Runner &runner);
+void runSimulatorBenchmarks(Runner &runner);
+void runMemoryBenchmarks(Runner &runner);
+
+} // namespace Benchmarks
+
+#endif
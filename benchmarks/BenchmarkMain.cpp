@@ -0,0 +1,17 @@
+#include "Benchmark.h"
+
+#include <span>
+#include <string_view>
+
+int main(int argc, char *argv[])
+{
+    const std::span arguments{argv, static_cast<std::size_t>(argc)};
+    Benchmarks::Runner runner{arguments.size() > 1 ? std::string_view{arguments[1]}
+                                                   : std::string_view{}};
+
+    Benchmarks::runGridBenchmarks(runner);
+    Benchmarks::runSimulatorBenchmarks(runner);
+    Benchmarks::runMemoryBenchmarks(runner);
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "Benchmark.h"
+
+#include "marvin/robot/Marvin.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/FixedRobotGrid.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Benchmarks
+{
+namespace
+{
+
+constexpr RobotFactory::Coordinate grid_width{1000};
+constexpr RobotFactory::Coordinate grid_height{1000};
+constexpr std::size_t robot_count{100'000};
+constexpr std::size_t lookup_count{4'000'000};
+constexpr std::size_t move_count{4'000'000};
+
+using Robots = std::vector<std::unique_ptr<RobotFactory::Marvin>>;
+
+[[nodiscard]] Robots makeRobots()
+{
+    std::mt19937_64 random{42};
+    std::uniform_int_distribution<RobotFactory::Coordinate> x{0, grid_width - 1};
+    std::uniform_int_distribution<RobotFactory::Coordinate> y{0, grid_height - 1};
+    std::uniform_int_distribution<int> direction{0, 3};
+    Robots robots;
+    robots.reserve(robot_count);
+    for (std::size_t robot = 0; robot < robot_count; ++robot)
+    {
+        robots.push_back(std::make_unique<RobotFactory::Marvin>(
+            RobotFactory::RobotLocation{
+                .x = x(random),
+                .y = y(random),
+                .direction = static_cast<RobotFactory::Direction>(direction(random))},
+            "BENCH"));
+    }
+    return robots;
+}
+
+[[nodiscard]] std::vector<RobotFactory::RobotLocation> makeLookups()
+{
+    std::mt19937_64 random{7};
+    std::uniform_int_distribution<RobotFactory::Coordinate> x{-1, grid_width};
+    std::uniform_int_distribution<RobotFactory::Coordinate> y{-1, grid_height};
+    std::vector<RobotFactory::RobotLocation> lookups(lookup_count);
+    for (auto &location : lookups)
+    {
+        location = {.x = x(random), .y = y(random)};
+    }
+    return lookups;
+}
+
+template <Simulator::GridStorage Grid>
+void benchmarkGrid(Runner &runner, std::string_view label, Grid &grid)
+{
+    auto robots = makeRobots();
+    for (const auto &robot : robots)
+    {
+        keep(grid.addRobot(*robot));
+    }
+
+    const auto lookups = makeLookups();
+    runner.run(std::string{label} + "/isOccupied(random)", lookups.size(),
+               [&grid, &lookups]
+               {
+                   std::size_t occupied{0};
+                   for (const auto location : lookups)
+                   {
+                       occupied += grid.isOccupied(location) ? 1U : 0U;
+                   }
+                   keep(occupied);
+               });
+
+    runner.run(std::string{label} + "/move(check+update)", move_count,
+               [&grid, &robots]
+               {
+                   std::size_t moved{0};
+                   for (std::size_t step = 0; step < move_count; ++step)
+                   {
+                       auto &robot = *robots[step % robots.size()];
+                       const auto previous = robot.location();
+                       robot.move(1);
+                       if (grid.isOffGrid(robot.location()) || grid.isOccupied(robot.location()))
+                       {
+                           robot.setLocation(previous);
+                           robot.rotate(RobotFactory::Rotation::Right);
+                           continue;
+                       }
+                       grid.updateLocation(previous, robot);
+                       ++moved;
+                   }
+                   keep(moved);
+               });
+}
+
+constexpr RobotFactory::Coordinate wide_width{8192};
+constexpr RobotFactory::Coordinate wide_height{512};
+constexpr RobotFactory::Coordinate region_side{32};
+constexpr std::size_t region_count{20'000};
+
+void benchmarkLayout(Runner &runner, std::string_view label, Simulator::GridLayout layout)
+{
+    Simulator::RobotGrid grid{{.width = wide_width, .height = wide_height}, layout};
+    std::mt19937_64 random{11};
+    std::uniform_int_distribution<RobotFactory::Coordinate> x{0, wide_width - 1};
+    std::uniform_int_distribution<RobotFactory::Coordinate> y{0, wide_height - 1};
+    std::bernoulli_distribution north{0.5};
+    Robots robots;
+    robots.reserve(robot_count);
+    for (std::size_t robot = 0; robot < robot_count; ++robot)
+    {
+        const auto direction =
+            north(random) ? RobotFactory::Direction::North : RobotFactory::Direction::South;
+        robots.push_back(std::make_unique<RobotFactory::Marvin>(
+            RobotFactory::RobotLocation{.x = x(random), .y = y(random), .direction = direction},
+            "BENCH"));
+        keep(grid.addRobot(*robots.back()));
+    }
+
+    std::uniform_int_distribution<RobotFactory::Coordinate> region_x{0, wide_width - region_side};
+    std::uniform_int_distribution<RobotFactory::Coordinate> region_y{0, wide_height - region_side};
+    std::vector<RobotFactory::RobotLocation> origins(region_count);
+    for (auto &origin : origins)
+    {
+        origin = {.x = region_x(random), .y = region_y(random)};
+    }
+    runner.run(std::string{label} + "/regionScan(32x32)",
+               region_count * static_cast<std::size_t>(region_side * region_side),
+               [&grid, &origins]
+               {
+                   std::size_t occupied{0};
+                   for (const auto origin : origins)
+                   {
+                       for (auto row = origin.y; row < origin.y + region_side; ++row)
+                       {
+                           for (auto column = origin.x; column < origin.x + region_side; ++column)
+                           {
+                               occupied += grid.isOccupied({.x = column, .y = row}) ? 1U : 0U;
+                           }
+                       }
+                   }
+                   keep(occupied);
+               });
+
+    std::uniform_int_distribution<std::size_t> pick{0, robots.size() - 1};
+    std::vector<std::size_t> order(move_count);
+    for (auto &robot : order)
+    {
+        robot = pick(random);
+    }
+    runner.run(std::string{label} + "/northSouthMove(random)", move_count,
+               [&grid, &robots, &order]
+               {
+                   std::size_t moved{0};
+                   for (const auto index : order)
+                   {
+                       auto &robot = *robots[index];
+                       const auto previous = robot.location();
+                       robot.move(1);
+                       if (grid.isOffGrid(robot.location()) || grid.isOccupied(robot.location()))
+                       {
+                           robot.setLocation(previous);
+                           robot.rotate(RobotFactory::Rotation::Right);
+                           robot.rotate(RobotFactory::Rotation::Right);
+                           continue;
+                       }
+                       grid.updateLocation(previous, robot);
+                       ++moved;
+                   }
+                   keep(moved);
+               });
+}
+
+// Grows a grid one row and column at a time, as clients that expand the world step by step do.
+void benchmarkGrowth(Runner &runner)
+{
+    constexpr RobotFactory::Coordinate steps{1000};
+    runner.run("RobotGrid/RESIZE +1 x1000", steps,
+               []
+               {
+                   Simulator::RobotGrid grid{{.width = grid_width, .height = grid_height}};
+                   for (RobotFactory::Coordinate step = 1; step <= steps; ++step)
+                   {
+                       keep(grid.resize(
+                           {.width = grid_width + step, .height = grid_height + step}));
+                   }
+               });
+}
+
+// Line of sight on a sparse grid, where rays are long: a cell-by-cell walk against the bitset scan.
+void benchmarkScan(Runner &runner)
+{
+    constexpr std::size_t sparse_robots{2'000};
+    constexpr std::size_t passes{200};
+    const auto robots = makeRobots();
+    Simulator::RobotGrid grid{{.width = grid_width, .height = grid_height}};
+    std::vector<RobotFactory::RobotLocation> locations;
+    for (std::size_t robot = 0; robot < sparse_robots; ++robot)
+    {
+        if (grid.addRobot(*robots.at(robot)))
+        {
+            locations.push_back(robots.at(robot)->location());
+        }
+    }
+
+    runner.run("RobotGrid/scan(isOccupied walk)", passes * locations.size(),
+               [&grid, &locations]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       for (const auto &location : locations)
+                       {
+                           RobotFactory::Marvin probe{location};
+                           RobotFactory::Coordinate distance{0};
+                           for (probe.move(1); !grid.isOffGrid(probe.location()) &&
+                                               !grid.isOccupied(probe.location());
+                                probe.move(1))
+                           {
+                               ++distance;
+                           }
+                           keep(distance);
+                       }
+                   }
+               });
+
+    grid.trackLineOfSight();
+    runner.run("RobotGrid/scan(bitsets)", passes * locations.size(),
+               [&grid, &locations]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       for (const auto &location : locations)
+                       {
+                           keep(grid.clearance(location));
+                       }
+                   }
+               });
+}
+
+} // namespace
+
+void runGridBenchmarks(Runner &runner)
+{
+    Simulator::RobotGrid dynamic_grid{{.width = grid_width, .height = grid_height}};
+    benchmarkGrid(runner, "RobotGrid", dynamic_grid);
+
+    const auto fixed_grid = std::make_unique<Simulator::FixedRobotGrid<grid_width, grid_height>>();
+    benchmarkGrid(runner, "FixedRobotGrid", *fixed_grid);
+
+    benchmarkLayout(runner, "RowMajor", Simulator::GridLayout::RowMajor);
+    benchmarkLayout(runner, "Morton", Simulator::GridLayout::Morton);
+    benchmarkGrowth(runner);
+    benchmarkScan(runner);
+}
+
+} // namespace Benchmarks
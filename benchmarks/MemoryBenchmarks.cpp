@@ -0,0 +1,191 @@
+#include "Benchmark.h"
+
+#include "marvin/robot/Marvin.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/PageAllocator.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Benchmarks
+{
+namespace
+{
+
+constexpr RobotFactory::Coordinate large_extent{4096};
+constexpr std::size_t probe_count{8'000'000};
+
+// Counts data-TLB load misses of this thread, where the kernel allows self-profiling.
+class TlbMissCounter
+{
+  public:
+    TlbMissCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attributes{};
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_descriptor = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+    ~TlbMissCounter()
+    {
+#ifdef __linux__
+        if (m_descriptor >= 0)
+        {
+            ::close(m_descriptor);
+        }
+#endif
+    }
+
+    TlbMissCounter(const TlbMissCounter &) = delete;
+    TlbMissCounter &operator=(const TlbMissCounter &) = delete;
+    TlbMissCounter(TlbMissCounter &&) = delete;
+    TlbMissCounter &operator=(TlbMissCounter &&) = delete;
+
+    void start() noexcept
+    {
+#ifdef __linux__
+        if (m_descriptor >= 0)
+        {
+            ::ioctl(m_descriptor, PERF_EVENT_IOC_RESET, 0);  // NOLINT(*-vararg)
+            ::ioctl(m_descriptor, PERF_EVENT_IOC_ENABLE, 0); // NOLINT(*-vararg)
+        }
+#endif
+    }
+
+    // Misses since start(), or a negative value when the counter is unavailable.
+    [[nodiscard]] std::int64_t stop() noexcept
+    {
+#ifdef __linux__
+        std::uint64_t misses{0};
+        if (m_descriptor >= 0)
+        {
+            ::ioctl(m_descriptor, PERF_EVENT_IOC_DISABLE, 0); // NOLINT(*-vararg)
+            if (::read(m_descriptor, &misses, sizeof(misses)) == sizeof(misses))
+            {
+                return static_cast<std::int64_t>(misses);
+            }
+        }
+#endif
+        return -1;
+    }
+
+  private:
+    int m_descriptor{-1};
+};
+
+[[nodiscard]] std::string modeName(Simulator::HugePages mode)
+{
+    switch (mode)
+    {
+    case Simulator::HugePages::Off:
+        return "off";
+    case Simulator::HugePages::Transparent:
+        return "transparent";
+    case Simulator::HugePages::Explicit:
+        return "explicit";
+    }
+    return "off";
+}
+
+// Random occupancy probes over a 128 MiB grid, where regular pages miss the TLB on most probes.
+void benchmarkPageMode(Runner &runner, Simulator::HugePages mode, unsigned threads)
+{
+    const auto label = "Pages/" + modeName(mode) + " touch=" + std::to_string(threads);
+    const auto construct = label + " construct";
+    const auto probe_name = label + " isOccupied(random)";
+    // Filling every page of the grid takes far longer than either benchmark.
+    if (!runner.matches(construct) && !runner.matches(probe_name))
+    {
+        return;
+    }
+    const auto saved = Simulator::pageOptions();
+    Simulator::setPageOptions({.huge_pages = mode, .first_touch_threads = threads});
+
+    std::mt19937_64 random{11};
+    std::uniform_int_distribution<RobotFactory::Coordinate> coordinate{0, large_extent - 1};
+    std::vector<RobotFactory::RobotLocation> probes(probe_count);
+    for (auto &probe : probes)
+    {
+        probe = {.x = coordinate(random), .y = coordinate(random)};
+    }
+
+    runner.run(construct, 1,
+               []
+               {
+                   const Simulator::RobotGrid grid{
+                       {.width = large_extent, .height = large_extent}};
+                   keep(grid.size().width);
+               });
+    if (!runner.matches(probe_name))
+    {
+        Simulator::setPageOptions(saved);
+        return;
+    }
+
+    // Never-written pages all map the shared zero page, so write one robot into every 4 KiB page.
+    Simulator::RobotGrid grid{{.width = large_extent, .height = large_extent}};
+    constexpr RobotFactory::Coordinate cells_per_page{4096 / sizeof(RobotFactory::RobotId)};
+    std::vector<std::unique_ptr<RobotFactory::Marvin>> robots;
+    robots.reserve(static_cast<std::size_t>(large_extent * large_extent / cells_per_page));
+    for (RobotFactory::Coordinate y = 0; y < large_extent; ++y)
+    {
+        for (RobotFactory::Coordinate x = 0; x < large_extent; x += cells_per_page)
+        {
+            robots.push_back(std::make_unique<RobotFactory::Marvin>(
+                RobotFactory::RobotLocation{.x = x, .y = y}, "PAGE"));
+            keep(grid.addRobot(*robots.back()));
+        }
+    }
+    TlbMissCounter counter;
+    std::int64_t misses{0};
+    runner.run(probe_name, probe_count,
+               [&grid, &probes, &counter, &misses]
+               {
+                   std::size_t occupied{0};
+                   counter.start();
+                   for (const auto &probe : probes)
+                   {
+                       occupied += grid.isOccupied(probe) ? 1U : 0U;
+                   }
+                   misses = counter.stop();
+                   keep(occupied);
+               });
+    if (misses >= 0)
+    {
+        std::cout << "  dTLB load misses per probe: "
+                  << static_cast<double>(misses) / static_cast<double>(probe_count) << '\n';
+    }
+    Simulator::setPageOptions(saved);
+}
+
+} // namespace
+
+void runMemoryBenchmarks(Runner &runner)
+{
+    benchmarkPageMode(runner, Simulator::HugePages::Off, 1);
+    benchmarkPageMode(runner, Simulator::HugePages::Transparent, 1);
+    benchmarkPageMode(runner, Simulator::HugePages::Explicit, 1);
+    benchmarkPageMode(runner, Simulator::HugePages::Transparent, 4);
+}
+
+} // namespace Benchmarks
@@ -0,0 +1,550 @@
+#include "Benchmark.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/EventRing.h"
+#include "marvin/simulator/Heatmap.h"
+#include "marvin/simulator/Population.h"
+#include "marvin/simulator/RobotBehavior.h"
+#include "marvin/simulator/RobotHandleTable.h"
+#include "marvin/simulator/RobotSimulator.h"
+#include "marvin/simulator/TerrainMap.h"
+#include "marvin/simulator/TrajectoryRecorder.h"
+#include "marvin/simulator/WorldHost.h"
+#include "marvin/simulator/WorldMap.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Benchmarks
+{
+namespace
+{
+
+constexpr Simulator::GridSize world_size{.width = 1000, .height = 1000};
+constexpr std::size_t world_robots{200'000};
+
+[[nodiscard]] std::vector<RobotFactory::RobotLocation> latticeLocations()
+{
+    std::vector<RobotFactory::RobotLocation> locations;
+    locations.reserve(world_robots);
+    for (RobotFactory::Coordinate y = 0; locations.size() < world_robots; y += 2)
+    {
+        for (RobotFactory::Coordinate x = 0;
+             x < world_size.width && locations.size() < world_robots; x += 2)
+        {
+            locations.push_back({.x = x, .y = y, .direction = RobotFactory::Direction::North});
+        }
+    }
+    return locations;
+}
+
+void benchmarkPopulation(Runner &runner)
+{
+    const auto locations = latticeLocations();
+    std::vector<std::string> script;
+    script.reserve(locations.size());
+    for (std::size_t robot = 0; robot < locations.size(); ++robot)
+    {
+        std::ostringstream line;
+        line << "PLACE BOT" << robot << ' ' << locations.at(robot).x << ','
+             << locations.at(robot).y << " NORTH";
+        script.push_back(line.str());
+    }
+
+    runner.run("World/PLACE script", world_robots,
+               [&script]
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   std::ostringstream sink;
+                   for (const auto &line : script)
+                   {
+                       keep(simulator.executeLine(line, sink, sink));
+                   }
+                   keep(simulator.robotCount());
+               });
+
+    runner.run("World/placeBulk(span)", world_robots,
+               [&locations]
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, locations));
+               });
+
+    runner.run("World/populate(LATTICE)", world_robots,
+               []
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.populate(world_robots, Simulator::PopulationPattern::Lattice));
+               });
+
+    runner.run("World/populate(RANDOM)", world_robots,
+               []
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.populate(world_robots, Simulator::PopulationPattern::Random, 1));
+               });
+}
+
+// A 4000x4000 ASCII warehouse: rack rows with aisles and about 100k robots; ops are bytes,
+// so Mop/s reads as MB/s.
+void benchmarkLoadMap(Runner &runner)
+{
+    constexpr RobotFactory::Coordinate side{4000};
+    const auto path = std::filesystem::temp_directory_path() / "marvin-benchmark-map.txt";
+    {
+        std::ofstream map{path, std::ios::binary};
+        std::string line(static_cast<std::size_t>(side), '.');
+        for (RobotFactory::Coordinate y = 0; y < side; ++y)
+        {
+            for (RobotFactory::Coordinate x = 0; x < side; ++x)
+            {
+                const bool rack = y % 4 == 1 && x % 40 < 36;
+                const bool robot = x % 64 == 0 && y % 2 == 0;
+                line.at(static_cast<std::size_t>(x)) = rack ? '#' : robot ? '^' : '.';
+            }
+            map << line << '\n';
+        }
+    }
+    const auto bytes = static_cast<std::size_t>(std::filesystem::file_size(path));
+    runner.run("World/loadMap(4000x4000 ASCII)", bytes,
+               [&path]
+               {
+                   Simulator::RobotSimulator simulator;
+                   const Simulator::WorldMap map{path.string()};
+                   keep(simulator.loadMap(map));
+                   keep(simulator.robotCount());
+               });
+    std::filesystem::remove(path);
+}
+
+void benchmarkTransactions(Runner &runner)
+{
+    constexpr std::size_t moves{100'000};
+    const auto run_moves = [](Simulator::RobotSimulator &simulator)
+    {
+        for (std::size_t step = 0; step < moves; ++step)
+        {
+            keep(simulator.moveAll());
+            keep(simulator.rotateAll(step % 2 == 0 ? RobotFactory::Rotation::Left
+                                                   : RobotFactory::Rotation::Right));
+        }
+    };
+
+    runner.run("Transaction/moves outside", moves,
+               [&run_moves]
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.populate(4, Simulator::PopulationPattern::Random, 1));
+                   run_moves(simulator);
+               });
+
+    runner.run("Transaction/moves then COMMIT", moves,
+               [&run_moves]
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.populate(4, Simulator::PopulationPattern::Random, 1));
+                   keep(simulator.begin());
+                   run_moves(simulator);
+                   keep(simulator.commit());
+               });
+
+    runner.run("Transaction/moves then ABORT", moves,
+               [&run_moves]
+               {
+                   Simulator::RobotSimulator simulator{world_size};
+                   keep(simulator.populate(4, Simulator::PopulationPattern::Random, 1));
+                   keep(simulator.begin());
+                   run_moves(simulator);
+                   keep(simulator.abort());
+               });
+}
+
+// 10k MOVE lines, each for a different robot of a full world, run on their own and as one
+// BEGIN/COMMIT batch, whose moves reach the grid in one pass at COMMIT; ops are lines.
+void benchmarkTransactionBatch(Runner &runner)
+{
+    constexpr std::size_t lines{10'000};
+    if (!runner.matches("Transaction/10k MOVE lines"))
+    {
+        return;
+    }
+    std::vector<std::size_t> slots(world_robots);
+    std::iota(slots.begin(), slots.end(), std::size_t{0});
+    std::shuffle(slots.begin(), slots.end(), std::mt19937_64{5});
+    std::vector<std::string> script;
+    script.reserve(lines);
+    for (std::size_t line = 0; line < lines; ++line)
+    {
+        // Bulk robots are named R<id>, and fresh IDs count up from first_id.
+        script.push_back("MOVE R" +
+                         std::to_string(Simulator::RobotHandleTable::first_id + slots.at(line)) +
+                         " 1");
+    }
+    const auto run_script = [&script](Simulator::RobotSimulator &simulator, bool batch)
+    {
+        std::ostringstream sink;
+        if (batch)
+        {
+            keep(simulator.executeLine("BEGIN", sink, sink));
+        }
+        for (const auto &line : script)
+        {
+            keep(simulator.executeLine(line, sink, sink));
+        }
+        if (batch)
+        {
+            keep(simulator.executeLine("COMMIT", sink, sink));
+        }
+        keep(sink.view().size());
+    };
+
+    for (const bool batch : {false, true})
+    {
+        Simulator::RobotSimulator simulator{world_size};
+        keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+        runner.run(batch ? "Transaction/10k MOVE lines in BEGIN/COMMIT"
+                         : "Transaction/10k MOVE lines on their own",
+                   lines, [&run_script, &simulator, batch] { run_script(simulator, batch); });
+    }
+}
+
+// WHERE scans over a full world; ops are robots tested.
+void benchmarkWhere(Runner &runner)
+{
+    constexpr std::size_t passes{20};
+    Simulator::RobotSimulator simulator{world_size};
+    keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+
+    const Simulator::RobotFilter none{.directions = 0b0010U, .x = {}, .y = {}, .id = {},
+                                      .name_prefix = {}};
+    runner.run("Where/no match", passes * world_robots,
+               [&simulator, &none]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       keep(simulator.rotateWhere(none, RobotFactory::Rotation::Left));
+                   }
+               });
+
+    const Simulator::RobotFilter band{
+        .directions = Simulator::RobotFilter::all_directions,
+        .x = {},
+        .y = {.first = 100, .last = 199},
+        .id = {},
+        .name_prefix = {}};
+    runner.run("Where/Y band (10%)", passes * world_robots,
+               [&simulator, &band]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       keep(simulator.rotateWhere(band, pass % 2 == 0
+                                                            ? RobotFactory::Rotation::Left
+                                                            : RobotFactory::Rotation::Right));
+                   }
+               });
+}
+
+// Robots step north and back; ops are moves. The terrain makes every odd row alternate slow and
+// blocked cells, so each robot crosses 1000 runs per row while it never hits a blocked one.
+void benchmarkTerrain(Runner &runner)
+{
+    constexpr std::size_t passes{10};
+    const auto run_moves = [](Simulator::RobotSimulator &simulator)
+    {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+        {
+            keep(simulator.moveAll());
+            keep(simulator.rotateAll(RobotFactory::Rotation::Left));
+            keep(simulator.rotateAll(RobotFactory::Rotation::Left));
+        }
+    };
+
+    Simulator::RobotSimulator open{world_size};
+    keep(open.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+    runner.run("Terrain/moveAll(no terrain)", passes * world_robots,
+               [&open, &run_moves] { run_moves(open); });
+
+    Simulator::TerrainMap::Builder builder;
+    for (RobotFactory::Coordinate y = 1; y < world_size.height; y += 2)
+    {
+        for (RobotFactory::Coordinate x = 0; x < world_size.width; ++x)
+        {
+            builder.addRun(y, x, x + 1, x % 2 == 0 ? 2 : Simulator::terrain_blocked);
+        }
+    }
+    Simulator::RobotSimulator rough{world_size};
+    keep(rough.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+    keep(rough.setTerrain(std::move(builder).build()));
+    runner.run("Terrain/moveAll(500k runs)", passes * world_robots,
+               [&rough, &run_moves] { run_moves(rough); });
+}
+
+// moveAll() and rotateAll() with and without an event subscriber that drains after each pass.
+void benchmarkEvents(Runner &runner)
+{
+    constexpr std::size_t passes{10};
+    Simulator::RobotSimulator quiet{world_size};
+    keep(quiet.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+    runner.run("Events/moveAll(no subscriber)", passes * world_robots,
+               [&quiet]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       keep(quiet.moveAll());
+                       keep(quiet.rotateAll(RobotFactory::Rotation::Left));
+                   }
+               });
+
+    Simulator::RobotSimulator observed{world_size};
+    keep(observed.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+    auto &ring = observed.events();
+    const auto subscriber = ring.subscribe();
+    std::size_t seen{0};
+    const auto count = [&seen](std::span<const Simulator::SimulatorEvent> events)
+    { seen += events.size(); };
+    runner.run("Events/moveAll(subscribed)", passes * world_robots,
+               [&observed, &ring, subscriber, &count]
+               {
+                   for (std::size_t pass = 0; pass < passes; ++pass)
+                   {
+                       keep(observed.moveAll());
+                       keep(ring.drain(subscriber, count).lost);
+                       keep(observed.rotateAll(RobotFactory::Rotation::Left));
+                       keep(ring.drain(subscriber, count).lost);
+                   }
+               });
+    keep(seen);
+}
+
+// The same moves with a heatmap counting them, against a simulator without one.
+void benchmarkHeatmap(Runner &runner)
+{
+    constexpr std::size_t passes{10};
+    const auto run = [&runner](std::string_view name, Simulator::RobotSimulator &simulator)
+    {
+        keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+        runner.run(name, passes * world_robots,
+                   [&simulator]
+                   {
+                       for (std::size_t pass = 0; pass < passes; ++pass)
+                       {
+                           keep(simulator.moveAll());
+                           keep(simulator.rotateAll(RobotFactory::Rotation::Left));
+                       }
+                   });
+    };
+    Simulator::RobotSimulator plain{world_size};
+    run("Heatmap/moveAll(off)", plain);
+    Simulator::RobotSimulator counted{world_size};
+    keep(counted.startHeatmap());
+    run("Heatmap/moveAll(on)", counted);
+    keep(counted.heatmap().tilesInUse());
+}
+
+// The same moves over the dynamic grid and over a FixedRobotGrid of the same size.
+void benchmarkFixedGrid(Runner &runner)
+{
+    constexpr std::size_t passes{10};
+    const auto run = [&runner](std::string_view name, auto &simulator)
+    {
+        keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+        runner.run(name, passes * world_robots,
+                   [&simulator]
+                   {
+                       for (std::size_t pass = 0; pass < passes; ++pass)
+                       {
+                           keep(simulator.moveAll());
+                           keep(simulator.rotateAll(RobotFactory::Rotation::Left));
+                       }
+                   });
+    };
+    Simulator::RobotSimulator dynamic{world_size};
+    run("Simulator/moveAll(RobotGrid)", dynamic);
+    Simulator::FixedRobotSimulator<world_size.width, world_size.height> fixed;
+    run("Simulator/moveAll(FixedRobotGrid)", fixed);
+}
+
+// Moves with the trajectory recorder off and streaming to memory; ops are moves and rotations,
+// each of which appends one record.
+void benchmarkTrajectory(Runner &runner)
+{
+    constexpr std::size_t passes{10};
+    const auto run = [&runner](std::string_view name, Simulator::RobotSimulator &simulator)
+    {
+        keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+        runner.run(name, passes * world_robots * 2,
+                   [&simulator]
+                   {
+                       for (std::size_t pass = 0; pass < passes; ++pass)
+                       {
+                           keep(simulator.moveAll());
+                           keep(simulator.rotateAll(RobotFactory::Rotation::Left));
+                       }
+                   });
+    };
+    Simulator::RobotSimulator plain{world_size};
+    run("Trajectory/moveAll(off)", plain);
+    std::ostringstream recording;
+    Simulator::RobotSimulator recorded{world_size};
+    recorded.startRecording(recording);
+    run("Trajectory/moveAll(on)", recorded);
+    keep(recorded.stopRecording());
+    keep(recording.view().size());
+}
+
+// A 100k-line replay run line by line and through the parsing pipeline; ops are lines. The
+// pipeline can only hide parsing, so it gains until the executing thread is saturated.
+void benchmarkPipeline(Runner &runner)
+{
+    constexpr std::size_t rounds{10'000};
+    std::string script{"PLACE A 1,1 NORTH\nPLACE B 5,5 EAST\n"};
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+        script += "MOVE A 2\nROTATE A RIGHT\nMOVE @43 WHERE X=0..9\nLEFT B\nMOVE B\n"
+                  "ROTATE ALL LEFT\nREMOVE NOBODY\nMOVE A 99999999999999999999\nHASH\nSCAN A\n";
+    }
+    const auto lines = (rounds * 10) + 2;
+    const auto replay = [&script](unsigned threads)
+    {
+        Simulator::RobotSimulator simulator;
+        std::istringstream input{script};
+        std::ostringstream output;
+        if (threads == 0)
+        {
+            simulator.run(input, output, output);
+        }
+        else
+        {
+            simulator.runPipelined(input, output, output, threads);
+        }
+        keep(output.view().size());
+    };
+    runner.run("Pipeline/run", lines, [&replay] { replay(0); });
+    const auto hardware = std::max(std::thread::hardware_concurrency(), 1U);
+    for (unsigned threads = 1; threads <= std::max(hardware, 2U); threads *= 2)
+    {
+        runner.run("Pipeline/runPipelined(" + std::to_string(threads) + ")", lines,
+                   [&replay, threads] { replay(threads); });
+    }
+}
+
+// 1000 small worlds, each given ten batches of ten commands; ops are commands. The baseline gives
+// every world a thread of its own.
+void benchmarkWorldHost(Runner &runner)
+{
+    constexpr std::size_t worlds{1000};
+    constexpr std::size_t batches{10};
+    const std::string batch{"MOVE A\nROTATE A RIGHT\nMOVE A\nROTATE A RIGHT\nMOVE A\n"
+                            "ROTATE A RIGHT\nMOVE A\nROTATE A RIGHT\nREPORT\nSCAN A"};
+
+    runner.run("WorldHost/thread per world", worlds * batches * 10,
+               [&batch]
+               {
+                   std::vector<std::jthread> threads;
+                   threads.reserve(worlds);
+                   for (std::size_t world = 0; world < worlds; ++world)
+                   {
+                       threads.emplace_back(
+                           [&batch]
+                           {
+                               Simulator::RobotSimulator simulator;
+                               std::ostringstream sink;
+                               keep(simulator.executeLine("PLACE A 1,1 NORTH", sink, sink));
+                               for (std::size_t round = 0; round < batches; ++round)
+                               {
+                                   std::istringstream lines{batch};
+                                   for (std::string line; std::getline(lines, line);)
+                                   {
+                                       keep(simulator.executeLine(line, sink, sink));
+                                   }
+                               }
+                           });
+                   }
+               });
+
+    runner.run("WorldHost/shared pool", worlds * batches * 10,
+               [&batch]
+               {
+                   Simulator::WorldHost host;
+                   std::vector<Simulator::WorldId> ids;
+                   ids.reserve(worlds);
+                   for (std::size_t world = 0; world < worlds; ++world)
+                   {
+                       ids.push_back(host.create());
+                       keep(host.submit(ids.back(), "PLACE A 1,1 NORTH").valid());
+                   }
+                   for (std::size_t round = 0; round < batches; ++round)
+                   {
+                       for (const auto id : ids)
+                       {
+                           keep(host.submit(id, batch).valid());
+                       }
+                   }
+                   host.wait();
+               });
+}
+
+Simulator::RobotBehavior wander(std::size_t steps)
+{
+    for (std::size_t step = 0; step < steps; ++step)
+    {
+        if (!co_await Simulator::Behavior::move())
+        {
+            co_await Simulator::Behavior::rotate(RobotFactory::Rotation::Right);
+        }
+    }
+}
+
+// One coroutine per robot; ops are behaviours resumed.
+void benchmarkBehaviors(Runner &runner)
+{
+    constexpr std::size_t ticks{20};
+    Simulator::RobotSimulator simulator{world_size};
+    keep(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, latticeLocations()));
+    for (RobotFactory::RobotId id = 43; id < 43 + world_robots; ++id)
+    {
+        keep(simulator.attach(id, wander(ticks)));
+    }
+    runner.run("Behavior/tick(200k wandering)", ticks * world_robots,
+               [&simulator]
+               {
+                   for (std::size_t tick = 0; tick < ticks; ++tick)
+                   {
+                       keep(simulator.tick());
+                   }
+               });
+}
+
+} // namespace
+
+void runSimulatorBenchmarks(Runner &runner)
+{
+    benchmarkPopulation(runner);
+    benchmarkLoadMap(runner);
+    benchmarkTransactions(runner);
+    benchmarkTransactionBatch(runner);
+    benchmarkWhere(runner);
+    benchmarkTerrain(runner);
+    benchmarkEvents(runner);
+    benchmarkHeatmap(runner);
+    benchmarkFixedGrid(runner);
+    benchmarkTrajectory(runner);
+    benchmarkPipeline(runner);
+    benchmarkBehaviors(runner);
+    benchmarkWorldHost(runner);
+}
+
+} // namespace Benchmarks
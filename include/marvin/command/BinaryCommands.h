@@ -0,0 +1,98 @@
+#ifndef BINARY_COMMANDS_H
+#define BINARY_COMMANDS_H
+
+#include "marvin/command/Command.h"
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace Simulator
+{
+
+// Binary command stream format, all integers unsigned LEB128 varints:
+//
+//   stream  := magic record*
+//   magic   := the 8 bytes "MRVCMDS1"
+//   record  := opcode operands, the opcode one byte:
+//
+//     0 PLACE name x y direction    5 REPORT         10 ABORT
+//     1 MOVE target blocks          6 SCAN target    11 QUIT
+//     2 ROTATE target rotation      7 HASH           12 TEXT length byte*
+//     3 REMOVE target               8 BEGIN
+//     4 RESIZE width height         9 COMMIT
+//
+//   target  := 0 (ALL) | 1 name | 2 id | 3 pattern
+//   name    := length byte*, upper-case, as is a pattern
+//
+// A direction is one byte, 0 north, 1 east, 2 south, 3 west, and a rotation one byte, 0 left and
+// 1 right. TEXT holds a command line for the parser, for every command without a record of its
+// own, malformed lines included. Records decode to the commands the parser makes of their text.
+inline constexpr std::array<char, 8> binary_commands_magic{'M', 'R', 'V', 'C', 'M', 'D', 'S', '1'};
+
+enum class BinaryOpcode : std::uint8_t
+{
+    Place,
+    Move,
+    Rotate,
+    Remove,
+    Resize,
+    Report,
+    Scan,
+    Hash,
+    Begin,
+    Commit,
+    Abort,
+    Quit,
+    Text
+};
+
+enum class BinaryTarget : std::uint8_t
+{
+    All,
+    Name,
+    Id,
+    Pattern
+};
+
+// Appends `command` as one record. Commands with WHERE filters or group targets have no record;
+// for those this returns false and appends nothing.
+bool appendBinaryCommand(const Command &command, std::string &bytes);
+// Appends a TEXT record.
+void appendBinaryText(std::string_view line, std::string &bytes);
+
+// Reads the bytes of `input` that match the binary stream header, leaving the first that does
+// not unread. Returns true once the whole header has been read; otherwise `prefix` holds the
+// bytes read, which are the start of a text line.
+[[nodiscard]] bool readBinaryHeader(std::istream &input, std::string &prefix);
+
+// Reads a binary command stream one record at a time.
+class BinaryCommandReader
+{
+  public:
+    enum class Header : std::uint8_t
+    {
+        Unread,
+        Read // By readBinaryHeader().
+    };
+
+    // Reads and checks the stream header, unless it has been read already.
+    explicit BinaryCommandReader(std::istream &input, Header header = Header::Unread);
+
+    // Replaces `result` with the next record's command, or with the parse error of a malformed
+    // TEXT record. Returns false at the end of the stream or, with valid() then false, on a bad
+    // header or a truncated or malformed record.
+    [[nodiscard]] bool next(ParseResult &result);
+    [[nodiscard]] bool valid() const noexcept;
+
+  private:
+    std::istream &m_input;
+    std::string m_text;
+    bool m_valid{true};
+};
+
+} // namespace Simulator
+
+#endif
@@ -2,64 +2,250 @@
 #define COMMAND_H
 
 #include "marvin/robot/Robot.h"
+#include "marvin/simulator/Heatmap.h"
+#include "marvin/simulator/Population.h"
 #include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotQuery.h"
+#include "marvin/simulator/TrajectoryRecorder.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 
 namespace Simulator
 {
 
+// Upper-case name pattern: `*` matches any run of characters and `?` any single character.
+struct NamePattern
+{
+    std::string pattern;
+
+    // The characters before the first wildcard, which every matching name starts with.
+    [[nodiscard]] std::string_view prefix() const noexcept;
+    [[nodiscard]] bool matches(std::string_view name) const noexcept;
+};
+
+// Upper-case name of a robot group. The parser reads every plain name as a robot name;
+// RobotSimulator::executeLine() turns one that no robot has into the group of that name.
+struct GroupName
+{
+    std::string name;
+};
+
 struct RobotTarget
 {
-    std::variant<std::string, RobotFactory::RobotId> value;
+    std::variant<std::string, RobotFactory::RobotId, NamePattern, GroupName> value;
 };
 
 struct PlaceCommand
 {
+    static constexpr std::string_view verb{"PLACE"};
+
     std::string name;
     RobotFactory::RobotLocation location;
 };
 
 struct MoveCommand
 {
+    static constexpr std::string_view verb{"MOVE"};
+
     std::optional<RobotTarget> target;
     std::uint32_t blocks{1};
+    std::optional<RobotFilter> where; // Only with no target: applies to the matching robots.
 };
 
 struct RotateCommand
 {
+    static constexpr std::string_view verb{"ROTATE"};
+
     std::optional<RobotTarget> target;
     RobotFactory::Rotation rotation;
+    std::optional<RobotFilter> where;
 };
 
 struct RemoveCommand
 {
+    static constexpr std::string_view verb{"REMOVE"};
+
     std::optional<RobotTarget> target;
+    std::optional<RobotFilter> where;
 };
 
 struct ResizeCommand
 {
+    static constexpr std::string_view verb{"RESIZE"};
+
     GridSize size;
 };
 
 struct ReportCommand
 {
+    static constexpr std::string_view verb{"REPORT"};
+
+    std::optional<RobotFilter> where;
 };
 
 struct MenuCommand
 {
+    static constexpr std::string_view verb{"MENU"};
 };
 
 struct QuitCommand
 {
+    static constexpr std::string_view verb{"QUIT"};
+};
+
+struct StatsCommand
+{
+    static constexpr std::string_view verb{"STATS"};
+
+    bool reset{false};
+    bool json{false};
+};
+
+struct TraceCommand
+{
+    static constexpr std::string_view verb{"TRACE"};
+
+    std::string path; // Empty stops tracing.
+    std::uint32_t sample_every{1};
+};
+
+struct PopulateCommand
+{
+    static constexpr std::string_view verb{"POPULATE"};
+
+    std::size_t count{0};
+    PopulationPattern pattern{PopulationPattern::Random};
+    std::uint64_t seed{0};
+};
+
+struct BeginCommand
+{
+    static constexpr std::string_view verb{"BEGIN"};
+};
+
+struct CommitCommand
+{
+    static constexpr std::string_view verb{"COMMIT"};
+};
+
+struct AbortCommand
+{
+    static constexpr std::string_view verb{"ABORT"};
+};
+
+struct HashCommand
+{
+    static constexpr std::string_view verb{"HASH"};
+
+    enum class Action : std::uint8_t
+    {
+        Show,
+        ShowTrail,
+        StartTrail,
+        StopTrail
+    };
+
+    Action action{Action::Show};
+    std::uint32_t every{0}; // Commands between trail entries, for StartTrail.
+};
+
+struct ScanCommand
+{
+    static constexpr std::string_view verb{"SCAN"};
+
+    std::optional<RobotTarget> target;
+};
+
+struct LoadMapCommand
+{
+    static constexpr std::string_view verb{"LOADMAP"};
+
+    std::string path;
+};
+
+struct MemoryCommand
+{
+    static constexpr std::string_view verb{"MEMORY"};
+
+    enum class Action : std::uint8_t
+    {
+        Show,
+        SetLimit
+    };
+
+    Action action{Action::Show};
+    std::size_t limit{0}; // Bytes, for SetLimit; zero removes the limit.
+};
+
+struct HeatmapCommand
+{
+    static constexpr std::string_view verb{"HEATMAP"};
+
+    enum class Action : std::uint8_t
+    {
+        Show,
+        Start,
+        Stop,
+        Reset,
+        ExportCsv,
+        ExportPgm
+    };
+
+    Action action{Action::Show};
+    Heatmap::Width width{Heatmap::Width::Bits32};       // For Start.
+    Heatmap::Channel channel{Heatmap::Channel::Visits}; // For ExportPgm.
+    std::string path;                                   // For the exports.
+};
+
+struct GroupCommand
+{
+    static constexpr std::string_view verb{"GROUP"};
+
+    enum class Action : std::uint8_t
+    {
+        List,
+        Create,
+        Add,
+        Delete
+    };
+
+    Action action{Action::List};
+    std::string name;                 // Upper-case, for everything but List.
+    std::vector<RobotTarget> members; // For Add.
+};
+
+struct RecordCommand
+{
+    static constexpr std::string_view verb{"RECORD"};
+
+    enum class Action : std::uint8_t
+    {
+        Show,
+        Start,
+        Stop
+    };
+
+    Action action{Action::Show};
+    std::string path; // For Start.
+    std::size_t chunk_records{TrajectoryRecorder::default_chunk_records};
 };
 
 using Command = std::variant<PlaceCommand, MoveCommand, RotateCommand, RemoveCommand, ResizeCommand,
-                             ReportCommand, MenuCommand, QuitCommand>;
+                             ReportCommand, MenuCommand, QuitCommand, StatsCommand, TraceCommand,
+                             PopulateCommand, BeginCommand, CommitCommand, AbortCommand,
+                             HashCommand, ScanCommand, LoadMapCommand, MemoryCommand,
+                             HeatmapCommand, GroupCommand, RecordCommand>;
+
+inline constexpr std::size_t command_kind_count = std::variant_size_v<Command>;
+
+// Upper-case verb of the command alternative at `index`, or "INVALID" past the last alternative.
+[[nodiscard]] std::string_view commandVerb(std::size_t index) noexcept;
 
 struct ParseResult
 {
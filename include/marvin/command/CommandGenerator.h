@@ -0,0 +1,150 @@
+#ifndef COMMAND_GENERATOR_H
+#define COMMAND_GENERATOR_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Simulator
+{
+
+// Relative weights of the commands a CommandGenerator writes; zero leaves a kind out.
+struct CommandMix
+{
+    std::uint32_t place{20};
+    std::uint32_t move{30};
+    std::uint32_t rotate{15}; // ROTATE, LEFT or RIGHT.
+    std::uint32_t remove{6};
+    std::uint32_t resize{2};
+    std::uint32_t report{2};
+    std::uint32_t scan{6};
+    std::uint32_t hash{3};
+    std::uint32_t transaction{6}; // BEGIN, COMMIT or ABORT.
+    std::uint32_t malformed{1};   // Lines the parser rejects.
+};
+
+// Relative weights of the ways MOVE, ROTATE, REMOVE and SCAN pick their robots.
+struct TargetMix
+{
+    std::uint32_t name{70};
+    std::uint32_t id{15};
+    std::uint32_t all{10};
+    std::uint32_t pattern{5};
+};
+
+struct CommandGeneratorOptions
+{
+    CommandMix mix;
+    TargetMix targets;
+    // Robots are named R0 up to R<names - 1>, so names are reused; zero gives every PLACE a new
+    // name, numbered from first_name, so that parts of a stream written apart keep theirs apart.
+    std::size_t names{24};
+    std::uint64_t first_name{0};
+    GridSize grid{default_grid_size};        // Where the commands expect the world to start.
+    RobotFactory::Coordinate max_extent{72}; // Largest RESIZE width or height.
+    std::uint32_t max_blocks{4};
+    // Share of PLACE commands aimed at the cell, and half of those at the name, of a recent PLACE.
+    double collisions{0.1};
+};
+
+// Writes a reproducible stream of random commands for the simulator, as text lines or binary
+// records: the same seed and options always give the same commands. The generator does not model
+// the world; it remembers only its recent placements and its own RESIZE and BEGIN commands, which
+// is enough to aim most commands at robots that exist while still producing collisions, misses
+// and failed transactions.
+class CommandGenerator
+{
+  public:
+    enum class Kind : std::uint8_t
+    {
+        Place,
+        Move,
+        Rotate,
+        Remove,
+        Resize,
+        Report,
+        Scan,
+        Hash,
+        Transaction,
+        Malformed
+    };
+    static constexpr std::size_t kind_count{10};
+
+    enum class Target : std::uint8_t
+    {
+        Name,
+        Id,
+        All,
+        Pattern
+    };
+    static constexpr std::size_t target_count{4};
+
+    // Throws std::invalid_argument if the command or target mix has no weight.
+    explicit CommandGenerator(std::uint64_t seed, CommandGeneratorOptions options = {});
+
+    // Seed for stream `stream` of a run seeded with `seed`, such as a block or an episode. The
+    // two are mixed rather than added, so runs with nearby seeds do not share streams.
+    [[nodiscard]] static std::uint64_t streamSeed(std::uint64_t seed,
+                                                  std::uint64_t stream) noexcept;
+
+    // The next command's line, without a newline.
+    [[nodiscard]] std::string next();
+    // Appends the next command's line and a newline.
+    void appendText(std::string &text);
+    // Appends the next command as a record of the binary command format (see BinaryCommands.h).
+    void appendBinary(std::string &bytes);
+
+    // Kind of the last command.
+    [[nodiscard]] Kind kind() const noexcept;
+    // Commands of a kind, and targets of a kind, generated so far.
+    [[nodiscard]] std::uint64_t generated(Kind kind) const noexcept;
+    [[nodiscard]] std::uint64_t targeted(Target target) const noexcept;
+
+  private:
+    static constexpr std::size_t recent_capacity{64};
+
+    struct Placement
+    {
+        std::uint64_t name{0}; // R<name>.
+        RobotFactory::RobotLocation location;
+    };
+
+    // Buffer that the next command's line or record is written into, one field at a time.
+    class LineWriter;
+
+    CommandGeneratorOptions m_options;
+    std::uint64_t m_state; // SplitMix64, which draws several times faster than mt19937_64.
+    std::array<std::uint64_t, kind_count> m_kind_thresholds{}; // Cumulative weights.
+    std::array<std::uint64_t, target_count> m_target_thresholds{};
+    std::array<std::uint64_t, kind_count> m_generated{};
+    std::array<std::uint64_t, target_count> m_targeted{};
+    GridSize m_grid;
+    std::vector<Placement> m_recent; // A ring of the last recent_capacity placements.
+    std::size_t m_placed{0};
+    bool m_open{false};
+
+    Kind m_kind{Kind::Place}; // Of the last command.
+
+    // Draws the next command and writes it as it goes, as a text line or a binary record, rather
+    // than building a Command, names and all, only to write it out.
+    template <bool Binary> void generate(LineWriter &writer);
+    [[nodiscard]] std::uint64_t draw() noexcept;
+    [[nodiscard]] bool chance(double probability);
+    [[nodiscard]] std::uint64_t below(std::uint64_t bound);
+    template <std::size_t Size>
+    [[nodiscard]] std::size_t pick(const std::array<std::uint64_t, Size> &thresholds);
+    [[nodiscard]] std::uint64_t name();
+    template <bool Binary> void target(LineWriter &writer);
+    template <bool Binary> void place(LineWriter &writer);
+    template <bool Binary> void transaction(LineWriter &writer);
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef COMMAND_PIPELINE_H
+#define COMMAND_PIPELINE_H
+
+#include "marvin/command/Command.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Simulator
+{
+
+struct ParsedLine
+{
+    ParseResult result;
+    std::uint64_t parse_ns{0}; // Zero when statistics are compiled out.
+};
+
+// Parses a script on worker threads ahead of a single consumer. Each worker takes the next chunk
+// of lines from the input, parses it on its own, and leaves the results in a slot of a bounded
+// window; next() hands the chunks back strictly in input order, so the consumer sees every line,
+// blank or malformed ones included, exactly as a line-by-line reader would. At most `window`
+// chunks are read ahead of the consumer, which bounds the memory held and keeps workers from
+// racing through input the consumer may never reach after a QUIT.
+//
+// Workers block on the input stream, so this suits files and pipes rather than an interactive
+// terminal: the destructor waits for any read in progress.
+class CommandPipeline
+{
+  public:
+    static constexpr std::size_t default_chunk_lines{256};
+    static constexpr std::size_t default_window_per_thread{4};
+
+    // A window of zero gives default_window_per_thread chunks per thread.
+    CommandPipeline(std::istream &input, unsigned threads,
+                    std::size_t chunk_lines = default_chunk_lines, std::size_t window = 0);
+    ~CommandPipeline();
+    CommandPipeline(const CommandPipeline &) = delete;
+    CommandPipeline &operator=(const CommandPipeline &) = delete;
+    CommandPipeline(CommandPipeline &&) = delete;
+    CommandPipeline &operator=(CommandPipeline &&) = delete;
+
+    // The next chunk in input order, valid until the following call; empty once the input ends.
+    [[nodiscard]] std::span<const ParsedLine> next();
+
+  private:
+    struct Chunk
+    {
+        std::vector<ParsedLine> lines;
+        bool ready{false};
+    };
+
+    std::istream &m_input;
+    std::size_t m_chunk_lines;
+
+    // Guards reading the input and m_next_read; taken before m_mutex when both are needed.
+    std::mutex m_input_mutex;
+    std::uint64_t m_next_read{0};
+    bool m_input_done{false};
+
+    // Guards everything below. Chunk n lives in slot n % window until the consumer moves past it.
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_space;
+    std::vector<Chunk> m_chunks;
+    std::uint64_t m_next_consume{0};
+    std::optional<std::uint64_t> m_end; // Number of chunks, once the input has ended.
+    bool m_holding{false};              // The consumer still holds chunk m_next_consume - 1.
+    bool m_stopping{false};
+
+    std::vector<std::jthread> m_threads; // Declared last so workers start after the rest.
+
+    void work();
+};
+
+} // namespace Simulator
+
+#endif
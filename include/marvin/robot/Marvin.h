@@ -3,6 +3,7 @@
 
 #include "marvin/robot/Robot.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -14,10 +15,12 @@ class Marvin final : public Robot
   public:
     explicit Marvin(std::string name = "Marvin");
     Marvin(RobotLocation location, std::string name = "Marvin");
+    Marvin(RobotLocation location, std::string name, RobotId id);
     ~Marvin() override = default;
 
     void rotate(Rotation rotation) noexcept override;
     void move(std::uint32_t blocks) noexcept override;
+    [[nodiscard]] std::size_t footprint() const noexcept override;
 };
 
 } // namespace RobotFactory
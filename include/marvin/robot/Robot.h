@@ -2,6 +2,7 @@
 #define ROBOT_H
 
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -57,6 +58,8 @@ class Robot
 {
   public:
     Robot(RobotLocation location, std::string model);
+    // Uses an ID allocated by the owner (for example a simulator's handle table); must be non-zero.
+    Robot(RobotLocation location, std::string model, RobotId id);
     virtual ~Robot() = default;
 
     Robot(const Robot &) = delete;
@@ -71,6 +74,8 @@ class Robot
 
     virtual void rotate(Rotation rotation) noexcept = 0;
     virtual void move(std::uint32_t blocks) noexcept = 0;
+    // Size of the most-derived object, not counting the heap storage of its name.
+    [[nodiscard]] virtual std::size_t footprint() const noexcept = 0;
 
   protected:
     RobotLocation m_location;
@@ -4,7 +4,9 @@
 #include "marvin/robot/Marvin.h"
 #include "marvin/robot/Robot.h"
 
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -35,6 +37,46 @@ struct RobotAssembly
 
         return nullptr;
     }
+
+    [[nodiscard]] static std::unique_ptr<Robot> create(GroundRobotType type, RobotLocation location,
+                                                       std::string name, RobotId id)
+    {
+        switch (type)
+        {
+        case GroundRobotType::Bipedal:
+            return std::make_unique<Marvin>(location, std::move(name), id);
+        }
+
+        return nullptr;
+    }
+
+    // Storage for a robot of any type, for owners that build robots in their own memory.
+    static constexpr std::size_t max_footprint{sizeof(Marvin)};
+    static constexpr std::size_t max_alignment{alignof(Marvin)};
+
+    // Builds the robot in `storage`, which holds max_footprint bytes aligned to max_alignment.
+    [[nodiscard]] static Robot *create(void *storage, GroundRobotType type, RobotLocation location,
+                                       std::string name, RobotId id)
+    {
+        switch (type)
+        {
+        case GroundRobotType::Bipedal:
+            return new (storage) Marvin(location, std::move(name), id);
+        }
+
+        return nullptr;
+    }
+
+    // Bytes create() allocates for a robot of `type`, not counting its name.
+    [[nodiscard]] static constexpr std::size_t footprint(GroundRobotType type) noexcept
+    {
+        switch (type)
+        {
+        case GroundRobotType::Bipedal:
+            return sizeof(Marvin);
+        }
+        return 0;
+    }
 };
 
 } // namespace RobotFactory
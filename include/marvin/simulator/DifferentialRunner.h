@@ -0,0 +1,62 @@
+#ifndef DIFFERENTIAL_RUNNER_H
+#define DIFFERENTIAL_RUNNER_H
+
+#include "marvin/simulator/ReferenceSimulator.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Simulator
+{
+
+struct Divergence
+{
+    std::size_t line{0};                     // Index of the first line whose results differ.
+    GridLayout layout{GridLayout::RowMajor}; // Of the RobotSimulator that differed.
+    std::string expected;                    // The reference simulator's results for the line.
+    std::string actual;
+};
+
+// Runs command lines through a ReferenceSimulator and a RobotSimulator for each grid layout, and
+// after every line compares what executeLine() returned, printed and reported as an error, then
+// the world itself: the REPORT listing and the world hash. The reference recomputes its hash from
+// scratch, so this also checks the simulator's incremental one.
+class DifferentialRunner
+{
+  public:
+    using Predicate = std::function<bool(std::span<const std::string>)>;
+
+    DifferentialRunner();
+
+    // Returns the first difference, with `line` set to the number of lines run before this one.
+    [[nodiscard]] std::optional<Divergence> step(std::string_view line);
+    [[nodiscard]] std::size_t steps() const noexcept;
+
+    // Runs a whole script on fresh simulators.
+    [[nodiscard]] static std::optional<Divergence> run(std::span<const std::string> script);
+    // Delta debugging: removes ever smaller runs of lines while `fails` still holds, until no
+    // single line can go. `fails` must hold for `script`.
+    [[nodiscard]] static std::vector<std::string> shrink(std::vector<std::string> script,
+                                                         const Predicate &fails);
+
+  private:
+    static constexpr std::array<GridLayout, 2> layouts{GridLayout::RowMajor, GridLayout::Morton};
+
+    ReferenceSimulator m_reference;
+    std::vector<RobotSimulator> m_simulators; // One per layout.
+    std::size_t m_steps{0};
+    std::ostringstream m_results;
+};
+
+} // namespace Simulator
+
+#endif
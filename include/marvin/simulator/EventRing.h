@@ -0,0 +1,147 @@
+#ifndef EVENT_RING_H
+#define EVENT_RING_H
+
+#include "marvin/robot/Robot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Simulator
+{
+
+enum class EventKind : std::uint8_t
+{
+    Placed,     // A robot appeared at `location`.
+    Moved,      // A robot moved to `location`.
+    Rotated,    // A robot turned in place; `location` holds the new heading.
+    Removed,    // A robot standing at `location` was removed.
+    Cleared,    // Every robot was removed at once.
+    Collided,   // A move was refused because robot `other` occupies the destination.
+    OffGrid,    // A move was refused because it would leave the grid.
+    Obstructed, // A move was refused by blocked terrain.
+    Batch       // The next `count` events come from one bulk operation.
+};
+
+// One change to the world. Refused moves report where the robot still stands.
+struct SimulatorEvent
+{
+    EventKind kind{EventKind::Placed};
+    // Batch only: the batch outgrew the ring, which overwrote its header and its first events. The
+    // header then takes the slot of the oldest event left, so drain() counts the events that
+    // never reach a subscriber as lost and `count` covers the ones that follow.
+    bool truncated{false};
+    std::uint32_t count{0}; // Batch only; nested batch headers are counted too.
+    RobotFactory::RobotId id{0};
+    RobotFactory::RobotId other{0};
+    RobotFactory::RobotLocation location{};
+};
+
+using SubscriberId = std::uint32_t;
+
+struct DrainResult
+{
+    std::size_t events{0}; // Events handed to the visitor.
+    std::uint64_t lost{0}; // Events overwritten before the subscriber read them.
+};
+
+// Broadcast ring of simulator events. The producer overwrites the oldest event when the ring is
+// full and never waits; every subscriber keeps its own read position, so a slow subscriber loses
+// events (and is told how many) without holding up the simulator or the other subscribers.
+//
+// Storage is allocated by the first subscribe() and reused from then on, so publishing is a copy
+// into a fixed slot. Producers are expected to test active() first: with no subscribers, that one
+// predictable branch is the whole cost of an event. The ring is not synchronised; drain it from
+// the thread that drives the simulator.
+class EventRing
+{
+  public:
+    static constexpr std::size_t default_capacity{std::size_t{1} << 14};
+
+    // The capacity is rounded up to a power of two.
+    explicit EventRing(std::size_t capacity = default_capacity);
+
+    // A new subscriber starts at the next event published.
+    [[nodiscard]] SubscriberId subscribe();
+    void unsubscribe(SubscriberId subscriber) noexcept;
+    [[nodiscard]] bool active() const noexcept
+    {
+        return m_subscribers != 0;
+    }
+
+    void publish(const SimulatorEvent &event) noexcept
+    {
+        m_events[m_head & m_mask] = event; // NOLINT(*-constant-array-index)
+        ++m_head;
+    }
+    // Reserves a Batch header; endBatch() fills in its count, or withdraws it if nothing followed.
+    // A batch that outgrew the ring gets a truncated header at its oldest surviving event.
+    [[nodiscard]] std::uint64_t beginBatch() noexcept;
+    void endBatch(std::uint64_t header) noexcept;
+
+    // Passes the subscriber's unread events, oldest first and at most `limit` of them, to
+    // `visit` as one or two contiguous std::span<const SimulatorEvent> batches.
+    template <typename Visitor>
+    DrainResult drain(SubscriberId subscriber, Visitor &&visit,
+                      std::size_t limit = std::numeric_limits<std::size_t>::max())
+    {
+        DrainResult result;
+        auto &cursor = m_cursors.at(subscriber);
+        const auto oldest = m_head - std::min<std::uint64_t>(m_head, m_events.size());
+        if (cursor < oldest)
+        {
+            result.lost = oldest - cursor;
+            cursor = oldest;
+        }
+        const auto end = cursor + std::min<std::uint64_t>(m_head - cursor, limit);
+        const std::span<const SimulatorEvent> events{m_events};
+        while (cursor < end)
+        {
+            const auto first = static_cast<std::size_t>(cursor & m_mask);
+            const auto count =
+                std::min(static_cast<std::size_t>(end - cursor), events.size() - first);
+            visit(events.subspan(first, count));
+            cursor += count;
+            result.events += count;
+        }
+        return result;
+    }
+
+    [[nodiscard]] std::uint64_t published() const noexcept;
+    [[nodiscard]] std::size_t capacity() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+  private:
+    static constexpr std::uint64_t unsubscribed{std::numeric_limits<std::uint64_t>::max()};
+
+    std::vector<SimulatorEvent> m_events;
+    std::size_t m_capacity;
+    std::uint64_t m_mask{0};
+    std::uint64_t m_head{0}; // Sequence number of the next event.
+    std::vector<std::uint64_t> m_cursors; // Next sequence number per subscriber.
+    std::size_t m_subscribers{0};
+};
+
+// Groups the events of one bulk operation under a Batch header. Does nothing without subscribers.
+class EventBatch
+{
+  public:
+    explicit EventBatch(EventRing &ring) noexcept;
+    ~EventBatch();
+    EventBatch(const EventBatch &) = delete;
+    EventBatch &operator=(const EventBatch &) = delete;
+    EventBatch(EventBatch &&) = delete;
+    EventBatch &operator=(EventBatch &&) = delete;
+
+  private:
+    EventRing &m_ring;
+    std::optional<std::uint64_t> m_header;
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef FIXED_ROBOT_GRID_H
+#define FIXED_ROBOT_GRID_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Simulator
+{
+
+// Operations RobotSimulator-style code needs from a grid.
+template <typename Grid>
+concept GridStorage = requires(Grid grid, const Grid &view, const RobotFactory::Robot &robot,
+                               RobotFactory::RobotLocation location, RobotFactory::RobotId id,
+                               GridSize size) {
+    { grid.addRobot(robot) } -> std::same_as<bool>;
+    grid.updateLocation(location, robot);
+    grid.updateLocation(location, location, id);
+    { grid.resize(size) } -> std::same_as<bool>;
+    grid.remove(robot);
+    { view.size() } -> std::same_as<GridSize>;
+    { view.robotIdAt(location) } -> std::same_as<RobotFactory::RobotId>;
+    { view.isOffGrid(location) } -> std::same_as<bool>;
+    { view.isOccupied(location) } -> std::same_as<bool>;
+    view.prefetch(location);
+};
+
+// Grid whose dimensions are fixed at compile time. Rows are padded to a power-of-two stride so
+// that indexing is a shift and an add, and bounds checks on constant locations fold away.
+// Large instantiations should be heap allocated. It keeps no line-of-sight bitsets: clearance()
+// walks the cells ahead, which the constant dimensions bound.
+template <RobotFactory::Coordinate Width, RobotFactory::Coordinate Height> class FixedRobotGrid
+{
+    static_assert(Width > 0 && Height > 0, "Grid dimensions must be positive.");
+
+  public:
+    static constexpr GridSize dimensions{.width = Width, .height = Height};
+    static constexpr auto stride = std::bit_ceil(static_cast<std::size_t>(Width));
+    static constexpr auto stride_shift = static_cast<std::size_t>(std::countr_zero(stride));
+
+    constexpr FixedRobotGrid() = default;
+    // For code generic over grids: throws std::invalid_argument unless `size` is the grid's own
+    // and the layout row-major.
+    explicit FixedRobotGrid(GridSize size, GridLayout layout = GridLayout::RowMajor)
+    {
+        if (size.width != Width || size.height != Height || layout != GridLayout::RowMajor)
+        {
+            throw std::invalid_argument{"A fixed grid has only its own size and layout."};
+        }
+    }
+
+    // Empties every cell in place, so that a large grid is never copied through the stack.
+    constexpr void clear() noexcept
+    {
+        m_cells.fill(0);
+    }
+
+    [[nodiscard]] constexpr bool addRobot(const RobotFactory::Robot &robot)
+    {
+        const auto location = robot.location();
+        if (isOffGrid(location) || isOccupied(location))
+        {
+            return false;
+        }
+        cell(index(location)) = robot.id();
+        return true;
+    }
+
+    constexpr void updateLocation(RobotFactory::RobotLocation previous,
+                                  const RobotFactory::Robot &robot)
+    {
+        updateLocation(previous, robot.location(), robot.id());
+    }
+
+    constexpr void updateLocation(RobotFactory::RobotLocation previous,
+                                  RobotFactory::RobotLocation location, RobotFactory::RobotId id)
+    {
+        cell(checkedIndex(previous)) = 0;
+        cell(checkedIndex(location)) = id;
+    }
+
+    // Fixed grids cannot change size; only a no-op resize succeeds.
+    [[nodiscard]] constexpr bool resize(GridSize size) const noexcept
+    {
+        return size.width == Width && size.height == Height;
+    }
+
+    constexpr void remove(const RobotFactory::Robot &robot) noexcept
+    {
+        const auto location = robot.location();
+        if (!isOffGrid(location))
+        {
+            cell(index(location)) = 0;
+        }
+    }
+
+    [[nodiscard]] constexpr GridSize size() const noexcept
+    {
+        return dimensions;
+    }
+
+    [[nodiscard]] constexpr GridLayout layout() const noexcept
+    {
+        return GridLayout::RowMajor;
+    }
+
+    [[nodiscard]] constexpr RobotFactory::RobotId robotIdAt(
+        RobotFactory::RobotLocation location) const
+    {
+        return cell(checkedIndex(location));
+    }
+
+    [[nodiscard]] constexpr bool isOffGrid(RobotFactory::RobotLocation location) const noexcept
+    {
+        // Negative coordinates wrap to large unsigned values, so one compare per axis suffices.
+        return static_cast<std::uint64_t>(location.x) >= static_cast<std::uint64_t>(Width) ||
+               static_cast<std::uint64_t>(location.y) >= static_cast<std::uint64_t>(Height);
+    }
+
+    [[nodiscard]] constexpr bool isOccupied(RobotFactory::RobotLocation location) const noexcept
+    {
+        return !isOffGrid(location) && cell(index(location)) != 0;
+    }
+
+    void prefetch(RobotFactory::RobotLocation location) const noexcept
+    {
+#if defined(__GNUC__)
+        if (!isOffGrid(location))
+        {
+            __builtin_prefetch(&cell(index(location)), 1);
+        }
+#else
+        static_cast<void>(location);
+#endif
+    }
+
+    // Line of sight needs no extra state here; these match RobotGrid's interface.
+    constexpr void trackLineOfSight() const noexcept {}
+    [[nodiscard]] constexpr bool tracksLineOfSight() const noexcept
+    {
+        return false;
+    }
+
+    // Free cells ahead of `location` in the direction it faces, up to the nearest robot or edge.
+    [[nodiscard]] constexpr RobotFactory::Coordinate clearance(
+        RobotFactory::RobotLocation location) const
+    {
+        static_cast<void>(checkedIndex(location));
+        RobotFactory::Coordinate distance{0};
+        for (auto ahead = step(location); isFree(ahead); ahead = step(ahead))
+        {
+            ++distance;
+        }
+        return distance;
+    }
+
+    [[nodiscard]] static constexpr std::size_t memoryBytes() noexcept
+    {
+        return sizeof(m_cells);
+    }
+    [[nodiscard]] static constexpr std::size_t memoryBytesAfterResize(GridSize size) noexcept
+    {
+        static_cast<void>(size);
+        return memoryBytes();
+    }
+    [[nodiscard]] static constexpr std::size_t memoryBytesFor(GridSize size, GridLayout layout,
+                                                              bool line_of_sight) noexcept
+    {
+        static_cast<void>(size);
+        static_cast<void>(layout);
+        static_cast<void>(line_of_sight);
+        return memoryBytes();
+    }
+
+  private:
+    using Cell = RobotFactory::RobotId;
+    std::array<Cell, stride * static_cast<std::size_t>(Height)> m_cells{};
+
+    // Offsets are produced by index(), which is only called for on-grid locations.
+    [[nodiscard]] constexpr Cell &cell(std::size_t offset) noexcept
+    {
+        return m_cells[offset]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    [[nodiscard]] constexpr const Cell &cell(std::size_t offset) const noexcept
+    {
+        return m_cells[offset]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    [[nodiscard]] static constexpr std::size_t index(RobotFactory::RobotLocation location) noexcept
+    {
+        return (static_cast<std::size_t>(location.y) << stride_shift) +
+               static_cast<std::size_t>(location.x);
+    }
+
+    [[nodiscard]] constexpr bool isFree(RobotFactory::RobotLocation location) const noexcept
+    {
+        return !isOffGrid(location) && cell(index(location)) == 0;
+    }
+
+    [[nodiscard]] static constexpr RobotFactory::RobotLocation step(
+        RobotFactory::RobotLocation location) noexcept
+    {
+        switch (location.direction)
+        {
+        case RobotFactory::Direction::North:
+            ++location.y;
+            break;
+        case RobotFactory::Direction::East:
+            ++location.x;
+            break;
+        case RobotFactory::Direction::South:
+            --location.y;
+            break;
+        case RobotFactory::Direction::West:
+            --location.x;
+            break;
+        }
+        return location;
+    }
+
+    [[nodiscard]] constexpr std::size_t checkedIndex(RobotFactory::RobotLocation location) const
+    {
+        if (isOffGrid(location))
+        {
+            throw std::out_of_range{"Grid location is outside the grid."};
+        }
+        return index(location);
+    }
+};
+
+static_assert(GridStorage<RobotGrid>);
+static_assert(GridStorage<FixedRobotGrid<10, 10>>);
+
+} // namespace Simulator
+
+#endif
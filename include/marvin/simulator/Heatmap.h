@@ -0,0 +1,146 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Simulator
+{
+
+// Per-cell traffic over a run: how many moves ended in each cell (visits) and how many moves were
+// refused at it (blocked), either by the robot standing there or by blocked terrain on the way to
+// it. Moves refused at the grid edge have no cell and are not counted.
+//
+// Counters saturate instead of wrapping. They are kept in 16x16 tiles, the grid's Morton tile
+// size, holding both channels of a tile's cells side by side; a tile is allocated the first time a
+// move reaches it, so a grid pays one index entry per tile plus the tiles its robots actually use.
+class Heatmap
+{
+  public:
+    enum class Width : std::uint8_t
+    {
+        Bits16,
+        Bits32
+    };
+
+    enum class Channel : std::uint8_t
+    {
+        Visits,
+        Blocked
+    };
+
+    struct Counts
+    {
+        std::uint32_t visits{0};
+        std::uint32_t blocked{0};
+    };
+
+    struct Hotspot
+    {
+        RobotFactory::Coordinate x{0};
+        RobotFactory::Coordinate y{0};
+        std::uint32_t count{0};
+    };
+
+    static constexpr RobotFactory::Coordinate tile_side{16};
+
+    // Starts counting on a grid of `size`, discarding earlier counts.
+    void start(GridSize size, Width width);
+    // Stops counting and frees every tile.
+    void stop() noexcept;
+    [[nodiscard]] bool active() const noexcept
+    {
+        return m_active;
+    }
+    // Zeroes every count and frees the tiles, keeping the heatmap running.
+    void reset() noexcept;
+    // Follows a grid resize; cells still on the grid keep their counts.
+    void resize(GridSize size);
+
+    // The location must be on the grid.
+    void countVisit(RobotFactory::RobotLocation location)
+    {
+        increment(location, 0);
+    }
+    void countBlocked(RobotFactory::RobotLocation location)
+    {
+        increment(location, tile_cells);
+    }
+
+    // Zero for cells outside the grid.
+    [[nodiscard]] Counts at(RobotFactory::RobotLocation location) const noexcept;
+    // The cell with the highest count in `channel`, lowest row and column first on ties; nullopt
+    // if every count is zero.
+    [[nodiscard]] std::optional<Hotspot> hottest(Channel channel) const noexcept;
+    [[nodiscard]] GridSize size() const noexcept;
+    [[nodiscard]] Width width() const noexcept;
+    [[nodiscard]] std::size_t tileCount() const noexcept;
+    [[nodiscard]] std::size_t tilesInUse() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    // At most what memoryBytes() would be after resize(size).
+    [[nodiscard]] std::size_t memoryBytesAfterResize(GridSize size) const noexcept;
+    // Bytes needed to start a heatmap of `size`, before any tile is allocated.
+    [[nodiscard]] static std::size_t memoryBytesFor(GridSize size) noexcept;
+
+    // `x,y,visits,blocked` after a header line, one line per cell with a non-zero count, ordered
+    // by row and then by column.
+    void writeCsv(std::ostream &output) const;
+    // Binary PGM of one channel scaled so the highest count is white, with the top row first to
+    // match the maps LOADMAP reads.
+    void writePgm(std::ostream &output, Channel channel) const;
+
+  private:
+    static constexpr std::size_t tile_cells{static_cast<std::size_t>(tile_side * tile_side)};
+    static constexpr std::size_t tile_counters{2 * tile_cells}; // Visits, then blocked.
+    static constexpr std::uint32_t no_tile{0};
+
+    // Entry per tile, row by row: no_tile, or one more than the tile's slot in the counters.
+    std::vector<std::uint32_t> m_tiles;
+    std::vector<std::uint16_t> m_narrow;
+    std::vector<std::uint32_t> m_wide;
+    std::size_t m_tiles_per_row{0};
+    std::uint32_t m_tiles_in_use{0};
+    GridSize m_size{0, 0};
+    Width m_width{Width::Bits32};
+    bool m_active{false};
+
+    void increment(RobotFactory::RobotLocation location, std::size_t channel)
+    {
+        const auto x = static_cast<std::size_t>(location.x);
+        const auto y = static_cast<std::size_t>(location.y);
+        constexpr auto side = static_cast<std::size_t>(tile_side);
+        auto &tile = m_tiles[(y / side * m_tiles_per_row) + (x / side)]; // NOLINT(*-array-index)
+        if (tile == no_tile)
+        {
+            tile = allocateTile();
+        }
+        const auto cell =
+            ((tile - 1) * tile_counters) + channel + ((y % side) * side) + (x % side);
+        if (m_width == Width::Bits16)
+        {
+            auto &count = m_narrow[cell]; // NOLINT(*-array-index)
+            count = static_cast<std::uint16_t>(
+                count + (count != std::numeric_limits<std::uint16_t>::max() ? 1 : 0));
+        }
+        else
+        {
+            auto &count = m_wide[cell]; // NOLINT(*-array-index)
+            count += count != std::numeric_limits<std::uint32_t>::max() ? 1U : 0U;
+        }
+    }
+
+    [[nodiscard]] std::uint32_t allocateTile();
+    [[nodiscard]] std::uint32_t counter(std::size_t tile, std::size_t cell) const noexcept;
+    [[nodiscard]] static std::size_t tilesAlong(RobotFactory::Coordinate cells) noexcept;
+};
+
+} // namespace Simulator
+
+#endif
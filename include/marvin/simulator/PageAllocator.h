@@ -0,0 +1,270 @@
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+enum class HugePages : std::uint8_t
+{
+    Off,         // Regular pages.
+    Transparent, // Ask the kernel to back the mapping with transparent huge pages.
+    Explicit     // Reserved hugetlbfs pages; falls back to Transparent when none are free.
+};
+
+struct PageOptions
+{
+    HugePages huge_pages{HugePages::Transparent};
+    // With more than one thread, each thread faults in one contiguous share of a new block while
+    // pinned to a CPU: share k goes to the k-th of that many CPUs spread evenly over the allowed
+    // ones, so on a NUMA system it is placed on that CPU's node.
+    unsigned first_touch_threads{1};
+};
+
+// Process-wide options for large simulator buffers, applied to allocations made after the call.
+// The defaults can be overridden with MARVIN_HUGE_PAGES=off|transparent|explicit and
+// MARVIN_FIRST_TOUCH_THREADS=<n> in the environment.
+void setPageOptions(PageOptions options) noexcept;
+[[nodiscard]] PageOptions pageOptions() noexcept;
+
+// A zero-filled block. Blocks of at least large_block_bytes are mapped directly from the operating
+// system on Linux (falling back from huge pages to regular pages as needed); smaller blocks, and
+// every block elsewhere, come from the C++ heap. Inside a PageArenaScope they come from the
+// scope's arena instead, rounded to the same sizes.
+struct PageBlock
+{
+    static constexpr std::size_t large_block_bytes{std::size_t{2} << 20U};
+
+    void *data{nullptr};
+    std::size_t bytes{0};
+    bool mapped{false};
+    bool huge_pages{false}; // Transparent huge pages were requested or hugetlbfs pages were used.
+    std::pmr::memory_resource *arena{nullptr}; // Where the block goes back to, if not the system.
+};
+
+// Makes the calling thread allocate page blocks from `arena` until the scope ends, so that one
+// simulator's grid, robots and indexes can share a memory resource, e.g. one per hosted world.
+// Blocks remember their arena, so they may be released or grown outside the scope. The arena must
+// outlive them.
+class PageArenaScope
+{
+  public:
+    explicit PageArenaScope(std::pmr::memory_resource *arena) noexcept;
+    ~PageArenaScope();
+
+    PageArenaScope(const PageArenaScope &) = delete;
+    PageArenaScope &operator=(const PageArenaScope &) = delete;
+    PageArenaScope(PageArenaScope &&) = delete;
+    PageArenaScope &operator=(PageArenaScope &&) = delete;
+
+  private:
+    std::pmr::memory_resource *m_previous;
+};
+
+// The calling thread's arena, or nullptr outside every PageArenaScope.
+[[nodiscard]] std::pmr::memory_resource *pageArena() noexcept;
+// A memory resource over the system blocks allocatePages() makes outside an arena, to serve as an
+// arena's upstream so large blocks are still mapped with the page options.
+[[nodiscard]] std::pmr::memory_resource *systemPages() noexcept;
+
+[[nodiscard]] PageBlock allocatePages(std::size_t bytes);
+// From `arena`, or from the system when it is nullptr, whatever the calling thread's arena.
+[[nodiscard]] PageBlock allocatePages(std::size_t bytes, std::pmr::memory_resource *arena);
+// Grows `block` to `bytes`, keeping its contents and zero-filling the tail; may move it. A mapped
+// block stays aligned to a huge page; a block from an arena is grown in that arena.
+[[nodiscard]] PageBlock growPages(PageBlock block, std::size_t bytes);
+void releasePages(PageBlock block) noexcept;
+// Reconstructs the block allocatePages(bytes, arena) returned at `data`, for callers that only
+// kept the pointer and the requested size.
+[[nodiscard]] PageBlock pageBlock(void *data, std::size_t bytes,
+                                  std::pmr::memory_resource *arena = nullptr) noexcept;
+
+// Standard allocator over allocatePages(), so large robot stores get the same page policy. It
+// allocates from the arena that was current when it was constructed.
+template <typename Value> class PageAllocator
+{
+  public:
+    using value_type = Value;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PageAllocator() noexcept : m_arena{pageArena()} {}
+    template <typename Other>
+    PageAllocator(const PageAllocator<Other> &other) noexcept // NOLINT(*-explicit-*)
+        : m_arena{other.arena()}
+    {
+    }
+
+    [[nodiscard]] Value *allocate(std::size_t count)
+    {
+        if (count > static_cast<std::size_t>(-1) / sizeof(Value))
+        {
+            throw std::bad_array_new_length{};
+        }
+        return static_cast<Value *>(allocatePages(count * sizeof(Value), m_arena).data);
+    }
+
+    void deallocate(Value *data, std::size_t count) noexcept
+    {
+        releasePages(pageBlock(data, count * sizeof(Value), m_arena));
+    }
+
+    [[nodiscard]] std::pmr::memory_resource *arena() const noexcept
+    {
+        return m_arena;
+    }
+
+    [[nodiscard]] friend bool operator==(const PageAllocator &left,
+                                         const PageAllocator &right) noexcept
+    {
+        return left.m_arena == right.m_arena;
+    }
+
+  private:
+    std::pmr::memory_resource *m_arena;
+};
+
+// Fixed-size array of trivially copyable values in a PageBlock, zero-initialised.
+template <typename Value> class PageBuffer
+{
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+  public:
+    PageBuffer() = default;
+    explicit PageBuffer(std::size_t count)
+        : m_block{count == 0 ? PageBlock{} : allocatePages(bytesFor(count))}, m_size{count}
+    {
+    }
+    ~PageBuffer()
+    {
+        releasePages(m_block);
+    }
+
+    PageBuffer(const PageBuffer &) = delete;
+    PageBuffer &operator=(const PageBuffer &) = delete;
+    PageBuffer(PageBuffer &&other) noexcept
+        : m_block{std::exchange(other.m_block, {})}, m_size{std::exchange(other.m_size, 0)}
+    {
+    }
+    PageBuffer &operator=(PageBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            releasePages(m_block);
+            m_block = std::exchange(other.m_block, {});
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    // Grows in place where the operating system allows it; new elements are zero.
+    void grow(std::size_t count)
+    {
+        if (count > m_size)
+        {
+            m_block = m_size == 0 ? allocatePages(bytesFor(count))
+                                  : growPages(m_block, bytesFor(count));
+            m_size = count;
+        }
+    }
+
+    [[nodiscard]] Value &at(std::size_t index)
+    {
+        return data()[checked(index)]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    [[nodiscard]] const Value &at(std::size_t index) const
+    {
+        return data()[checked(index)]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]] Value *data() noexcept
+    {
+        return static_cast<Value *>(m_block.data);
+    }
+    [[nodiscard]] const Value *data() const noexcept
+    {
+        return static_cast<const Value *>(m_block.data);
+    }
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+    [[nodiscard]] const PageBlock &block() const noexcept
+    {
+        return m_block;
+    }
+
+  private:
+    PageBlock m_block;
+    std::size_t m_size{0};
+
+    [[nodiscard]] static std::size_t bytesFor(std::size_t count)
+    {
+        if (count > static_cast<std::size_t>(-1) / sizeof(Value))
+        {
+            throw std::length_error{"Page buffer is too large."};
+        }
+        return count * sizeof(Value);
+    }
+
+    [[nodiscard]] std::size_t checked(std::size_t index) const
+    {
+        if (index >= m_size)
+        {
+            throw std::out_of_range{"Page buffer index is out of range."};
+        }
+        return index;
+    }
+};
+
+// Fixed-size cells carved from page blocks, for many small objects of one size: a cell costs a
+// pointer bump or a free-list pop instead of a heap allocation. Blocks grow geometrically and are
+// returned only when the pool is destroyed.
+class CellPool
+{
+  public:
+    CellPool(std::size_t cell_bytes, std::size_t alignment);
+    ~CellPool();
+
+    CellPool(const CellPool &) = delete;
+    CellPool &operator=(const CellPool &) = delete;
+    CellPool(CellPool &&) = delete;
+    CellPool &operator=(CellPool &&) = delete;
+
+    [[nodiscard]] void *allocate();
+    void deallocate(void *cell) noexcept;
+    // Makes room for `count` more cells, adding at most one block.
+    void reserve(std::size_t count);
+
+    [[nodiscard]] std::size_t cellBytes() const noexcept;
+    [[nodiscard]] std::size_t cellsInUse() const noexcept;
+    // Bytes of every block, in use or not.
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    // What memoryBytes() would be once `count` cells are in use, by allocate() or reserve().
+    [[nodiscard]] std::size_t memoryBytesFor(std::size_t count) const noexcept;
+
+  private:
+    std::size_t m_cell_bytes;
+    std::vector<PageBlock> m_blocks;
+    std::byte *m_next{nullptr};
+    std::byte *m_end{nullptr};
+    void *m_free{nullptr}; // Freed cells, each holding a pointer to the next.
+    std::size_t m_free_cells{0};
+    std::size_t m_in_use{0};
+    std::size_t m_bytes{0};
+
+    [[nodiscard]] std::size_t available() const noexcept;
+    [[nodiscard]] std::size_t blockBytesFor(std::size_t count) const noexcept;
+};
+
+} // namespace Simulator
+
+#endif
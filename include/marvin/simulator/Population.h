@@ -0,0 +1,47 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace Simulator
+{
+
+enum class PopulationPattern : std::uint8_t
+{
+    Random,
+    Lattice,
+    Clustered
+};
+
+// Produces candidate robot locations for bulk population. Candidates may repeat or collide with
+// existing robots; the simulator skips those and asks for more.
+class PopulationGenerator
+{
+  public:
+    PopulationGenerator(PopulationPattern pattern, std::size_t count, GridSize size,
+                        std::uint64_t seed);
+
+    [[nodiscard]] RobotFactory::RobotLocation next();
+
+  private:
+    PopulationPattern m_pattern;
+    GridSize m_size;
+    std::mt19937_64 m_random;
+    RobotFactory::Coordinate m_spacing{1};
+    RobotFactory::Coordinate m_x{0};
+    RobotFactory::Coordinate m_y{0};
+    std::vector<RobotFactory::RobotLocation> m_centres;
+    double m_spread{1.0};
+
+    [[nodiscard]] RobotFactory::Direction direction();
+};
+
+} // namespace Simulator
+
+#endif
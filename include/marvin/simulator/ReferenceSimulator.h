@@ -0,0 +1,108 @@
+#ifndef REFERENCE_SIMULATOR_H
+#define REFERENCE_SIMULATOR_H
+
+#include "marvin/command/Command.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/WorldHash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Simulator
+{
+
+// A deliberately plain model of RobotSimulator, kept as the oracle its optimised structures are
+// tested against: robots live in one vector, every lookup and collision check is a linear scan,
+// and a transaction is a copy of the whole world. It shares only the command parser, and prints
+// the same output and errors as RobotSimulator::executeLine() for PLACE, MOVE, ROTATE, LEFT,
+// RIGHT, REMOVE, RESIZE, REPORT, SCAN, HASH, BEGIN, COMMIT, ABORT and QUIT without WHERE or
+// groups. Any other command fails with an error that names it.
+class ReferenceSimulator
+{
+  public:
+    ReferenceSimulator() = default;
+    explicit ReferenceSimulator(GridSize size);
+
+    // Returns false for QUIT, like RobotSimulator::executeLine().
+    bool executeLine(std::string_view line, std::ostream &output, std::ostream &errors);
+
+    void report(std::ostream &output) const;
+    // Computed from scratch on every call.
+    [[nodiscard]] WorldHash worldHash() const;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] bool inTransaction() const noexcept;
+
+  private:
+    struct Robot
+    {
+        std::string name;
+        RobotFactory::RobotLocation location;
+    };
+
+    // IDs follow RobotHandleTable's scheme, slot plus first_id with the slot's generation above,
+    // and slots are reused in the same order, so both simulators hand out the same IDs.
+    struct Slot
+    {
+        std::optional<Robot> robot;
+        std::uint32_t generation{0};
+    };
+
+    struct World
+    {
+        GridSize size{default_grid_size};
+        std::vector<Slot> slots;
+        std::vector<std::size_t> free; // Reused from the back.
+    };
+
+    // A move of one robot, or a rotation behind one, inside a transaction.
+    struct Step
+    {
+        std::size_t slot;
+        RobotFactory::RobotLocation location; // Where the robot ended up.
+    };
+
+    World m_world;
+    std::optional<World> m_saved; // The world as BEGIN found it.
+    bool m_failed{false};
+    // Like RobotSimulator, a transaction checks moves of one robot against the others only when
+    // a command other than such a move or a rotation runs: settle() replays the steps taken since
+    // on the world as it was before them.
+    std::optional<World> m_unsettled;
+    std::vector<Step> m_steps;
+
+    [[nodiscard]] static RobotFactory::RobotId id(std::size_t slot, std::uint32_t generation);
+    [[nodiscard]] bool isFree(RobotFactory::RobotLocation location) const;
+    [[nodiscard]] RobotFactory::Coordinate clearance(RobotFactory::RobotLocation location) const;
+    // Whether the target selects the robot in an occupied slot.
+    [[nodiscard]] bool selects(const RobotTarget &target, std::size_t slot) const;
+    // Slots of the robots a target selects; every robot, in slot order, without one.
+    [[nodiscard]] std::vector<std::size_t> select(const std::optional<RobotTarget> &target) const;
+    void release(std::size_t slot);
+    // Whether a command waits for settle(): a MOVE of one robot or a rotation.
+    [[nodiscard]] static bool deferrable(const Command &command);
+    // Returns false if a step collided; the world is then as it was just before that step.
+    [[nodiscard]] bool settle();
+
+    // Each returns the error to report, or an empty string on success.
+    [[nodiscard]] std::string apply(const PlaceCommand &command);
+    [[nodiscard]] std::string apply(const MoveCommand &command);
+    [[nodiscard]] std::string apply(const RotateCommand &command);
+    [[nodiscard]] std::string apply(const RemoveCommand &command);
+    [[nodiscard]] std::string apply(const ResizeCommand &command);
+    [[nodiscard]] std::string apply(const ReportCommand &command, std::ostream &output) const;
+    [[nodiscard]] std::string apply(const ScanCommand &command, std::ostream &output) const;
+    [[nodiscard]] std::string apply(const HashCommand &command, std::ostream &output) const;
+    [[nodiscard]] std::string apply(const BeginCommand &command);
+    [[nodiscard]] std::string apply(const CommitCommand &command);
+    [[nodiscard]] std::string apply(const AbortCommand &command);
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef ROBOT_BEHAVIOR_H
+#define ROBOT_BEHAVIOR_H
+
+#include "marvin/robot/Robot.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+// Size-class free lists for coroutine frames. Frames are carved from slabs that are kept for the
+// life of the process, so creating and finishing behaviours reuses memory instead of going to the
+// heap each time.
+class BehaviorFramePool
+{
+  public:
+    [[nodiscard]] static void *allocate(std::size_t bytes);
+    static void deallocate(void *frame, std::size_t bytes) noexcept;
+};
+
+// What behaviours can do to the world they run in; implemented by the simulator.
+class BehaviorWorld
+{
+  public:
+    enum class Cell : std::uint8_t
+    {
+        Free,
+        Occupied,
+        OffGrid
+    };
+
+    [[nodiscard]] virtual bool moveRobot(RobotFactory::RobotId id, std::uint32_t blocks) = 0;
+    virtual void rotateRobot(RobotFactory::RobotId id, RobotFactory::Rotation rotation) = 0;
+    [[nodiscard]] virtual Cell cell(RobotFactory::RobotLocation location) const = 0;
+    [[nodiscard]] virtual bool contains(RobotFactory::RobotId id) const = 0;
+
+  protected:
+    BehaviorWorld() = default;
+    ~BehaviorWorld() = default;
+    BehaviorWorld(const BehaviorWorld &) = default;
+    BehaviorWorld &operator=(const BehaviorWorld &) = default;
+    BehaviorWorld(BehaviorWorld &&) = default;
+    BehaviorWorld &operator=(BehaviorWorld &&) = default;
+};
+
+class BehaviorScheduler;
+
+// A coroutine that drives one robot. It starts suspended and runs only when a scheduler resumes
+// it: Behavior::move() and Behavior::rotate() act at once and end the behaviour's turn for the
+// current tick, while Behavior::untilFree() parks it on a cell until that cell is vacated.
+// GCC 12 miscompiles a co_await in an if condition inside a loop with no exit: with
+// `for (;;) { if (!co_await Behavior::move(1)) ... }` the behaviour ends on its first resume
+// without moving. Await into a local first (`const bool moved = co_await ...;`) or give the loop
+// a condition.
+class RobotBehavior
+{
+  public:
+    struct promise_type
+    {
+        BehaviorScheduler *scheduler{nullptr};
+        RobotFactory::RobotId robot{0};
+        std::optional<RobotFactory::RobotLocation> waiting_for; // Set while parked on a cell.
+        std::exception_ptr exception;
+
+        [[nodiscard]] static void *operator new(std::size_t bytes)
+        {
+            return BehaviorFramePool::allocate(bytes);
+        }
+        static void operator delete(void *frame, std::size_t bytes) noexcept
+        {
+            BehaviorFramePool::deallocate(frame, bytes);
+        }
+
+        [[nodiscard]] RobotBehavior get_return_object() noexcept
+        {
+            return RobotBehavior{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        [[nodiscard]] static std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        [[nodiscard]] static std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        static void return_void() noexcept {}
+        void unhandled_exception() noexcept
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    RobotBehavior() = default;
+    ~RobotBehavior();
+    RobotBehavior(const RobotBehavior &) = delete;
+    RobotBehavior &operator=(const RobotBehavior &) = delete;
+    RobotBehavior(RobotBehavior &&other) noexcept : m_handle{std::exchange(other.m_handle, {})} {}
+    RobotBehavior &operator=(RobotBehavior &&other) noexcept;
+
+    // Hands the coroutine over, leaving this object empty.
+    [[nodiscard]] Handle release() noexcept
+    {
+        return std::exchange(m_handle, {});
+    }
+
+  private:
+    explicit RobotBehavior(Handle handle) noexcept : m_handle{handle} {}
+
+    Handle m_handle;
+};
+
+// Runs behaviours in ticks. Each tick resumes every behaviour that was made ready before the tick
+// began, so a tick costs O(ready behaviours); behaviours parked on a cell are not looked at until
+// vacated() reports that cell free.
+class BehaviorScheduler
+{
+  public:
+    explicit BehaviorScheduler(BehaviorWorld &world) noexcept : m_world{&world} {}
+    ~BehaviorScheduler();
+    BehaviorScheduler(const BehaviorScheduler &) = delete;
+    BehaviorScheduler &operator=(const BehaviorScheduler &) = delete;
+    BehaviorScheduler(BehaviorScheduler &&) = delete;
+    BehaviorScheduler &operator=(BehaviorScheduler &&) = delete;
+
+    // The behaviour first runs on the next tick.
+    void attach(RobotFactory::RobotId robot, RobotBehavior behavior);
+    // Returns the number of behaviours resumed. Behaviours whose robot has been removed are
+    // destroyed instead of resumed. An exception escaping a behaviour ends that behaviour and is
+    // rethrown once the tick is complete.
+    std::size_t tick();
+    // Wakes the behaviours parked on `location` for the next tick. Inline, so moves cost nothing
+    // extra while no behaviour is parked.
+    void vacated(RobotFactory::RobotLocation location)
+    {
+        if (m_parked_count != 0)
+        {
+            wake(location);
+        }
+    }
+    // Wakes every parked behaviour, for changes that may free many cells at once.
+    void vacatedAll();
+    // Destroys the behaviours driving `robot`, parked or not, for a robot that has been removed.
+    void detach(RobotFactory::RobotId robot);
+    // Destroys every behaviour, for when every robot is removed.
+    void detachAll() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t parked() const noexcept;
+
+    // Used by the awaitables.
+    [[nodiscard]] BehaviorWorld &world() const noexcept
+    {
+        return *m_world;
+    }
+    void resumeNextTick(RobotBehavior::Handle handle);
+    void park(RobotFactory::RobotLocation location, RobotBehavior::Handle handle);
+
+  private:
+    BehaviorWorld *m_world;
+    std::vector<RobotBehavior::Handle> m_ready;
+    std::vector<RobotBehavior::Handle> m_running;
+    std::unordered_map<std::uint64_t, std::vector<RobotBehavior::Handle>> m_parked;
+    std::unordered_multimap<RobotFactory::RobotId, RobotBehavior::Handle> m_attached;
+    std::size_t m_parked_count{0};
+    std::size_t m_size{0};
+
+    void wake(RobotFactory::RobotLocation location);
+    void finish(RobotBehavior::Handle handle) noexcept;
+};
+
+namespace Behavior
+{
+
+struct MoveAwaiter
+{
+    std::uint32_t blocks;
+    bool moved{false};
+
+    [[nodiscard]] static bool await_ready() noexcept
+    {
+        return false;
+    }
+    void await_suspend(RobotBehavior::Handle handle)
+    {
+        auto &promise = handle.promise();
+        moved = promise.scheduler->world().moveRobot(promise.robot, blocks);
+        promise.scheduler->resumeNextTick(handle);
+    }
+    [[nodiscard]] bool await_resume() const noexcept
+    {
+        return moved;
+    }
+};
+
+struct RotateAwaiter
+{
+    RobotFactory::Rotation rotation;
+
+    [[nodiscard]] static bool await_ready() noexcept
+    {
+        return false;
+    }
+    void await_suspend(RobotBehavior::Handle handle) const
+    {
+        auto &promise = handle.promise();
+        promise.scheduler->world().rotateRobot(promise.robot, rotation);
+        promise.scheduler->resumeNextTick(handle);
+    }
+    static void await_resume() noexcept {}
+};
+
+struct UntilFreeAwaiter
+{
+    RobotFactory::RobotLocation cell;
+    bool free{false};
+
+    [[nodiscard]] static bool await_ready() noexcept
+    {
+        return false;
+    }
+    // Continues at once if the cell is free or off the grid; otherwise parks on it.
+    [[nodiscard]] bool await_suspend(RobotBehavior::Handle handle)
+    {
+        auto &promise = handle.promise();
+        const auto state = promise.scheduler->world().cell(cell);
+        free = state != BehaviorWorld::Cell::OffGrid;
+        if (state != BehaviorWorld::Cell::Occupied)
+        {
+            return false;
+        }
+        promise.scheduler->park(cell, handle);
+        return true;
+    }
+    // False only when the cell is off the grid and can never be entered.
+    [[nodiscard]] bool await_resume() const noexcept
+    {
+        return free;
+    }
+};
+
+// co_await move(n): moves n blocks ahead; yields whether the robot moved.
+[[nodiscard]] inline MoveAwaiter move(std::uint32_t blocks = 1) noexcept
+{
+    return {.blocks = blocks};
+}
+
+// co_await rotate(rotation): turns 90 degrees.
+[[nodiscard]] inline RotateAwaiter rotate(RobotFactory::Rotation rotation) noexcept
+{
+    return {.rotation = rotation};
+}
+
+// co_await untilFree(cell): waits, without polling, until no robot occupies the cell.
+[[nodiscard]] inline UntilFreeAwaiter untilFree(RobotFactory::RobotLocation cell) noexcept
+{
+    return {.cell = cell};
+}
+
+} // namespace Behavior
+
+} // namespace Simulator
+
+#endif
@@ -2,7 +2,10 @@
 #define ROBOT_GRID_H
 
 #include "marvin/robot/Robot.h"
+#include "marvin/simulator/PageAllocator.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace Simulator
@@ -16,28 +19,83 @@ struct GridSize
 
 inline constexpr GridSize default_grid_size{};
 
+// Cell ordering in memory. Morton stores 16x16 tiles in Z-order so that vertical neighbours and
+// small regions share cache lines; tiles themselves are laid out row by row.
+enum class GridLayout : std::uint8_t
+{
+    RowMajor,
+    Morton
+};
+
+// Dynamic grid. Storage is allocated with geometric headroom (capacity), so growing within the
+// capacity is O(1) and reallocations are amortized over the rows and columns they add. Per-row and
+// per-column occupancy counts bound the occupied area, which is what shrinking is checked against.
+// Once trackLineOfSight() is called, row and column occupancy bitsets (one bit per cell along each
+// axis) are kept as well and answer line-of-sight queries a word at a time; grids that are never
+// scanned do not pay for maintaining them.
 class RobotGrid
 {
   public:
     RobotGrid();
-    explicit RobotGrid(GridSize size);
+    explicit RobotGrid(GridSize size, GridLayout layout = GridLayout::RowMajor);
 
     [[nodiscard]] bool addRobot(const RobotFactory::Robot &robot);
     void updateLocation(RobotFactory::RobotLocation previous, const RobotFactory::Robot &robot);
+    // The same for a robot known only by its ID, e.g. when replaying a logged move.
+    void updateLocation(RobotFactory::RobotLocation previous, RobotFactory::RobotLocation location,
+                        RobotFactory::RobotId id);
+    // Grows or shrinks the grid; fails without changes if a robot would end up off-grid.
     [[nodiscard]] bool resize(GridSize size);
     void remove(const RobotFactory::Robot &robot);
 
     [[nodiscard]] GridSize size() const noexcept;
+    [[nodiscard]] GridSize capacity() const noexcept;
+    [[nodiscard]] GridLayout layout() const noexcept;
     [[nodiscard]] RobotFactory::RobotId robotIdAt(RobotFactory::RobotLocation location) const;
     [[nodiscard]] bool isOffGrid(RobotFactory::RobotLocation location) const noexcept;
     [[nodiscard]] bool isOccupied(RobotFactory::RobotLocation location) const;
+    // Hints that the cell will soon be read and written; does nothing for an off-grid location.
+    void prefetch(RobotFactory::RobotLocation location) const noexcept;
+    // Builds the line-of-sight bitsets in O(cells) and maintains them from then on.
+    void trackLineOfSight();
+    [[nodiscard]] bool tracksLineOfSight() const noexcept;
+    // Free cells between `location` and the nearest robot or edge in the direction it faces;
+    // O(distance / 64) when line of sight is tracked, a cell-by-cell walk otherwise. The location
+    // itself must be on the grid.
+    [[nodiscard]] RobotFactory::Coordinate clearance(RobotFactory::RobotLocation location) const;
+
+    // Bytes held by the cells, occupancy counts and line-of-sight bitsets. The projections below
+    // throw for the same sizes as resize() and the constructor, and saturate rather than overflow.
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    // What memoryBytes() would be after resize(size).
+    [[nodiscard]] std::size_t memoryBytesAfterResize(GridSize size) const;
+    // What memoryBytes() would be for a new grid, with line of sight tracked or not.
+    [[nodiscard]] static std::size_t memoryBytesFor(GridSize size, GridLayout layout,
+                                                    bool line_of_sight);
 
   private:
     using Cell = RobotFactory::RobotId;
-    std::vector<Cell> m_cells;
+    PageBuffer<Cell> m_cells;
+    std::vector<std::uint32_t, PageAllocator<std::uint32_t>> m_row_occupancy;
+    std::vector<std::uint32_t, PageAllocator<std::uint32_t>> m_column_occupancy;
+    // Row y holds bit x, m_row_words words per row; column x holds bit y, m_column_words per
+    // column.
+    std::vector<std::uint64_t, PageAllocator<std::uint64_t>> m_row_bits;
+    std::vector<std::uint64_t, PageAllocator<std::uint64_t>> m_column_bits;
+    std::size_t m_row_words{0};
+    std::size_t m_column_words{0};
+    bool m_tracks_line_of_sight{false};
     GridSize m_size;
+    GridSize m_capacity;
+    GridLayout m_layout;
+    std::size_t m_tiles_per_row;
 
+    void occupy(RobotFactory::RobotLocation location, RobotFactory::RobotId id);
+    void vacate(RobotFactory::RobotLocation location);
+    void reserve(GridSize capacity);
     [[nodiscard]] std::size_t index(RobotFactory::RobotLocation location) const;
+    [[nodiscard]] std::size_t offset(RobotFactory::Coordinate x,
+                                     RobotFactory::Coordinate y) const noexcept;
 };
 
 } // namespace Simulator
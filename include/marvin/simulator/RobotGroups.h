@@ -0,0 +1,93 @@
+#ifndef ROBOT_GROUPS_H
+#define ROBOT_GROUPS_H
+
+#include "marvin/robot/Robot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+// Named, persistent sets of robots. Each group keeps its members in a dense array of IDs, so a
+// group command is a linear loop over it. A robot's memberships are chained from its handle slot,
+// and every membership knows its position in the group's array, so a removed robot leaves each of
+// its groups in O(1) by moving the group's last member into its place.
+class RobotGroups
+{
+  public:
+    using GroupId = std::uint32_t;
+
+    // Names are canonical (upper-case). Returns nullopt if a group already has the name.
+    [[nodiscard]] std::optional<GroupId> create(std::string name);
+    // Deletes a group and its memberships; returns false if no group has the name.
+    bool erase(std::string_view name);
+    [[nodiscard]] std::optional<GroupId> find(std::string_view name) const;
+
+    // Returns false if the robot already belongs to the group.
+    bool add(GroupId group, RobotFactory::RobotId id);
+    // Removes a robot from every group it belongs to and returns those groups, valid until the
+    // next call.
+    std::span<const GroupId> leaveAll(RobotFactory::RobotId id);
+    // Empties every group, keeping the groups themselves.
+    void clearMembers() noexcept;
+
+    [[nodiscard]] std::span<const RobotFactory::RobotId> members(GroupId group) const;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+    // Calls visit(name, members) for every group in name order.
+    template <typename Visitor> void forEach(Visitor &&visit) const
+    {
+        for (const auto &[name, group] : m_names)
+        {
+            visit(std::string_view{name}, members(group));
+        }
+    }
+
+  private:
+    // Link numbers are one more than the link's index, so zero ends a chain.
+    static constexpr std::uint32_t no_link{0};
+
+    struct Group
+    {
+        std::vector<RobotFactory::RobotId> members;
+        std::vector<std::uint32_t> links; // The membership link of each member.
+    };
+
+    struct Link
+    {
+        GroupId group{0};
+        std::uint32_t position{0}; // Of the member in its group.
+        std::uint32_t next{no_link};
+    };
+
+    using Names = std::map<std::string, GroupId, std::less<>>;
+    // Red-black tree node: three links and a colour, then the name and group.
+    static constexpr std::size_t name_node_bytes{(4 * sizeof(void *)) +
+                                                 sizeof(std::pair<const std::string, GroupId>)};
+
+    std::vector<Group> m_groups;
+    std::vector<GroupId> m_free_groups;
+    Names m_names;
+    std::vector<std::uint32_t> m_first; // First membership link of each handle slot.
+    std::vector<Link> m_links;
+    std::vector<std::uint32_t> m_free_links;
+    std::vector<GroupId> m_left;
+
+    [[nodiscard]] std::uint32_t allocateLink(const Link &link);
+    void removeMember(Group &group, std::uint32_t position) noexcept;
+};
+
+} // namespace Simulator
+
+#endif
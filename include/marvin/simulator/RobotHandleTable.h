@@ -0,0 +1,122 @@
+#ifndef ROBOT_HANDLE_TABLE_H
+#define ROBOT_HANDLE_TABLE_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/PageAllocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+
+// Per-simulator generational ID allocator and dense owning robot store. An ID packs the slot index
+// (offset by first_id) into its low 32 bits and the slot's generation into the high 32 bits, so
+// a fresh simulator hands out 43, 44, 45, ... exactly as before while IDs of removed robots become
+// detectably stale once their slot is reused.
+class RobotHandleTable
+{
+  public:
+    static constexpr RobotFactory::RobotId first_id{43};
+
+    // Destroys a robot and returns its cell to the table's pool; robots made elsewhere, which have
+    // no pool, are deleted.
+    struct RobotDeleter
+    {
+        CellPool *pool{nullptr};
+
+        RobotDeleter() noexcept = default;
+        explicit RobotDeleter(CellPool *owner) noexcept : pool{owner}
+        {
+        }
+        template <typename Robot>
+        RobotDeleter(std::default_delete<Robot> /*heap*/) noexcept // NOLINT(*-explicit-*)
+        {
+        }
+        void operator()(RobotFactory::Robot *robot) const noexcept;
+    };
+    using RobotPointer = std::unique_ptr<RobotFactory::Robot, RobotDeleter>;
+
+    // acquire() reserves an ID, bind() stores the robot built with it, and release() returns the
+    // slot (destroying any bound robot) exactly once. emplace() builds the robot in the table's
+    // own pool of robot-sized cells, which saves a heap allocation per robot.
+    [[nodiscard]] RobotFactory::RobotId acquire();
+    RobotFactory::Robot &bind(RobotFactory::RobotId id, RobotPointer robot);
+    RobotFactory::Robot &emplace(RobotFactory::RobotId id, RobotFactory::GroundRobotType type,
+                                 RobotFactory::RobotLocation location, std::string name);
+    void release(RobotFactory::RobotId id);
+    void clear();
+
+    // Undo support. take() frees a slot like release() but hands the robot back; restore() undoes
+    // the most recent take() of that ID; revert() undoes acquire() and bind() as if the ID had
+    // never been handed out.
+    [[nodiscard]] RobotPointer take(RobotFactory::RobotId id);
+    void restore(RobotFactory::RobotId id, RobotPointer robot);
+    void revert(RobotFactory::RobotId id);
+
+    // Makes room for `count` robots, growing the slots geometrically like single binds do and the
+    // pool by one block.
+    void reserve(std::size_t count);
+
+    [[nodiscard]] RobotFactory::Robot *find(RobotFactory::RobotId id) const;
+    // The slot an ID refers to, without checking that it is live. Slots are dense, so side tables
+    // can be indexed by them.
+    [[nodiscard]] static std::size_t slotIndex(RobotFactory::RobotId id) noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t capacity() const noexcept;
+
+    // Memory accounting, kept current in O(1) per change. robotBytes() covers the bound robot
+    // objects and nameBytes() the heap storage of their names; memoryBytes() is the table itself,
+    // including pool cells that hold no robot.
+    [[nodiscard]] std::size_t robotBytes() const noexcept;
+    [[nodiscard]] std::size_t nameBytes() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    // What memoryBytes() would be once `count` robots are bound, by single binds or reserve().
+    [[nodiscard]] std::size_t memoryBytesFor(std::size_t count) const noexcept;
+    // Heap bytes of a name of `length` characters built to size, and of a robot's actual name.
+    [[nodiscard]] static std::size_t nameBytes(std::size_t length) noexcept;
+    [[nodiscard]] static std::size_t nameBytes(const RobotFactory::Robot &robot) noexcept;
+
+    // Visits live robots in slot order, which is stable between calls.
+    template <typename Visitor> void forEach(Visitor &&visit) const
+    {
+        for (const auto &slot : m_slots)
+        {
+            if (slot.robot)
+            {
+                visit(*slot.robot);
+            }
+        }
+    }
+
+  private:
+    struct Slot
+    {
+        RobotPointer robot;
+        std::uint32_t generation{0};
+    };
+
+    // Held by pointer so robots keep their pool when the table moves; declared before the slots so
+    // that it outlives them.
+    std::unique_ptr<CellPool> m_pool{
+        std::make_unique<CellPool>(RobotFactory::RobotAssembly::max_footprint,
+                                   RobotFactory::RobotAssembly::max_alignment)};
+    std::vector<Slot, PageAllocator<Slot>> m_slots;
+    std::vector<std::uint32_t> m_free;
+    std::size_t m_size{0};
+    std::size_t m_robot_bytes{0};
+    std::size_t m_name_bytes{0};
+
+    [[nodiscard]] std::size_t poolSlack(std::size_t pool_bytes, std::size_t cells) const noexcept;
+    void count(const RobotFactory::Robot &robot) noexcept;
+    void uncount(const RobotFactory::Robot &robot) noexcept;
+    [[nodiscard]] const Slot *slot(RobotFactory::RobotId id) const;
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef ROBOT_NAME_INDEX_H
+#define ROBOT_NAME_INDEX_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/PageAllocator.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+// Case-insensitive open-addressing index from robot name to ID. Names are not copied: each entry
+// holds a name hash and an ID, and candidates are confirmed against the robot's own canonical
+// (upper-case) name through the handle table, so inserting a robot never allocates.
+//
+// Prefix queries use a second, ordered index of views of the robots' own names. It is built by
+// the first trackPrefixes() in O(n log n) and maintained by insert(), erase() and clear() from then
+// on, so a prefix query costs O(log n + matches); an index never searched by prefix does not pay
+// for it.
+class RobotNameIndex
+{
+  public:
+    [[nodiscard]] RobotFactory::RobotId find(std::string_view name,
+                                             const RobotHandleTable &robots) const;
+    // Returns false, leaving the index unchanged, if another robot already has the same name.
+    [[nodiscard]] bool insert(const RobotFactory::Robot &robot, const RobotHandleTable &robots);
+    // Inserts the robots with `ids` as insert() would one by one, but hashes a block of names
+    // ahead so that the table misses of the block overlap. Appends the IDs whose names are
+    // already taken to `clashes`.
+    void insertAll(std::span<const RobotFactory::RobotId> ids, const RobotHandleTable &robots,
+                   std::vector<RobotFactory::RobotId> &clashes);
+    void erase(const RobotFactory::Robot &robot);
+    void clear() noexcept;
+    void reserve(std::size_t count);
+
+    void trackPrefixes(const RobotHandleTable &robots);
+    [[nodiscard]] bool tracksPrefixes() const noexcept;
+    // Calls visit(name, id) for every name starting with the upper-case `prefix`, in name order.
+    // Prefixes must be tracked.
+    template <typename Visitor> void forEachPrefixed(std::string_view prefix, Visitor &&visit) const
+    {
+        for (auto entry = m_ordered.lower_bound(prefix);
+             entry != m_ordered.end() && entry->first.starts_with(prefix); ++entry)
+        {
+            visit(entry->first, entry->second);
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    // What memoryBytes() would be once the index holds `count` names.
+    [[nodiscard]] std::size_t memoryBytesFor(std::size_t count) const noexcept;
+
+  private:
+    struct Entry
+    {
+        std::uint64_t hash{0};
+        RobotFactory::RobotId id{0}; // Zero marks an empty entry.
+    };
+
+    using OrderedNames = std::map<std::string_view, RobotFactory::RobotId, std::less<>>;
+    // Red-black tree node: three links and a colour, then the name view and ID.
+    static constexpr std::size_t ordered_node_bytes{
+        (4 * sizeof(void *)) + sizeof(std::pair<const std::string_view, RobotFactory::RobotId>)};
+
+    PageBuffer<Entry> m_entries; // Fresh pages are zero, so a new table is never written to clear.
+    std::size_t m_size{0};
+    OrderedNames m_ordered;
+    bool m_tracks_prefixes{false};
+
+    [[nodiscard]] bool insert(const RobotFactory::Robot &robot, std::uint64_t hash,
+                              const RobotHandleTable &robots);
+    void rehash(std::size_t capacity);
+    [[nodiscard]] std::size_t mask() const noexcept;
+};
+
+} // namespace Simulator
+
+#endif
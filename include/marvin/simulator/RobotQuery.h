@@ -0,0 +1,67 @@
+#ifndef ROBOT_QUERY_H
+#define ROBOT_QUERY_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+
+// Inclusive range of values; the default range admits every value.
+template <typename Value> struct FilterRange
+{
+    Value first{std::numeric_limits<Value>::lowest()};
+    Value last{std::numeric_limits<Value>::max()};
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        return last < first;
+    }
+};
+
+// Parsed WHERE clause. Every clause must hold for a robot to match; the default filter matches
+// every robot.
+struct RobotFilter
+{
+    static constexpr std::uint8_t all_directions{0b1111};
+
+    std::uint8_t directions{all_directions}; // Bit n admits RobotFactory::Direction n.
+    FilterRange<RobotFactory::Coordinate> x;
+    FilterRange<RobotFactory::Coordinate> y;
+    FilterRange<RobotFactory::RobotId> id;
+    std::string name_prefix; // Upper-case; empty admits every name.
+};
+
+// A RobotFilter compiled into unsigned offset ranges, so that each numeric clause is a single
+// compare. select() copies the locations of a block of robots into columns and evaluates every
+// numeric clause over the block in one branch-free loop, which the compiler vectorises; only
+// robots that pass are checked against the name prefix.
+class RobotQuery
+{
+  public:
+    explicit RobotQuery(const RobotFilter &filter);
+
+    // Replaces `matches` with the robots the query admits, in slot order.
+    void select(const RobotHandleTable &robots, std::vector<RobotFactory::Robot *> &matches) const;
+    [[nodiscard]] bool matches(const RobotFactory::Robot &robot) const;
+
+  private:
+    std::uint64_t m_min_x;
+    std::uint64_t m_span_x;
+    std::uint64_t m_min_y;
+    std::uint64_t m_span_y;
+    std::uint64_t m_min_id;
+    std::uint64_t m_span_id;
+    std::uint8_t m_directions;
+    bool m_never; // An empty range or direction set: nothing can match.
+    std::string m_name_prefix;
+};
+
+} // namespace Simulator
+
+#endif
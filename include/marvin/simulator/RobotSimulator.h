@@ -4,36 +4,102 @@
 #include "marvin/command/Command.h"
 #include "marvin/robot/Robot.h"
 #include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/EventRing.h"
+#include "marvin/simulator/FixedRobotGrid.h"
+#include "marvin/simulator/Heatmap.h"
+#include "marvin/simulator/Population.h"
+#include "marvin/simulator/RobotBehavior.h"
 #include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotGroups.h"
+#include "marvin/simulator/RobotQuery.h"
+#include "marvin/simulator/Statistics.h"
+#include "marvin/simulator/TerrainMap.h"
+#include "marvin/simulator/TrajectoryRecorder.h"
+#include "marvin/simulator/WorldHash.h"
+#include "marvin/simulator/WorldMap.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <iosfwd>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 namespace Simulator
 {
 
-class RobotSimulator
+struct ScanResult
+{
+    RobotFactory::RobotId id{0};
+    RobotFactory::Coordinate distance{0};
+};
+
+// Bytes held by a simulator's data structures.
+struct MemoryUsage
+{
+    std::size_t grid{0};        // Cells, occupancy counts and line-of-sight bitsets.
+    std::size_t robots{0};      // Robot objects.
+    std::size_t ids{0};         // ID handle table and its free list.
+    std::size_t names{0};       // Name index.
+    std::size_t strings{0};     // Names too long to be stored inside their robot.
+    std::size_t terrain{0};     // Terrain runs and their row index.
+    std::size_t transaction{0}; // Undo log and robots removed inside the open transaction.
+    std::size_t events{0};      // Event ring, once something has subscribed.
+    std::size_t heatmap{0};     // Heatmap tile index and the tiles moves have reached.
+    std::size_t groups{0};      // Robot groups and their memberships.
+    std::size_t trajectory{0};  // The trajectory recorder's open chunk.
+
+    [[nodiscard]] std::size_t total() const noexcept
+    {
+        return grid + robots + ids + names + strings + terrain + transaction + events + heatmap +
+               groups + trajectory;
+    }
+};
+
+// A simulator over any grid storage: RobotGrid, sized at run time, or a FixedRobotGrid for a
+// layout known at build time, which makes every grid access a shift and an add. RobotSimulator is
+// the dynamic one. The implementation is compiled in RobotSimulator.cpp for RobotGrid and the
+// fixed grids declared at the end of this file; another fixed layout needs its own explicit
+// instantiation there. Over a fixed grid, resize() and loadMap() fail for any other size.
+template <GridStorage Grid> class BasicRobotSimulator
 {
   public:
-    RobotSimulator();
-    explicit RobotSimulator(GridSize size);
-    ~RobotSimulator();
+    // The default grid size, or a fixed grid's own.
+    BasicRobotSimulator();
+    // Throws std::invalid_argument if a fixed grid has another size or layout.
+    explicit BasicRobotSimulator(GridSize size, GridLayout layout = GridLayout::RowMajor);
+    ~BasicRobotSimulator();
 
-    RobotSimulator(const RobotSimulator &) = delete;
-    RobotSimulator &operator=(const RobotSimulator &) = delete;
-    RobotSimulator(RobotSimulator &&) noexcept;
-    RobotSimulator &operator=(RobotSimulator &&) noexcept;
+    BasicRobotSimulator(const BasicRobotSimulator &) = delete;
+    BasicRobotSimulator &operator=(const BasicRobotSimulator &) = delete;
+    BasicRobotSimulator(BasicRobotSimulator &&) noexcept;
+    BasicRobotSimulator &operator=(BasicRobotSimulator &&) noexcept;
 
     void start();
+    // Runs text lines, or a binary command stream (see BinaryCommands.h) when the input starts
+    // with its header.
     void run(std::istream &input, std::ostream &output, std::ostream &errors);
+    // Same output and errors as run(), with lines parsed ahead on `parser_threads` threads while
+    // this thread executes them in order. Parsers read up to a bounded window of lines ahead of
+    // execution, so this suits scripts and pipes rather than an interactive terminal.
+    void runPipelined(std::istream &input, std::ostream &output, std::ostream &errors,
+                      unsigned parser_threads = std::thread::hardware_concurrency());
     [[nodiscard]] bool executeLine(std::string_view line, std::ostream &output,
                                    std::ostream &errors);
 
     [[nodiscard]] bool place(RobotFactory::GroundRobotType type,
                              RobotFactory::RobotLocation location, std::string_view name);
+    // Bulk placement: robots are named R<id>, locations that are off-grid or already occupied
+    // (including by earlier robots of the same batch) are skipped. Returns the number placed.
+    [[nodiscard]] std::size_t placeBulk(RobotFactory::GroundRobotType type,
+                                        std::span<const RobotFactory::RobotLocation> locations);
+    [[nodiscard]] std::size_t populate(std::size_t count, PopulationPattern pattern,
+                                       std::uint64_t seed = 0);
     [[nodiscard]] bool move(std::string_view name, std::uint32_t blocks = 1);
     [[nodiscard]] bool move(RobotFactory::RobotId id, std::uint32_t blocks = 1);
     [[nodiscard]] std::size_t moveAll(std::uint32_t blocks = 1);
@@ -46,16 +112,147 @@ class RobotSimulator
     [[nodiscard]] bool resize(GridSize size);
     void report(std::ostream &output) const;
 
+    // WHERE clauses. The filter is compiled once and every robot is tested before any of them
+    // changes, so a robot that enters or leaves the filter during the command is not re-tested.
+    // Matching robots are processed in the same order as moveAll().
+    [[nodiscard]] std::size_t moveWhere(const RobotFilter &filter, std::uint32_t blocks = 1);
+    [[nodiscard]] std::size_t rotateWhere(const RobotFilter &filter,
+                                          RobotFactory::Rotation rotation);
+    [[nodiscard]] std::size_t removeWhere(const RobotFilter &filter);
+    void report(std::ostream &output, const RobotFilter &filter) const;
+
+    // Name patterns: every robot whose name matches, in name order. Candidates come from an
+    // ordered name index that the first pattern builds and every change maintains, so a pattern
+    // costs O(log n + names sharing its literal prefix) rather than a scan of every robot.
+    [[nodiscard]] std::size_t move(const NamePattern &pattern, std::uint32_t blocks = 1);
+    [[nodiscard]] std::size_t rotate(const NamePattern &pattern, RobotFactory::Rotation rotation);
+    [[nodiscard]] std::size_t remove(const NamePattern &pattern);
+    void scan(const NamePattern &pattern, std::vector<ScanResult> &results);
+
+    // Named groups of robots, which share one case-insensitive namespace with robot names:
+    // createGroup() fails for a name a robot or group already has, and place() for a group's name.
+    // addToGroup() adds the robots a target selects, expanding a name that belongs to a group into
+    // its members, and returns how many it selected, including robots already in the group.
+    // Removed robots leave their groups in O(1) per group; a removal undone by abort() rejoins
+    // them, but groups and additions are otherwise not part of a transaction, and deleteGroup()
+    // fails inside one.
+    [[nodiscard]] bool createGroup(std::string_view name);
+    [[nodiscard]] bool deleteGroup(std::string_view name);
+    [[nodiscard]] std::size_t addToGroup(std::string_view group, const RobotTarget &target);
+    [[nodiscard]] const RobotGroups &groups() const noexcept;
+    // Group members, in the order of the group's dense member array.
+    [[nodiscard]] std::size_t move(const GroupName &group, std::uint32_t blocks = 1);
+    [[nodiscard]] std::size_t rotate(const GroupName &group, RobotFactory::Rotation rotation);
+    [[nodiscard]] std::size_t remove(const GroupName &group);
+    void scan(const GroupName &group, std::vector<ScanResult> &results);
+
+    // Static terrain. Moves may not enter or cross a blocked cell and robots may not be placed on
+    // one; the cost of the cells each move enters is added to the statistics. With no terrain a
+    // move costs one branch more. setTerrain() is not undoable, so it fails inside a transaction,
+    // and it fails if a robot stands on a blocked cell.
+    [[nodiscard]] bool setTerrain(TerrainMap terrain);
+    [[nodiscard]] const TerrainMap &terrain() const noexcept;
+    // Replaces the world with a map: every robot is removed, the grid takes the map's size, its
+    // terrain is installed, and its robot markers are placed in bulk as R<id>. Fails inside a
+    // transaction.
+    [[nodiscard]] bool loadMap(const WorldMap &map);
+
+    // Line-of-sight sensing: the number of free cells ahead of a robot before the nearest robot or
+    // grid edge in the direction it faces. scanAll() answers for every robot in one pass, in the
+    // same order as report(). The first scan starts maintaining the grid's line-of-sight bitsets.
+    [[nodiscard]] std::optional<RobotFactory::Coordinate> scan(std::string_view name);
+    [[nodiscard]] std::optional<RobotFactory::Coordinate> scan(RobotFactory::RobotId id);
+    void scanAll(std::vector<ScanResult> &results);
+
+    // Behaviours: coroutines that each drive one robot, advanced one step per tick() without a
+    // thread per robot. attach() fails if the robot does not exist; a behaviour ends when its
+    // coroutine returns or its robot is removed. tick() returns the number of behaviours resumed.
+    [[nodiscard]] bool attach(RobotFactory::RobotId id, RobotBehavior behavior);
+    std::size_t tick();
+    [[nodiscard]] std::size_t behaviorCount() const noexcept;
+
+    // Transactions: changes made between begin() and commit() are applied immediately and logged,
+    // so abort() undoes them in O(changes) without copying the grid. Moves of a single robot are
+    // checked against other robots only when the grid is next needed, in one pass over the log;
+    // until then move(name) and move(id) succeed unless the robot would leave the grid or hit
+    // blocked terrain. commit() rolls back and returns false if one of them collided or a command
+    // executed through executeLine() failed inside the transaction.
+    [[nodiscard]] bool begin();
+    [[nodiscard]] bool commit();
+    [[nodiscard]] bool abort();
+    [[nodiscard]] bool inTransaction() const noexcept;
+
     [[nodiscard]] const RobotFactory::Robot *findRobot(std::string_view name) const;
     [[nodiscard]] const RobotFactory::Robot *findRobot(RobotFactory::RobotId id) const;
     [[nodiscard]] GridSize gridSize() const noexcept;
     [[nodiscard]] std::size_t robotCount() const noexcept;
+    [[nodiscard]] const SimulatorStatistics &statistics() const noexcept;
+
+    // Typed change notifications. Subscribe through the ring and drain it between commands; bulk
+    // operations, behaviour ticks and rollbacks wrap their events in a Batch header, and removing
+    // every robot outside a transaction is a single Cleared event. While nothing is subscribed no
+    // event is built.
+    [[nodiscard]] EventRing &events() noexcept;
+
+    // Trajectory recording: every placement, move and rotation, including those a rollback
+    // makes, is appended as a (tick, ID, x, y, direction) record to columnar chunks streamed to a
+    // file or stream; see TrajectoryRecorder for the format. A record's tick is the number of
+    // commands executed through executeLine() plus the number of tick() calls before it.
+    [[nodiscard]] bool startRecording(
+        const std::filesystem::path &path,
+        std::size_t chunk_records = TrajectoryRecorder::default_chunk_records);
+    void startRecording(std::ostream &output,
+                        std::size_t chunk_records = TrajectoryRecorder::default_chunk_records);
+    bool stopRecording();
+    [[nodiscard]] const TrajectoryRecorder &trajectory() const noexcept;
+
+    // Per-cell traffic heatmap, counted by every move while it runs and kept through resizes and
+    // rollbacks; loading a map restarts it. startHeatmap() fails, like the changes below, if its
+    // tile index would take the total past the memory limit; tiles allocated later by moves are
+    // counted but never refused.
+    [[nodiscard]] bool startHeatmap(Heatmap::Width width = Heatmap::Width::Bits32);
+    void stopHeatmap() noexcept;
+    void resetHeatmap() noexcept;
+    [[nodiscard]] const Heatmap &heatmap() const noexcept;
+
+    // Memory accounting, kept current by every change so that memoryUsage() is O(1). With a limit
+    // set, resize(), place(), placeBulk(), populate() and loadMap() fail without changes if they
+    // would take the total past it; bulk operations are checked for the whole batch up front.
+    // Zero removes the limit. A limit below the current total does not free anything.
+    [[nodiscard]] MemoryUsage memoryUsage() const noexcept;
+    void setMemoryLimit(std::size_t bytes) noexcept;
+    [[nodiscard]] std::size_t memoryLimit() const noexcept;
+
+    // Hash of the grid size and every robot's ID and location, maintained in O(1) per change.
+    [[nodiscard]] WorldHash worldHash() const noexcept;
+    // Records the world hash after every `every` commands run through executeLine(), counting
+    // from this call, so two runs of the same script can be compared with firstDivergence().
+    void startHashTrail(std::uint32_t every);
+    void stopHashTrail() noexcept;
+    [[nodiscard]] std::span<const WorldHash> hashTrail() const noexcept;
+    [[nodiscard]] std::uint32_t hashTrailInterval() const noexcept;
 
   private:
     class Impl;
     std::unique_ptr<Impl> m_impl;
+
+    // Shows the menu and reads what the input starts with: a binary command stream is run to its
+    // end, and the first line of text is run if reading it began with part of the binary header.
+    // Returns whether there are lines left to run.
+    [[nodiscard]] bool startInput(std::istream &input, std::ostream &output,
+                                  std::ostream &errors);
+    [[nodiscard]] bool execute(const ParseResult &parsed, std::uint64_t parse_ns,
+                               std::ostream &output, std::ostream &errors);
 };
 
+extern template class BasicRobotSimulator<RobotGrid>;
+extern template class BasicRobotSimulator<FixedRobotGrid<10, 10>>;
+extern template class BasicRobotSimulator<FixedRobotGrid<1000, 1000>>;
+
+using RobotSimulator = BasicRobotSimulator<RobotGrid>;
+template <RobotFactory::Coordinate Width, RobotFactory::Coordinate Height>
+using FixedRobotSimulator = BasicRobotSimulator<FixedRobotGrid<Width, Height>>;
+
 } // namespace Simulator
 
 #endif
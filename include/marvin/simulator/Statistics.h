@@ -0,0 +1,201 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#ifndef MARVIN_ENABLE_STATS
+#define MARVIN_ENABLE_STATS 1
+#endif
+
+namespace Simulator
+{
+
+inline constexpr bool statistics_enabled = MARVIN_ENABLE_STATS != 0;
+
+enum class Stage : std::uint8_t
+{
+    Parse,
+    Dispatch,
+    Grid,
+    Output
+};
+
+inline constexpr std::size_t stage_count{4};
+
+// Monotonic nanosecond timestamp; folds to a constant when statistics are compiled out.
+[[nodiscard]] inline std::uint64_t timestamp() noexcept
+{
+    if constexpr (statistics_enabled)
+    {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+// Adds the lifetime of the scope to an accumulator, e.g. the grid-check time of one command.
+class ScopedStage
+{
+  public:
+    explicit ScopedStage(std::uint64_t &accumulator) noexcept
+        : m_accumulator{accumulator}, m_start{timestamp()}
+    {
+    }
+    ~ScopedStage()
+    {
+        if constexpr (statistics_enabled)
+        {
+            m_accumulator += timestamp() - m_start;
+        }
+    }
+
+    ScopedStage(const ScopedStage &) = delete;
+    ScopedStage &operator=(const ScopedStage &) = delete;
+    ScopedStage(ScopedStage &&) = delete;
+    ScopedStage &operator=(ScopedStage &&) = delete;
+
+  private:
+    std::uint64_t &m_accumulator;
+    std::uint64_t m_start;
+};
+
+// A ScopedStage that nests: only the outermost scope sharing `open` reads the clock. A bulk
+// command opens one around its whole loop, so the per-robot scopes inside cost a branch each.
+class NestedStage
+{
+  public:
+    NestedStage(std::uint64_t &accumulator, bool &open) noexcept
+        : m_accumulator{accumulator}, m_open{open}, m_outermost{statistics_enabled && !open},
+          m_start{m_outermost ? timestamp() : 0}
+    {
+        if (m_outermost)
+        {
+            m_open = true;
+        }
+    }
+    ~NestedStage()
+    {
+        if constexpr (statistics_enabled)
+        {
+            if (m_outermost)
+            {
+                m_accumulator += timestamp() - m_start;
+                m_open = false;
+            }
+        }
+    }
+
+    NestedStage(const NestedStage &) = delete;
+    NestedStage &operator=(const NestedStage &) = delete;
+    NestedStage(NestedStage &&) = delete;
+    NestedStage &operator=(NestedStage &&) = delete;
+
+  private:
+    std::uint64_t &m_accumulator;
+    bool &m_open;
+    bool m_outermost;
+    std::uint64_t m_start;
+};
+
+// Log-linear histogram: exact below 8 ns, then eight sub-buckets per power of two (<12.5% error).
+class LatencyHistogram
+{
+  public:
+    void record(std::uint64_t nanoseconds);
+    void reset() noexcept;
+
+    [[nodiscard]] std::uint64_t count() const noexcept;
+    [[nodiscard]] std::uint64_t max() const noexcept;
+    [[nodiscard]] std::uint64_t percentile(double fraction) const noexcept;
+
+  private:
+    std::vector<std::uint64_t> m_buckets;
+    std::uint64_t m_count{0};
+    std::uint64_t m_max{0};
+};
+
+struct CommandStatistics
+{
+    std::uint64_t count{0};
+    std::array<LatencyHistogram, stage_count> latency;
+};
+
+struct SimulatorCounters
+{
+    std::uint64_t collisions{0};
+    std::uint64_t off_grid{0};
+    std::uint64_t lookups{0};
+    std::uint64_t lookup_misses{0};
+    std::uint64_t obstacles{0};    // Moves stopped by blocked terrain.
+    std::uint64_t terrain_cost{0}; // Cost of every cell entered by a move.
+};
+
+class SimulatorStatistics
+{
+  public:
+    SimulatorStatistics();
+
+    void record(std::size_t verb, const std::array<std::uint64_t, stage_count> &stages);
+    void reset();
+
+    void countCollision() noexcept
+    {
+        if constexpr (statistics_enabled)
+        {
+            ++m_counters.collisions;
+        }
+    }
+    void countOffGrid() noexcept
+    {
+        if constexpr (statistics_enabled)
+        {
+            ++m_counters.off_grid;
+        }
+    }
+    void countObstacle() noexcept
+    {
+        if constexpr (statistics_enabled)
+        {
+            ++m_counters.obstacles;
+        }
+    }
+    void countTerrainCost(std::uint64_t cost) noexcept
+    {
+        if constexpr (statistics_enabled)
+        {
+            m_counters.terrain_cost += cost;
+        }
+    }
+    void countLookup(bool found) noexcept
+    {
+        if constexpr (statistics_enabled)
+        {
+            ++m_counters.lookups;
+            m_counters.lookup_misses += found ? 0U : 1U;
+        }
+    }
+
+    [[nodiscard]] const CommandStatistics &command(std::size_t verb) const;
+    [[nodiscard]] const SimulatorCounters &counters() const noexcept;
+
+    void writeText(std::ostream &output) const;
+    void writeJson(std::ostream &output) const;
+
+  private:
+    // One slot per command kind plus a trailing slot for input that failed to parse.
+    std::vector<CommandStatistics> m_commands;
+    SimulatorCounters m_counters;
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TERRAIN_MAP_H
+#define TERRAIN_MAP_H
+
+#include "marvin/robot/Robot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Simulator
+{
+
+// Per-cell terrain: terrain_open is plain floor, terrain_blocked is a wall or rack that no robot
+// may enter or cross, and any other code is passable floor that costs the code plus one to enter.
+using TerrainCode = std::uint8_t;
+inline constexpr TerrainCode terrain_open{0};
+inline constexpr TerrainCode terrain_blocked{255};
+
+[[nodiscard]] constexpr std::uint64_t terrainCost(TerrainCode code) noexcept
+{
+    return std::uint64_t{code} + 1;
+}
+
+// Static terrain, run-length encoded per row: only runs of cells that are not open are stored,
+// sorted by row and then by column, with an index of where each row's runs begin. Memory grows
+// with the number of runs and the last row that has one, never with the area they cover, and a
+// lookup is a binary search within one row.
+class TerrainMap
+{
+  public:
+    struct Run
+    {
+        std::uint32_t begin; // First column.
+        std::uint32_t end;   // One past the last column.
+        TerrainCode code;
+    };
+
+    // Builds a map from rows or runs given in increasing row order, and within a row in
+    // increasing, non-overlapping column order; adjacent runs with the same code are merged.
+    // Throws std::invalid_argument for input out of order or out of range.
+    class Builder
+    {
+      public:
+        void addRun(RobotFactory::Coordinate y, RobotFactory::Coordinate begin,
+                    RobotFactory::Coordinate end, TerrainCode code);
+        // Encodes one row of cells starting at column 0.
+        void addRow(RobotFactory::Coordinate y, std::span<const TerrainCode> cells);
+        [[nodiscard]] TerrainMap build() &&;
+
+      private:
+        std::vector<std::uint32_t> m_row_begin;
+        std::vector<Run> m_runs;
+        std::uint32_t m_row_end{0}; // End column of the last run in the current row.
+
+        void startRow(RobotFactory::Coordinate y);
+    };
+
+    // Cells outside the map, including negative coordinates, are open.
+    [[nodiscard]] TerrainCode at(RobotFactory::RobotLocation location) const noexcept;
+    // Total cost of entering each cell after `from` up to and including `to`, which must share a
+    // row or a column; nullopt if any of those cells is blocked.
+    [[nodiscard]] std::optional<std::uint64_t> pathCost(RobotFactory::RobotLocation from,
+                                                        RobotFactory::RobotLocation to) const;
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return m_runs.empty();
+    }
+    [[nodiscard]] std::size_t runCount() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+    [[nodiscard]] std::span<const Run> row(RobotFactory::Coordinate y) const noexcept;
+
+  private:
+    // Runs of row y are m_runs[m_row_begin[y], m_row_begin[y + 1]); rows past the end are open.
+    std::vector<std::uint32_t> m_row_begin;
+    std::vector<Run> m_runs;
+};
+
+} // namespace Simulator
+
+#endif
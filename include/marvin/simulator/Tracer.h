@@ -0,0 +1,86 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#ifndef MARVIN_ENABLE_TRACING
+#define MARVIN_ENABLE_TRACING 1
+#endif
+
+namespace Simulator
+{
+
+inline constexpr bool tracing_enabled = MARVIN_ENABLE_TRACING != 0;
+
+class TraceBuffer;
+
+// Process-wide Chrome/Perfetto trace-event recorder. Each thread appends completed spans to its own
+// single-producer ring buffer; a background thread drains the rings into the JSON file.
+class Tracer
+{
+  public:
+    [[nodiscard]] static bool start(const std::filesystem::path &path,
+                                    std::uint32_t sample_every = 1);
+    static void stop();
+
+    [[nodiscard]] static bool active() noexcept
+    {
+        return s_active.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] static std::uint64_t dropped() noexcept;
+    // Ring buffers registered so far. A thread that exits leaves its buffer to the next thread
+    // to start tracing, so this is bounded by the threads ever tracing at once.
+    [[nodiscard]] static std::size_t threadBuffers();
+
+  private:
+    static std::atomic<bool> s_active;
+};
+
+// Records the lifetime of the enclosing scope. Sampling is decided by the outermost span on each
+// thread, so a sampled command keeps all of its nested spans.
+class TraceSpan
+{
+  public:
+    explicit TraceSpan(std::string_view name) noexcept
+    {
+        if constexpr (tracing_enabled)
+        {
+            if (Tracer::active())
+            {
+                begin(name);
+            }
+        }
+    }
+    ~TraceSpan()
+    {
+        if constexpr (tracing_enabled)
+        {
+            if (m_open)
+            {
+                end();
+            }
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+    TraceSpan(TraceSpan &&) = delete;
+    TraceSpan &operator=(TraceSpan &&) = delete;
+
+  private:
+    void begin(std::string_view name) noexcept;
+    void end() noexcept;
+
+    TraceBuffer *m_buffer{nullptr};
+    std::string_view m_name;
+    std::uint64_t m_start{0};
+    bool m_open{false};
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include "marvin/robot/Robot.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace Simulator
+{
+
+struct TrajectoryRecord
+{
+    std::uint64_t tick{0};
+    RobotFactory::RobotId id{0};
+    RobotFactory::RobotLocation location;
+};
+
+// Trajectory file format, all integers unsigned LEB128 varints unless stated otherwise:
+//
+//   file   := magic chunk*
+//   magic  := the 8 bytes "MRVTRAJ1"
+//   chunk  := count tick_bytes id_bytes x_bytes y_bytes direction_bytes
+//             tick_column id_column x_column y_column direction_column
+//
+// A chunk holds `count` records split into one column per field, each column `*_bytes` long so a
+// reader can skip the ones it does not need. The tick, ID, x and y columns hold the difference
+// from the previous record's value in the same chunk (the first record's from zero), zigzag
+// encoded so small negative steps stay short; ID differences wrap modulo 2^64. The direction
+// column is one byte per record: 0 north, 1 east, 2 south, 3 west. Chunks decode independently,
+// hold at most TrajectoryRecorder::max_chunk_records records, and the file ends after the last.
+inline constexpr std::array<char, 8> trajectory_magic{'M', 'R', 'V', 'T', 'R', 'A', 'J', '1'};
+
+// Appends records to in-memory columnar chunks and streams each full chunk to its output, so
+// memory stays bounded by one chunk however long the run. A record costs a few varint appends;
+// while stopped, record() is a single branch.
+class TrajectoryRecorder
+{
+  public:
+    static constexpr std::size_t default_chunk_records{4096};
+    static constexpr std::size_t max_chunk_records{std::size_t{1} << 20};
+
+    TrajectoryRecorder() = default;
+    ~TrajectoryRecorder();
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder(TrajectoryRecorder &&) = delete;
+    TrajectoryRecorder &operator=(TrajectoryRecorder &&) = delete;
+
+    // Stops any earlier recording and writes the file header. The stream must outlive recording,
+    // and chunk_records is clamped to 1..max_chunk_records.
+    void start(std::ostream &output, std::size_t chunk_records = default_chunk_records);
+    // Returns false if the file cannot be created.
+    [[nodiscard]] bool start(const std::filesystem::path &path,
+                             std::size_t chunk_records = default_chunk_records);
+    // Writes the open chunk and closes any file. Returns false if a write failed.
+    bool stop();
+    [[nodiscard]] bool active() const noexcept
+    {
+        return m_output != nullptr;
+    }
+
+    void record(std::uint64_t tick, RobotFactory::RobotId id,
+                RobotFactory::RobotLocation location)
+    {
+        if (m_output == nullptr)
+        {
+            return;
+        }
+        append(m_ticks, tick - m_previous.tick);
+        append(m_ids, id - m_previous.id);
+        append(m_xs, static_cast<std::uint64_t>(location.x) -
+                         static_cast<std::uint64_t>(m_previous.location.x));
+        append(m_ys, static_cast<std::uint64_t>(location.y) -
+                         static_cast<std::uint64_t>(m_previous.location.y));
+        m_directions.push_back(static_cast<std::uint8_t>(location.direction));
+        m_previous = {.tick = tick, .id = id, .location = location};
+        ++m_recorded;
+        if (++m_chunk_size == m_chunk_records)
+        {
+            writeChunk();
+        }
+    }
+
+    // Records since start(), and bytes of the chunks written so far, header included.
+    [[nodiscard]] std::uint64_t recorded() const noexcept;
+    [[nodiscard]] std::uint64_t bytesWritten() const noexcept;
+    [[nodiscard]] std::size_t memoryBytes() const noexcept;
+
+  private:
+    std::ostream *m_output{nullptr};
+    std::unique_ptr<std::ofstream> m_file;
+    std::size_t m_chunk_records{default_chunk_records};
+    std::size_t m_chunk_size{0};
+    std::uint64_t m_recorded{0};
+    std::uint64_t m_bytes_written{0};
+    bool m_failed{false};
+    TrajectoryRecord m_previous;
+    std::vector<std::uint8_t> m_ticks;
+    std::vector<std::uint8_t> m_ids;
+    std::vector<std::uint8_t> m_xs;
+    std::vector<std::uint8_t> m_ys;
+    std::vector<std::uint8_t> m_directions;
+    std::vector<std::uint8_t> m_header;
+
+    // Zigzag-encodes `delta`, read as a two's-complement signed value, as a varint.
+    static void append(std::vector<std::uint8_t> &column, std::uint64_t delta)
+    {
+        auto value = (delta << 1U) ^ (0U - (delta >> 63U));
+        while (value >= 0x80U)
+        {
+            column.push_back(static_cast<std::uint8_t>(value | 0x80U));
+            value >>= 7U;
+        }
+        column.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void writeChunk();
+};
+
+// Reads a trajectory file one chunk at a time.
+class TrajectoryReader
+{
+  public:
+    // Reads and checks the file header.
+    explicit TrajectoryReader(std::istream &input);
+
+    // Replaces `records` with the next chunk's. Returns false at the end of the file or, with
+    // valid() then false, on a bad header or a truncated or malformed chunk.
+    [[nodiscard]] bool next(std::vector<TrajectoryRecord> &records);
+    [[nodiscard]] bool valid() const noexcept;
+
+  private:
+    std::istream &m_input;
+    std::vector<std::uint8_t> m_columns;
+    bool m_valid{true};
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef WORLD_HASH_H
+#define WORLD_HASH_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+
+namespace Simulator
+{
+
+// 128-bit Zobrist-style world hash: the XOR of one term per robot, keyed on (ID, x, y, direction),
+// and one term for the grid size. Any single change is undone by XOR-ing its term out again, so the
+// simulator keeps the hash current in O(1) per operation. Equal worlds always hash equal; unequal
+// worlds collide with probability about 2^-128.
+struct WorldHash
+{
+    std::uint64_t high{0};
+    std::uint64_t low{0};
+
+    constexpr WorldHash &operator^=(const WorldHash &other) noexcept
+    {
+        high ^= other.high;
+        low ^= other.low;
+        return *this;
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(const WorldHash &, const WorldHash &) = default;
+};
+
+namespace Detail
+{
+
+// SplitMix64 finaliser; every input bit affects every output bit.
+[[nodiscard]] constexpr std::uint64_t mixBits(std::uint64_t value) noexcept
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+[[nodiscard]] constexpr std::uint64_t hashLane(std::uint64_t seed, std::uint64_t first,
+                                               std::uint64_t second, std::uint64_t third,
+                                               std::uint64_t fourth) noexcept
+{
+    return mixBits(mixBits(mixBits(mixBits(seed ^ first) ^ second) ^ third) ^ fourth);
+}
+
+inline constexpr std::uint64_t high_seed{0x9e3779b97f4a7c15ULL};
+inline constexpr std::uint64_t low_seed{0xc2b2ae3d27d4eb4fULL};
+inline constexpr std::uint64_t grid_tag{0x165667b19e3779f9ULL};
+
+} // namespace Detail
+
+[[nodiscard]] constexpr WorldHash robotHash(RobotFactory::RobotId id,
+                                            RobotFactory::RobotLocation location) noexcept
+{
+    const auto x = static_cast<std::uint64_t>(location.x);
+    const auto y = static_cast<std::uint64_t>(location.y);
+    const auto direction = static_cast<std::uint64_t>(location.direction);
+    return {.high = Detail::hashLane(Detail::high_seed, id, x, y, direction),
+            .low = Detail::hashLane(Detail::low_seed, id, x, y, direction)};
+}
+
+[[nodiscard]] constexpr WorldHash gridHash(GridSize size) noexcept
+{
+    const auto width = static_cast<std::uint64_t>(size.width);
+    const auto height = static_cast<std::uint64_t>(size.height);
+    return {.high = Detail::hashLane(Detail::high_seed, Detail::grid_tag, width, height, 0),
+            .low = Detail::hashLane(Detail::low_seed, Detail::grid_tag, width, height, 0)};
+}
+
+// Writes the hash as 32 lower-case hexadecimal digits.
+std::ostream &operator<<(std::ostream &stream, const WorldHash &hash);
+
+// Index of the first differing entry of two hash trails recorded with the same interval, or
+// nullopt when the shorter trail is a prefix of the longer one. Uses binary search, which assumes
+// that runs stay diverged once they differ; a later accidental re-convergence is not detected.
+[[nodiscard]] std::optional<std::size_t> firstDivergence(std::span<const WorldHash> first,
+                                                         std::span<const WorldHash> second);
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef WORLD_HOST_H
+#define WORLD_HOST_H
+
+#include "marvin/simulator/PageAllocator.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Simulator
+{
+
+using WorldId = std::uint32_t;
+
+struct BatchResult
+{
+    std::string output;
+    std::string errors;
+    std::size_t executed{0}; // Commands run, including ones that failed.
+    bool quit{false};        // A QUIT ended the batch early.
+};
+
+// Hosts many independent simulators on a fixed pool of worker threads instead of a thread each.
+//
+// Work is submitted as batches of newline-separated commands. A world is queued on at most one
+// worker at a time, so it always runs on a single thread and its batches run in submission order.
+// Each worker keeps its own queue of worlds and steals from the others when it runs dry. A world
+// runs at most `quantum` commands before it goes to the back of its worker's queue, so one busy
+// world cannot starve the others sharing that worker.
+//
+// Each world owns a pool arena drawing on `upstream`. It holds the world's queued batches and,
+// since the world's simulator is built and run inside a PageArenaScope, its grid, robots and
+// indexes; all of it goes back upstream in one step when the world is destroyed.
+class WorldHost
+{
+  public:
+    static constexpr std::size_t default_quantum{64};
+
+    explicit WorldHost(unsigned threads = std::thread::hardware_concurrency(),
+                       std::size_t quantum = default_quantum,
+                       std::pmr::memory_resource *upstream = systemPages());
+    // Runs every queued batch, then stops the workers.
+    ~WorldHost();
+    WorldHost(const WorldHost &) = delete;
+    WorldHost &operator=(const WorldHost &) = delete;
+    WorldHost(WorldHost &&) = delete;
+    WorldHost &operator=(WorldHost &&) = delete;
+
+    [[nodiscard]] WorldId create(GridSize size = default_grid_size);
+    // Batches already queued still run; later submissions to the world fail.
+    [[nodiscard]] bool destroy(WorldId world);
+    // Queues a script for the world. The future holds the batch's output, or the exception that
+    // stopped it; it is invalid if the world does not exist.
+    [[nodiscard]] std::future<BatchResult> submit(WorldId world, std::string_view script);
+    // Blocks until every batch queued so far has run.
+    void wait();
+
+    [[nodiscard]] std::size_t worldCount() const;
+    [[nodiscard]] unsigned threadCount() const noexcept;
+
+  private:
+    struct World;
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<World>> worlds;
+    };
+
+    std::size_t m_quantum;
+    std::pmr::memory_resource *m_upstream;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    mutable std::mutex m_mutex; // Guards everything below.
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::unordered_map<WorldId, std::shared_ptr<World>> m_worlds;
+    WorldId m_next_world{1};
+    std::size_t m_next_worker{0};
+    std::size_t m_queued{0};      // Worlds waiting in worker queues.
+    std::size_t m_outstanding{0}; // Batches submitted and not yet finished.
+    bool m_stopping{false};
+
+    std::vector<std::jthread> m_threads; // Declared last so workers start after the rest.
+
+    void work(std::size_t self);
+    [[nodiscard]] std::shared_ptr<World> take(std::size_t self);
+    void schedule(std::shared_ptr<World> world, std::size_t worker);
+    // Runs up to one quantum of the world's commands; returns whether it has more to run.
+    [[nodiscard]] bool run(World &world);
+};
+
+} // namespace Simulator
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef WORLD_MAP_H
+#define WORLD_MAP_H
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/TerrainMap.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Simulator
+{
+
+// A world layout read from a file, which is memory-mapped where the platform allows and read into
+// memory otherwise. Two formats are recognised:
+//
+// - ASCII art, one line per row with the top line northernmost. '.' and ' ' are open floor, '#' is
+//   blocked, '1' to '9' are slow floor with that terrain code, and '^', '>', 'v' and '<' are robots
+//   facing north, east, south and west on open floor. Lines may differ in length; the grid is as
+//   wide as the longest one and shorter lines are open to the right.
+// - Binary greyscale PGM (P5) with a maximum value up to 255, top row northernmost. White is open
+//   floor, black is blocked, and every grey in between is slow floor whose terrain code grows as
+//   it darkens.
+//
+// The constructor validates the whole file in one pass and keeps only its dimensions and robot
+// count. Rows are then streamed from y = 0 up straight out of the mapping, so loading needs no
+// memory beyond the file's pages, the terrain runs, and the robots themselves.
+class WorldMap
+{
+  public:
+    enum class Format : std::uint8_t
+    {
+        Ascii,
+        Pgm
+    };
+
+    // Yields robot markers in row order from y = 0 up, and west to east within a row.
+    class RobotCursor
+    {
+      public:
+        explicit RobotCursor(const WorldMap &map) noexcept;
+
+        [[nodiscard]] std::optional<RobotFactory::RobotLocation> next() noexcept;
+
+      private:
+        const WorldMap *m_map;
+        std::size_t m_line_start{0}; // Line being scanned, as byte offsets into the file.
+        std::size_t m_line_end{0};
+        std::size_t m_offset{0}; // Next byte to look at.
+        RobotFactory::Coordinate m_y{0};
+    };
+
+    // Throws std::runtime_error if the file cannot be read or is not a valid map.
+    explicit WorldMap(const std::string &path);
+    ~WorldMap();
+    WorldMap(const WorldMap &) = delete;
+    WorldMap &operator=(const WorldMap &) = delete;
+    WorldMap(WorldMap &&) = delete;
+    WorldMap &operator=(WorldMap &&) = delete;
+
+    [[nodiscard]] Format format() const noexcept;
+    [[nodiscard]] GridSize size() const noexcept;
+    [[nodiscard]] std::size_t robotCount() const noexcept;
+    [[nodiscard]] std::size_t bytes() const noexcept;
+
+    // Adds every row's terrain runs, from y = 0 up.
+    void buildTerrain(TerrainMap::Builder &builder) const;
+
+  private:
+    std::string_view m_data;
+    std::vector<char> m_buffer; // File contents where the file cannot be mapped.
+    bool m_mapped{false};
+    Format m_format{Format::Ascii};
+    GridSize m_size{};
+    std::size_t m_robots{0};
+    std::size_t m_pixels{0}; // Offset of the first PGM pixel.
+    std::uint32_t m_max_grey{255};
+
+    void validateAscii();
+    void validatePgm();
+    // The ASCII line that ends just before offset `end`, without its line break.
+    [[nodiscard]] std::string_view lineEndingAt(std::size_t end) const noexcept;
+    // One past the last byte of the bottom ASCII line, ignoring a final line break.
+    [[nodiscard]] std::size_t asciiEnd() const noexcept;
+};
+
+} // namespace Simulator
+
+#endif
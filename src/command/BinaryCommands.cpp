@@ -0,0 +1,413 @@
+#include "marvin/command/BinaryCommands.h"
+
+#include "marvin/command/Command.h"
+#include "marvin/robot/Robot.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace Simulator
+{
+namespace
+{
+
+using Opcode = BinaryOpcode;
+using TargetTag = BinaryTarget;
+
+// Longest name or TEXT line a reader accepts, so a corrupt length cannot exhaust memory.
+constexpr std::uint64_t max_text_bytes{std::uint64_t{1} << 20};
+constexpr std::uint8_t last_direction{static_cast<std::uint8_t>(RobotFactory::Direction::West)};
+constexpr std::string_view wildcards{"*?"};
+
+[[nodiscard]] std::string uppercase(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char character)
+                   { return static_cast<char>(std::toupper(character)); });
+    return text;
+}
+
+void appendByte(std::string &bytes, std::uint8_t value)
+{
+    bytes.push_back(static_cast<char>(value));
+}
+
+void appendVarint(std::string &bytes, std::uint64_t value)
+{
+    while (value >= 0x80U)
+    {
+        appendByte(bytes, static_cast<std::uint8_t>(value | 0x80U));
+        value >>= 7U;
+    }
+    appendByte(bytes, static_cast<std::uint8_t>(value));
+}
+
+void appendString(std::string &bytes, std::string_view text)
+{
+    appendVarint(bytes, text.size());
+    bytes.append(text);
+}
+
+// Returns false for a group, which has no encoding.
+bool appendTarget(std::string &bytes, const std::optional<RobotTarget> &target)
+{
+    if (!target)
+    {
+        appendByte(bytes, static_cast<std::uint8_t>(TargetTag::All));
+        return true;
+    }
+    if (const auto *name = std::get_if<std::string>(&target->value))
+    {
+        appendByte(bytes, static_cast<std::uint8_t>(TargetTag::Name));
+        appendString(bytes, *name);
+        return true;
+    }
+    if (const auto *id = std::get_if<RobotFactory::RobotId>(&target->value))
+    {
+        appendByte(bytes, static_cast<std::uint8_t>(TargetTag::Id));
+        appendVarint(bytes, *id);
+        return true;
+    }
+    if (const auto *pattern = std::get_if<NamePattern>(&target->value))
+    {
+        appendByte(bytes, static_cast<std::uint8_t>(TargetTag::Pattern));
+        appendString(bytes, pattern->pattern);
+        return true;
+    }
+    return false;
+}
+
+// Reads the fields of one record, remembering whether any was missing or out of range.
+class RecordDecoder
+{
+  public:
+    explicit RecordDecoder(std::istream &input) : m_input{input} {}
+
+    [[nodiscard]] bool failed() const noexcept
+    {
+        return m_failed;
+    }
+
+    [[nodiscard]] std::uint8_t byte(std::uint8_t last)
+    {
+        const auto value = m_input.get();
+        if (value == std::istream::traits_type::eof() || value > last)
+        {
+            m_failed = true;
+            return 0;
+        }
+        return static_cast<std::uint8_t>(value);
+    }
+
+    [[nodiscard]] std::uint64_t varint(std::uint64_t first, std::uint64_t last)
+    {
+        std::uint64_t value{0};
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            const auto byte = m_input.get();
+            if (byte == std::istream::traits_type::eof())
+            {
+                break;
+            }
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                if (value >= first && value <= last)
+                {
+                    return value;
+                }
+                break;
+            }
+        }
+        m_failed = true;
+        return first;
+    }
+
+    [[nodiscard]] std::string text()
+    {
+        std::string value(varint(0, max_text_bytes), '\0');
+        if (!m_failed && !m_input.read(value.data(), static_cast<std::streamsize>(value.size())))
+        {
+            m_failed = true;
+        }
+        return value;
+    }
+
+    [[nodiscard]] std::string name()
+    {
+        // Upper-cased, and only names the parser accepts.
+        auto value = uppercase(text());
+        if (value.empty() || value == "ALL" || value.starts_with('@') ||
+            (value.find_first_of(wildcards) != std::string::npos))
+        {
+            m_failed = true;
+        }
+        return value;
+    }
+
+    [[nodiscard]] std::optional<RobotTarget> target()
+    {
+        switch (static_cast<TargetTag>(byte(static_cast<std::uint8_t>(TargetTag::Pattern))))
+        {
+        case TargetTag::All:
+            return std::nullopt;
+        case TargetTag::Name:
+            return RobotTarget{name()};
+        case TargetTag::Id:
+            return RobotTarget{varint(1, std::numeric_limits<RobotFactory::RobotId>::max())};
+        case TargetTag::Pattern:
+        {
+            auto pattern = uppercase(text());
+            if (pattern.find_first_of(wildcards) == std::string::npos)
+            {
+                m_failed = true;
+            }
+            return RobotTarget{NamePattern{std::move(pattern)}};
+        }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] RobotFactory::Coordinate coordinate(std::uint64_t first)
+    {
+        return static_cast<RobotFactory::Coordinate>(
+            varint(first, std::numeric_limits<RobotFactory::Coordinate>::max()));
+    }
+
+  private:
+    std::istream &m_input;
+    bool m_failed{false};
+};
+
+} // namespace
+
+bool appendBinaryCommand(const Command &command, std::string &bytes)
+{
+    const auto start = bytes.size();
+    const auto encoded = std::visit(
+        [&bytes](const auto &command) -> bool
+        {
+            using Type = std::decay_t<decltype(command)>;
+            const auto opcode = [&bytes](Opcode value)
+            { appendByte(bytes, static_cast<std::uint8_t>(value)); };
+            if constexpr (std::is_same_v<Type, PlaceCommand>)
+            {
+                opcode(Opcode::Place);
+                appendString(bytes, command.name);
+                appendVarint(bytes, static_cast<std::uint64_t>(command.location.x));
+                appendVarint(bytes, static_cast<std::uint64_t>(command.location.y));
+                appendByte(bytes, static_cast<std::uint8_t>(command.location.direction));
+                return true;
+            }
+            else if constexpr (std::is_same_v<Type, MoveCommand>)
+            {
+                opcode(Opcode::Move);
+                const auto encoded = !command.where && appendTarget(bytes, command.target);
+                appendVarint(bytes, command.blocks);
+                return encoded;
+            }
+            else if constexpr (std::is_same_v<Type, RotateCommand>)
+            {
+                opcode(Opcode::Rotate);
+                const auto encoded = !command.where && appendTarget(bytes, command.target);
+                appendByte(bytes, command.rotation == RobotFactory::Rotation::Left ? 0 : 1);
+                return encoded;
+            }
+            else if constexpr (std::is_same_v<Type, RemoveCommand>)
+            {
+                opcode(Opcode::Remove);
+                return !command.where && appendTarget(bytes, command.target);
+            }
+            else if constexpr (std::is_same_v<Type, ResizeCommand>)
+            {
+                opcode(Opcode::Resize);
+                appendVarint(bytes, static_cast<std::uint64_t>(command.size.width));
+                appendVarint(bytes, static_cast<std::uint64_t>(command.size.height));
+                return true;
+            }
+            else if constexpr (std::is_same_v<Type, ReportCommand>)
+            {
+                opcode(Opcode::Report);
+                return !command.where;
+            }
+            else if constexpr (std::is_same_v<Type, ScanCommand>)
+            {
+                opcode(Opcode::Scan);
+                return appendTarget(bytes, command.target);
+            }
+            else if constexpr (std::is_same_v<Type, HashCommand>)
+            {
+                opcode(Opcode::Hash);
+                return command.action == HashCommand::Action::Show;
+            }
+            else if constexpr (std::is_same_v<Type, BeginCommand>)
+            {
+                opcode(Opcode::Begin);
+                return true;
+            }
+            else if constexpr (std::is_same_v<Type, CommitCommand>)
+            {
+                opcode(Opcode::Commit);
+                return true;
+            }
+            else if constexpr (std::is_same_v<Type, AbortCommand>)
+            {
+                opcode(Opcode::Abort);
+                return true;
+            }
+            else if constexpr (std::is_same_v<Type, QuitCommand>)
+            {
+                opcode(Opcode::Quit);
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        },
+        command);
+    if (!encoded)
+    {
+        bytes.resize(start);
+    }
+    return encoded;
+}
+
+void appendBinaryText(std::string_view line, std::string &bytes)
+{
+    appendByte(bytes, static_cast<std::uint8_t>(Opcode::Text));
+    appendString(bytes, line);
+}
+
+bool readBinaryHeader(std::istream &input, std::string &prefix)
+{
+    prefix.clear();
+    for (const auto character : binary_commands_magic)
+    {
+        if (input.peek() != std::istream::traits_type::to_int_type(character))
+        {
+            return false;
+        }
+        prefix.push_back(static_cast<char>(input.get()));
+    }
+    return true;
+}
+
+BinaryCommandReader::BinaryCommandReader(std::istream &input, Header header) : m_input{input}
+{
+    m_valid = header == Header::Read || readBinaryHeader(m_input, m_text);
+}
+
+bool BinaryCommandReader::next(ParseResult &result)
+{
+    if (!m_valid)
+    {
+        return false;
+    }
+    const auto opcode = m_input.get();
+    if (opcode == std::istream::traits_type::eof())
+    {
+        return false;
+    }
+
+    RecordDecoder decode{m_input};
+    std::optional<Command> command;
+    switch (static_cast<Opcode>(opcode))
+    {
+    case Opcode::Place:
+    {
+        PlaceCommand place{.name = decode.name(), .location = {}};
+        place.location.x = decode.coordinate(0);
+        place.location.y = decode.coordinate(0);
+        place.location.direction =
+            static_cast<RobotFactory::Direction>(decode.byte(last_direction));
+        command = std::move(place);
+        break;
+    }
+    case Opcode::Move:
+    {
+        MoveCommand move;
+        move.target = decode.target();
+        move.blocks =
+            static_cast<std::uint32_t>(decode.varint(1, std::numeric_limits<std::uint32_t>::max()));
+        command = std::move(move);
+        break;
+    }
+    case Opcode::Rotate:
+    {
+        RotateCommand rotate;
+        rotate.target = decode.target();
+        rotate.rotation = decode.byte(1) == 0 ? RobotFactory::Rotation::Left
+                                              : RobotFactory::Rotation::Right;
+        command = std::move(rotate);
+        break;
+    }
+    case Opcode::Remove:
+        command = RemoveCommand{.target = decode.target(), .where = std::nullopt};
+        break;
+    case Opcode::Resize:
+    {
+        ResizeCommand resize;
+        resize.size.width = decode.coordinate(1);
+        resize.size.height = decode.coordinate(1);
+        command = resize;
+        break;
+    }
+    case Opcode::Report:
+        command = ReportCommand{};
+        break;
+    case Opcode::Scan:
+        command = ScanCommand{.target = decode.target()};
+        break;
+    case Opcode::Hash:
+        command = HashCommand{};
+        break;
+    case Opcode::Begin:
+        command = BeginCommand{};
+        break;
+    case Opcode::Commit:
+        command = CommitCommand{};
+        break;
+    case Opcode::Abort:
+        command = AbortCommand{};
+        break;
+    case Opcode::Quit:
+        command = QuitCommand{};
+        break;
+    case Opcode::Text:
+        m_text = decode.text();
+        if (!decode.failed())
+        {
+            result = CommandParser::parse(m_text);
+            return true;
+        }
+        break;
+    default:
+        m_valid = false;
+        return false;
+    }
+    if (decode.failed())
+    {
+        m_valid = false;
+        return false;
+    }
+    result.command = std::move(command);
+    result.error.clear();
+    return true;
+}
+
+bool BinaryCommandReader::valid() const noexcept
+{
+    return m_valid;
+}
+
+} // namespace Simulator
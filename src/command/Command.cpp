@@ -1,17 +1,24 @@
 #include "marvin/command/Command.h"
 
 #include "marvin/robot/Robot.h"
+#include "marvin/simulator/Tracer.h"
 
 #include <algorithm>
+#include <array>
 #include <charconv>
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <limits>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace Simulator
@@ -54,6 +61,36 @@ template <typename Value> [[nodiscard]] std::optional<Value> parseInteger(std::s
     return value;
 }
 
+// A byte count with an optional binary K, M or G suffix, such as 512K.
+[[nodiscard]] std::optional<std::size_t> parseByteCount(std::string_view text)
+{
+    unsigned shift{0};
+    if (!text.empty())
+    {
+        switch (std::toupper(static_cast<unsigned char>(text.back())))
+        {
+        case 'K':
+            shift = 10;
+            break;
+        case 'M':
+            shift = 20;
+            break;
+        case 'G':
+            shift = 30;
+            break;
+        default:
+            break;
+        }
+    }
+    const auto digits = shift == 0 ? text : text.substr(0, text.size() - 1);
+    const auto count = parseInteger<std::size_t>(digits);
+    if (!count || *count > (std::numeric_limits<std::size_t>::max() >> shift))
+    {
+        return std::nullopt;
+    }
+    return *count << shift;
+}
+
 [[nodiscard]] std::optional<RobotFactory::Direction> parseDirection(std::string value)
 {
     value = uppercase(std::move(value));
@@ -90,6 +127,26 @@ template <typename Value> [[nodiscard]] std::optional<Value> parseInteger(std::s
     return std::nullopt;
 }
 
+[[nodiscard]] std::optional<PopulationPattern> parsePattern(std::string value)
+{
+    value = uppercase(std::move(value));
+    if (value == "RANDOM")
+    {
+        return PopulationPattern::Random;
+    }
+    if (value == "LATTICE")
+    {
+        return PopulationPattern::Lattice;
+    }
+    if (value == "CLUSTERED")
+    {
+        return PopulationPattern::Clustered;
+    }
+    return std::nullopt;
+}
+
+constexpr std::string_view wildcards{"*?"};
+
 [[nodiscard]] std::optional<RobotTarget> parseTarget(std::string value)
 {
     if (value.starts_with('@'))
@@ -107,9 +164,147 @@ template <typename Value> [[nodiscard]] std::optional<Value> parseInteger(std::s
     {
         return std::nullopt;
     }
+    if (value.find_first_of(wildcards) != std::string::npos)
+    {
+        return RobotTarget{NamePattern{std::move(value)}};
+    }
     return RobotTarget{std::move(value)};
 }
 
+// Parses `first..last`, `first..`, `..last` or a single value.
+template <typename Value>
+[[nodiscard]] std::optional<FilterRange<Value>> parseRange(std::string_view text)
+{
+    FilterRange<Value> range;
+    const auto separator = text.find("..");
+    if (separator == std::string_view::npos)
+    {
+        const auto value = parseInteger<Value>(text);
+        if (!value)
+        {
+            return std::nullopt;
+        }
+        return FilterRange<Value>{.first = *value, .last = *value};
+    }
+    const auto first = text.substr(0, separator);
+    const auto last = text.substr(separator + 2);
+    if (first.empty() && last.empty())
+    {
+        return std::nullopt;
+    }
+    if (!first.empty())
+    {
+        const auto value = parseInteger<Value>(first);
+        if (!value)
+        {
+            return std::nullopt;
+        }
+        range.first = *value;
+    }
+    if (!last.empty())
+    {
+        const auto value = parseInteger<Value>(last);
+        if (!value)
+        {
+            return std::nullopt;
+        }
+        range.last = *value;
+    }
+    return range.empty() ? std::nullopt : std::optional{range};
+}
+
+template <typename Value>
+void intersect(FilterRange<Value> &range, const FilterRange<Value> &other) noexcept
+{
+    range.first = std::max(range.first, other.first);
+    range.last = std::min(range.last, other.last);
+}
+
+// Applies one `KEY=VALUE` term of a WHERE clause; repeated numeric terms narrow each other.
+[[nodiscard]] bool applyTerm(RobotFilter &filter, const std::string &term)
+{
+    const auto separator = term.find('=');
+    if (separator == std::string::npos)
+    {
+        return false;
+    }
+    const auto key = std::string_view{term}.substr(0, separator);
+    const auto value = std::string_view{term}.substr(separator + 1);
+    if (key == "DIRECTION")
+    {
+        std::uint8_t directions{0};
+        for (std::size_t start = 0; start <= value.size();)
+        {
+            const auto end = std::min(value.find('|', start), value.size());
+            const auto direction = parseDirection(std::string{value.substr(start, end - start)});
+            if (!direction)
+            {
+                return false;
+            }
+            directions |= static_cast<std::uint8_t>(1U << static_cast<unsigned>(*direction));
+            start = end + 1;
+        }
+        filter.directions &= directions;
+        return true;
+    }
+    if (key == "NAME")
+    {
+        auto prefix = value;
+        if (prefix.ends_with('*'))
+        {
+            prefix.remove_suffix(1);
+        }
+        if (prefix.empty() || !filter.name_prefix.empty())
+        {
+            return false;
+        }
+        filter.name_prefix = std::string{prefix};
+        return true;
+    }
+    if (key == "X" || key == "Y")
+    {
+        const auto range = parseRange<RobotFactory::Coordinate>(value);
+        if (range)
+        {
+            intersect(key == "X" ? filter.x : filter.y, *range);
+        }
+        return range.has_value();
+    }
+    if (key == "ID")
+    {
+        const auto range = parseRange<RobotFactory::RobotId>(value);
+        if (range)
+        {
+            intersect(filter.id, *range);
+        }
+        return range.has_value();
+    }
+    return false;
+}
+
+// Terms following WHERE, optionally joined by AND.
+[[nodiscard]] std::optional<RobotFilter> parseWhere(std::span<const std::string> terms,
+                                                    std::string &invalid)
+{
+    RobotFilter filter;
+    bool any{false};
+    for (const auto &token : terms)
+    {
+        auto term = uppercase(token);
+        if (term == "AND")
+        {
+            continue;
+        }
+        if (!applyTerm(filter, term))
+        {
+            invalid = token;
+            return std::nullopt;
+        }
+        any = true;
+    }
+    return any ? std::optional{std::move(filter)} : std::nullopt;
+}
+
 [[nodiscard]] ParseResult failure(std::string message)
 {
     return {.command = std::nullopt, .error = std::move(message)};
@@ -120,22 +315,75 @@ template <typename Value> [[nodiscard]] std::optional<Value> parseInteger(std::s
     return {.command = std::move(command), .error = {}};
 }
 
+template <std::size_t... Indices>
+[[nodiscard]] constexpr auto makeVerbs(std::index_sequence<Indices...> /*indices*/) noexcept
+{
+    return std::array<std::string_view, sizeof...(Indices)>{
+        std::variant_alternative_t<Indices, Command>::verb...};
+}
+
+constexpr auto command_verbs = makeVerbs(std::make_index_sequence<command_kind_count>{});
+
 } // namespace
 
-ParseResult::operator bool() const noexcept
+std::string_view commandVerb(std::size_t index) noexcept
 {
-    return command.has_value();
+    return index < command_verbs.size() ? command_verbs.at(index) : std::string_view{"INVALID"};
 }
 
-ParseResult CommandParser::parse(std::string_view input)
+std::string_view NamePattern::prefix() const noexcept
 {
-    auto tokens = tokenize(input);
-    if (tokens.empty())
+    return std::string_view{pattern}.substr(0, pattern.find_first_of(wildcards));
+}
+
+bool NamePattern::matches(std::string_view name) const noexcept
+{
+    // Greedy glob matching: on a mismatch, let the most recent `*` absorb one more character.
+    const std::string_view glob{pattern};
+    std::size_t position{0};
+    std::size_t character{0};
+    auto star = std::string_view::npos;
+    std::size_t star_character{0};
+    while (character < name.size())
     {
-        return failure("Command is empty.");
+        if (position < glob.size() &&
+            (glob[position] == '?' || glob[position] == name[character]))
+        {
+            ++position;
+            ++character;
+        }
+        else if (position < glob.size() && glob[position] == '*')
+        {
+            star = position++;
+            star_character = character;
+        }
+        else if (star != std::string_view::npos)
+        {
+            position = star + 1;
+            character = ++star_character;
+        }
+        else
+        {
+            return false;
+        }
     }
+    while (position < glob.size() && glob[position] == '*')
+    {
+        ++position;
+    }
+    return position == glob.size();
+}
 
-    const std::string verb = uppercase(tokens.front());
+ParseResult::operator bool() const noexcept
+{
+    return command.has_value();
+}
+
+namespace
+{
+
+[[nodiscard]] ParseResult parseVerb(const std::string &verb, const std::vector<std::string> &tokens)
+{
     if (verb == "PLACE")
     {
         if (tokens.size() != 5)
@@ -146,6 +394,10 @@ ParseResult CommandParser::parse(std::string_view input)
         {
             return failure("Robot names cannot begin with '@'.");
         }
+        if (tokens.at(1).find_first_of(wildcards) != std::string::npos)
+        {
+            return failure("Robot names cannot contain '*' or '?'.");
+        }
         const auto x = parseInteger<RobotFactory::Coordinate>(tokens.at(2));
         const auto y = parseInteger<RobotFactory::Coordinate>(tokens.at(3));
         const auto direction = parseDirection(tokens.at(4));
@@ -217,7 +469,8 @@ ParseResult CommandParser::parse(std::string_view input)
         }
         RotateCommand command{.target = std::nullopt,
                               .rotation = verb == "LEFT" ? RobotFactory::Rotation::Left
-                                                         : RobotFactory::Rotation::Right};
+                                                         : RobotFactory::Rotation::Right,
+                              .where = std::nullopt};
         if (tokens.size() == 2 && uppercase(tokens.at(1)) != "ALL")
         {
             command.target = parseTarget(tokens.at(1));
@@ -247,6 +500,149 @@ ParseResult CommandParser::parse(std::string_view input)
         return success(command);
     }
 
+    if (verb == "SCAN")
+    {
+        if (tokens.size() > 2)
+        {
+            return failure("Usage: SCAN [ALL|name|@id].");
+        }
+        ScanCommand command;
+        if (tokens.size() == 2 && uppercase(tokens.at(1)) != "ALL")
+        {
+            command.target = parseTarget(tokens.at(1));
+            if (!command.target)
+            {
+                return failure("SCAN target is invalid.");
+            }
+        }
+        return success(command);
+    }
+
+    if (verb == "LOADMAP")
+    {
+        if (tokens.size() != 2)
+        {
+            return failure("Usage: LOADMAP <file>.");
+        }
+        return success(LoadMapCommand{.path = tokens.at(1)});
+    }
+
+    if (verb == "MEMORY")
+    {
+        if (tokens.size() == 1)
+        {
+            return success(MemoryCommand{});
+        }
+        if (tokens.size() != 3 || uppercase(tokens.at(1)) != "LIMIT")
+        {
+            return failure("Usage: MEMORY [LIMIT <bytes[K|M|G]>|OFF].");
+        }
+        if (uppercase(tokens.at(2)) == "OFF")
+        {
+            return success(MemoryCommand{.action = MemoryCommand::Action::SetLimit, .limit = 0});
+        }
+        const auto limit = parseByteCount(tokens.at(2));
+        if (!limit || *limit == 0)
+        {
+            return failure("MEMORY LIMIT must be a positive byte count or OFF.");
+        }
+        return success(MemoryCommand{.action = MemoryCommand::Action::SetLimit, .limit = *limit});
+    }
+
+    if (verb == "HEATMAP")
+    {
+        constexpr std::string_view usage{
+            "Usage: HEATMAP [ON [16|32]|OFF|RESET|CSV <file>|PGM <file> [VISITS|BLOCKED]]."};
+        if (tokens.size() == 1)
+        {
+            return success(HeatmapCommand{});
+        }
+        const auto action = uppercase(tokens.at(1));
+        if (action == "ON" && tokens.size() <= 3)
+        {
+            HeatmapCommand command;
+            command.action = HeatmapCommand::Action::Start;
+            if (tokens.size() == 3)
+            {
+                const auto bits = tokens.at(2);
+                if (bits != "16" && bits != "32")
+                {
+                    return failure("HEATMAP counters are 16 or 32 bits wide.");
+                }
+                command.width = bits == "16" ? Heatmap::Width::Bits16 : Heatmap::Width::Bits32;
+            }
+            return success(command);
+        }
+        if ((action == "OFF" || action == "RESET") && tokens.size() == 2)
+        {
+            HeatmapCommand command;
+            command.action =
+                action == "OFF" ? HeatmapCommand::Action::Stop : HeatmapCommand::Action::Reset;
+            return success(command);
+        }
+        if (action == "CSV" && tokens.size() == 3)
+        {
+            return success(HeatmapCommand{.action = HeatmapCommand::Action::ExportCsv,
+                                          .width = {},
+                                          .channel = {},
+                                          .path = tokens.at(2)});
+        }
+        if (action == "PGM" && (tokens.size() == 3 || tokens.size() == 4))
+        {
+            HeatmapCommand command;
+            command.action = HeatmapCommand::Action::ExportPgm;
+            command.path = tokens.at(2);
+            if (tokens.size() == 4)
+            {
+                const auto channel = uppercase(tokens.at(3));
+                if (channel != "VISITS" && channel != "BLOCKED")
+                {
+                    return failure("HEATMAP PGM exports VISITS or BLOCKED.");
+                }
+                command.channel = channel == "VISITS" ? Heatmap::Channel::Visits
+                                                      : Heatmap::Channel::Blocked;
+            }
+            return success(command);
+        }
+        return failure(std::string{usage});
+    }
+
+    if (verb == "GROUP")
+    {
+        constexpr std::string_view usage{
+            "Usage: GROUP [CREATE <group>|DELETE <group>|ADD <group> <name|@id>...]."};
+        if (tokens.size() == 1)
+        {
+            return success(GroupCommand{});
+        }
+        const auto action = uppercase(tokens.at(1));
+        const bool adds = action == "ADD" && tokens.size() >= 4;
+        if (!adds && ((action != "CREATE" && action != "DELETE") || tokens.size() != 3))
+        {
+            return failure(std::string{usage});
+        }
+        const auto name = parseTarget(tokens.at(2));
+        if (!name || !std::holds_alternative<std::string>(name->value))
+        {
+            return failure("GROUP name is invalid.");
+        }
+        GroupCommand command;
+        command.action = adds                 ? GroupCommand::Action::Add
+                         : action == "CREATE" ? GroupCommand::Action::Create
+                                              : GroupCommand::Action::Delete;
+        command.name = std::get<std::string>(name->value);
+        for (std::size_t token = 3; token < tokens.size(); ++token)
+        {
+            auto member = parseTarget(tokens.at(token));
+            if (!member)
+            {
+                return failure("GROUP ADD target is invalid.");
+            }
+            command.members.push_back(std::move(*member));
+        }
+        return success(command);
+    }
+
     if (verb == "RESIZE")
     {
         if (tokens.size() != 3)
@@ -262,7 +658,135 @@ ParseResult CommandParser::parse(std::string_view input)
         return success(ResizeCommand{.size = {.width = *width, .height = *height}});
     }
 
-    if ((verb == "REPORT" || verb == "MENU" || verb == "QUIT" || verb == "EXIT") &&
+    if (verb == "POPULATE")
+    {
+        if (tokens.size() != 3 && tokens.size() != 4)
+        {
+            return failure("Usage: POPULATE <count> <RANDOM|LATTICE|CLUSTERED> [seed].");
+        }
+        const auto count = parseInteger<std::size_t>(tokens.at(1));
+        const auto pattern = parsePattern(tokens.at(2));
+        if (!count || *count == 0 || !pattern)
+        {
+            return failure("POPULATE requires a positive count and RANDOM, LATTICE or CLUSTERED.");
+        }
+        PopulateCommand command{.count = *count, .pattern = *pattern};
+        if (tokens.size() == 4)
+        {
+            const auto seed = parseInteger<std::uint64_t>(tokens.at(3));
+            if (!seed)
+            {
+                return failure("POPULATE seed must be a non-negative integer.");
+            }
+            command.seed = *seed;
+        }
+        return success(command);
+    }
+
+    if (verb == "STATS")
+    {
+        if (tokens.size() > 2)
+        {
+            return failure("Usage: STATS [RESET|JSON].");
+        }
+        StatsCommand command;
+        if (tokens.size() == 2)
+        {
+            const auto option = uppercase(tokens.at(1));
+            command.reset = option == "RESET";
+            command.json = option == "JSON";
+            if (!command.reset && !command.json)
+            {
+                return failure("STATS accepts RESET or JSON.");
+            }
+        }
+        return success(command);
+    }
+
+    if (verb == "HASH")
+    {
+        if (tokens.size() == 1)
+        {
+            return success(HashCommand{});
+        }
+        if (uppercase(tokens.at(1)) != "TRAIL" || tokens.size() > 3)
+        {
+            return failure("Usage: HASH [TRAIL [every|OFF]].");
+        }
+        if (tokens.size() == 2)
+        {
+            return success(HashCommand{.action = HashCommand::Action::ShowTrail});
+        }
+        if (uppercase(tokens.at(2)) == "OFF")
+        {
+            return success(HashCommand{.action = HashCommand::Action::StopTrail});
+        }
+        const auto every = parseInteger<std::uint32_t>(tokens.at(2));
+        if (!every || *every == 0)
+        {
+            return failure("HASH TRAIL interval must be a positive integer.");
+        }
+        return success(HashCommand{.action = HashCommand::Action::StartTrail, .every = *every});
+    }
+
+    if (verb == "TRACE")
+    {
+        if (tokens.size() < 2 || tokens.size() > 3)
+        {
+            return failure("Usage: TRACE <file> [sample-every] | TRACE STOP.");
+        }
+        if (uppercase(tokens.at(1)) == "STOP")
+        {
+            return tokens.size() == 2 ? success(TraceCommand{})
+                                      : failure("TRACE STOP does not accept arguments.");
+        }
+        TraceCommand command{.path = tokens.at(1)};
+        if (tokens.size() == 3)
+        {
+            const auto sample_every = parseInteger<std::uint32_t>(tokens.at(2));
+            if (!sample_every || *sample_every == 0)
+            {
+                return failure("TRACE sampling interval must be a positive integer.");
+            }
+            command.sample_every = *sample_every;
+        }
+        return success(command);
+    }
+
+    if (verb == "RECORD")
+    {
+        if (tokens.size() > 3)
+        {
+            return failure("Usage: RECORD [<file> [chunk-records]|STOP].");
+        }
+        RecordCommand command;
+        if (tokens.size() == 1)
+        {
+            return success(command);
+        }
+        if (uppercase(tokens.at(1)) == "STOP")
+        {
+            command.action = RecordCommand::Action::Stop;
+            return tokens.size() == 2 ? success(command)
+                                      : failure("RECORD STOP does not accept arguments.");
+        }
+        command.action = RecordCommand::Action::Start;
+        command.path = tokens.at(1);
+        if (tokens.size() == 3)
+        {
+            const auto chunk_records = parseInteger<std::size_t>(tokens.at(2));
+            if (!chunk_records || *chunk_records == 0 ||
+                *chunk_records > TrajectoryRecorder::max_chunk_records)
+            {
+                return failure("RECORD chunks hold 1 to 1048576 records.");
+            }
+            command.chunk_records = *chunk_records;
+        }
+        return success(command);
+    }
+
+    if ((verb == "REPORT" || verb == "MENU" || verb == "QUIT" || verb == "EXIT" ||
+         verb == "BEGIN" || verb == "COMMIT" || verb == "ABORT") &&
         tokens.size() != 1)
     {
         return failure(verb + " does not accept arguments.");
@@ -279,7 +803,101 @@ ParseResult CommandParser::parse(std::string_view input)
     {
         return success(QuitCommand{});
     }
+    if (verb == "BEGIN")
+    {
+        return success(BeginCommand{});
+    }
+    if (verb == "COMMIT")
+    {
+        return success(CommitCommand{});
+    }
+    if (verb == "ABORT")
+    {
+        return success(AbortCommand{});
+    }
     return failure("Unknown command: " + verb + '.');
 }
 
+// The WHERE that starts a filter clause, or end(). Only verbs that take a filter have one, and
+// a WHERE followed by anything but a KEY=VALUE term is an argument, such as a robot named WHERE.
+[[nodiscard]] std::vector<std::string>::iterator whereClause(const std::string &verb,
+                                                             std::vector<std::string> &tokens)
+{
+    if (verb != "MOVE" && verb != "ROTATE" && verb != "LEFT" && verb != "RIGHT" &&
+        verb != "REMOVE" && verb != "REPORT")
+    {
+        return tokens.end();
+    }
+    for (auto token = std::next(tokens.begin()); token != tokens.end(); ++token)
+    {
+        const auto term = std::next(token);
+        if (uppercase(*token) == "WHERE" &&
+            (term == tokens.end() || term->find('=') != std::string::npos))
+        {
+            return token;
+        }
+    }
+    return tokens.end();
+}
+
+} // namespace
+
+ParseResult CommandParser::parse(std::string_view input)
+{
+    const TraceSpan span{"CommandParser::parse"};
+    auto tokens = tokenize(input);
+    if (tokens.empty())
+    {
+        return failure("Command is empty.");
+    }
+
+    const std::string verb = uppercase(tokens.front());
+    const auto clause = whereClause(verb, tokens);
+    if (clause == tokens.end())
+    {
+        return parseVerb(verb, tokens);
+    }
+
+    std::string invalid;
+    auto where = parseWhere(std::span{std::next(clause), tokens.end()}, invalid);
+    if (!where)
+    {
+        return failure(invalid.empty() ? "Usage: ... WHERE [DIRECTION=d[|d]] [X=a..b] [Y=a..b] "
+                                         "[ID=a..b] [NAME=prefix*]."
+                                       : "Invalid WHERE term: " + invalid + '.');
+    }
+    tokens.erase(clause, tokens.end());
+    // No target may come before WHERE, so a lone number there is MOVE's block count.
+    if (verb == "MOVE" && tokens.size() == 2 && parseInteger<std::uint32_t>(tokens.at(1)))
+    {
+        tokens.insert(std::next(tokens.begin()), "ALL");
+    }
+    auto result = parseVerb(verb, tokens);
+    if (!result)
+    {
+        return result;
+    }
+    return std::visit(
+        [&where](auto command) -> ParseResult
+        {
+            if constexpr (requires { command.where; })
+            {
+                if constexpr (requires { command.target; })
+                {
+                    if (command.target)
+                    {
+                        return failure("WHERE cannot be combined with a robot name or ID.");
+                    }
+                }
+                command.where = std::move(where);
+                return success(std::move(command));
+            }
+            else
+            {
+                return failure(std::string{command.verb} + " does not accept WHERE.");
+            }
+        },
+        std::move(*result.command));
+}
+
 } // namespace Simulator
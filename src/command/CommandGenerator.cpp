@@ -0,0 +1,520 @@
+#include "marvin/command/CommandGenerator.h"
+
+#include "marvin/command/BinaryCommands.h"
+#include "marvin/command/Command.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr unsigned generation_shift{32};
+constexpr std::size_t direction_count{4};
+constexpr std::uint64_t golden_gamma{0x9E3779B97F4A7C15U};
+
+// SplitMix64's output function, a bijection that spreads every input bit over the whole word.
+[[nodiscard]] constexpr std::uint64_t mix(std::uint64_t value) noexcept
+{
+    value = (value ^ (value >> 30U)) * 0xBF58476D1CE4E5B9U;
+    value = (value ^ (value >> 27U)) * 0x94D049BB133111EBU;
+    return value ^ (value >> 31U);
+}
+
+[[nodiscard]] constexpr std::uint64_t splitmix64(std::uint64_t value) noexcept
+{
+    return mix(value + golden_gamma);
+}
+
+// Each is rejected by the parser for a different reason.
+constexpr std::array<std::string_view, 8> malformed_lines{
+    "MOVE R1 0",     "PLACE R1 1,1 UP", "ROTATE R1 AROUND",    "RESIZE 0 4",
+    "JUMP R1 NORTH", "REMOVE R1 R2",    "PLACE @R1 0,0 NORTH", "SCAN ALL R1"};
+
+template <std::size_t Size>
+[[nodiscard]] std::array<std::uint64_t, Size>
+cumulative(const std::array<std::uint32_t, Size> &weights)
+{
+    std::array<std::uint64_t, Size> thresholds{};
+    std::uint64_t total{0};
+    for (std::size_t index = 0; index < Size; ++index)
+    {
+        total += weights.at(index);
+        thresholds.at(index) = total;
+    }
+    if (total == 0)
+    {
+        throw std::invalid_argument{"A command generator mix has no weight in it."};
+    }
+    return thresholds;
+}
+
+// Room for the longest line or record a CommandGenerator writes, a PLACE with 20-digit operands.
+constexpr std::size_t max_line_bytes{128};
+
+[[nodiscard]] std::string_view rotationName(RobotFactory::Rotation rotation)
+{
+    return rotation == RobotFactory::Rotation::Left ? "LEFT" : "RIGHT";
+}
+
+} // namespace
+
+// Fields are written into a fixed buffer, which is then appended to the output at once.
+class CommandGenerator::LineWriter
+{
+  public:
+    void put(char character) noexcept
+    {
+        m_buffer[m_size++] = character;
+    }
+
+    void put(std::string_view text) noexcept
+    {
+        std::copy(text.begin(), text.end(), m_buffer.data() + m_size);
+        m_size += text.size();
+    }
+
+    template <typename Integer> void number(Integer value) noexcept
+    {
+        m_size = static_cast<std::size_t>(
+            std::to_chars(m_buffer.data() + m_size, m_buffer.data() + m_buffer.size(), value).ptr -
+            m_buffer.data());
+    }
+
+    void byte(std::uint8_t value) noexcept
+    {
+        put(static_cast<char>(value));
+    }
+
+    void varint(std::uint64_t value) noexcept
+    {
+        while (value >= 0x80U)
+        {
+            byte(static_cast<std::uint8_t>(value | 0x80U));
+            value >>= 7U;
+        }
+        byte(static_cast<std::uint8_t>(value));
+    }
+
+    // A length-prefixed string of the binary format.
+    void string(std::string_view text) noexcept
+    {
+        varint(text.size());
+        put(text);
+    }
+
+    // R<number>, which is every generated name.
+    template <bool Binary> void name(std::uint64_t number) noexcept
+    {
+        if constexpr (Binary)
+        {
+            // Names are at most 21 characters long, so their length is a one-byte varint, which
+            // is written once the name is.
+            const auto start = m_size++;
+            put('R');
+            this->number(number);
+            m_buffer.at(start) = static_cast<char>(m_size - start - 1);
+        }
+        else
+        {
+            put('R');
+            this->number(number);
+        }
+    }
+
+    // The verb of a text line, or the opcode of a record.
+    template <bool Binary> void verb(BinaryOpcode opcode, std::string_view text) noexcept
+    {
+        if constexpr (Binary)
+        {
+            byte(static_cast<std::uint8_t>(opcode));
+        }
+        else
+        {
+            put(text);
+        }
+    }
+
+    void appendTo(std::string &text) const
+    {
+        text.append(m_buffer.data(), m_size);
+    }
+
+  private:
+    // Left uninitialised: clearing it would cost more than writing a whole line.
+    std::array<char, max_line_bytes> m_buffer; // NOLINT(*-member-init)
+    std::size_t m_size{0};
+};
+
+CommandGenerator::CommandGenerator(std::uint64_t seed, CommandGeneratorOptions options)
+    : m_options{options}, m_state{seed}, m_grid{options.grid}
+{
+    const auto &mix = m_options.mix;
+    m_kind_thresholds = cumulative<kind_count>({mix.place, mix.move, mix.rotate, mix.remove,
+                                                mix.resize, mix.report, mix.scan, mix.hash,
+                                                mix.transaction, mix.malformed});
+    const auto &targets = m_options.targets;
+    m_target_thresholds =
+        cumulative<target_count>({targets.name, targets.id, targets.all, targets.pattern});
+    m_recent.reserve(recent_capacity);
+}
+
+std::string CommandGenerator::next()
+{
+    std::string line;
+    appendText(line);
+    line.pop_back();
+    return line;
+}
+
+void CommandGenerator::appendText(std::string &text)
+{
+    LineWriter writer;
+    generate<false>(writer);
+    writer.put('\n');
+    writer.appendTo(text);
+}
+
+void CommandGenerator::appendBinary(std::string &bytes)
+{
+    LineWriter writer;
+    generate<true>(writer);
+    writer.appendTo(bytes);
+}
+
+CommandGenerator::Kind CommandGenerator::kind() const noexcept
+{
+    return m_kind;
+}
+
+std::uint64_t CommandGenerator::generated(Kind kind) const noexcept
+{
+    return m_generated[static_cast<std::size_t>(kind)];
+}
+
+std::uint64_t CommandGenerator::targeted(Target target) const noexcept
+{
+    return m_targeted[static_cast<std::size_t>(target)];
+}
+
+template <bool Binary> void CommandGenerator::generate(LineWriter &writer)
+{
+    m_kind = static_cast<Kind>(pick(m_kind_thresholds));
+    ++m_generated.at(static_cast<std::size_t>(m_kind));
+    switch (m_kind)
+    {
+    case Kind::Place:
+        place<Binary>(writer);
+        break;
+    case Kind::Move:
+    {
+        writer.verb<Binary>(BinaryOpcode::Move, "MOVE ");
+        target<Binary>(writer);
+        const auto blocks =
+            chance(0.5) ? 1 : static_cast<std::uint32_t>(1 + below(m_options.max_blocks));
+        if constexpr (Binary)
+        {
+            writer.varint(blocks);
+        }
+        else if (blocks != 1)
+        {
+            writer.put(' ');
+            writer.number(blocks);
+        }
+        break;
+    }
+    case Kind::Rotate:
+    {
+        const auto rotation =
+            chance(0.5) ? RobotFactory::Rotation::Left : RobotFactory::Rotation::Right;
+        // Drawn for records too, so that both formats give the same commands for a seed.
+        const auto shorthand = chance(0.5);
+        if constexpr (Binary)
+        {
+            writer.byte(static_cast<std::uint8_t>(BinaryOpcode::Rotate));
+            target<Binary>(writer);
+            writer.byte(rotation == RobotFactory::Rotation::Left ? 0 : 1);
+        }
+        else if (shorthand)
+        {
+            writer.put(rotationName(rotation));
+            writer.put(' ');
+            target<Binary>(writer);
+        }
+        else
+        {
+            writer.put("ROTATE ");
+            target<Binary>(writer);
+            writer.put(' ');
+            writer.put(rotationName(rotation));
+        }
+        break;
+    }
+    case Kind::Remove:
+        writer.verb<Binary>(BinaryOpcode::Remove, "REMOVE ");
+        target<Binary>(writer);
+        break;
+    case Kind::Resize:
+    {
+        // Mostly near the starting size, where robots are, so shrinking can fail.
+        const auto extent = [this](RobotFactory::Coordinate start) -> RobotFactory::Coordinate
+        {
+            const auto bound = static_cast<std::uint64_t>(chance(0.6) ? 2 * start
+                                                                      : m_options.max_extent);
+            return 1 + static_cast<RobotFactory::Coordinate>(below(bound));
+        };
+        m_grid = {.width = extent(m_options.grid.width), .height = extent(m_options.grid.height)};
+        writer.verb<Binary>(BinaryOpcode::Resize, "RESIZE ");
+        if constexpr (Binary)
+        {
+            writer.varint(static_cast<std::uint64_t>(m_grid.width));
+            writer.varint(static_cast<std::uint64_t>(m_grid.height));
+        }
+        else
+        {
+            writer.number(m_grid.width);
+            writer.put(' ');
+            writer.number(m_grid.height);
+        }
+        break;
+    }
+    case Kind::Report:
+        writer.verb<Binary>(BinaryOpcode::Report, ReportCommand::verb);
+        break;
+    case Kind::Scan:
+        writer.verb<Binary>(BinaryOpcode::Scan, "SCAN ");
+        target<Binary>(writer);
+        break;
+    case Kind::Hash:
+        writer.verb<Binary>(BinaryOpcode::Hash, HashCommand::verb);
+        break;
+    case Kind::Transaction:
+        transaction<Binary>(writer);
+        break;
+    case Kind::Malformed:
+    {
+        const auto line = malformed_lines.at(below(malformed_lines.size()));
+        if constexpr (Binary)
+        {
+            writer.byte(static_cast<std::uint8_t>(BinaryOpcode::Text));
+            writer.string(line);
+        }
+        else
+        {
+            writer.put(line);
+        }
+        break;
+    }
+    }
+}
+
+std::uint64_t CommandGenerator::streamSeed(std::uint64_t seed, std::uint64_t stream) noexcept
+{
+    return splitmix64(splitmix64(seed) ^ stream);
+}
+
+std::uint64_t CommandGenerator::draw() noexcept
+{
+    m_state += golden_gamma;
+    return mix(m_state);
+}
+
+bool CommandGenerator::chance(double probability)
+{
+    constexpr double unit{0x1.0p-64};
+    return static_cast<double>(draw()) * unit < probability;
+}
+
+std::uint64_t CommandGenerator::below(std::uint64_t bound)
+{
+    // Scales the high half of a draw rather than dividing, with a bias below bound / 2^32; unlike
+    // uniform_int_distribution it also gives the same stream with every standard library.
+    constexpr unsigned half_bits{32};
+    const auto value = draw();
+    if (bound > std::uint64_t{1} << half_bits)
+    {
+        return value % bound;
+    }
+    return ((value >> half_bits) * bound) >> half_bits;
+}
+
+template <std::size_t Size>
+std::size_t CommandGenerator::pick(const std::array<std::uint64_t, Size> &thresholds)
+{
+    const auto value = below(thresholds.back());
+    return static_cast<std::size_t>(std::upper_bound(thresholds.begin(), thresholds.end(), value) -
+                                    thresholds.begin());
+}
+
+std::uint64_t CommandGenerator::name()
+{
+    return m_options.names == 0 ? m_options.first_name + m_placed : below(m_options.names);
+}
+
+template <bool Binary> void CommandGenerator::target(LineWriter &writer)
+{
+    const auto target = static_cast<Target>(pick(m_target_thresholds));
+    ++m_targeted.at(static_cast<std::size_t>(target));
+    switch (target)
+    {
+    case Target::All:
+        if constexpr (Binary)
+        {
+            writer.byte(static_cast<std::uint8_t>(BinaryTarget::All));
+        }
+        else
+        {
+            writer.put("ALL");
+        }
+        return;
+    case Target::Id:
+    {
+        // Mostly live slots' first generation, sometimes a stale or never-used handle.
+        const auto slots = m_options.names == 0 ? std::min(m_placed, recent_capacity)
+                                                : std::min(m_placed, m_options.names);
+        const auto slot = below(slots + 1);
+        const auto generation = chance(0.7) ? 0 : below(3);
+        const auto id = (generation << generation_shift) | (RobotHandleTable::first_id + slot);
+        if constexpr (Binary)
+        {
+            writer.byte(static_cast<std::uint8_t>(BinaryTarget::Id));
+            writer.varint(id);
+        }
+        else
+        {
+            writer.put('@');
+            writer.number(id);
+        }
+        return;
+    }
+    case Target::Pattern:
+    {
+        const auto digit = static_cast<char>('0' + below(10));
+        const std::array<std::array<char, 3>, 3> forms{
+            {{'R', digit, '*'}, {'R', '?', digit}, {'*', digit}}};
+        const auto form = below(forms.size());
+        const std::string_view pattern{forms.at(form).data(), form == 2 ? 2U : 3U};
+        if constexpr (Binary)
+        {
+            writer.byte(static_cast<std::uint8_t>(BinaryTarget::Pattern));
+            writer.string(pattern);
+        }
+        else
+        {
+            writer.put(pattern);
+        }
+        return;
+    }
+    case Target::Name:
+        break;
+    }
+    if constexpr (Binary)
+    {
+        writer.byte(static_cast<std::uint8_t>(BinaryTarget::Name));
+    }
+    if (!m_recent.empty() && (m_options.names == 0 || chance(0.75)))
+    {
+        writer.name<Binary>(m_recent.at(below(m_recent.size())).name);
+        return;
+    }
+    writer.name<Binary>(name());
+}
+
+template <bool Binary> void CommandGenerator::place(LineWriter &writer)
+{
+    Placement placement;
+    if (!m_recent.empty() && chance(m_options.collisions))
+    {
+        placement = m_recent.at(below(m_recent.size()));
+        if (chance(0.5))
+        {
+            placement.name = name();
+        }
+    }
+    else
+    {
+        // One past the far edge now and then, for off-grid placements.
+        placement.name = name();
+        placement.location.x = static_cast<RobotFactory::Coordinate>(
+            below(static_cast<std::uint64_t>(m_grid.width) + 1));
+        placement.location.y = static_cast<RobotFactory::Coordinate>(
+            below(static_cast<std::uint64_t>(m_grid.height) + 1));
+    }
+    placement.location.direction = static_cast<RobotFactory::Direction>(below(direction_count));
+
+    const auto &location = placement.location;
+    writer.verb<Binary>(BinaryOpcode::Place, "PLACE ");
+    writer.name<Binary>(placement.name);
+    if constexpr (Binary)
+    {
+        writer.varint(static_cast<std::uint64_t>(location.x));
+        writer.varint(static_cast<std::uint64_t>(location.y));
+        writer.byte(static_cast<std::uint8_t>(location.direction));
+    }
+    else
+    {
+        writer.put(' ');
+        writer.number(location.x);
+        writer.put(',');
+        writer.number(location.y);
+        writer.put(' ');
+        writer.put(RobotFactory::toString(location.direction));
+    }
+
+    if (m_recent.size() < recent_capacity)
+    {
+        m_recent.push_back(placement);
+    }
+    else
+    {
+        m_recent.at(m_placed % recent_capacity) = placement;
+    }
+    ++m_placed;
+}
+
+template <bool Binary> void CommandGenerator::transaction(LineWriter &writer)
+{
+    const auto finish = [this, &writer](double commit)
+    {
+        if (chance(commit))
+        {
+            writer.verb<Binary>(BinaryOpcode::Commit, CommitCommand::verb);
+        }
+        else
+        {
+            writer.verb<Binary>(BinaryOpcode::Abort, AbortCommand::verb);
+        }
+    };
+    // Mostly well-formed: BEGIN when none is open, then COMMIT or ABORT.
+    if (chance(0.15))
+    {
+        if (m_open)
+        {
+            writer.verb<Binary>(BinaryOpcode::Begin, BeginCommand::verb);
+        }
+        else
+        {
+            finish(0.5);
+        }
+        return;
+    }
+    m_open = !m_open;
+    if (m_open)
+    {
+        writer.verb<Binary>(BinaryOpcode::Begin, BeginCommand::verb);
+        return;
+    }
+    finish(0.7);
+}
+
+} // namespace Simulator
@@ -0,0 +1,127 @@
+#include "marvin/command/CommandPipeline.h"
+
+#include "marvin/command/Command.h"
+#include "marvin/simulator/Statistics.h"
+#include "marvin/simulator/Tracer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+
+CommandPipeline::CommandPipeline(std::istream &input, unsigned threads, std::size_t chunk_lines,
+                                 std::size_t window)
+    : m_input{input}, m_chunk_lines{std::max<std::size_t>(chunk_lines, 1)}
+{
+    const auto count = std::max(threads, 1U);
+    m_chunks.resize(window == 0 ? count * default_window_per_thread : window);
+    m_threads.reserve(count);
+    for (unsigned worker = 0; worker < count; ++worker)
+    {
+        m_threads.emplace_back([this] { work(); });
+    }
+}
+
+CommandPipeline::~CommandPipeline()
+{
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_stopping = true;
+    }
+    m_space.notify_all();
+}
+
+std::span<const ParsedLine> CommandPipeline::next()
+{
+    std::unique_lock lock{m_mutex};
+    if (m_holding)
+    {
+        m_chunks[(m_next_consume - 1) % m_chunks.size()].ready = false;
+        m_holding = false;
+        m_space.notify_all();
+    }
+    auto &chunk = m_chunks[m_next_consume % m_chunks.size()];
+    m_ready.wait(lock, [this, &chunk] { return chunk.ready || m_end == m_next_consume; });
+    if (!chunk.ready)
+    {
+        return {};
+    }
+    ++m_next_consume;
+    m_holding = true;
+    return chunk.lines;
+}
+
+void CommandPipeline::work()
+{
+    std::vector<std::string> text(m_chunk_lines);
+    for (;;)
+    {
+        std::uint64_t sequence{0};
+        std::size_t count{0};
+        {
+            const std::scoped_lock input{m_input_mutex};
+            {
+                // Wait for a free slot before reading, so no chunk is read past the window.
+                std::unique_lock lock{m_mutex};
+                m_space.wait(lock,
+                             [this]
+                             {
+                                 return m_stopping ||
+                                        m_next_read - m_next_consume + (m_holding ? 1 : 0) <
+                                            m_chunks.size();
+                             });
+                if (m_stopping)
+                {
+                    return;
+                }
+            }
+            if (m_input_done)
+            {
+                return;
+            }
+            while (count < m_chunk_lines && std::getline(m_input, text[count]))
+            {
+                ++count;
+            }
+            m_input_done = count < m_chunk_lines;
+            if (count == 0)
+            {
+                const std::scoped_lock lock{m_mutex};
+                m_end = m_next_read;
+                m_ready.notify_all();
+                return;
+            }
+            sequence = m_next_read++;
+            if (m_input_done)
+            {
+                const std::scoped_lock lock{m_mutex};
+                m_end = m_next_read;
+            }
+        }
+
+        // The slot is free: the window check above kept the consumer within reach of it.
+        const TraceSpan span{"CommandPipeline::parse"};
+        auto &chunk = m_chunks[sequence % m_chunks.size()];
+        chunk.lines.resize(count);
+        for (std::size_t line = 0; line < count; ++line)
+        {
+            const auto start = timestamp();
+            chunk.lines[line].result = CommandParser::parse(text[line]);
+            chunk.lines[line].parse_ns = timestamp() - start;
+        }
+        {
+            const std::scoped_lock lock{m_mutex};
+            chunk.ready = true;
+        }
+        m_ready.notify_all();
+    }
+}
+
+} // namespace Simulator
@@ -1,6 +1,7 @@
 #include "marvin/robot/Marvin.h"
 #include "marvin/robot/Robot.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -12,6 +13,11 @@ Marvin::Marvin(std::string name) : Robot{{}, std::move(name)} {}
 
 Marvin::Marvin(RobotLocation location, std::string name) : Robot{location, std::move(name)} {}
 
+Marvin::Marvin(RobotLocation location, std::string name, RobotId id)
+    : Robot{location, std::move(name), id}
+{
+}
+
 void Marvin::move(std::uint32_t blocks) noexcept
 {
     const auto distance = static_cast<Coordinate>(blocks);
@@ -43,4 +49,9 @@ void Marvin::rotate(Rotation rotation) noexcept
     m_location.direction = static_cast<Direction>(direction);
 }
 
+std::size_t Marvin::footprint() const noexcept
+{
+    return sizeof(Marvin);
+}
+
 } // namespace RobotFactory
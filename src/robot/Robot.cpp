@@ -20,6 +20,11 @@ Robot::Robot(RobotLocation location, std::string model)
 {
 }
 
+Robot::Robot(RobotLocation location, std::string model, RobotId id)
+    : m_location{location}, m_model{std::move(model)}, m_id{id}
+{
+}
+
 RobotId Robot::id() const noexcept
 {
     return m_id;
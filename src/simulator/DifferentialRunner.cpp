@@ -0,0 +1,122 @@
+#include "marvin/simulator/DifferentialRunner.h"
+
+#include "marvin/simulator/ReferenceSimulator.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+// Everything a line can be observed to do, as text.
+template <typename Engine>
+[[nodiscard]] std::string results(Engine &engine, std::string_view line, std::ostringstream &text)
+{
+    std::ostringstream output;
+    std::ostringstream errors;
+    const auto running = engine.executeLine(line, output, errors);
+    text.str({});
+    text << "Returned: " << (running ? "true" : "false") << "\nOutput:\n"
+         << output.view() << "Errors:\n"
+         << errors.view() << "World:\n";
+    engine.report(text);
+    text << "Hash: " << engine.worldHash() << '\n';
+    return text.str();
+}
+
+} // namespace
+
+DifferentialRunner::DifferentialRunner()
+{
+    m_simulators.reserve(layouts.size());
+    for (const auto layout : layouts)
+    {
+        m_simulators.emplace_back(default_grid_size, layout);
+    }
+}
+
+std::optional<Divergence> DifferentialRunner::step(std::string_view line)
+{
+    std::optional<Divergence> divergence;
+    auto expected = results(m_reference, line, m_results);
+    for (std::size_t engine = 0; engine < layouts.size(); ++engine)
+    {
+        auto actual = results(m_simulators[engine], line, m_results);
+        if (!divergence && actual != expected)
+        {
+            divergence = Divergence{.line = m_steps,
+                                    .layout = layouts.at(engine),
+                                    .expected = expected,
+                                    .actual = std::move(actual)};
+        }
+    }
+    ++m_steps;
+    return divergence;
+}
+
+std::size_t DifferentialRunner::steps() const noexcept
+{
+    return m_steps;
+}
+
+std::optional<Divergence> DifferentialRunner::run(std::span<const std::string> script)
+{
+    DifferentialRunner runner;
+    for (const auto &line : script)
+    {
+        if (auto divergence = runner.step(line))
+        {
+            return divergence;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> DifferentialRunner::shrink(std::vector<std::string> script,
+                                                    const Predicate &fails)
+{
+    std::size_t chunks{2};
+    while (script.size() > 1)
+    {
+        const auto chunk = (script.size() + chunks - 1) / chunks;
+        bool reduced{false};
+        for (std::size_t start = 0; start < script.size() && !reduced; start += chunk)
+        {
+            const auto end = std::min(start + chunk, script.size());
+            std::vector<std::string> candidate;
+            candidate.reserve(script.size() - (end - start));
+            candidate.insert(candidate.end(), script.begin(),
+                             script.begin() + static_cast<std::ptrdiff_t>(start));
+            candidate.insert(candidate.end(), script.begin() + static_cast<std::ptrdiff_t>(end),
+                             script.end());
+            if (fails(candidate))
+            {
+                script = std::move(candidate);
+                chunks = std::max<std::size_t>(chunks - 1, 2);
+                reduced = true;
+            }
+        }
+        if (!reduced)
+        {
+            if (chunk == 1)
+            {
+                break;
+            }
+            chunks = std::min(chunks * 2, script.size());
+        }
+    }
+    return script;
+}
+
+} // namespace Simulator
@@ -0,0 +1,109 @@
+#include "marvin/simulator/EventRing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Simulator
+{
+
+EventRing::EventRing(std::size_t capacity)
+    : m_capacity{std::bit_ceil(std::max<std::size_t>(capacity, 2))}
+{
+}
+
+SubscriberId EventRing::subscribe()
+{
+    if (m_events.empty())
+    {
+        m_events.resize(m_capacity);
+        m_mask = m_capacity - 1;
+    }
+    auto free = std::ranges::find(m_cursors, unsubscribed);
+    if (free == m_cursors.end())
+    {
+        free = m_cursors.insert(free, unsubscribed);
+    }
+    *free = m_head;
+    ++m_subscribers;
+    return static_cast<SubscriberId>(free - m_cursors.begin());
+}
+
+void EventRing::unsubscribe(SubscriberId subscriber) noexcept
+{
+    if (subscriber < m_cursors.size() && m_cursors[subscriber] != unsubscribed)
+    {
+        m_cursors[subscriber] = unsubscribed;
+        --m_subscribers;
+    }
+}
+
+std::uint64_t EventRing::beginBatch() noexcept
+{
+    const auto header = m_head;
+    publish({.kind = EventKind::Batch, .count = 0, .id = 0, .other = 0, .location = {}});
+    return header;
+}
+
+void EventRing::endBatch(std::uint64_t header) noexcept
+{
+    const auto events = m_head - header - 1;
+    if (events == 0)
+    {
+        m_head = header;
+    }
+    else if (events < m_events.size())
+    {
+        m_events[header & m_mask].count = static_cast<std::uint32_t>( // NOLINT(*-array-index)
+            std::min<std::uint64_t>(events, std::numeric_limits<std::uint32_t>::max()));
+    }
+    else
+    {
+        // The header was overwritten; put it in place of the oldest event that is still there,
+        // which is the slot the next event would take.
+        const auto following = std::min<std::uint64_t>(m_events.size() - 1,
+                                                       std::numeric_limits<std::uint32_t>::max());
+        m_events[m_head & m_mask] = {.kind = EventKind::Batch, // NOLINT(*-array-index)
+                                     .truncated = true,
+                                     .count = static_cast<std::uint32_t>(following),
+                                     .id = 0,
+                                     .other = 0,
+                                     .location = {}};
+    }
+}
+
+std::uint64_t EventRing::published() const noexcept
+{
+    return m_head;
+}
+
+std::size_t EventRing::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+std::size_t EventRing::memoryBytes() const noexcept
+{
+    return (m_events.capacity() * sizeof(SimulatorEvent)) +
+           (m_cursors.capacity() * sizeof(std::uint64_t));
+}
+
+EventBatch::EventBatch(EventRing &ring) noexcept : m_ring{ring}
+{
+    if (m_ring.active())
+    {
+        m_header = m_ring.beginBatch();
+    }
+}
+
+EventBatch::~EventBatch()
+{
+    if (m_header)
+    {
+        m_ring.endBatch(*m_header);
+    }
+}
+
+} // namespace Simulator
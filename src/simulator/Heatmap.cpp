@@ -0,0 +1,265 @@
+#include "marvin/simulator/Heatmap.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+void Heatmap::start(GridSize size, Width width)
+{
+    stop();
+    m_tiles.assign(tilesAlong(size.width) * tilesAlong(size.height), no_tile);
+    m_tiles_per_row = tilesAlong(size.width);
+    m_size = size;
+    m_width = width;
+    m_active = true;
+}
+
+void Heatmap::stop() noexcept
+{
+    *this = Heatmap{};
+}
+
+void Heatmap::reset() noexcept
+{
+    std::ranges::fill(m_tiles, no_tile);
+    m_narrow.clear();
+    m_wide.clear();
+    m_tiles_in_use = 0;
+}
+
+void Heatmap::resize(GridSize size)
+{
+    if (!m_active || (size.width == m_size.width && size.height == m_size.height))
+    {
+        return;
+    }
+    Heatmap resized;
+    resized.start(size, m_width);
+    for (std::size_t tile = 0; tile < m_tiles.size(); ++tile)
+    {
+        if (m_tiles[tile] == no_tile)
+        {
+            continue;
+        }
+        const auto tile_x = tile % m_tiles_per_row;
+        const auto tile_y = tile / m_tiles_per_row;
+        const auto left = static_cast<RobotFactory::Coordinate>(tile_x) * tile_side;
+        const auto bottom = static_cast<RobotFactory::Coordinate>(tile_y) * tile_side;
+        if (left >= size.width || bottom >= size.height)
+        {
+            continue;
+        }
+        const auto target = (tile_y * resized.m_tiles_per_row) + tile_x;
+        const auto slot = resized.allocateTile();
+        resized.m_tiles[target] = slot;
+        for (std::size_t cell = 0; cell < tile_cells; ++cell)
+        {
+            const auto x = left + (static_cast<RobotFactory::Coordinate>(cell) % tile_side);
+            const auto y = bottom + (static_cast<RobotFactory::Coordinate>(cell) / tile_side);
+            if (x >= size.width || y >= size.height)
+            {
+                continue;
+            }
+            for (const auto channel : {std::size_t{0}, tile_cells})
+            {
+                const auto from = ((m_tiles[tile] - 1) * tile_counters) + channel + cell;
+                const auto to = ((slot - 1) * tile_counters) + channel + cell;
+                if (m_width == Width::Bits16)
+                {
+                    resized.m_narrow[to] = m_narrow[from];
+                }
+                else
+                {
+                    resized.m_wide[to] = m_wide[from];
+                }
+            }
+        }
+    }
+    *this = std::move(resized);
+}
+
+Heatmap::Counts Heatmap::at(RobotFactory::RobotLocation location) const noexcept
+{
+    if (!m_active || location.x < 0 || location.y < 0 || location.x >= m_size.width ||
+        location.y >= m_size.height)
+    {
+        return {};
+    }
+    const auto x = static_cast<std::size_t>(location.x);
+    const auto y = static_cast<std::size_t>(location.y);
+    constexpr auto side = static_cast<std::size_t>(tile_side);
+    const auto tile = m_tiles[(y / side * m_tiles_per_row) + (x / side)];
+    if (tile == no_tile)
+    {
+        return {};
+    }
+    const auto cell = ((y % side) * side) + (x % side);
+    return {.visits = counter(tile, cell), .blocked = counter(tile, tile_cells + cell)};
+}
+
+std::optional<Heatmap::Hotspot> Heatmap::hottest(Channel channel) const noexcept
+{
+    const auto offset = channel == Channel::Visits ? 0 : tile_cells;
+    std::optional<Hotspot> hottest;
+    for (std::size_t tile = 0; tile < m_tiles.size(); ++tile)
+    {
+        if (m_tiles[tile] == no_tile)
+        {
+            continue;
+        }
+        for (std::size_t cell = 0; cell < tile_cells; ++cell)
+        {
+            const auto count = counter(m_tiles[tile], offset + cell);
+            const Hotspot candidate{
+                .x = (static_cast<RobotFactory::Coordinate>(tile % m_tiles_per_row) * tile_side) +
+                     (static_cast<RobotFactory::Coordinate>(cell) % tile_side),
+                .y = (static_cast<RobotFactory::Coordinate>(tile / m_tiles_per_row) * tile_side) +
+                     (static_cast<RobotFactory::Coordinate>(cell) / tile_side),
+                .count = count};
+            if (count != 0 &&
+                (!hottest || count > hottest->count ||
+                 (count == hottest->count &&
+                  std::pair{candidate.y, candidate.x} < std::pair{hottest->y, hottest->x})))
+            {
+                hottest = candidate;
+            }
+        }
+    }
+    return hottest;
+}
+
+GridSize Heatmap::size() const noexcept
+{
+    return m_size;
+}
+
+Heatmap::Width Heatmap::width() const noexcept
+{
+    return m_width;
+}
+
+std::size_t Heatmap::tileCount() const noexcept
+{
+    return m_tiles.size();
+}
+
+std::size_t Heatmap::tilesInUse() const noexcept
+{
+    return m_tiles_in_use;
+}
+
+std::size_t Heatmap::memoryBytes() const noexcept
+{
+    return (m_tiles.capacity() * sizeof(std::uint32_t)) +
+           (m_narrow.capacity() * sizeof(std::uint16_t)) +
+           (m_wide.capacity() * sizeof(std::uint32_t));
+}
+
+std::size_t Heatmap::memoryBytesAfterResize(GridSize size) const noexcept
+{
+    const auto counter_bytes = m_width == Width::Bits16 ? sizeof(std::uint16_t)
+                                                        : sizeof(std::uint32_t);
+    return memoryBytesFor(size) + (m_tiles_in_use * tile_counters * counter_bytes);
+}
+
+std::size_t Heatmap::memoryBytesFor(GridSize size) noexcept
+{
+    return tilesAlong(size.width) * tilesAlong(size.height) * sizeof(std::uint32_t);
+}
+
+void Heatmap::writeCsv(std::ostream &output) const
+{
+    output << "x,y,visits,blocked\n";
+    constexpr auto side = static_cast<std::size_t>(tile_side);
+    const auto width = static_cast<std::size_t>(m_size.width);
+    const auto height = static_cast<std::size_t>(m_size.height);
+    for (std::size_t y = 0; m_active && y < height; ++y)
+    {
+        const auto *row = &m_tiles[y / side * m_tiles_per_row];
+        for (std::size_t tile_x = 0; tile_x < m_tiles_per_row; ++tile_x)
+        {
+            const auto tile = row[tile_x]; // NOLINT(*-pointer-arithmetic)
+            if (tile == no_tile)
+            {
+                continue;
+            }
+            for (std::size_t x = tile_x * side; x < std::min(width, (tile_x + 1) * side); ++x)
+            {
+                const auto cell = ((y % side) * side) + (x % side);
+                const auto visits = counter(tile, cell);
+                const auto blocked = counter(tile, tile_cells + cell);
+                if (visits != 0 || blocked != 0)
+                {
+                    output << x << ',' << y << ',' << visits << ',' << blocked << '\n';
+                }
+            }
+        }
+    }
+}
+
+void Heatmap::writePgm(std::ostream &output, Channel channel) const
+{
+    output << "P5\n" << m_size.width << ' ' << m_size.height << "\n255\n";
+    const auto peak = hottest(channel).value_or(Hotspot{}).count;
+    const auto offset = channel == Channel::Visits ? 0 : tile_cells;
+    constexpr auto side = static_cast<std::size_t>(tile_side);
+    const auto width = static_cast<std::size_t>(m_size.width);
+    std::string pixels(width, '\0');
+    for (auto y = static_cast<std::size_t>(m_size.height); y-- > 0;)
+    {
+        std::ranges::fill(pixels, '\0');
+        const auto *row = &m_tiles[y / side * m_tiles_per_row];
+        for (std::size_t tile_x = 0; peak != 0 && tile_x < m_tiles_per_row; ++tile_x)
+        {
+            const auto tile = row[tile_x]; // NOLINT(*-pointer-arithmetic)
+            if (tile == no_tile)
+            {
+                continue;
+            }
+            for (std::size_t x = tile_x * side; x < std::min(width, (tile_x + 1) * side); ++x)
+            {
+                const auto count = counter(tile, offset + ((y % side) * side) + (x % side));
+                pixels[x] = static_cast<char>(std::uint64_t{count} * 255U / peak);
+            }
+        }
+        output.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+    }
+}
+
+std::uint32_t Heatmap::allocateTile()
+{
+    if (m_width == Width::Bits16)
+    {
+        m_narrow.resize(m_narrow.size() + tile_counters);
+    }
+    else
+    {
+        m_wide.resize(m_wide.size() + tile_counters);
+    }
+    return ++m_tiles_in_use;
+}
+
+std::uint32_t Heatmap::counter(std::size_t tile, std::size_t cell) const noexcept
+{
+    const auto index = ((tile - 1) * tile_counters) + cell;
+    return m_width == Width::Bits16 ? m_narrow[index] : m_wide[index];
+}
+
+std::size_t Heatmap::tilesAlong(RobotFactory::Coordinate cells) noexcept
+{
+    return static_cast<std::size_t>((std::max<RobotFactory::Coordinate>(cells, 0) + tile_side - 1) /
+                                    tile_side);
+}
+
+} // namespace Simulator
@@ -16,7 +16,22 @@ void Menu::showUsage(std::ostream &output)
               "  LEFT|RIGHT [ALL|name|@id]\n"
               "  REMOVE [ALL|name|@id]\n"
               "  REPORT\n"
+              "  MOVE|ROTATE|REMOVE|REPORT ... WHERE [DIRECTION=d[|d]] [X=a..b] [Y=a..b]\n"
+              "                                      [ID=a..b] [NAME=prefix*]\n"
+              "  SCAN [ALL|name|@id]\n"
+              "  (a name may be a pattern: * matches any run of characters, ? any one)\n"
+              "  GROUP [CREATE <group>|DELETE <group>|ADD <group> <name|@id>...]\n"
+              "  (a group's name targets its members wherever a robot name is accepted)\n"
               "  RESIZE <width> <height>\n"
+              "  LOADMAP <file>\n"
+              "  POPULATE <count> <RANDOM|LATTICE|CLUSTERED> [seed]\n"
+              "  BEGIN | COMMIT | ABORT\n"
+              "  HASH [TRAIL [every|OFF]]\n"
+              "  MEMORY [LIMIT <bytes[K|M|G]>|OFF]\n"
+              "  HEATMAP [ON [16|32]|OFF|RESET|CSV <file>|PGM <file> [VISITS|BLOCKED]]\n"
+              "  RECORD [<file> [chunk-records]|STOP]\n"
+              "  STATS [RESET|JSON]\n"
+              "  TRACE <file> [sample-every] | TRACE STOP\n"
               "  MENU\n"
               "  QUIT\n\n> ";
 }
@@ -0,0 +1,514 @@
+#include "marvin/simulator/PageAllocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdlib>
+#include <sched.h>
+#include <sys/mman.h>
+#define MARVIN_HAS_MMAP 1
+#endif
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::size_t huge_page_bytes{std::size_t{2} << 20U};
+constexpr std::size_t small_page_bytes{4096};
+
+class Settings
+{
+  public:
+    explicit Settings(PageOptions options)
+        : m_huge_pages{options.huge_pages}, m_first_touch_threads{options.first_touch_threads}
+    {
+    }
+
+    void store(PageOptions options) noexcept
+    {
+        m_huge_pages.store(options.huge_pages, std::memory_order_relaxed);
+        m_first_touch_threads.store(options.first_touch_threads, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] PageOptions load() const noexcept
+    {
+        return {.huge_pages = m_huge_pages.load(std::memory_order_relaxed),
+                .first_touch_threads = m_first_touch_threads.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    std::atomic<HugePages> m_huge_pages;
+    std::atomic<unsigned> m_first_touch_threads;
+};
+
+#ifdef MARVIN_HAS_MMAP
+// Read once, when the settings are first used.
+[[nodiscard]] std::string_view environment(const char *name)
+{
+    const char *value = std::getenv(name); // NOLINT(concurrency-mt-unsafe)
+    return value == nullptr ? std::string_view{} : std::string_view{value};
+}
+#endif
+
+[[nodiscard]] PageOptions environmentOptions()
+{
+    PageOptions options;
+#ifdef MARVIN_HAS_MMAP
+    if (const auto mode = environment("MARVIN_HUGE_PAGES"); !mode.empty())
+    {
+        if (mode == "off")
+        {
+            options.huge_pages = HugePages::Off;
+        }
+        else if (mode == "explicit")
+        {
+            options.huge_pages = HugePages::Explicit;
+        }
+    }
+    if (const auto count = environment("MARVIN_FIRST_TOUCH_THREADS"); !count.empty())
+    {
+        const auto *last = count.data() + count.size(); // NOLINT(*-pointer-arithmetic)
+        unsigned threads{0};
+        const auto [end, error] = std::from_chars(count.data(), last, threads);
+        if (error == std::errc{} && end == last && threads > 0)
+        {
+            options.first_touch_threads = threads;
+        }
+    }
+#endif
+    return options;
+}
+
+[[nodiscard]] Settings &settings()
+{
+    static Settings instance{environmentOptions()};
+    return instance;
+}
+
+thread_local std::pmr::memory_resource *current_arena{nullptr};
+
+[[nodiscard]] std::size_t roundUp(std::size_t bytes, std::size_t multiple) noexcept
+{
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+[[nodiscard]] PageBlock allocateHeap(std::size_t bytes)
+{
+    auto *data = ::operator new(bytes);
+    std::memset(data, 0, bytes);
+    return {.data = data, .bytes = bytes, .mapped = false, .huge_pages = false};
+}
+
+#ifdef MARVIN_HAS_MMAP
+
+constexpr int protection{PROT_READ | PROT_WRITE};
+constexpr int anonymous{MAP_PRIVATE | MAP_ANONYMOUS};
+
+// Maps `length` bytes starting on a huge-page boundary, which transparent huge pages require.
+[[nodiscard]] void *mapAligned(std::size_t length) noexcept
+{
+    auto *raw = ::mmap(nullptr, length + huge_page_bytes, protection, anonymous, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(raw); // NOLINT(*-reinterpret-cast)
+    const auto aligned = roundUp(address, huge_page_bytes);
+    const auto head = aligned - address;
+    if (head > 0)
+    {
+        ::munmap(raw, head);
+    }
+    ::munmap(reinterpret_cast<void *>(aligned + length), // NOLINT(*-reinterpret-cast,*-int-to-ptr)
+             huge_page_bytes - head);
+    return reinterpret_cast<void *>(aligned); // NOLINT(*-reinterpret-cast,*-int-to-ptr)
+}
+
+[[nodiscard]] PageBlock mapPages(std::size_t bytes, HugePages huge_pages) noexcept
+{
+    const auto length = roundUp(bytes, huge_page_bytes);
+    if (huge_pages == HugePages::Explicit)
+    {
+        auto *data = ::mmap(nullptr, length, protection, anonymous | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED)
+        {
+            return {.data = data, .bytes = length, .mapped = true, .huge_pages = true};
+        }
+    }
+    auto *data = mapAligned(length);
+    if (data == nullptr)
+    {
+        return {};
+    }
+    const bool transparent = huge_pages != HugePages::Off;
+    static_cast<void>(::madvise(data, length, transparent ? MADV_HUGEPAGE : MADV_NOHUGEPAGE));
+    return {.data = data, .bytes = length, .mapped = true, .huge_pages = transparent};
+}
+
+// The CPUs this process may run on, in ascending order.
+[[nodiscard]] std::vector<int> allowedCpus()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> cpus;
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+// Pins the calling thread to one CPU; a CPU that cannot be used leaves it unpinned.
+void pinTo(int cpu) noexcept
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    static_cast<void>(::sched_setaffinity(0, sizeof(set), &set));
+}
+
+// Faults in [begin, end) of a fresh mapping from `threads` threads, one contiguous share each.
+// Share k is touched from a thread pinned to the k-th of `threads` CPUs spread evenly over the
+// allowed ones, so the kernel's first-touch policy places it on that CPU's NUMA node.
+void firstTouch(std::byte *begin, std::byte *end, unsigned threads)
+{
+    const auto bytes = static_cast<std::size_t>(end - begin);
+    if (threads <= 1 || bytes == 0)
+    {
+        return;
+    }
+    const auto cpus = allowedCpus();
+    const auto share = roundUp((bytes + threads - 1) / threads, small_page_bytes);
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (std::size_t offset = 0, index = 0; offset < bytes; offset += share, ++index)
+    {
+        auto *first = begin + offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto *last = begin + std::min(bytes, offset + share); // NOLINT(*-pointer-arithmetic)
+        const int cpu = cpus.empty() ? -1 : cpus[index * cpus.size() / threads];
+        workers.emplace_back(
+            [first, last, cpu]
+            {
+                if (cpu >= 0)
+                {
+                    pinTo(cpu);
+                }
+                for (auto *page = first; page < last;
+                     page += small_page_bytes) // NOLINT(*-pointer-arithmetic)
+                {
+                    *static_cast<volatile std::byte *>(page) = std::byte{0};
+                }
+            });
+    }
+}
+
+// Grows a mapping with mremap(), keeping a huge-page boundary at its start: a mapping that
+// cannot grow in place is moved onto a fresh aligned reservation rather than wherever the kernel
+// finds room. Returns nullptr, leaving `block` intact, when neither works.
+[[nodiscard]] void *remapAligned(const PageBlock &block, std::size_t length) noexcept
+{
+    auto *data = ::mremap(block.data, block.bytes, length, 0);
+    if (data != MAP_FAILED)
+    {
+        return data;
+    }
+    auto *target = mapAligned(length);
+    if (target == nullptr)
+    {
+        return nullptr;
+    }
+    data = ::mremap(block.data, block.bytes, length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (data == MAP_FAILED)
+    {
+        ::munmap(target, length);
+        return nullptr;
+    }
+    return data;
+}
+
+#endif
+
+[[nodiscard]] PageBlock allocateSystem(std::size_t bytes)
+{
+#ifdef MARVIN_HAS_MMAP
+    if (bytes >= PageBlock::large_block_bytes)
+    {
+        const auto options = pageOptions();
+        const auto block = mapPages(bytes, options.huge_pages);
+        if (block.data == nullptr)
+        {
+            throw std::bad_alloc{};
+        }
+        auto *begin = static_cast<std::byte *>(block.data);
+        firstTouch(begin, begin + block.bytes, // NOLINT(*-pointer-arithmetic)
+                   options.first_touch_threads);
+        return block;
+    }
+#endif
+    return allocateHeap(bytes);
+}
+
+// Upstream for arenas: sizes that would be mapped are, and the rest come from the heap. Nothing
+// is zero-filled here, since arenas reuse memory and zero what they hand out themselves.
+class SystemPages final : public std::pmr::memory_resource
+{
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (pageBlock(nullptr, bytes).mapped)
+        {
+            return allocateSystem(bytes).data;
+        }
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    void do_deallocate(void *data, std::size_t bytes, std::size_t alignment) noexcept override
+    {
+        if (pageBlock(nullptr, bytes).mapped)
+        {
+            releasePages(pageBlock(data, bytes));
+            return;
+        }
+        ::operator delete(data, bytes, std::align_val_t{alignment});
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+void setPageOptions(PageOptions options) noexcept
+{
+    settings().store(options);
+}
+
+PageOptions pageOptions() noexcept
+{
+    return settings().load();
+}
+
+PageArenaScope::PageArenaScope(std::pmr::memory_resource *arena) noexcept
+    : m_previous{std::exchange(current_arena, arena)}
+{
+}
+
+PageArenaScope::~PageArenaScope()
+{
+    current_arena = m_previous;
+}
+
+std::pmr::memory_resource *pageArena() noexcept
+{
+    return current_arena;
+}
+
+std::pmr::memory_resource *systemPages() noexcept
+{
+    static SystemPages instance;
+    return &instance;
+}
+
+PageBlock allocatePages(std::size_t bytes)
+{
+    return allocatePages(bytes, current_arena);
+}
+
+PageBlock allocatePages(std::size_t bytes, std::pmr::memory_resource *arena)
+{
+    if (bytes == 0)
+    {
+        return {};
+    }
+    if (arena == nullptr)
+    {
+        return allocateSystem(bytes);
+    }
+    auto block = pageBlock(nullptr, bytes, arena);
+    block.data = arena->allocate(block.bytes, alignof(std::max_align_t));
+    std::memset(block.data, 0, block.bytes);
+    return block;
+}
+
+PageBlock growPages(PageBlock block, std::size_t bytes)
+{
+    if (bytes <= block.bytes)
+    {
+        return block;
+    }
+#ifdef MARVIN_HAS_MMAP
+    if (block.mapped)
+    {
+        // Moving the page tables keeps the contents without copying them.
+        const auto length = roundUp(bytes, huge_page_bytes);
+        if (auto *data = remapAligned(block, length); data != nullptr)
+        {
+            // Fails harmlessly on hugetlbfs mappings, which need no advice.
+            static_cast<void>(
+                ::madvise(data, length, block.huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE));
+            auto *begin = static_cast<std::byte *>(data);
+            firstTouch(begin + block.bytes, begin + length, // NOLINT(*-pointer-arithmetic)
+                       pageOptions().first_touch_threads);
+            return {.data = data, .bytes = length, .mapped = true, .huge_pages = block.huge_pages};
+        }
+    }
+#endif
+    auto grown = allocatePages(bytes, block.data == nullptr ? current_arena : block.arena);
+    if (block.data != nullptr)
+    {
+        std::memcpy(grown.data, block.data, block.bytes);
+    }
+    releasePages(block);
+    return grown;
+}
+
+PageBlock pageBlock(void *data, std::size_t bytes, std::pmr::memory_resource *arena) noexcept
+{
+#ifdef MARVIN_HAS_MMAP
+    if (bytes >= PageBlock::large_block_bytes)
+    {
+        bytes = roundUp(bytes, huge_page_bytes);
+        if (arena == nullptr)
+        {
+            return {.data = data, .bytes = bytes, .mapped = true, .huge_pages = false};
+        }
+    }
+#endif
+    return {.data = data, .bytes = bytes, .mapped = false, .huge_pages = false, .arena = arena};
+}
+
+void releasePages(PageBlock block) noexcept
+{
+    if (block.data == nullptr)
+    {
+        return;
+    }
+    if (block.arena != nullptr)
+    {
+        block.arena->deallocate(block.data, block.bytes, alignof(std::max_align_t));
+        return;
+    }
+#ifdef MARVIN_HAS_MMAP
+    if (block.mapped)
+    {
+        ::munmap(block.data, block.bytes);
+        return;
+    }
+#endif
+    ::operator delete(block.data);
+}
+
+CellPool::CellPool(std::size_t cell_bytes, std::size_t alignment)
+    : m_cell_bytes{roundUp(std::max(cell_bytes, sizeof(void *)), alignment)}
+{
+    if (alignment == 0 || alignment > alignof(std::max_align_t) ||
+        (alignment & (alignment - 1)) != 0)
+    {
+        throw std::invalid_argument{"Cell alignment is not supported."};
+    }
+}
+
+CellPool::~CellPool()
+{
+    for (const auto &block : m_blocks)
+    {
+        releasePages(block);
+    }
+}
+
+void *CellPool::allocate()
+{
+    if (m_free != nullptr)
+    {
+        auto *cell = m_free;
+        std::memcpy(&m_free, cell, sizeof(m_free));
+        --m_free_cells;
+        ++m_in_use;
+        return cell;
+    }
+    if (m_next == m_end)
+    {
+        reserve(1);
+    }
+    auto *cell = m_next;
+    m_next += m_cell_bytes; // NOLINT(*-pointer-arithmetic)
+    ++m_in_use;
+    return cell;
+}
+
+void CellPool::deallocate(void *cell) noexcept
+{
+    std::memcpy(cell, &m_free, sizeof(m_free));
+    m_free = cell;
+    ++m_free_cells;
+    --m_in_use;
+}
+
+void CellPool::reserve(std::size_t count)
+{
+    if (count <= available())
+    {
+        return;
+    }
+    // What is left of the current block is given up; the new block is larger.
+    const auto block = allocatePages(blockBytesFor(count));
+    m_blocks.push_back(block);
+    m_bytes += block.bytes;
+    m_next = static_cast<std::byte *>(block.data);
+    m_end = m_next + ((block.bytes / m_cell_bytes) * m_cell_bytes); // NOLINT(*-pointer-arithmetic)
+}
+
+std::size_t CellPool::cellBytes() const noexcept
+{
+    return m_cell_bytes;
+}
+
+std::size_t CellPool::cellsInUse() const noexcept
+{
+    return m_in_use;
+}
+
+std::size_t CellPool::memoryBytes() const noexcept
+{
+    return m_bytes;
+}
+
+std::size_t CellPool::memoryBytesFor(std::size_t count) const noexcept
+{
+    const auto more = count - std::min(count, m_in_use);
+    return more <= available() ? m_bytes : m_bytes + pageBlock(nullptr, blockBytesFor(more)).bytes;
+}
+
+std::size_t CellPool::available() const noexcept
+{
+    return m_free_cells + static_cast<std::size_t>(m_end - m_next) / m_cell_bytes;
+}
+
+std::size_t CellPool::blockBytesFor(std::size_t count) const noexcept
+{
+    // At least double the pool so growth stays amortised, and large enough to hold the whole
+    // request in one block.
+    return std::max({count, m_bytes / m_cell_bytes, std::size_t{1}}) * m_cell_bytes;
+}
+
+} // namespace Simulator
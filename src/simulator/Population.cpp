@@ -0,0 +1,94 @@
+#include "marvin/simulator/Population.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::size_t robots_per_cluster{1000};
+
+} // namespace
+
+PopulationGenerator::PopulationGenerator(PopulationPattern pattern, std::size_t count,
+                                         GridSize size, std::uint64_t seed)
+    : m_pattern{pattern}, m_size{size}, m_random{seed}
+{
+    const auto cells = static_cast<double>(size.width) * static_cast<double>(size.height);
+    const auto robots = static_cast<double>(std::max<std::size_t>(count, 1));
+    if (pattern == PopulationPattern::Lattice)
+    {
+        // The largest square spacing that still leaves room for every robot.
+        m_spacing = std::max<RobotFactory::Coordinate>(
+            1, static_cast<RobotFactory::Coordinate>(std::floor(std::sqrt(cells / robots))));
+        while (m_spacing > 1 && ((size.width + m_spacing - 1) / m_spacing) *
+                                        ((size.height + m_spacing - 1) / m_spacing) <
+                                    static_cast<RobotFactory::Coordinate>(robots))
+        {
+            --m_spacing;
+        }
+    }
+    else if (pattern == PopulationPattern::Clustered)
+    {
+        const auto clusters = std::max<std::size_t>(1, count / robots_per_cluster);
+        std::uniform_int_distribution<RobotFactory::Coordinate> x{0, size.width - 1};
+        std::uniform_int_distribution<RobotFactory::Coordinate> y{0, size.height - 1};
+        m_centres.reserve(clusters);
+        for (std::size_t cluster = 0; cluster < clusters; ++cluster)
+        {
+            m_centres.push_back({.x = x(m_random), .y = y(m_random)});
+        }
+        // Spread each cluster over roughly four times as many cells as it has robots.
+        m_spread = std::sqrt(4.0 * robots / static_cast<double>(clusters)) / 2.0;
+    }
+}
+
+RobotFactory::RobotLocation PopulationGenerator::next()
+{
+    switch (m_pattern)
+    {
+    case PopulationPattern::Random:
+    {
+        std::uniform_int_distribution<RobotFactory::Coordinate> x{0, m_size.width - 1};
+        std::uniform_int_distribution<RobotFactory::Coordinate> y{0, m_size.height - 1};
+        return {.x = x(m_random), .y = y(m_random), .direction = direction()};
+    }
+    case PopulationPattern::Lattice:
+    {
+        const RobotFactory::RobotLocation location{.x = m_x, .y = m_y, .direction = direction()};
+        m_x += m_spacing;
+        if (m_x >= m_size.width)
+        {
+            m_x = 0;
+            m_y = m_y + m_spacing >= m_size.height ? 0 : m_y + m_spacing;
+        }
+        return location;
+    }
+    case PopulationPattern::Clustered:
+    {
+        std::uniform_int_distribution<std::size_t> pick{0, m_centres.size() - 1};
+        std::normal_distribution<double> offset{0.0, m_spread};
+        const auto centre = m_centres.at(pick(m_random));
+        const auto dx = static_cast<RobotFactory::Coordinate>(std::lround(offset(m_random)));
+        const auto dy = static_cast<RobotFactory::Coordinate>(std::lround(offset(m_random)));
+        return {.x = centre.x + dx, .y = centre.y + dy, .direction = direction()};
+    }
+    }
+    return {};
+}
+
+RobotFactory::Direction PopulationGenerator::direction()
+{
+    std::uniform_int_distribution<int> direction{0, 3};
+    return static_cast<RobotFactory::Direction>(direction(m_random));
+}
+
+} // namespace Simulator
@@ -0,0 +1,480 @@
+#include "marvin/simulator/ReferenceSimulator.h"
+
+#include "marvin/command/Command.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotHandleTable.h"
+#include "marvin/simulator/WorldHash.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr unsigned generation_shift{32};
+
+[[nodiscard]] RobotFactory::RobotLocation ahead(RobotFactory::RobotLocation location,
+                                                RobotFactory::Coordinate blocks) noexcept
+{
+    switch (location.direction)
+    {
+    case RobotFactory::Direction::North:
+        location.y += blocks;
+        break;
+    case RobotFactory::Direction::East:
+        location.x += blocks;
+        break;
+    case RobotFactory::Direction::South:
+        location.y -= blocks;
+        break;
+    case RobotFactory::Direction::West:
+        location.x -= blocks;
+        break;
+    }
+    return location;
+}
+
+[[nodiscard]] RobotFactory::Direction turned(RobotFactory::Direction direction,
+                                             RobotFactory::Rotation rotation) noexcept
+{
+    constexpr int directions{4};
+    const auto step = rotation == RobotFactory::Rotation::Left ? directions - 1 : 1;
+    return static_cast<RobotFactory::Direction>((static_cast<int>(direction) + step) % directions);
+}
+
+} // namespace
+
+ReferenceSimulator::ReferenceSimulator(GridSize size)
+{
+    m_world.size = size;
+}
+
+bool ReferenceSimulator::executeLine(std::string_view line, std::ostream &output,
+                                     std::ostream &errors)
+{
+    const auto parsed = CommandParser::parse(line);
+    if ((!parsed || !deferrable(*parsed.command)) && !m_failed && !settle())
+    {
+        errors << "No robot could be moved.\n";
+        m_failed = true;
+    }
+    if (!parsed)
+    {
+        errors << "Error: " << parsed.error << '\n';
+        m_failed = m_saved.has_value();
+        return true;
+    }
+    const auto &command = *parsed.command;
+    if (std::holds_alternative<QuitCommand>(command))
+    {
+        return false;
+    }
+    // A failed transaction ignores everything up to its COMMIT or ABORT.
+    if (m_failed && !std::holds_alternative<CommitCommand>(command) &&
+        !std::holds_alternative<AbortCommand>(command))
+    {
+        return true;
+    }
+    const auto error = std::visit(
+        [this, &output](const auto &command) -> std::string
+        {
+            using Type = std::decay_t<decltype(command)>;
+            if constexpr (std::is_same_v<Type, ReportCommand> ||
+                          std::is_same_v<Type, ScanCommand> || std::is_same_v<Type, HashCommand>)
+            {
+                return apply(command, output);
+            }
+            else if constexpr (requires { apply(command); })
+            {
+                return apply(command);
+            }
+            else
+            {
+                return "The reference simulator does not support " + std::string{Type::verb} +
+                       ".\n";
+            }
+        },
+        command);
+    if (!error.empty())
+    {
+        errors << error;
+        m_failed = m_saved.has_value();
+    }
+    return true;
+}
+
+void ReferenceSimulator::report(std::ostream &output) const
+{
+    output << "Grid: " << m_world.size.width << 'x' << m_world.size.height
+           << "\nRobots: " << size() << '\n';
+    for (std::size_t slot = 0; slot < m_world.slots.size(); ++slot)
+    {
+        const auto &entry = m_world.slots[slot];
+        if (entry.robot)
+        {
+            const auto location = entry.robot->location;
+            output << "\nName: " << entry.robot->name << "\nID: " << id(slot, entry.generation)
+                   << "\nLocation: (" << location.x << ',' << location.y << "), facing "
+                   << location.direction << '\n';
+        }
+    }
+}
+
+WorldHash ReferenceSimulator::worldHash() const
+{
+    auto hash = gridHash(m_world.size);
+    for (std::size_t slot = 0; slot < m_world.slots.size(); ++slot)
+    {
+        const auto &entry = m_world.slots[slot];
+        if (entry.robot)
+        {
+            hash ^= robotHash(id(slot, entry.generation), entry.robot->location);
+        }
+    }
+    return hash;
+}
+
+std::size_t ReferenceSimulator::size() const noexcept
+{
+    return static_cast<std::size_t>(std::count_if(m_world.slots.begin(), m_world.slots.end(),
+                                                  [](const Slot &slot) { return slot.robot; }));
+}
+
+bool ReferenceSimulator::inTransaction() const noexcept
+{
+    return m_saved.has_value();
+}
+
+RobotFactory::RobotId ReferenceSimulator::id(std::size_t slot, std::uint32_t generation)
+{
+    return (RobotFactory::RobotId{generation} << generation_shift) |
+           (RobotHandleTable::first_id + slot);
+}
+
+bool ReferenceSimulator::isFree(RobotFactory::RobotLocation location) const
+{
+    if (location.x < 0 || location.y < 0 || location.x >= m_world.size.width ||
+        location.y >= m_world.size.height)
+    {
+        return false;
+    }
+    return std::none_of(m_world.slots.begin(), m_world.slots.end(),
+                        [location](const Slot &slot)
+                        {
+                            return slot.robot && slot.robot->location.x == location.x &&
+                                   slot.robot->location.y == location.y;
+                        });
+}
+
+RobotFactory::Coordinate ReferenceSimulator::clearance(RobotFactory::RobotLocation location) const
+{
+    RobotFactory::Coordinate distance{0};
+    while (isFree(ahead(location, distance + 1)))
+    {
+        ++distance;
+    }
+    return distance;
+}
+
+std::vector<std::size_t> ReferenceSimulator::select(const std::optional<RobotTarget> &target) const
+{
+    std::vector<std::size_t> selected;
+    for (std::size_t slot = 0; slot < m_world.slots.size(); ++slot)
+    {
+        const auto &entry = m_world.slots[slot];
+        if (!entry.robot)
+        {
+            continue;
+        }
+        if (!target || selects(*target, slot))
+        {
+            selected.push_back(slot);
+        }
+    }
+    // Patterns visit their robots in name order.
+    if (target && std::holds_alternative<NamePattern>(target->value))
+    {
+        std::sort(selected.begin(), selected.end(),
+                  [this](std::size_t first, std::size_t second)
+                  { return m_world.slots[first].robot->name < m_world.slots[second].robot->name; });
+    }
+    return selected;
+}
+
+bool ReferenceSimulator::selects(const RobotTarget &target, std::size_t slot) const
+{
+    const auto &entry = m_world.slots[slot];
+    if (const auto *name = std::get_if<std::string>(&target.value))
+    {
+        return entry.robot->name == *name;
+    }
+    if (const auto *robot_id = std::get_if<RobotFactory::RobotId>(&target.value))
+    {
+        return id(slot, entry.generation) == *robot_id;
+    }
+    if (const auto *pattern = std::get_if<NamePattern>(&target.value))
+    {
+        return pattern->matches(entry.robot->name);
+    }
+    return false; // No groups here.
+}
+
+bool ReferenceSimulator::deferrable(const Command &command)
+{
+    if (std::holds_alternative<RotateCommand>(command))
+    {
+        return true;
+    }
+    const auto *move = std::get_if<MoveCommand>(&command);
+    return move != nullptr && !move->where && move->target &&
+           !std::holds_alternative<NamePattern>(move->target->value);
+}
+
+bool ReferenceSimulator::settle()
+{
+    if (!m_unsettled)
+    {
+        return true;
+    }
+    m_world = std::move(*m_unsettled);
+    m_unsettled.reset();
+    const auto steps = std::exchange(m_steps, {});
+    for (const auto &step : steps)
+    {
+        auto &location = m_world.slots[step.slot].robot->location;
+        const bool moved = location.x != step.location.x || location.y != step.location.y;
+        if (moved && !isFree(step.location))
+        {
+            return false;
+        }
+        location = step.location;
+    }
+    return true;
+}
+
+void ReferenceSimulator::release(std::size_t slot)
+{
+    auto &entry = m_world.slots[slot];
+    entry.robot.reset();
+    ++entry.generation;
+    m_world.free.push_back(slot);
+}
+
+std::string ReferenceSimulator::apply(const PlaceCommand &command)
+{
+    const auto taken = std::any_of(m_world.slots.begin(), m_world.slots.end(),
+                                   [&command](const Slot &slot)
+                                   { return slot.robot && slot.robot->name == command.name; });
+    if (taken || !isFree(command.location))
+    {
+        return "Unable to place robot; name or location is already in use.\n";
+    }
+    std::size_t slot{m_world.slots.size()};
+    if (m_world.free.empty())
+    {
+        m_world.slots.emplace_back();
+    }
+    else
+    {
+        slot = m_world.free.back();
+        m_world.free.pop_back();
+    }
+    m_world.slots[slot].robot = Robot{.name = command.name, .location = command.location};
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const MoveCommand &command)
+{
+    if (command.where)
+    {
+        return "The reference simulator does not support MOVE WHERE.\n";
+    }
+    if (m_saved && command.target && !std::holds_alternative<NamePattern>(command.target->value))
+    {
+        const auto selected = select(command.target);
+        if (selected.empty())
+        {
+            return "No robot could be moved.\n";
+        }
+        auto &robot = *m_world.slots[selected.front()].robot;
+        const auto destination = ahead(robot.location, command.blocks);
+        if (destination.x < 0 || destination.y < 0 || destination.x >= m_world.size.width ||
+            destination.y >= m_world.size.height)
+        {
+            return "No robot could be moved.\n";
+        }
+        if (!m_unsettled)
+        {
+            m_unsettled = m_world;
+        }
+        robot.location = destination;
+        m_steps.push_back({.slot = selected.front(), .location = destination});
+        return {};
+    }
+    std::size_t moved{0};
+    for (const auto slot : select(command.target))
+    {
+        auto &robot = *m_world.slots[slot].robot;
+        const auto destination = ahead(robot.location, command.blocks);
+        if (isFree(destination))
+        {
+            robot.location = destination;
+            ++moved;
+        }
+    }
+    return moved == 0 ? "No robot could be moved.\n" : std::string{};
+}
+
+std::string ReferenceSimulator::apply(const RotateCommand &command)
+{
+    if (command.where)
+    {
+        return "The reference simulator does not support ROTATE WHERE.\n";
+    }
+    const auto selected = select(command.target);
+    for (const auto slot : selected)
+    {
+        auto &location = m_world.slots[slot].robot->location;
+        location.direction = turned(location.direction, command.rotation);
+        if (m_unsettled)
+        {
+            m_steps.push_back({.slot = slot, .location = location});
+        }
+    }
+    return selected.empty() ? "No matching robot was found.\n" : std::string{};
+}
+
+std::string ReferenceSimulator::apply(const RemoveCommand &command)
+{
+    if (command.where)
+    {
+        return "The reference simulator does not support REMOVE WHERE.\n";
+    }
+    auto selected = select(command.target);
+    // Outside a transaction REMOVE ALL frees the highest slots first, so the lowest are reused
+    // first; inside one, robots are removed one at a time in slot order.
+    if (!command.target && !m_saved)
+    {
+        std::reverse(selected.begin(), selected.end());
+    }
+    for (const auto slot : selected)
+    {
+        release(slot);
+    }
+    return selected.empty() ? "No matching robot was found.\n" : std::string{};
+}
+
+std::string ReferenceSimulator::apply(const ResizeCommand &command)
+{
+    const auto outside = std::any_of(m_world.slots.begin(), m_world.slots.end(),
+                                     [&command](const Slot &slot)
+                                     {
+                                         return slot.robot &&
+                                                (slot.robot->location.x >= command.size.width ||
+                                                 slot.robot->location.y >= command.size.height);
+                                     });
+    if (outside)
+    {
+        return "Unable to resize; a robot would be left off the grid.\n";
+    }
+    m_world.size = command.size;
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const ReportCommand &command, std::ostream &output) const
+{
+    if (command.where)
+    {
+        return "The reference simulator does not support REPORT WHERE.\n";
+    }
+    report(output);
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const ScanCommand &command, std::ostream &output) const
+{
+    const auto selected = select(command.target);
+    const auto single =
+        command.target && !std::holds_alternative<NamePattern>(command.target->value);
+    if (command.target && selected.empty())
+    {
+        return "No matching robot was found.\n";
+    }
+    for (const auto slot : selected)
+    {
+        const auto &robot = *m_world.slots[slot].robot;
+        if (!single)
+        {
+            output << robot.name << ": ";
+        }
+        output << clearance(robot.location) << '\n';
+    }
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const HashCommand &command, std::ostream &output) const
+{
+    if (command.action != HashCommand::Action::Show)
+    {
+        return "The reference simulator does not support HASH TRAIL.\n";
+    }
+    output << worldHash() << '\n';
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const BeginCommand & /*command*/)
+{
+    if (m_saved)
+    {
+        return "A transaction is already open.\n";
+    }
+    m_saved = m_world;
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const CommitCommand & /*command*/)
+{
+    if (!m_saved)
+    {
+        return "No transaction is open.\n";
+    }
+    if (m_failed)
+    {
+        m_world = std::move(*m_saved);
+        m_saved.reset();
+        m_unsettled.reset();
+        m_steps.clear();
+        m_failed = false;
+        return "Transaction rolled back; a command inside it failed.\n";
+    }
+    m_saved.reset();
+    return {};
+}
+
+std::string ReferenceSimulator::apply(const AbortCommand & /*command*/)
+{
+    if (!m_saved)
+    {
+        return "No transaction is open.\n";
+    }
+    m_world = std::move(*m_saved);
+    m_saved.reset();
+    m_unsettled.reset();
+    m_steps.clear();
+    m_failed = false;
+    return {};
+}
+
+} // namespace Simulator
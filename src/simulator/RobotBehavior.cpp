@@ -0,0 +1,295 @@
+#include "marvin/simulator/RobotBehavior.h"
+
+#include "marvin/robot/Robot.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::size_t frame_granularity{64};
+constexpr std::size_t size_classes{16}; // Frames up to 1 KiB are pooled.
+constexpr std::size_t frames_per_slab{64};
+
+class FramePool
+{
+  public:
+    [[nodiscard]] void *allocate(std::size_t size_class)
+    {
+        const std::scoped_lock lock{m_mutex};
+        auto *&head = m_free.at(size_class);
+        if (head == nullptr)
+        {
+            refill(size_class);
+        }
+        auto *frame = head;
+        head = frame->next;
+        return frame;
+    }
+
+    void deallocate(void *frame, std::size_t size_class) noexcept
+    {
+        const std::scoped_lock lock{m_mutex};
+        auto *node = ::new (frame) FreeFrame{.next = m_free.at(size_class)};
+        m_free.at(size_class) = node;
+    }
+
+  private:
+    struct FreeFrame
+    {
+        FreeFrame *next;
+    };
+
+    std::mutex m_mutex;
+    std::array<FreeFrame *, size_classes> m_free{};
+    std::vector<std::unique_ptr<std::byte[]>> m_slabs; // NOLINT(*-avoid-c-arrays)
+
+    void refill(std::size_t size_class)
+    {
+        const auto frame_bytes = (size_class + 1) * frame_granularity;
+        auto &slab = m_slabs.emplace_back(
+            std::make_unique<std::byte[]>(frame_bytes * frames_per_slab)); // NOLINT(*-c-arrays)
+        for (std::size_t frame = frames_per_slab; frame-- > 0;)
+        {
+            auto &head = m_free.at(size_class);
+            head = ::new (&slab[frame * frame_bytes]) FreeFrame{.next = head};
+        }
+    }
+};
+
+// Never destroyed, so frames released during static destruction still have somewhere to go.
+[[nodiscard]] FramePool &framePool()
+{
+    static auto &pool = *new FramePool; // NOLINT(cppcoreguidelines-owning-memory)
+    return pool;
+}
+
+[[nodiscard]] std::size_t sizeClass(std::size_t bytes) noexcept
+{
+    return (bytes + frame_granularity - 1) / frame_granularity - 1;
+}
+
+[[nodiscard]] std::uint64_t cellKey(RobotFactory::RobotLocation location) noexcept
+{
+    // Distinct cells may share a key on enormous grids; woken behaviours re-check their cell.
+    return (static_cast<std::uint64_t>(location.x) << 32U) ^
+           static_cast<std::uint64_t>(static_cast<std::uint32_t>(location.y));
+}
+
+} // namespace
+
+void *BehaviorFramePool::allocate(std::size_t bytes)
+{
+    const auto size_class = sizeClass(bytes);
+    if (bytes == 0 || size_class >= size_classes)
+    {
+        return ::operator new(bytes);
+    }
+    return framePool().allocate(size_class);
+}
+
+void BehaviorFramePool::deallocate(void *frame, std::size_t bytes) noexcept
+{
+    const auto size_class = sizeClass(bytes);
+    if (bytes == 0 || size_class >= size_classes)
+    {
+        ::operator delete(frame);
+        return;
+    }
+    framePool().deallocate(frame, size_class);
+}
+
+RobotBehavior::~RobotBehavior()
+{
+    if (m_handle)
+    {
+        m_handle.destroy();
+    }
+}
+
+RobotBehavior &RobotBehavior::operator=(RobotBehavior &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+        m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+}
+
+BehaviorScheduler::~BehaviorScheduler()
+{
+    detachAll();
+}
+
+void BehaviorScheduler::attach(RobotFactory::RobotId robot, RobotBehavior behavior)
+{
+    const auto handle = behavior.release();
+    if (!handle)
+    {
+        return;
+    }
+    handle.promise().scheduler = this;
+    handle.promise().robot = robot;
+    m_ready.push_back(handle);
+    m_attached.emplace(robot, handle);
+    ++m_size;
+}
+
+std::size_t BehaviorScheduler::tick()
+{
+    m_running.clear();
+    m_running.swap(m_ready);
+    std::size_t resumed{0};
+    std::exception_ptr failure;
+    for (std::size_t next = 0; next < m_running.size(); ++next)
+    {
+        const auto handle = m_running[next];
+        auto &promise = handle.promise();
+        if (!m_world->contains(promise.robot))
+        {
+            finish(handle);
+            continue;
+        }
+        if (promise.waiting_for)
+        {
+            // Another robot may have taken the cell between the wake-up and this tick.
+            if (m_world->cell(*promise.waiting_for) == BehaviorWorld::Cell::Occupied)
+            {
+                park(*promise.waiting_for, handle);
+                continue;
+            }
+            promise.waiting_for.reset();
+        }
+        handle.resume();
+        ++resumed;
+        if (handle.done())
+        {
+            if (promise.exception && !failure)
+            {
+                failure = promise.exception;
+            }
+            finish(handle);
+        }
+    }
+    m_running.clear();
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+    return resumed;
+}
+
+void BehaviorScheduler::wake(RobotFactory::RobotLocation location)
+{
+    const auto waiters = m_parked.find(cellKey(location));
+    if (waiters == m_parked.end())
+    {
+        return;
+    }
+    m_ready.insert(m_ready.end(), waiters->second.begin(), waiters->second.end());
+    m_parked_count -= waiters->second.size();
+    m_parked.erase(waiters);
+}
+
+void BehaviorScheduler::vacatedAll()
+{
+    for (auto &[key, handles] : m_parked)
+    {
+        m_ready.insert(m_ready.end(), handles.begin(), handles.end());
+    }
+    m_parked.clear();
+    m_parked_count = 0;
+}
+
+void BehaviorScheduler::detach(RobotFactory::RobotId robot)
+{
+    auto [first, last] = m_attached.equal_range(robot);
+    while (first != last)
+    {
+        const auto handle = (first++)->second;
+        auto &promise = handle.promise();
+        // A woken behaviour keeps its cell until its next turn, so it may be ready instead.
+        const auto parked = promise.waiting_for ? m_parked.find(cellKey(*promise.waiting_for))
+                                                : m_parked.end();
+        if (parked != m_parked.end() && std::erase(parked->second, handle) != 0)
+        {
+            --m_parked_count;
+            if (parked->second.empty())
+            {
+                m_parked.erase(parked);
+            }
+        }
+        else
+        {
+            std::erase(m_ready, handle);
+        }
+        finish(handle);
+    }
+}
+
+void BehaviorScheduler::detachAll() noexcept
+{
+    for (const auto &[robot, handle] : m_attached)
+    {
+        handle.destroy();
+    }
+    m_attached.clear();
+    m_ready.clear();
+    m_running.clear();
+    m_parked.clear();
+    m_parked_count = 0;
+    m_size = 0;
+}
+
+std::size_t BehaviorScheduler::size() const noexcept
+{
+    return m_size;
+}
+
+std::size_t BehaviorScheduler::parked() const noexcept
+{
+    return m_parked_count;
+}
+
+void BehaviorScheduler::resumeNextTick(RobotBehavior::Handle handle)
+{
+    m_ready.push_back(handle);
+}
+
+void BehaviorScheduler::park(RobotFactory::RobotLocation location, RobotBehavior::Handle handle)
+{
+    handle.promise().waiting_for = location;
+    m_parked[cellKey(location)].push_back(handle);
+    ++m_parked_count;
+}
+
+void BehaviorScheduler::finish(RobotBehavior::Handle handle) noexcept
+{
+    auto [first, last] = m_attached.equal_range(handle.promise().robot);
+    for (; first != last; ++first)
+    {
+        if (first->second == handle)
+        {
+            m_attached.erase(first);
+            break;
+        }
+    }
+    handle.destroy();
+    --m_size;
+}
+
+} // namespace Simulator
@@ -3,36 +3,238 @@
 #include "marvin/robot/Robot.h"
 
 #include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define MARVIN_HAS_PDEP 1
+#endif
+
 namespace Simulator
 {
 
 namespace
 {
-[[nodiscard]] std::size_t cellCount(GridSize size)
+
+constexpr std::size_t tile_bits{4};
+constexpr std::size_t tile_side{std::size_t{1} << tile_bits};
+constexpr std::size_t tile_mask{tile_side - 1};
+constexpr std::size_t tile_cells{tile_side * tile_side};
+
+[[nodiscard]] std::size_t tileCount(RobotFactory::Coordinate extent)
+{
+    return (static_cast<std::size_t>(extent) + tile_mask) >> tile_bits;
+}
+
+[[nodiscard]] std::size_t cellCount(GridSize size, GridLayout layout)
 {
     if (size.width <= 0 || size.height <= 0)
     {
         throw std::invalid_argument{"Grid dimensions must be positive."};
     }
-    const auto width = static_cast<std::size_t>(size.width);
-    const auto height = static_cast<std::size_t>(size.height);
+    auto width = static_cast<std::size_t>(size.width);
+    auto height = static_cast<std::size_t>(size.height);
+    if (layout == GridLayout::Morton)
+    {
+        width = tileCount(size.width) * tile_side;
+        height = tileCount(size.height) * tile_side;
+    }
     if (width > std::numeric_limits<std::size_t>::max() / height)
     {
         throw std::length_error{"Grid dimensions are too large."};
     }
     return width * height;
 }
+
+// Interleaves the low tile_bits of x (even bits) and y (odd bits).
+[[nodiscard]] std::size_t interleave(std::size_t x, std::size_t y) noexcept
+{
+#ifdef MARVIN_HAS_PDEP
+    return _pdep_u32(static_cast<std::uint32_t>(x), 0x55U) |
+           _pdep_u32(static_cast<std::uint32_t>(y), 0xAAU);
+#else
+    const auto spread = [](std::size_t value)
+    {
+        value = (value | (value << 2U)) & 0x33U;
+        return (value | (value << 1U)) & 0x55U;
+    };
+    return spread(x) | (spread(y) << 1U);
+#endif
+}
+
+// Capacity along one axis after a resize to `requested`: unchanged while it fits, otherwise at
+// least 1.5 times the current capacity so that stepwise growth reallocates O(log n) times.
+[[nodiscard]] RobotFactory::Coordinate grownExtent(RobotFactory::Coordinate current,
+                                                   RobotFactory::Coordinate requested) noexcept
+{
+    if (requested <= current)
+    {
+        return current;
+    }
+    const auto geometric = current > std::numeric_limits<RobotFactory::Coordinate>::max() / 3
+                               ? std::numeric_limits<RobotFactory::Coordinate>::max()
+                               : current + (current / 2);
+    return std::max(requested, geometric);
+}
+
+using Counts = std::vector<std::uint32_t, PageAllocator<std::uint32_t>>;
+using Bits = std::vector<std::uint64_t, PageAllocator<std::uint64_t>>;
+
+// True when no robot lies in [from, to) along the axis the counts describe.
+[[nodiscard]] bool isBandEmpty(const Counts &occupancy,
+                               RobotFactory::Coordinate from, RobotFactory::Coordinate to)
+{
+    if (from >= to)
+    {
+        return true;
+    }
+    return std::all_of(occupancy.begin() + static_cast<std::ptrdiff_t>(from),
+                       occupancy.begin() + static_cast<std::ptrdiff_t>(to),
+                       [](std::uint32_t robots) { return robots == 0; });
+}
+
+constexpr std::size_t word_bits{64};
+
+[[nodiscard]] std::size_t wordCount(RobotFactory::Coordinate extent) noexcept
+{
+    return (static_cast<std::size_t>(extent) + word_bits - 1) / word_bits;
+}
+
+// Word holding bit `position` of the line of `words` words starting at `line * words`. Callers
+// have already validated the location through index().
+[[nodiscard]] std::uint64_t &wordAt(Bits &bits, std::size_t words, RobotFactory::Coordinate line,
+                                    RobotFactory::Coordinate position) noexcept
+{
+    return bits[(static_cast<std::size_t>(line) * words) + // NOLINT(*-constant-array-index)
+                (static_cast<std::size_t>(position) / word_bits)];
+}
+
+[[nodiscard]] std::uint64_t bitFor(RobotFactory::Coordinate position) noexcept
+{
+    return std::uint64_t{1} << (static_cast<std::size_t>(position) % word_bits);
+}
+
+// First set bit at or after `from` in one line, or `end` if none is set before it.
+[[nodiscard]] RobotFactory::Coordinate nextSet(const std::uint64_t *line, std::size_t from,
+                                               std::size_t end) noexcept
+{
+    if (from >= end)
+    {
+        return static_cast<RobotFactory::Coordinate>(end);
+    }
+    auto word = from / word_bits;
+    auto bits = line[word] & (~std::uint64_t{0} << (from % word_bits)); // NOLINT(*-arithmetic)
+    const auto last_word = (end - 1) / word_bits;
+    while (bits == 0 && word < last_word)
+    {
+        bits = line[++word]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    if (bits == 0)
+    {
+        return static_cast<RobotFactory::Coordinate>(end);
+    }
+    const auto found = (word * word_bits) + static_cast<std::size_t>(std::countr_zero(bits));
+    return static_cast<RobotFactory::Coordinate>(std::min(found, end));
+}
+
+// Last set bit at or before `from` in one line, or -1 if none is set.
+[[nodiscard]] RobotFactory::Coordinate previousSet(const std::uint64_t *line,
+                                                   std::size_t from) noexcept
+{
+    auto word = from / word_bits;
+    const auto shift = word_bits - 1 - (from % word_bits);
+    auto bits = line[word] & (~std::uint64_t{0} >> shift); // NOLINT(*-pointer-arithmetic)
+    while (bits == 0 && word > 0)
+    {
+        bits = line[--word]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    if (bits == 0)
+    {
+        return -1;
+    }
+    return static_cast<RobotFactory::Coordinate>((word * word_bits) + word_bits - 1 -
+                                                 static_cast<std::size_t>(std::countl_zero(bits)));
+}
+
+// The cell one block ahead of `location`.
+[[nodiscard]] RobotFactory::RobotLocation step(RobotFactory::RobotLocation location) noexcept
+{
+    switch (location.direction)
+    {
+    case RobotFactory::Direction::North:
+        ++location.y;
+        break;
+    case RobotFactory::Direction::East:
+        ++location.x;
+        break;
+    case RobotFactory::Direction::South:
+        --location.y;
+        break;
+    case RobotFactory::Direction::West:
+        --location.x;
+        break;
+    }
+    return location;
+}
+
+// Copies `lines` lines of a bitset to a wider stride.
+[[nodiscard]] Bits restride(const Bits &bits, std::size_t lines, std::size_t words,
+                           std::size_t new_lines, std::size_t new_words)
+{
+    Bits wider(new_lines * new_words);
+    for (std::size_t line = 0; line < lines; ++line)
+    {
+        std::copy_n(bits.begin() + static_cast<std::ptrdiff_t>(line * words), words,
+                    wider.begin() + static_cast<std::ptrdiff_t>(line * new_words));
+    }
+    return wider;
+}
+
+// a * b + c, saturating at the largest size.
+[[nodiscard]] std::size_t saturatingMultiplyAdd(std::size_t a, std::size_t b,
+                                                std::size_t c) noexcept
+{
+    constexpr auto max = std::numeric_limits<std::size_t>::max();
+    if (b != 0 && a > (max - c) / b)
+    {
+        return max;
+    }
+    return (a * b) + c;
+}
+
+// Bytes of the cells, which the page allocator rounds up, and of the bitsets of a grid with the
+// given capacity.
+[[nodiscard]] std::size_t storageBytes(GridSize capacity, GridLayout layout, bool line_of_sight)
+{
+    const auto cells =
+        saturatingMultiplyAdd(cellCount(capacity, layout), sizeof(RobotFactory::RobotId), 0);
+    auto bytes = pageBlock(nullptr, cells).bytes;
+    if (line_of_sight)
+    {
+        // Each bitset has no more words than there are cells, which cellCount() bounded.
+        const auto rows = static_cast<std::size_t>(capacity.height) * wordCount(capacity.width);
+        const auto columns = static_cast<std::size_t>(capacity.width) * wordCount(capacity.height);
+        bytes = saturatingMultiplyAdd(rows + columns, sizeof(std::uint64_t), bytes);
+    }
+    return bytes;
+}
+
 } // namespace
 
 RobotGrid::RobotGrid() : RobotGrid{default_grid_size} {}
 
-RobotGrid::RobotGrid(GridSize size) : m_cells(cellCount(size)), m_size{size} {}
+RobotGrid::RobotGrid(GridSize size, GridLayout layout)
+    : m_cells(cellCount(size, layout)), m_row_occupancy(static_cast<std::size_t>(size.height)),
+      m_column_occupancy(static_cast<std::size_t>(size.width)), m_size{size}, m_capacity{size},
+      m_layout{layout}, m_tiles_per_row{tileCount(size.width)}
+{
+}
 
 bool RobotGrid::addRobot(const RobotFactory::Robot &robot)
 {
@@ -41,34 +243,57 @@ bool RobotGrid::addRobot(const RobotFactory::Robot &robot)
     {
         return false;
     }
-    m_cells.at(index(location)) = robot.id();
+    occupy(location, robot.id());
     return true;
 }
 
 void RobotGrid::updateLocation(RobotFactory::RobotLocation previous,
                                const RobotFactory::Robot &robot)
+{
+    updateLocation(previous, robot.location(), robot.id());
+}
+
+void RobotGrid::updateLocation(RobotFactory::RobotLocation previous,
+                               RobotFactory::RobotLocation location, RobotFactory::RobotId id)
 {
     m_cells.at(index(previous)) = 0;
-    m_cells.at(index(robot.location())) = robot.id();
+    m_cells.at(index(location)) = id;
+    if (m_tracks_line_of_sight)
+    {
+        wordAt(m_row_bits, m_row_words, previous.y, previous.x) &= ~bitFor(previous.x);
+        wordAt(m_row_bits, m_row_words, location.y, location.x) |= bitFor(location.x);
+        wordAt(m_column_bits, m_column_words, previous.x, previous.y) &= ~bitFor(previous.y);
+        wordAt(m_column_bits, m_column_words, location.x, location.y) |= bitFor(location.y);
+    }
+    // A move changes one axis, so only one pair of occupancy counts needs updating.
+    if (previous.y != location.y)
+    {
+        --m_row_occupancy[static_cast<std::size_t>(previous.y)];
+        ++m_row_occupancy[static_cast<std::size_t>(location.y)];
+    }
+    if (previous.x != location.x)
+    {
+        --m_column_occupancy[static_cast<std::size_t>(previous.x)];
+        ++m_column_occupancy[static_cast<std::size_t>(location.x)];
+    }
 }
 
 bool RobotGrid::resize(GridSize size)
 {
-    if (size.width < m_size.width || size.height < m_size.height)
+    static_cast<void>(cellCount(size, m_layout));
+    // The occupied bounding box fits the new size exactly when the cut-off bands are empty, which
+    // the occupancy counts answer in O(rows + columns removed).
+    if (!isBandEmpty(m_row_occupancy, size.height, m_size.height) ||
+        !isBandEmpty(m_column_occupancy, size.width, m_size.width))
     {
         return false;
     }
-
-    std::vector<Cell> resized(cellCount(size));
-    for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+    if (size.width > m_capacity.width || size.height > m_capacity.height)
     {
-        const auto old_offset = static_cast<std::size_t>(y * m_size.width);
-        const auto new_offset = static_cast<std::size_t>(y * size.width);
-        std::copy_n(m_cells.begin() + static_cast<std::ptrdiff_t>(old_offset),
-                    static_cast<std::size_t>(m_size.width),
-                    resized.begin() + static_cast<std::ptrdiff_t>(new_offset));
+        reserve({.width = grownExtent(m_capacity.width, size.width),
+                 .height = grownExtent(m_capacity.height, size.height)});
     }
-    m_cells = std::move(resized);
+    // Cells between the old and new size are empty, so growing within capacity is just this.
     m_size = size;
     return true;
 }
@@ -76,9 +301,9 @@ bool RobotGrid::resize(GridSize size)
 void RobotGrid::remove(const RobotFactory::Robot &robot)
 {
     const auto location = robot.location();
-    if (!isOffGrid(location))
+    if (!isOffGrid(location) && m_cells.at(index(location)) == robot.id())
     {
-        m_cells.at(index(location)) = 0;
+        vacate(location);
     }
 }
 
@@ -87,6 +312,16 @@ GridSize RobotGrid::size() const noexcept
     return m_size;
 }
 
+GridSize RobotGrid::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+GridLayout RobotGrid::layout() const noexcept
+{
+    return m_layout;
+}
+
 RobotFactory::RobotId RobotGrid::robotIdAt(RobotFactory::RobotLocation location) const
 {
     return m_cells.at(index(location));
@@ -103,13 +338,211 @@ bool RobotGrid::isOccupied(RobotFactory::RobotLocation location) const
     return !isOffGrid(location) && m_cells.at(index(location)) != 0;
 }
 
+void RobotGrid::prefetch(RobotFactory::RobotLocation location) const noexcept
+{
+#if defined(__GNUC__)
+    if (!isOffGrid(location))
+    {
+        __builtin_prefetch(m_cells.data() + offset(location.x, location.y), 1);
+    }
+#else
+    static_cast<void>(location);
+#endif
+}
+
+void RobotGrid::trackLineOfSight()
+{
+    if (m_tracks_line_of_sight)
+    {
+        return;
+    }
+    m_row_words = wordCount(m_capacity.width);
+    m_column_words = wordCount(m_capacity.height);
+    m_row_bits.assign(static_cast<std::size_t>(m_capacity.height) * m_row_words, 0);
+    m_column_bits.assign(static_cast<std::size_t>(m_capacity.width) * m_column_words, 0);
+    m_tracks_line_of_sight = true;
+    for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+    {
+        for (RobotFactory::Coordinate x = 0; x < m_size.width; ++x)
+        {
+            if (m_cells.at(offset(x, y)) != 0)
+            {
+                wordAt(m_row_bits, m_row_words, y, x) |= bitFor(x);
+                wordAt(m_column_bits, m_column_words, x, y) |= bitFor(y);
+            }
+        }
+    }
+}
+
+bool RobotGrid::tracksLineOfSight() const noexcept
+{
+    return m_tracks_line_of_sight;
+}
+
+RobotFactory::Coordinate RobotGrid::clearance(RobotFactory::RobotLocation location) const
+{
+    static_cast<void>(index(location));
+    if (!m_tracks_line_of_sight)
+    {
+        RobotFactory::Coordinate distance{0};
+        for (auto ahead = step(location); !isOffGrid(ahead) && !isOccupied(ahead);
+             ahead = step(ahead))
+        {
+            ++distance;
+        }
+        return distance;
+    }
+    const auto x = static_cast<std::size_t>(location.x);
+    const auto y = static_cast<std::size_t>(location.y);
+    const auto *row = &m_row_bits.at(y * m_row_words);
+    const auto *column = &m_column_bits.at(x * m_column_words);
+    switch (location.direction)
+    {
+    case RobotFactory::Direction::North:
+        return nextSet(column, y + 1, static_cast<std::size_t>(m_size.height)) - location.y - 1;
+    case RobotFactory::Direction::East:
+        return nextSet(row, x + 1, static_cast<std::size_t>(m_size.width)) - location.x - 1;
+    case RobotFactory::Direction::South:
+        return location.y == 0 ? 0 : location.y - previousSet(column, y - 1) - 1;
+    case RobotFactory::Direction::West:
+        return location.x == 0 ? 0 : location.x - previousSet(row, x - 1) - 1;
+    }
+    return 0;
+}
+
+std::size_t RobotGrid::memoryBytes() const noexcept
+{
+    return m_cells.block().bytes +
+           ((m_row_occupancy.capacity() + m_column_occupancy.capacity()) * sizeof(std::uint32_t)) +
+           ((m_row_bits.capacity() + m_column_bits.capacity()) * sizeof(std::uint64_t));
+}
+
+std::size_t RobotGrid::memoryBytesAfterResize(GridSize size) const
+{
+    static_cast<void>(cellCount(size, m_layout));
+    if (size.width <= m_capacity.width && size.height <= m_capacity.height)
+    {
+        return memoryBytes();
+    }
+    const GridSize capacity{.width = grownExtent(m_capacity.width, size.width),
+                            .height = grownExtent(m_capacity.height, size.height)};
+    // Occupancy counts grow like std::vector::resize(), to at least twice their size.
+    const auto counts = [](const Counts &occupancy, RobotFactory::Coordinate extent)
+    {
+        const auto wanted = static_cast<std::size_t>(extent);
+        return wanted <= occupancy.capacity() ? occupancy.capacity()
+                                              : std::max(wanted, occupancy.size() * 2);
+    };
+    const auto occupancy = counts(m_row_occupancy, capacity.height) +
+                           (capacity.width == m_capacity.width
+                                ? m_column_occupancy.capacity()
+                                : counts(m_column_occupancy, capacity.width));
+    return saturatingMultiplyAdd(occupancy, sizeof(std::uint32_t),
+                                 storageBytes(capacity, m_layout, m_tracks_line_of_sight));
+}
+
+std::size_t RobotGrid::memoryBytesFor(GridSize size, GridLayout layout, bool line_of_sight)
+{
+    const auto storage = storageBytes(size, layout, line_of_sight);
+    const auto occupancy =
+        static_cast<std::size_t>(size.width) + static_cast<std::size_t>(size.height);
+    return saturatingMultiplyAdd(occupancy, sizeof(std::uint32_t), storage);
+}
+
 std::size_t RobotGrid::index(RobotFactory::RobotLocation location) const
 {
     if (isOffGrid(location))
     {
         throw std::out_of_range{"Grid location is outside the grid."};
     }
-    return static_cast<std::size_t>((location.y * m_size.width) + location.x);
+    return offset(location.x, location.y);
+}
+
+void RobotGrid::occupy(RobotFactory::RobotLocation location, RobotFactory::RobotId id)
+{
+    m_cells.at(index(location)) = id;
+    ++m_row_occupancy.at(static_cast<std::size_t>(location.y));
+    ++m_column_occupancy.at(static_cast<std::size_t>(location.x));
+    if (m_tracks_line_of_sight)
+    {
+        wordAt(m_row_bits, m_row_words, location.y, location.x) |= bitFor(location.x);
+        wordAt(m_column_bits, m_column_words, location.x, location.y) |= bitFor(location.y);
+    }
+}
+
+void RobotGrid::vacate(RobotFactory::RobotLocation location)
+{
+    m_cells.at(index(location)) = 0;
+    --m_row_occupancy.at(static_cast<std::size_t>(location.y));
+    --m_column_occupancy.at(static_cast<std::size_t>(location.x));
+    if (m_tracks_line_of_sight)
+    {
+        wordAt(m_row_bits, m_row_words, location.y, location.x) &= ~bitFor(location.x);
+        wordAt(m_column_bits, m_column_words, location.x, location.y) &= ~bitFor(location.y);
+    }
+}
+
+void RobotGrid::reserve(GridSize capacity)
+{
+    if (m_tracks_line_of_sight)
+    {
+        const auto row_words = wordCount(capacity.width);
+        const auto column_words = wordCount(capacity.height);
+        m_row_bits = restride(m_row_bits, static_cast<std::size_t>(m_capacity.height),
+                              m_row_words, static_cast<std::size_t>(capacity.height), row_words);
+        m_column_bits =
+            restride(m_column_bits, static_cast<std::size_t>(m_capacity.width), m_column_words,
+                     static_cast<std::size_t>(capacity.width), column_words);
+        m_row_words = row_words;
+        m_column_words = column_words;
+    }
+
+    if (m_layout == GridLayout::RowMajor && capacity.width == m_capacity.width)
+    {
+        // Same stride: new rows are appended after the existing ones.
+        m_cells.grow(cellCount(capacity, m_layout));
+        m_row_occupancy.resize(static_cast<std::size_t>(capacity.height));
+        m_capacity = capacity;
+        return;
+    }
+
+    RobotGrid grown{capacity, m_layout};
+    grown.m_size = m_size;
+    if (m_layout == GridLayout::RowMajor)
+    {
+        for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+        {
+            std::copy_n(&m_cells.at(offset(0, y)), static_cast<std::size_t>(m_size.width),
+                        &grown.m_cells.at(grown.offset(0, y)));
+        }
+    }
+    else
+    {
+        for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+        {
+            for (RobotFactory::Coordinate x = 0; x < m_size.width; ++x)
+            {
+                grown.m_cells.at(grown.offset(x, y)) = m_cells.at(offset(x, y));
+            }
+        }
+    }
+    m_cells = std::move(grown.m_cells);
+    m_row_occupancy.resize(static_cast<std::size_t>(capacity.height));
+    m_column_occupancy.resize(static_cast<std::size_t>(capacity.width));
+    m_capacity = capacity;
+    m_tiles_per_row = grown.m_tiles_per_row;
+}
+
+std::size_t RobotGrid::offset(RobotFactory::Coordinate x, RobotFactory::Coordinate y) const noexcept
+{
+    const auto column = static_cast<std::size_t>(x);
+    const auto row = static_cast<std::size_t>(y);
+    if (m_layout == GridLayout::RowMajor)
+    {
+        return (row * static_cast<std::size_t>(m_capacity.width)) + column;
+    }
+    const auto tile = ((row >> tile_bits) * m_tiles_per_row) + (column >> tile_bits);
+    return (tile * tile_cells) + interleave(column & tile_mask, row & tile_mask);
 }
 
 } // namespace Simulator
@@ -0,0 +1,193 @@
+#include "marvin/simulator/RobotGroups.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+std::optional<RobotGroups::GroupId> RobotGroups::create(std::string name)
+{
+    if (m_names.contains(name))
+    {
+        return std::nullopt;
+    }
+    GroupId group{0};
+    if (m_free_groups.empty())
+    {
+        group = static_cast<GroupId>(m_groups.size());
+        m_groups.emplace_back();
+    }
+    else
+    {
+        group = m_free_groups.back();
+        m_free_groups.pop_back();
+    }
+    m_names.emplace(std::move(name), group);
+    return group;
+}
+
+bool RobotGroups::erase(std::string_view name)
+{
+    const auto entry = m_names.find(name);
+    if (entry == m_names.end())
+    {
+        return false;
+    }
+    auto &group = m_groups.at(entry->second);
+    for (std::size_t position = 0; position < group.members.size(); ++position)
+    {
+        // Unchain the membership from its robot's slot.
+        const auto link = group.links[position];
+        auto *previous = &m_first.at(RobotHandleTable::slotIndex(group.members[position]));
+        while (*previous != link)
+        {
+            previous = &m_links[*previous - 1].next;
+        }
+        *previous = m_links[link - 1].next;
+        m_free_links.push_back(link);
+    }
+    group = Group{};
+    m_free_groups.push_back(entry->second);
+    m_names.erase(entry);
+    return true;
+}
+
+std::optional<RobotGroups::GroupId> RobotGroups::find(std::string_view name) const
+{
+    const auto entry = m_names.find(name);
+    if (entry == m_names.end())
+    {
+        return std::nullopt;
+    }
+    return entry->second;
+}
+
+bool RobotGroups::add(GroupId group, RobotFactory::RobotId id)
+{
+    const auto slot = RobotHandleTable::slotIndex(id);
+    if (slot >= m_first.size())
+    {
+        m_first.resize(slot + 1, no_link);
+    }
+    for (auto link = m_first[slot]; link != no_link; link = m_links[link - 1].next)
+    {
+        if (m_links[link - 1].group == group)
+        {
+            return false;
+        }
+    }
+    auto &target = m_groups.at(group);
+    const auto link = allocateLink({.group = group,
+                                    .position = static_cast<std::uint32_t>(target.members.size()),
+                                    .next = m_first[slot]});
+    target.members.push_back(id);
+    target.links.push_back(link);
+    m_first[slot] = link;
+    return true;
+}
+
+std::span<const RobotGroups::GroupId> RobotGroups::leaveAll(RobotFactory::RobotId id)
+{
+    m_left.clear();
+    const auto slot = RobotHandleTable::slotIndex(id);
+    if (slot >= m_first.size())
+    {
+        return {};
+    }
+    for (auto link = m_first[slot]; link != no_link;)
+    {
+        const auto membership = m_links[link - 1];
+        removeMember(m_groups[membership.group], membership.position);
+        m_left.push_back(membership.group);
+        m_free_links.push_back(link);
+        link = membership.next;
+    }
+    m_first[slot] = no_link;
+    return m_left;
+}
+
+void RobotGroups::clearMembers() noexcept
+{
+    for (auto &group : m_groups)
+    {
+        group.members.clear();
+        group.links.clear();
+    }
+    m_first.clear();
+    m_links.clear();
+    m_free_links.clear();
+}
+
+std::span<const RobotFactory::RobotId> RobotGroups::members(GroupId group) const
+{
+    return m_groups.at(group).members;
+}
+
+bool RobotGroups::empty() const noexcept
+{
+    return m_names.empty();
+}
+
+std::size_t RobotGroups::size() const noexcept
+{
+    return m_names.size();
+}
+
+std::size_t RobotGroups::memoryBytes() const noexcept
+{
+    auto bytes = (m_groups.capacity() * sizeof(Group)) +
+                 (m_free_groups.capacity() * sizeof(GroupId)) +
+                 (m_first.capacity() * sizeof(std::uint32_t)) +
+                 (m_links.capacity() * sizeof(Link)) +
+                 (m_free_links.capacity() * sizeof(std::uint32_t)) +
+                 (m_left.capacity() * sizeof(GroupId)) + (m_names.size() * name_node_bytes);
+    for (const auto &group : m_groups)
+    {
+        bytes += (group.members.capacity() * sizeof(RobotFactory::RobotId)) +
+                 (group.links.capacity() * sizeof(std::uint32_t));
+    }
+    for (const auto &[name, group] : m_names)
+    {
+        // Short names live inside the string itself.
+        bytes += name.capacity() > std::string{}.capacity() ? name.capacity() + 1 : 0;
+    }
+    return bytes;
+}
+
+std::uint32_t RobotGroups::allocateLink(const Link &link)
+{
+    if (m_free_links.empty())
+    {
+        m_links.push_back(link);
+        return static_cast<std::uint32_t>(m_links.size());
+    }
+    const auto number = m_free_links.back();
+    m_free_links.pop_back();
+    m_links[number - 1] = link;
+    return number;
+}
+
+void RobotGroups::removeMember(Group &group, std::uint32_t position) noexcept
+{
+    const auto last = group.members.size() - 1;
+    if (position != last)
+    {
+        group.members[position] = group.members[last];
+        group.links[position] = group.links[last];
+        m_links[group.links[position] - 1].position = position;
+    }
+    group.members.pop_back();
+    group.links.pop_back();
+}
+
+} // namespace Simulator
@@ -0,0 +1,310 @@
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/PageAllocator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr unsigned generation_shift{32};
+constexpr RobotFactory::RobotId slot_mask{(RobotFactory::RobotId{1} << generation_shift) - 1};
+
+[[nodiscard]] RobotFactory::RobotId makeId(std::uint32_t slot, std::uint32_t generation) noexcept
+{
+    return (RobotFactory::RobotId{generation} << generation_shift) |
+           (RobotHandleTable::first_id + slot);
+}
+
+// Slots come from the page allocator, which rounds large blocks up to whole huge pages.
+[[nodiscard]] std::size_t pageBytes(std::size_t bytes) noexcept
+{
+    return pageBlock(nullptr, bytes).bytes;
+}
+
+} // namespace
+
+void RobotHandleTable::RobotDeleter::operator()(RobotFactory::Robot *robot) const noexcept
+{
+    if (pool == nullptr)
+    {
+        delete robot; // NOLINT(cppcoreguidelines-owning-memory)
+        return;
+    }
+    std::destroy_at(robot);
+    pool->deallocate(robot);
+}
+
+RobotFactory::RobotId RobotHandleTable::acquire()
+{
+    if (!m_free.empty())
+    {
+        const auto index = m_free.back();
+        m_free.pop_back();
+        return makeId(index, m_slots.at(index).generation);
+    }
+    if (m_slots.size() >= slot_mask - first_id)
+    {
+        throw std::length_error{"Robot handle table is full."};
+    }
+    m_slots.emplace_back();
+    return makeId(static_cast<std::uint32_t>(m_slots.size() - 1), 0);
+}
+
+RobotFactory::Robot &RobotHandleTable::bind(RobotFactory::RobotId id, RobotPointer robot)
+{
+    if (slot(id) == nullptr || !robot)
+    {
+        throw std::invalid_argument{"Robot ID was not acquired from this table."};
+    }
+    auto &entry = m_slots.at(slotIndex(id));
+    if (entry.robot)
+    {
+        uncount(*entry.robot);
+    }
+    m_size += entry.robot ? 0U : 1U;
+    entry.robot = std::move(robot);
+    count(*entry.robot);
+    return *entry.robot;
+}
+
+RobotFactory::Robot &RobotHandleTable::emplace(RobotFactory::RobotId id,
+                                               RobotFactory::GroundRobotType type,
+                                               RobotFactory::RobotLocation location,
+                                               std::string name)
+{
+    if (slot(id) == nullptr)
+    {
+        throw std::invalid_argument{"Robot ID was not acquired from this table."};
+    }
+    auto *cell = m_pool->allocate();
+    RobotFactory::Robot *robot{nullptr};
+    try
+    {
+        robot = RobotFactory::RobotAssembly::create(cell, type, location, std::move(name), id);
+    }
+    catch (...)
+    {
+        m_pool->deallocate(cell);
+        throw;
+    }
+    if (robot == nullptr)
+    {
+        m_pool->deallocate(cell);
+        throw std::invalid_argument{"Unknown robot type."};
+    }
+    // bind() without a second ID check or a virtual footprint() call.
+    auto &entry = m_slots.at(slotIndex(id));
+    if (entry.robot)
+    {
+        uncount(*entry.robot);
+    }
+    m_size += entry.robot ? 0U : 1U;
+    entry.robot = RobotPointer{robot, RobotDeleter{m_pool.get()}};
+    m_robot_bytes += RobotFactory::RobotAssembly::footprint(type);
+    m_name_bytes += nameBytes(*robot);
+    return *robot;
+}
+
+void RobotHandleTable::release(RobotFactory::RobotId id)
+{
+    if (slot(id) == nullptr)
+    {
+        return;
+    }
+    const auto index = slotIndex(id);
+    auto &entry = m_slots.at(index);
+    // A slot that never held a robot handed out no usable ID, so it keeps its generation.
+    if (entry.robot)
+    {
+        uncount(*entry.robot);
+        entry.robot.reset();
+        ++entry.generation;
+        --m_size;
+    }
+    m_free.push_back(static_cast<std::uint32_t>(index));
+}
+
+RobotHandleTable::RobotPointer RobotHandleTable::take(RobotFactory::RobotId id)
+{
+    if (slot(id) == nullptr)
+    {
+        return nullptr;
+    }
+    const auto index = slotIndex(id);
+    auto &entry = m_slots.at(index);
+    auto robot = std::move(entry.robot);
+    if (robot)
+    {
+        uncount(*robot);
+        ++entry.generation;
+        --m_size;
+        m_free.push_back(static_cast<std::uint32_t>(index));
+    }
+    return robot;
+}
+
+void RobotHandleTable::restore(RobotFactory::RobotId id, RobotPointer robot)
+{
+    const auto index = static_cast<std::uint32_t>(slotIndex(id));
+    const auto free_slot = std::find(m_free.rbegin(), m_free.rend(), index);
+    if (index >= m_slots.size() || free_slot == m_free.rend() || !robot)
+    {
+        throw std::invalid_argument{"Robot ID cannot be restored."};
+    }
+    m_free.erase(std::next(free_slot).base());
+    auto &entry = m_slots.at(index);
+    entry.generation = static_cast<std::uint32_t>(id >> generation_shift);
+    entry.robot = std::move(robot);
+    count(*entry.robot);
+    ++m_size;
+}
+
+void RobotHandleTable::revert(RobotFactory::RobotId id)
+{
+    if (slot(id) == nullptr)
+    {
+        return;
+    }
+    const auto index = slotIndex(id);
+    auto &entry = m_slots.at(index);
+    if (entry.robot)
+    {
+        uncount(*entry.robot);
+        entry.robot.reset();
+        --m_size;
+    }
+    m_free.push_back(static_cast<std::uint32_t>(index));
+}
+
+void RobotHandleTable::clear()
+{
+    // Walk backwards so the lowest slots are reused first.
+    for (auto index = static_cast<std::uint32_t>(m_slots.size()); index-- > 0;)
+    {
+        auto &entry = m_slots.at(index);
+        if (entry.robot)
+        {
+            entry.robot.reset();
+            ++entry.generation;
+            m_free.push_back(index);
+        }
+    }
+    m_size = 0;
+    m_robot_bytes = 0;
+    m_name_bytes = 0;
+}
+
+void RobotHandleTable::reserve(std::size_t count)
+{
+    const auto slots = std::max(m_slots.size(), count);
+    if (slots > m_slots.capacity())
+    {
+        m_slots.reserve(std::max(slots, m_slots.capacity() * 2));
+    }
+    m_pool->reserve(count - std::min(count, m_pool->cellsInUse()));
+}
+
+std::size_t RobotHandleTable::slotIndex(RobotFactory::RobotId id) noexcept
+{
+    return static_cast<std::size_t>((id & slot_mask) - first_id);
+}
+
+RobotFactory::Robot *RobotHandleTable::find(RobotFactory::RobotId id) const
+{
+    const auto *entry = slot(id);
+    return entry == nullptr ? nullptr : entry->robot.get();
+}
+
+std::size_t RobotHandleTable::size() const noexcept
+{
+    return m_size;
+}
+
+std::size_t RobotHandleTable::capacity() const noexcept
+{
+    return m_slots.size();
+}
+
+std::size_t RobotHandleTable::robotBytes() const noexcept
+{
+    return m_robot_bytes;
+}
+
+std::size_t RobotHandleTable::nameBytes() const noexcept
+{
+    return m_name_bytes;
+}
+
+std::size_t RobotHandleTable::memoryBytes() const noexcept
+{
+    return pageBytes(m_slots.capacity() * sizeof(Slot)) +
+           (m_free.capacity() * sizeof(std::uint32_t)) +
+           poolSlack(m_pool->memoryBytes(), m_pool->cellsInUse());
+}
+
+std::size_t RobotHandleTable::memoryBytesFor(std::size_t count) const noexcept
+{
+    // Free slots are reused before new ones are added, and vectors grow by doubling.
+    auto slots = m_slots.capacity();
+    if (const auto needed = std::max(m_slots.size(), count); needed > slots)
+    {
+        slots = std::max(needed, slots * 2);
+    }
+    return pageBytes(slots * sizeof(Slot)) + (m_free.capacity() * sizeof(std::uint32_t)) +
+           poolSlack(m_pool->memoryBytesFor(count), count);
+}
+
+std::size_t RobotHandleTable::nameBytes(std::size_t length) noexcept
+{
+    // Names that fit the small-string buffer live inside the robot object.
+    return length > std::string{}.capacity() ? length + 1 : 0;
+}
+
+std::size_t RobotHandleTable::nameBytes(const RobotFactory::Robot &robot) noexcept
+{
+    const auto capacity = robot.model().capacity();
+    return capacity > std::string{}.capacity() ? capacity + 1 : 0;
+}
+
+std::size_t RobotHandleTable::poolSlack(std::size_t pool_bytes, std::size_t cells) const noexcept
+{
+    // Robots in the pool are counted by robotBytes(), or by their transaction once taken.
+    return pool_bytes - std::min(pool_bytes, cells * m_pool->cellBytes());
+}
+
+void RobotHandleTable::count(const RobotFactory::Robot &robot) noexcept
+{
+    m_robot_bytes += robot.footprint();
+    m_name_bytes += nameBytes(robot);
+}
+
+void RobotHandleTable::uncount(const RobotFactory::Robot &robot) noexcept
+{
+    m_robot_bytes -= robot.footprint();
+    m_name_bytes -= nameBytes(robot);
+}
+
+const RobotHandleTable::Slot *RobotHandleTable::slot(RobotFactory::RobotId id) const
+{
+    const auto low = id & slot_mask;
+    if (low < first_id || low - first_id >= m_slots.size())
+    {
+        return nullptr;
+    }
+    const auto &entry = m_slots.at(static_cast<std::size_t>(low - first_id));
+    return entry.generation == static_cast<std::uint32_t>(id >> generation_shift) ? &entry
+                                                                                   : nullptr;
+}
+
+} // namespace Simulator
@@ -0,0 +1,255 @@
+#include "marvin/simulator/RobotNameIndex.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/PageAllocator.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::size_t minimum_capacity{16};
+
+// The simulator never sets a locale, so std::toupper is ASCII-only; this is the same mapping
+// without a library call per character.
+[[nodiscard]] constexpr unsigned char upper(unsigned char character) noexcept
+{
+    return character >= 'a' && character <= 'z' ? static_cast<unsigned char>(character - 'a' + 'A')
+                                                : character;
+}
+
+// Hints that the cache line at `address` is about to be written.
+void prefetch(const void *address) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 1);
+#else
+    static_cast<void>(address);
+#endif
+}
+
+// FNV-1a over the upper-cased name.
+[[nodiscard]] std::uint64_t hashName(std::string_view name) noexcept
+{
+    constexpr std::uint64_t offset_basis{14695981039346656037ULL};
+    constexpr std::uint64_t prime{1099511628211ULL};
+    auto hash = offset_basis;
+    for (const unsigned char character : name)
+    {
+        hash ^= static_cast<std::uint64_t>(upper(character));
+        hash *= prime;
+    }
+    return hash;
+}
+
+[[nodiscard]] bool sameName(std::string_view name, const RobotFactory::Robot *robot)
+{
+    return robot != nullptr &&
+           std::ranges::equal(name, robot->model(),
+                              [](unsigned char lhs, unsigned char rhs)
+                              { return upper(lhs) == rhs; });
+}
+
+} // namespace
+
+RobotFactory::RobotId RobotNameIndex::find(std::string_view name,
+                                           const RobotHandleTable &robots) const
+{
+    if (m_entries.size() == 0)
+    {
+        return 0;
+    }
+    const auto hash = hashName(name);
+    for (auto position = static_cast<std::size_t>(hash) & mask();;
+         position = (position + 1) & mask())
+    {
+        const auto &entry = m_entries.at(position);
+        if (entry.id == 0)
+        {
+            return 0;
+        }
+        if (entry.hash == hash && sameName(name, robots.find(entry.id)))
+        {
+            return entry.id;
+        }
+    }
+}
+
+bool RobotNameIndex::insert(const RobotFactory::Robot &robot, const RobotHandleTable &robots)
+{
+    if ((m_size + 1) * 2 > m_entries.size())
+    {
+        rehash(std::max(minimum_capacity, m_entries.size() * 2));
+    }
+    return insert(robot, hashName(robot.model()), robots);
+}
+
+void RobotNameIndex::insertAll(std::span<const RobotFactory::RobotId> ids,
+                               const RobotHandleTable &robots,
+                               std::vector<RobotFactory::RobotId> &clashes)
+{
+    constexpr std::size_t block{32};
+    reserve(m_size + ids.size());
+    std::array<std::uint64_t, block> hashes{};
+    for (std::size_t first = 0; first < ids.size(); first += block)
+    {
+        const auto batch = ids.subspan(first, std::min(block, ids.size() - first));
+        for (std::size_t index = 0; index < batch.size(); ++index)
+        {
+            hashes.at(index) = hashName(robots.find(batch[index])->model());
+            prefetch(&m_entries.at(static_cast<std::size_t>(hashes.at(index)) & mask()));
+        }
+        for (std::size_t index = 0; index < batch.size(); ++index)
+        {
+            if (!insert(*robots.find(batch[index]), hashes.at(index), robots))
+            {
+                clashes.push_back(batch[index]);
+            }
+        }
+    }
+}
+
+bool RobotNameIndex::insert(const RobotFactory::Robot &robot, std::uint64_t hash,
+                            const RobotHandleTable &robots)
+{
+    auto position = static_cast<std::size_t>(hash) & mask();
+    for (; m_entries.at(position).id != 0; position = (position + 1) & mask())
+    {
+        const auto &entry = m_entries.at(position);
+        if (entry.hash == hash && sameName(robot.model(), robots.find(entry.id)))
+        {
+            return false;
+        }
+    }
+    if (m_tracks_prefixes)
+    {
+        m_ordered.emplace(robot.model(), robot.id());
+    }
+    m_entries.at(position) = {.hash = hash, .id = robot.id()};
+    ++m_size;
+    return true;
+}
+
+void RobotNameIndex::erase(const RobotFactory::Robot &robot)
+{
+    if (m_entries.size() == 0)
+    {
+        return;
+    }
+    auto hole = static_cast<std::size_t>(hashName(robot.model())) & mask();
+    for (; m_entries.at(hole).id != robot.id(); hole = (hole + 1) & mask())
+    {
+        if (m_entries.at(hole).id == 0)
+        {
+            return;
+        }
+    }
+    // Backward-shift deletion keeps every probe sequence contiguous without tombstones.
+    for (auto next = (hole + 1) & mask(); m_entries.at(next).id != 0; next = (next + 1) & mask())
+    {
+        const auto home = static_cast<std::size_t>(m_entries.at(next).hash) & mask();
+        if (((next - home) & mask()) >= ((next - hole) & mask()))
+        {
+            m_entries.at(hole) = m_entries.at(next);
+            hole = next;
+        }
+    }
+    m_entries.at(hole) = {};
+    --m_size;
+    if (m_tracks_prefixes)
+    {
+        m_ordered.erase(std::string_view{robot.model()});
+    }
+}
+
+void RobotNameIndex::clear() noexcept
+{
+    std::fill_n(m_entries.data(), m_entries.size(), Entry{});
+    m_size = 0;
+    m_ordered.clear();
+}
+
+void RobotNameIndex::reserve(std::size_t count)
+{
+    const auto capacity = std::bit_ceil(std::max(minimum_capacity, count * 2));
+    if (capacity > m_entries.size())
+    {
+        rehash(capacity);
+    }
+}
+
+void RobotNameIndex::trackPrefixes(const RobotHandleTable &robots)
+{
+    if (m_tracks_prefixes)
+    {
+        return;
+    }
+    robots.forEach([this](const RobotFactory::Robot &robot)
+                   { m_ordered.emplace(robot.model(), robot.id()); });
+    m_tracks_prefixes = true;
+}
+
+bool RobotNameIndex::tracksPrefixes() const noexcept
+{
+    return m_tracks_prefixes;
+}
+
+std::size_t RobotNameIndex::size() const noexcept
+{
+    return m_size;
+}
+
+std::size_t RobotNameIndex::memoryBytes() const noexcept
+{
+    return m_entries.block().bytes + (m_ordered.size() * ordered_node_bytes);
+}
+
+std::size_t RobotNameIndex::memoryBytesFor(std::size_t count) const noexcept
+{
+    const auto ordered = m_tracks_prefixes ? count * ordered_node_bytes : 0;
+    if (count * 2 <= m_entries.size())
+    {
+        return m_entries.block().bytes + ordered;
+    }
+    // insert() doubles and reserve() rounds up to a power of two, so both land on this capacity.
+    const auto capacity = std::bit_ceil(std::max(minimum_capacity, count * 2));
+    return pageBlock(nullptr, capacity * sizeof(Entry)).bytes + ordered;
+}
+
+void RobotNameIndex::rehash(std::size_t capacity)
+{
+    const auto previous = std::exchange(m_entries, PageBuffer<Entry>{capacity});
+    for (std::size_t index = 0; index < previous.size(); ++index)
+    {
+        const auto &entry = previous.at(index);
+        if (entry.id == 0)
+        {
+            continue;
+        }
+        auto position = static_cast<std::size_t>(entry.hash) & mask();
+        while (m_entries.at(position).id != 0)
+        {
+            position = (position + 1) & mask();
+        }
+        m_entries.at(position) = entry;
+    }
+}
+
+std::size_t RobotNameIndex::mask() const noexcept
+{
+    return m_entries.size() - 1;
+}
+
+} // namespace Simulator
@@ -0,0 +1,115 @@
+#include "marvin/simulator/RobotQuery.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotHandleTable.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+// Robots evaluated per pass; the columns stay in L1.
+constexpr std::size_t block_size{256};
+
+[[nodiscard]] constexpr std::uint64_t offset(std::int64_t value) noexcept
+{
+    return static_cast<std::uint64_t>(value);
+}
+
+// Offset and span of an inclusive range, so `value - min <= span` (in unsigned arithmetic) tests
+// membership with one compare.
+template <typename Value>
+[[nodiscard]] constexpr std::uint64_t span(const FilterRange<Value> &range) noexcept
+{
+    return static_cast<std::uint64_t>(range.last) - static_cast<std::uint64_t>(range.first);
+}
+
+struct Block
+{
+    std::array<std::uint64_t, block_size> x{};
+    std::array<std::uint64_t, block_size> y{};
+    std::array<std::uint64_t, block_size> id{};
+    std::array<std::uint8_t, block_size> direction{};
+    std::array<std::uint8_t, block_size> admitted{};
+    std::array<RobotFactory::Robot *, block_size> robots{};
+    std::size_t size{0};
+};
+
+} // namespace
+
+RobotQuery::RobotQuery(const RobotFilter &filter)
+    : m_min_x{offset(filter.x.first)}, m_span_x{span(filter.x)}, m_min_y{offset(filter.y.first)},
+      m_span_y{span(filter.y)}, m_min_id{filter.id.first}, m_span_id{span(filter.id)},
+      m_directions{static_cast<std::uint8_t>(filter.directions & RobotFilter::all_directions)},
+      m_never{filter.x.empty() || filter.y.empty() || filter.id.empty() || m_directions == 0},
+      m_name_prefix{filter.name_prefix}
+{
+}
+
+void RobotQuery::select(const RobotHandleTable &robots,
+                        std::vector<RobotFactory::Robot *> &matches) const
+{
+    matches.clear();
+    if (m_never)
+    {
+        return;
+    }
+
+    Block block;
+    const auto evaluate = [this, &block, &matches]
+    {
+        // Always the whole block: a constant trip count lets the compiler drop the bounds checks
+        // and vectorise the loop. Entries past block.size are stale and ignored below.
+        for (std::size_t index = 0; index < block_size; ++index)
+        {
+            const bool in_x = block.x.at(index) - m_min_x <= m_span_x;
+            const bool in_y = block.y.at(index) - m_min_y <= m_span_y;
+            const bool in_id = block.id.at(index) - m_min_id <= m_span_id;
+            const bool facing = ((m_directions >> block.direction.at(index)) & 1U) != 0;
+            block.admitted.at(index) = static_cast<std::uint8_t>(in_x & in_y & in_id & facing);
+        }
+        for (std::size_t index = 0; index < block.size; ++index)
+        {
+            auto *robot = block.robots.at(index);
+            if (block.admitted.at(index) != 0 &&
+                (m_name_prefix.empty() || robot->model().starts_with(m_name_prefix)))
+            {
+                matches.push_back(robot);
+            }
+        }
+        block.size = 0;
+    };
+
+    robots.forEach(
+        [&block, &evaluate](RobotFactory::Robot &robot)
+        {
+            const auto location = robot.location();
+            const auto index = block.size++;
+            block.x.at(index) = offset(location.x);
+            block.y.at(index) = offset(location.y);
+            block.id.at(index) = robot.id();
+            block.direction.at(index) = static_cast<std::uint8_t>(location.direction);
+            block.robots.at(index) = &robot;
+            if (block.size == block_size)
+            {
+                evaluate();
+            }
+        });
+    evaluate();
+}
+
+bool RobotQuery::matches(const RobotFactory::Robot &robot) const
+{
+    const auto location = robot.location();
+    return !m_never && offset(location.x) - m_min_x <= m_span_x &&
+           offset(location.y) - m_min_y <= m_span_y && robot.id() - m_min_id <= m_span_id &&
+           ((m_directions >> static_cast<unsigned>(location.direction)) & 1U) != 0 &&
+           robot.model().starts_with(m_name_prefix);
+}
+
+} // namespace Simulator
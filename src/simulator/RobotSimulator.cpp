@@ -1,25 +1,51 @@
 #include "marvin/simulator/RobotSimulator.h"
 
+#include "marvin/command/BinaryCommands.h"
 #include "marvin/command/Command.h"
+#include "marvin/command/CommandPipeline.h"
 #include "marvin/robot/Robot.h"
 #include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/EventRing.h"
+#include "marvin/simulator/FixedRobotGrid.h"
+#include "marvin/simulator/Heatmap.h"
 #include "marvin/simulator/Menu.h"
+#include "marvin/simulator/RobotBehavior.h"
 #include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotGroups.h"
+#include "marvin/simulator/RobotHandleTable.h"
+#include "marvin/simulator/RobotNameIndex.h"
+#include "marvin/simulator/RobotQuery.h"
+#include "marvin/simulator/Statistics.h"
+#include "marvin/simulator/TerrainMap.h"
+#include "marvin/simulator/Tracer.h"
+#include "marvin/simulator/TrajectoryRecorder.h"
+#include "marvin/simulator/WorldHash.h"
+#include "marvin/simulator/WorldMap.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <istream>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace Simulator
 {
@@ -34,305 +60,2204 @@ namespace
     return canonical;
 }
 
+// Name given to robots created by bulk placement.
+[[nodiscard]] std::string bulkName(RobotFactory::RobotId id)
+{
+    // Sized exactly, so a name that spills to the heap holds no more than it needs.
+    std::array<char, std::numeric_limits<RobotFactory::RobotId>::digits10 + 1> digits{};
+    const auto end = std::to_chars(digits.begin(), digits.end(), id).ptr;
+    std::string name(1 + static_cast<std::size_t>(end - digits.begin()), 'R');
+    std::copy(digits.begin(), end, name.begin() + 1);
+    return name;
+}
+
+// Longest bulk name. IDs of fresh slots stay far below the small-string limit; only reused slots,
+// whose IDs carry a generation, can reach it.
+constexpr std::size_t max_bulk_name{std::numeric_limits<RobotFactory::RobotId>::digits10 + 2};
+
+// One reversible change made inside a transaction. Relocations cover both moves and rotations and
+// keep where the robot went, which settle() replays; a resize keeps the former width and height in
+// previous.x and previous.y.
+struct UndoEntry
+{
+    enum class Kind : std::uint8_t
+    {
+        Place,
+        Relocate,
+        Remove,
+        Resize
+    };
+
+    Kind kind;
+    RobotFactory::RobotId id;
+    RobotFactory::RobotLocation previous;
+    RobotFactory::RobotLocation location;
+};
+
+// Grid a simulator starts with: the default size, or a fixed grid's own.
+template <typename Grid> [[nodiscard]] constexpr GridSize initialSize() noexcept
+{
+    if constexpr (std::is_same_v<Grid, RobotGrid>)
+    {
+        return default_grid_size;
+    }
+    else
+    {
+        return Grid::dimensions;
+    }
+}
+
 } // namespace
 
-class RobotSimulator::Impl
+template <GridStorage Grid>
+class BasicRobotSimulator<Grid>::Impl final : public BehaviorWorld
+{
+  public:
+    Impl(GridSize size, GridLayout layout)
+        : grid{size, layout}, hash{gridHash(size)}, behaviors{*this}
+    {
+    }
+
+    [[nodiscard]] bool moveRobot(RobotFactory::RobotId id, std::uint32_t blocks) override
+    {
+        auto *robot = robots.find(id);
+        return robot != nullptr && move(*robot, blocks);
+    }
+
+    void rotateRobot(RobotFactory::RobotId id, RobotFactory::Rotation rotation) override
+    {
+        if (auto *robot = robots.find(id); robot != nullptr)
+        {
+            rotate(*robot, rotation);
+        }
+    }
+
+    [[nodiscard]] Cell cell(RobotFactory::RobotLocation location) const override
+    {
+        if (grid.isOffGrid(location))
+        {
+            return Cell::OffGrid;
+        }
+        return grid.isOccupied(location) ? Cell::Occupied : Cell::Free;
+    }
+
+    [[nodiscard]] bool contains(RobotFactory::RobotId id) const override
+    {
+        return robots.find(id) != nullptr;
+    }
+
+  private:
+    friend class BasicRobotSimulator;
+
+    Grid grid;
+    RobotHandleTable robots;
+    RobotNameIndex robots_by_name;
+    TerrainMap terrain;
+    SimulatorStatistics statistics;
+    std::uint64_t grid_ns{0};
+    std::uint64_t output_ns{0};
+    bool grid_stage_open{false}; // A bulk command is timing its whole loop as the grid stage.
+
+    // Open transaction: changes are applied immediately and logged so that rollback() can reverse
+    // them in O(changes). Removed robots are parked until commit() so their IDs can be restored.
+    // Moves of a single robot are the exception: the grid does not see them until settle()
+    // replays the log from `settled` on, so a run of them is checked in one pass.
+    std::vector<UndoEntry> undo_log;
+    std::size_t settled{0};
+    std::vector<RobotHandleTable::RobotPointer> removed_robots;
+    // Groups left by robots removed in the transaction, newest last.
+    std::vector<std::pair<RobotFactory::RobotId, RobotGroups::GroupId>> removed_memberships;
+    std::size_t removed_bytes{0}; // Objects and names of removed_robots.
+    bool in_transaction{false};
+    bool transaction_failed{false};
+
+    // World hash, kept current by every change; the copy taken at BEGIN is what rollback restores.
+    WorldHash hash;
+    WorldHash transaction_hash;
+    std::vector<WorldHash> hash_trail;
+    std::uint32_t hash_trail_every{0};
+    bool hash_trail_active{false};
+    std::uint64_t hash_trail_commands{0}; // Since the trail started.
+    std::uint64_t commands_executed{0};   // Since construction; trajectory ticks build on it.
+
+    // Zero means no limit. over_budget tells executeLine() that the limit rejected a command.
+    std::size_t memory_limit{0};
+    bool over_budget{false};
+
+    // Robots matched by the last WHERE clause and results of the last SCAN ALL, reused between
+    // commands.
+    std::vector<RobotFactory::Robot *> selected;
+    std::vector<ScanResult> scanned;
+
+    RobotGroups groups;
+    RobotTarget resolved; // Group targets built by resolve(), reused between commands.
+
+    // Published to only while something is subscribed.
+    EventRing events;
+    Heatmap heatmap;
+    TrajectoryRecorder trajectory;
+    std::uint64_t behavior_ticks{0};
+
+    // Declared last so that behaviours are destroyed while their robots still exist.
+    BehaviorScheduler behaviors;
+
+    [[nodiscard]] RobotFactory::Robot *find(std::string_view name)
+    {
+        auto *robot = robots.find(robots_by_name.find(name, robots));
+        statistics.countLookup(robot != nullptr);
+        return robot;
+    }
+
+    [[nodiscard]] const RobotFactory::Robot *find(std::string_view name) const
+    {
+        return robots.find(robots_by_name.find(name, robots));
+    }
+
+    [[nodiscard]] RobotFactory::Robot *find(RobotFactory::RobotId id)
+    {
+        auto *robot = robots.find(id);
+        statistics.countLookup(robot != nullptr);
+        return robot;
+    }
+
+    [[nodiscard]] const RobotFactory::Robot *find(RobotFactory::RobotId id) const
+    {
+        return robots.find(id);
+    }
+
+    // Replaces `selected` with the robots whose names match, in name order. Only names that start
+    // with the pattern's literal prefix are visited.
+    void selectMatching(const NamePattern &pattern)
+    {
+        selected.clear();
+        robots_by_name.trackPrefixes(robots);
+        const auto visit = [this, &pattern](std::string_view name, RobotFactory::RobotId id)
+        {
+            if (pattern.matches(name))
+            {
+                selected.push_back(robots.find(id));
+            }
+        };
+        robots_by_name.forEachPrefixed(pattern.prefix(), visit);
+    }
+
+    // A target naming a group that no robot shares a name with becomes the group.
+    [[nodiscard]] const RobotTarget &resolve(const RobotTarget &target)
+    {
+        const auto *name = std::get_if<std::string>(&target.value);
+        if (name == nullptr || groups.empty() || !groups.find(*name) ||
+            robots_by_name.find(*name, robots) != 0)
+        {
+            return target;
+        }
+        resolved.value = GroupName{*name};
+        return resolved;
+    }
+
+    // Replaces `selected` with the robots a target selects.
+    void select(const RobotTarget &target)
+    {
+        selected.clear();
+        const auto &resolved_target = resolve(target);
+        if (const auto *pattern = std::get_if<NamePattern>(&resolved_target.value))
+        {
+            selectMatching(*pattern);
+        }
+        else if (const auto *group = std::get_if<GroupName>(&resolved_target.value))
+        {
+            selectGroup(group->name);
+        }
+        else
+        {
+            const auto *name = std::get_if<std::string>(&resolved_target.value);
+            auto *robot = name != nullptr
+                              ? find(*name)
+                              : find(std::get<RobotFactory::RobotId>(resolved_target.value));
+            if (robot != nullptr)
+            {
+                selected.push_back(robot);
+            }
+        }
+    }
+
+    // Replaces `selected` with a group's members, for commands that change the membership.
+    void selectGroup(std::string_view name)
+    {
+        selected.clear();
+        if (const auto group = groups.find(name))
+        {
+            for (const auto id : groups.members(*group))
+            {
+                selected.push_back(robots.find(id));
+            }
+        }
+    }
+
+    // A deferred move, made only inside a transaction, is checked against the grid's edges and the
+    // terrain but not against other robots, and leaves the grid to settle().
+    [[nodiscard]] bool move(RobotFactory::Robot &robot, std::uint32_t blocks, bool deferred = false)
+    {
+        if (!deferred)
+        {
+            settle();
+        }
+        const auto previous = robot.location();
+        robot.move(blocks);
+        const bool off_grid{grid.isOffGrid(robot.location())};
+        bool occupied{false};
+        if (!deferred && !off_grid)
+        {
+            const auto stage = gridStage();
+            occupied = grid.isOccupied(robot.location());
+        }
+        if (off_grid || occupied)
+        {
+            const auto blocker = occupied && events.active() ? grid.robotIdAt(robot.location()) : 0;
+            if (off_grid)
+            {
+                statistics.countOffGrid();
+            }
+            else
+            {
+                statistics.countCollision();
+            }
+            if (occupied && heatmap.active())
+            {
+                heatmap.countBlocked(robot.location());
+            }
+            robot.setLocation(previous);
+            if (events.active())
+            {
+                emit(off_grid ? EventKind::OffGrid : EventKind::Collided, robot, blocker);
+            }
+            return false;
+        }
+        if (terrain.empty())
+        {
+            statistics.countTerrainCost(blocks);
+        }
+        else if (const auto cost = terrain.pathCost(previous, robot.location()))
+        {
+            statistics.countTerrainCost(*cost);
+        }
+        else
+        {
+            statistics.countObstacle();
+            if (heatmap.active())
+            {
+                heatmap.countBlocked(robot.location());
+            }
+            robot.setLocation(previous);
+            if (events.active())
+            {
+                emit(EventKind::Obstructed, robot);
+            }
+            return false;
+        }
+        if (deferred)
+        {
+            recordRelocate(robot, previous, true);
+        }
+        else
+        {
+            if (heatmap.active())
+            {
+                heatmap.countVisit(robot.location());
+            }
+            grid.updateLocation(previous, robot);
+            recordRelocate(robot, previous);
+            behaviors.vacated(previous);
+        }
+        if (events.active())
+        {
+            emit(EventKind::Moved, robot);
+        }
+        return true;
+    }
+
+    void emit(EventKind kind, const RobotFactory::Robot &robot,
+              RobotFactory::RobotId other = 0) noexcept
+    {
+        events.publish({.kind = kind,
+                        .count = 0,
+                        .id = robot.id(),
+                        .other = other,
+                        .location = robot.location()});
+    }
+
+    [[nodiscard]] bool isBlocked(RobotFactory::RobotLocation location) const noexcept
+    {
+        return !terrain.empty() && terrain.at(location) == terrain_blocked;
+    }
+
+    void rotate(RobotFactory::Robot &robot, RobotFactory::Rotation rotation)
+    {
+        const auto previous = robot.location();
+        robot.rotate(rotation);
+        recordRelocate(robot, previous);
+        if (events.active())
+        {
+            emit(EventKind::Rotated, robot);
+        }
+    }
+
+    // Times grid checks: on its own for a single robot, or as part of an enclosing bulk loop.
+    [[nodiscard]] NestedStage gridStage() noexcept
+    {
+        return NestedStage{grid_ns, grid_stage_open};
+    }
+
+    [[nodiscard]] bool addToGrid(const RobotFactory::Robot &robot)
+    {
+        settle();
+        const auto stage = gridStage();
+        if (isBlocked(robot.location()))
+        {
+            statistics.countObstacle();
+            return false;
+        }
+        if (grid.addRobot(robot))
+        {
+            return true;
+        }
+        if (grid.isOffGrid(robot.location()))
+        {
+            statistics.countOffGrid();
+        }
+        else
+        {
+            statistics.countCollision();
+        }
+        return false;
+    }
+
+    [[nodiscard]] MemoryUsage memoryUsage() const noexcept
+    {
+        return {.grid = grid.memoryBytes(),
+                .robots = robots.robotBytes(),
+                .ids = robots.memoryBytes(),
+                .names = robots_by_name.memoryBytes(),
+                .strings = robots.nameBytes(),
+                .terrain = terrain.memoryBytes(),
+                .transaction =
+                    removed_bytes + (undo_log.capacity() * sizeof(UndoEntry)) +
+                    (removed_robots.capacity() * sizeof(removed_robots.front())) +
+                    (removed_memberships.capacity() * sizeof(removed_memberships.front())),
+                .events = events.memoryBytes(),
+                .heatmap = heatmap.memoryBytes(),
+                .groups = groups.memoryBytes(),
+                .trajectory = trajectory.memoryBytes()};
+    }
+
+    // Whether a change leaving `usage` behind stays within the limit. A rejection is remembered
+    // for executeLine().
+    [[nodiscard]] bool fitsLimit(const MemoryUsage &usage)
+    {
+        const bool fits = memory_limit == 0 || usage.total() <= memory_limit;
+        over_budget |= !fits;
+        return fits;
+    }
+
+    // Usage after `count` more robots with `name_bytes` of heap names are placed, counting the
+    // growth of both indexes.
+    [[nodiscard]] MemoryUsage placementUsage(MemoryUsage usage, RobotFactory::GroundRobotType type,
+                                             std::size_t count, std::size_t name_bytes) const
+    {
+        usage.robots += count * RobotFactory::RobotAssembly::footprint(type);
+        usage.strings += name_bytes;
+        usage.ids = robots.memoryBytesFor(robots.size() + count);
+        usage.names = robots_by_name.memoryBytesFor(robots.size() + count);
+        return usage;
+    }
+
+    // Upper bound on the heap bytes of `count` bulk names; see max_bulk_name.
+    [[nodiscard]] std::size_t bulkNameBytes(std::size_t count) const noexcept
+    {
+        const auto reused = std::min(count, robots.capacity() - robots.size());
+        return reused * RobotHandleTable::nameBytes(max_bulk_name);
+    }
+
+    // Places up to `count` robots at locations drawn from `next`, giving up after `attempts`
+    // candidates. Containers are reserved once for the whole batch, and the whole batch must fit
+    // the memory limit.
+    template <typename Next>
+    [[nodiscard]] std::size_t placeBatch(RobotFactory::GroundRobotType type, std::size_t count,
+                                         std::size_t attempts, Next &&next)
+    {
+        const auto size = grid.size();
+        const auto cells = static_cast<std::size_t>(size.width) *
+                           static_cast<std::size_t>(size.height);
+        const auto expected = std::min(count, cells - std::min(cells, robots.size()));
+        if (memory_limit != 0 &&
+            !fitsLimit(placementUsage(memoryUsage(), type, expected, bulkNameBytes(expected))))
+        {
+            return 0;
+        }
+        settle();
+        robots.reserve(robots.size() + expected);
+        robots_by_name.reserve(robots.size() + expected);
+        const EventBatch batch{events};
+
+        // Robots are built and put on the grid a chunk at a time, then named together so that the
+        // name index can overlap its cache misses.
+        constexpr std::size_t chunk{256};
+        std::array<RobotFactory::RobotId, chunk> built{};
+        std::vector<RobotFactory::RobotId> clashes;
+        std::size_t placed{0};
+        for (std::size_t attempt = 0; placed < count && attempt < attempts;)
+        {
+            std::size_t size{0};
+            for (; size < chunk && placed + size < count && attempt < attempts; ++attempt)
+            {
+                const RobotFactory::RobotLocation location = next();
+                if (grid.isOffGrid(location) || grid.isOccupied(location) || isBlocked(location))
+                {
+                    continue;
+                }
+                const auto id = robots.acquire();
+                static_cast<void>(grid.addRobot(robots.emplace(id, type, location, bulkName(id))));
+                built.at(size++) = id;
+            }
+            const auto ids = std::span{built}.first(size);
+            robots_by_name.insertAll(ids, robots, clashes);
+            // Only an explicitly placed robot named R<digits> can clash with a generated name. The
+            // robot keeps its cell under the next ID, which carries a new generation.
+            for (const auto clash : clashes)
+            {
+                auto &id = *std::ranges::find(ids, clash);
+                const auto location = robots.find(id)->location();
+                do
+                {
+                    robots.release(id);
+                    id = robots.acquire();
+                } while (!robots_by_name.insert(robots.emplace(id, type, location, bulkName(id)),
+                                                robots));
+                grid.updateLocation(location, *robots.find(id));
+            }
+            clashes.clear();
+            for (const auto id : ids)
+            {
+                if (const auto *robot = robots.find(id); robot != nullptr)
+                {
+                    recordPlace(*robot);
+                    ++placed;
+                }
+            }
+        }
+        return placed;
+    }
+
+    // Drops every robot and starts over on an empty grid of `size`, outside a transaction.
+    void clear(GridSize size)
+    {
+        robots_by_name.clear();
+        robots.clear();
+        groups.clearMembers();
+        if constexpr (std::is_same_v<Grid, RobotGrid>)
+        {
+            const bool tracks_line_of_sight = grid.tracksLineOfSight();
+            grid = RobotGrid{size, grid.layout()};
+            if (tracks_line_of_sight)
+            {
+                grid.trackLineOfSight();
+            }
+        }
+        else
+        {
+            // Callers only clear a fixed grid at its own size.
+            grid.clear();
+        }
+        heatmap.resize(size);
+        hash = gridHash(size);
+        behaviors.detachAll();
+        if (events.active())
+        {
+            events.publish(
+                {.kind = EventKind::Cleared, .count = 0, .id = 0, .other = 0, .location = {}});
+        }
+    }
+
+    void recordCommand(std::size_t verb, std::uint64_t parse_ns, std::uint64_t dispatch_start)
+    {
+        if constexpr (statistics_enabled)
+        {
+            const auto dispatch = timestamp() - dispatch_start;
+            const auto nested = std::min(dispatch, grid_ns + output_ns);
+            statistics.record(verb, {parse_ns, dispatch - nested, grid_ns, output_ns});
+        }
+    }
+
+    [[nodiscard]] bool erase(RobotFactory::Robot &robot)
+    {
+        settle();
+        hash ^= robotHash(robot.id(), robot.location());
+        grid.remove(robot);
+        behaviors.detach(robot.id());
+        behaviors.vacated(robot.location());
+        robots_by_name.erase(robot);
+        const auto left = groups.leaveAll(robot.id());
+        if (events.active())
+        {
+            emit(EventKind::Removed, robot);
+        }
+        if (in_transaction)
+        {
+            const auto id = robot.id();
+            for (const auto group : left)
+            {
+                removed_memberships.emplace_back(id, group);
+            }
+            removed_bytes += robot.footprint() + RobotHandleTable::nameBytes(robot);
+            removed_robots.push_back(robots.take(id));
+            log({.kind = UndoEntry::Kind::Remove, .id = id, .previous = {}, .location = {}});
+        }
+        else
+        {
+            robots.release(robot.id());
+        }
+        return true;
+    }
+
+    // Trajectory ticks count the commands executed and the behaviour ticks run so far.
+    [[nodiscard]] std::uint64_t currentTick() const noexcept
+    {
+        return commands_executed + behavior_ticks;
+    }
+
+    void recordPlace(const RobotFactory::Robot &robot)
+    {
+        hash ^= robotHash(robot.id(), robot.location());
+        trajectory.record(currentTick(), robot.id(), robot.location());
+        if (events.active())
+        {
+            emit(EventKind::Placed, robot);
+        }
+        if (in_transaction)
+        {
+            log({.kind = UndoEntry::Kind::Place, .id = robot.id(), .previous = {}, .location = {}});
+        }
+    }
+
+    void recordRelocate(const RobotFactory::Robot &robot, RobotFactory::RobotLocation previous,
+                        bool deferred = false)
+    {
+        hash ^= robotHash(robot.id(), previous);
+        hash ^= robotHash(robot.id(), robot.location());
+        trajectory.record(currentTick(), robot.id(), robot.location());
+        if (in_transaction)
+        {
+            log({.kind = UndoEntry::Kind::Relocate,
+                 .id = robot.id(),
+                 .previous = previous,
+                 .location = robot.location()},
+                deferred);
+        }
+    }
+
+    // Appends to the undo log. A change other than a deferred move is made on a settled grid, so it
+    // leaves the log settled, unless it is a rotation behind deferred moves.
+    void log(const UndoEntry &entry, bool deferred = false)
+    {
+        const bool was_settled = settled == undo_log.size();
+        undo_log.push_back(entry);
+        if (was_settled && !deferred)
+        {
+            settled = undo_log.size();
+        }
+    }
+
+    // Replays the deferred moves against the grid in log order, so each is checked as if it had
+    // been made alone, with a single pass and without touching the robots. A collision undoes that
+    // move and the ones after it and fails the transaction. Returns false after a collision.
+    bool settle()
+    {
+        if (settled == undo_log.size())
+        {
+            return true;
+        }
+        const auto stage = gridStage();
+        constexpr std::size_t lookahead{16};
+        for (auto entry = settled; entry < undo_log.size(); ++entry)
+        {
+            if (entry + lookahead < undo_log.size())
+            {
+                grid.prefetch(undo_log[entry + lookahead].previous);
+                grid.prefetch(undo_log[entry + lookahead].location);
+            }
+            const auto &change = undo_log[entry];
+            if (change.previous.x == change.location.x && change.previous.y == change.location.y)
+            {
+                continue;
+            }
+            if (grid.isOccupied(change.location))
+            {
+                const auto blocker = events.active() ? grid.robotIdAt(change.location) : 0;
+                statistics.countCollision();
+                if (heatmap.active())
+                {
+                    heatmap.countBlocked(change.location);
+                }
+                const auto id = change.id;
+                settled = entry;
+                unwind(entry);
+                transaction_failed = true;
+                if (events.active())
+                {
+                    emit(EventKind::Collided, *robots.find(id), blocker);
+                }
+                return false;
+            }
+            grid.updateLocation(change.previous, change.location, change.id);
+            if (heatmap.active())
+            {
+                heatmap.countVisit(change.location);
+            }
+            behaviors.vacated(change.previous);
+        }
+        settled = undo_log.size();
+        return true;
+    }
+
+    // Reverses the deferred moves from `first` on, newest first. The grid never saw them, so only
+    // the robots, the hash and the observers are told.
+    void unwind(std::size_t first)
+    {
+        for (auto entry = undo_log.size(); entry-- > first;)
+        {
+            const auto &change = undo_log[entry];
+            auto &robot = *robots.find(change.id);
+            hash ^= robotHash(change.id, change.location);
+            hash ^= robotHash(change.id, change.previous);
+            robot.setLocation(change.previous);
+            trajectory.record(currentTick(), robot.id(), robot.location());
+            if (events.active())
+            {
+                const bool moved = change.location.x != change.previous.x ||
+                                   change.location.y != change.previous.y;
+                emit(moved ? EventKind::Moved : EventKind::Rotated, robot);
+            }
+        }
+        undo_log.resize(first);
+    }
+
+    void endTransaction() noexcept
+    {
+        undo_log.clear();
+        settled = 0;
+        removed_robots.clear();
+        removed_memberships.clear();
+        removed_bytes = 0;
+        in_transaction = false;
+        transaction_failed = false;
+    }
+
+    // Reverses the undo log newest first, so every entry sees the world exactly as it was just
+    // after the change it records.
+    void rollback()
+    {
+        const EventBatch batch{events};
+        unwind(settled);
+        for (auto entry = undo_log.rbegin(); entry != undo_log.rend(); ++entry)
+        {
+            switch (entry->kind)
+            {
+            case UndoEntry::Kind::Place:
+            {
+                auto &robot = *robots.find(entry->id);
+                grid.remove(robot);
+                behaviors.detach(entry->id);
+                behaviors.vacated(robot.location());
+                robots_by_name.erase(robot);
+                static_cast<void>(groups.leaveAll(entry->id));
+                if (events.active())
+                {
+                    emit(EventKind::Removed, robot);
+                }
+                robots.revert(entry->id);
+                break;
+            }
+            case UndoEntry::Kind::Relocate:
+            {
+                auto &robot = *robots.find(entry->id);
+                const auto current = robot.location();
+                robot.setLocation(entry->previous);
+                trajectory.record(currentTick(), robot.id(), robot.location());
+                const bool moved = current.x != entry->previous.x || current.y != entry->previous.y;
+                if (moved)
+                {
+                    grid.updateLocation(current, robot);
+                    behaviors.vacated(current);
+                }
+                if (events.active())
+                {
+                    emit(moved ? EventKind::Moved : EventKind::Rotated, robot);
+                }
+                break;
+            }
+            case UndoEntry::Kind::Remove:
+            {
+                auto robot = std::move(removed_robots.back());
+                removed_robots.pop_back();
+                removed_bytes -= robot->footprint() + RobotHandleTable::nameBytes(*robot);
+                const auto &restored = *robot;
+                robots.restore(entry->id, std::move(robot));
+                static_cast<void>(robots_by_name.insert(restored, robots));
+                static_cast<void>(grid.addRobot(restored));
+                trajectory.record(currentTick(), restored.id(), restored.location());
+                while (!removed_memberships.empty() &&
+                       removed_memberships.back().first == entry->id)
+                {
+                    groups.add(removed_memberships.back().second, entry->id);
+                    removed_memberships.pop_back();
+                }
+                if (events.active())
+                {
+                    emit(EventKind::Placed, restored);
+                }
+                break;
+            }
+            case UndoEntry::Kind::Resize:
+                // Robots placed or moved into the cut-off area were undone first, so this fits.
+                static_cast<void>(
+                    grid.resize({.width = entry->previous.x, .height = entry->previous.y}));
+                heatmap.resize(grid.size());
+                break;
+            }
+        }
+        hash = transaction_hash;
+        endTransaction();
+    }
+
+    void recordHashTrail()
+    {
+        ++commands_executed;
+        ++hash_trail_commands;
+        if (hash_trail_active && hash_trail_commands % hash_trail_every == 0)
+        {
+            hash_trail.push_back(hash);
+        }
+    }
+};
+
+template <GridStorage Grid>
+BasicRobotSimulator<Grid>::BasicRobotSimulator() : BasicRobotSimulator{initialSize<Grid>()} {}
+
+template <GridStorage Grid>
+BasicRobotSimulator<Grid>::BasicRobotSimulator(GridSize size, GridLayout layout)
+    : m_impl{std::make_unique<Impl>(size, layout)}
+{
+}
+
+template <GridStorage Grid> BasicRobotSimulator<Grid>::~BasicRobotSimulator() = default;
+template <GridStorage Grid>
+BasicRobotSimulator<Grid>::BasicRobotSimulator(BasicRobotSimulator &&) noexcept = default;
+template <GridStorage Grid>
+BasicRobotSimulator<Grid> &
+BasicRobotSimulator<Grid>::operator=(BasicRobotSimulator &&) noexcept = default;
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::start()
+{
+    run(std::cin, std::cout, std::cerr);
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::startInput(std::istream &input, std::ostream &output,
+                                           std::ostream &errors)
+{
+    Menu::showUsage(output);
+    std::string line;
+    if (!readBinaryHeader(input, line))
+    {
+        if (line.empty())
+        {
+            return true;
+        }
+        // The first line starts with the part of the header that it matched.
+        std::string rest;
+        std::getline(input, rest);
+        line += rest;
+        if (!executeLine(line, output, errors))
+        {
+            return false;
+        }
+        output << "> ";
+        return true;
+    }
+
+    BinaryCommandReader reader{input, BinaryCommandReader::Header::Read};
+    ParseResult parsed;
+    for (auto parse_start = timestamp(); reader.next(parsed); parse_start = timestamp())
+    {
+        const TraceSpan span{"RobotSimulator::execute"};
+        if (!execute(parsed, timestamp() - parse_start, output, errors))
+        {
+            return false;
+        }
+        output << "> ";
+    }
+    if (!reader.valid())
+    {
+        errors << "Error: the binary command stream is malformed.\n";
+    }
+    return false;
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::run(std::istream &input, std::ostream &output, std::ostream &errors)
+{
+    if (!startInput(input, output, errors))
+    {
+        return;
+    }
+    for (std::string line; std::getline(input, line);)
+    {
+        if (!executeLine(line, output, errors))
+        {
+            break;
+        }
+        output << "> ";
+    }
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::runPipelined(std::istream &input, std::ostream &output,
+                                             std::ostream &errors, unsigned parser_threads)
+{
+    if (!startInput(input, output, errors))
+    {
+        return;
+    }
+    CommandPipeline pipeline{input, parser_threads};
+    for (auto chunk = pipeline.next(); !chunk.empty(); chunk = pipeline.next())
+    {
+        for (const auto &line : chunk)
+        {
+            const TraceSpan span{"RobotSimulator::execute"};
+            if (!execute(line.result, line.parse_ns, output, errors))
+            {
+                return;
+            }
+            output << "> ";
+        }
+    }
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::executeLine(std::string_view line, std::ostream &output,
+                                            std::ostream &errors)
+{
+    const TraceSpan span{"RobotSimulator::executeLine"};
+    const auto parse_start = timestamp();
+    const auto parsed = CommandParser::parse(line);
+    return execute(parsed, timestamp() - parse_start, output, errors);
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::execute(const ParseResult &parsed, std::uint64_t parse_ns,
+                                        std::ostream &output, std::ostream &errors)
+{
+    const auto dispatch_start = timestamp();
+    m_impl->grid_ns = 0;
+    m_impl->output_ns = 0;
+    m_impl->over_budget = false;
+    // Inside a transaction, moves of a single robot are checked against the others by the next
+    // command that is neither one of them nor a rotation, which reports a collision among them.
+    const auto deferrable = [this, &parsed]
+    {
+        if (!parsed || std::holds_alternative<RotateCommand>(*parsed.command))
+        {
+            return static_cast<bool>(parsed);
+        }
+        const auto *move = std::get_if<MoveCommand>(&*parsed.command);
+        if (move == nullptr || move->where || !move->target)
+        {
+            return false;
+        }
+        const auto &target = m_impl->resolve(*move->target).value;
+        return std::holds_alternative<std::string>(target) ||
+               std::holds_alternative<RobotFactory::RobotId>(target);
+    }();
+    if (!deferrable && !m_impl->transaction_failed && !m_impl->settle())
+    {
+        const ScopedStage stage{m_impl->output_ns};
+        errors << "No robot could be moved.\n";
+    }
+    if (!parsed)
+    {
+        {
+            const ScopedStage stage{m_impl->output_ns};
+            errors << "Error: " << parsed.error << '\n';
+        }
+        m_impl->transaction_failed = m_impl->in_transaction;
+        m_impl->recordHashTrail();
+        m_impl->recordCommand(command_kind_count, parse_ns, dispatch_start);
+        return true;
+    }
+
+    // Any error dooms an open transaction; the rest of its commands are still parsed, so every
+    // syntax error is reported, but are not applied, and COMMIT rolls the whole batch back.
+    const auto fail = [this, &errors](std::string_view message)
+    {
+        const ScopedStage stage{m_impl->output_ns};
+        errors << message;
+        m_impl->transaction_failed = m_impl->in_transaction;
+    };
+    const auto running = std::visit(
+        [this, &output, &fail](const auto &command) -> bool
+        {
+            using Type = std::decay_t<decltype(command)>;
+            if constexpr (!std::is_same_v<Type, CommitCommand> &&
+                          !std::is_same_v<Type, AbortCommand> &&
+                          !std::is_same_v<Type, QuitCommand>)
+            {
+                if (m_impl->transaction_failed)
+                {
+                    return true;
+                }
+            }
+            if constexpr (std::is_same_v<Type, PlaceCommand>)
+            {
+                if (!place(RobotFactory::GroundRobotType::Bipedal, command.location, command.name))
+                {
+                    fail(m_impl->over_budget
+                             ? "Unable to place robot; the memory limit would be exceeded.\n"
+                             : "Unable to place robot; name or location is already in use.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, MoveCommand>)
+            {
+                const auto moved =
+                    command.where    ? moveWhere(*command.where, command.blocks) > 0
+                    : command.target
+                        ? std::visit([this, &command](const auto &target) -> bool
+                                     { return this->move(target, command.blocks) != 0; },
+                                     m_impl->resolve(*command.target).value)
+                                     : moveAll(command.blocks) > 0;
+                if (!moved)
+                {
+                    fail("No robot could be moved.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, RotateCommand>)
+            {
+                const auto rotated =
+                    command.where ? rotateWhere(*command.where, command.rotation) > 0
+                    : command.target
+                        ? std::visit([this, &command](const auto &target) -> bool
+                                     { return this->rotate(target, command.rotation) != 0; },
+                                     m_impl->resolve(*command.target).value)
+                        : rotateAll(command.rotation) > 0;
+                if (!rotated)
+                {
+                    fail("No matching robot was found.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, RemoveCommand>)
+            {
+                const auto removed =
+                    command.where    ? removeWhere(*command.where) > 0
+                    : command.target ? std::visit([this](const auto &target) -> bool
+                                                  { return this->remove(target) != 0; },
+                                                  m_impl->resolve(*command.target).value)
+                                     : removeAll() > 0;
+                if (!removed)
+                {
+                    fail("No matching robot was found.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, ResizeCommand>)
+            {
+                if (!resize(command.size))
+                {
+                    fail(m_impl->over_budget
+                             ? "Unable to resize; the memory limit would be exceeded.\n"
+                             : "Unable to resize; a robot would be left off the grid.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, ReportCommand>)
+            {
+                const ScopedStage stage{m_impl->output_ns};
+                if (command.where)
+                {
+                    report(output, *command.where);
+                }
+                else
+                {
+                    report(output);
+                }
+            }
+            else if constexpr (std::is_same_v<Type, MenuCommand>)
+            {
+                const ScopedStage stage{m_impl->output_ns};
+                Menu::showUsage(output);
+            }
+            else if constexpr (std::is_same_v<Type, StatsCommand>)
+            {
+                if constexpr (!statistics_enabled)
+                {
+                    fail("Statistics are disabled in this build.\n");
+                }
+                else if (command.reset)
+                {
+                    m_impl->statistics.reset();
+                }
+                else
+                {
+                    const ScopedStage stage{m_impl->output_ns};
+                    if (command.json)
+                    {
+                        m_impl->statistics.writeJson(output);
+                    }
+                    else
+                    {
+                        m_impl->statistics.writeText(output);
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, PopulateCommand>)
+            {
+                const auto placed = populate(command.count, command.pattern, command.seed);
+                if (placed < command.count)
+                {
+                    fail("Placed " + std::to_string(placed) + " of " +
+                         std::to_string(command.count) + " robots; " +
+                         (m_impl->over_budget ? "the memory limit would be exceeded.\n"
+                                              : "free cells ran out.\n"));
+                }
+            }
+            else if constexpr (std::is_same_v<Type, TraceCommand>)
+            {
+                if (command.path.empty())
+                {
+                    Tracer::stop();
+                }
+                else if (!Tracer::start(command.path, command.sample_every))
+                {
+                    fail(tracing_enabled ? "Unable to open the trace file.\n"
+                                         : "Tracing is disabled in this build.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, BeginCommand>)
+            {
+                if (!begin())
+                {
+                    fail("A transaction is already open.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, CommitCommand>)
+            {
+                if (!inTransaction())
+                {
+                    fail("No transaction is open.\n");
+                }
+                else if (!commit())
+                {
+                    fail("Transaction rolled back; a command inside it failed.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, AbortCommand>)
+            {
+                if (!abort())
+                {
+                    fail("No transaction is open.\n");
+                }
+            }
+            else if constexpr (std::is_same_v<Type, HashCommand>)
+            {
+                const ScopedStage stage{m_impl->output_ns};
+                switch (command.action)
+                {
+                case HashCommand::Action::Show:
+                    output << worldHash() << '\n';
+                    break;
+                case HashCommand::Action::ShowTrail:
+                    for (std::size_t entry = 0; entry < m_impl->hash_trail.size(); ++entry)
+                    {
+                        output << (entry + 1) * m_impl->hash_trail_every << ' '
+                               << m_impl->hash_trail.at(entry) << '\n';
+                    }
+                    break;
+                case HashCommand::Action::StartTrail:
+                    startHashTrail(command.every);
+                    break;
+                case HashCommand::Action::StopTrail:
+                    stopHashTrail();
+                    break;
+                }
+            }
+            else if constexpr (std::is_same_v<Type, ScanCommand>)
+            {
+                const auto *target = command.target ? &m_impl->resolve(*command.target) : nullptr;
+                const auto *pattern = target ? std::get_if<NamePattern>(&target->value) : nullptr;
+                const auto *group = target ? std::get_if<GroupName>(&target->value) : nullptr;
+                if (target && pattern == nullptr && group == nullptr)
+                {
+                    const auto *name = std::get_if<std::string>(&target->value);
+                    const auto distance =
+                        name != nullptr ? scan(*name)
+                                        : scan(std::get<RobotFactory::RobotId>(target->value));
+                    if (!distance)
+                    {
+                        fail("No matching robot was found.\n");
+                    }
+                    else
+                    {
+                        const ScopedStage stage{m_impl->output_ns};
+                        output << *distance << '\n';
+                    }
+                }
+                else
+                {
+                    auto &results = m_impl->scanned;
+                    if (pattern != nullptr)
+                    {
+                        scan(*pattern, results);
+                    }
+                    else if (group != nullptr)
+                    {
+                        scan(*group, results);
+                    }
+                    else
+                    {
+                        scanAll(results);
+                    }
+                    if (target && results.empty())
+                    {
+                        fail("No matching robot was found.\n");
+                    }
+                    const ScopedStage stage{m_impl->output_ns};
+                    for (const auto &result : results)
+                    {
+                        output << m_impl->robots.find(result.id)->model() << ": "
+                               << result.distance << '\n';
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, LoadMapCommand>)
+            {
+                try
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    const WorldMap map{command.path};
+                    if (!loadMap(map))
+                    {
+                        fail(m_impl->over_budget
+                                 ? "Unable to load the map: the memory limit would be exceeded.\n"
+                                 : "A map cannot be loaded inside a transaction.\n");
+                        return true;
+                    }
+                    const std::chrono::duration<double> elapsed =
+                        std::chrono::steady_clock::now() - start;
+                    const auto megabytes = static_cast<double>(map.bytes()) / 1e6;
+                    const ScopedStage stage{m_impl->output_ns};
+                    const auto flags = output.flags();
+                    const auto precision = output.precision();
+                    output << "Loaded " << map.size().width << 'x' << map.size().height
+                           << " map with " << robotCount() << " robots and "
+                           << m_impl->terrain.runCount() << " terrain runs: " << std::fixed
+                           << std::setprecision(3) << megabytes << " MB in " << elapsed.count()
+                           << " s (" << megabytes / std::max(elapsed.count(), 1e-9)
+                           << " MB/s)\n";
+                    output.flags(flags);
+                    output.precision(precision);
+                }
+                catch (const std::runtime_error &error)
+                {
+                    fail(std::string{"Unable to load the map: "} + error.what() + '\n');
+                }
+            }
+            else if constexpr (std::is_same_v<Type, MemoryCommand>)
+            {
+                if (command.action == MemoryCommand::Action::SetLimit)
+                {
+                    setMemoryLimit(command.limit);
+                }
+                else
+                {
+                    const auto usage = memoryUsage();
+                    const ScopedStage stage{m_impl->output_ns};
+                    output << "Grid: " << usage.grid << " bytes\n"
+                           << "Robots: " << usage.robots << " bytes\n"
+                           << "ID index: " << usage.ids << " bytes\n"
+                           << "Name index: " << usage.names << " bytes\n"
+                           << "Name strings: " << usage.strings << " bytes\n"
+                           << "Terrain: " << usage.terrain << " bytes\n"
+                           << "Transaction: " << usage.transaction << " bytes\n"
+                           << "Events: " << usage.events << " bytes\n"
+                           << "Heatmap: " << usage.heatmap << " bytes\n"
+                           << "Groups: " << usage.groups << " bytes\n"
+                           << "Trajectory: " << usage.trajectory << " bytes\n"
+                           << "Total: " << usage.total() << " bytes\n";
+                    if (memoryLimit() == 0)
+                    {
+                        output << "Limit: none\n";
+                    }
+                    else
+                    {
+                        output << "Limit: " << memoryLimit() << " bytes\n";
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, HeatmapCommand>)
+            {
+                using Action = HeatmapCommand::Action;
+                const auto &heatmap = m_impl->heatmap;
+                if (command.action == Action::Start)
+                {
+                    if (!startHeatmap(command.width))
+                    {
+                        fail("Unable to start the heatmap; the memory limit would be exceeded.\n");
+                    }
+                }
+                else if (command.action == Action::Stop)
+                {
+                    stopHeatmap();
+                }
+                else if (!heatmap.active())
+                {
+                    if (command.action == Action::Show)
+                    {
+                        const ScopedStage stage{m_impl->output_ns};
+                        output << "Heatmap: off\n";
+                    }
+                    else
+                    {
+                        fail("The heatmap is not running; start it with HEATMAP ON.\n");
+                    }
+                }
+                else if (command.action == Action::Reset)
+                {
+                    resetHeatmap();
+                }
+                else if (command.action == Action::Show)
+                {
+                    const ScopedStage stage{m_impl->output_ns};
+                    output << "Heatmap: "
+                           << (heatmap.width() == Heatmap::Width::Bits16 ? 16 : 32)
+                           << "-bit counters, " << heatmap.tilesInUse() << " of "
+                           << heatmap.tileCount() << " tiles in use\n";
+                    for (const auto channel : {Heatmap::Channel::Visits, Heatmap::Channel::Blocked})
+                    {
+                        output << (channel == Heatmap::Channel::Visits ? "Most visited: "
+                                                                       : "Most blocked: ");
+                        if (const auto hotspot = heatmap.hottest(channel))
+                        {
+                            output << '(' << hotspot->x << ',' << hotspot->y << "), "
+                                   << hotspot->count << " times\n";
+                        }
+                        else
+                        {
+                            output << "none\n";
+                        }
+                    }
+                }
+                else
+                {
+                    const ScopedStage stage{m_impl->output_ns};
+                    std::ofstream file{command.path, std::ios::binary};
+                    if (command.action == Action::ExportCsv)
+                    {
+                        heatmap.writeCsv(file);
+                    }
+                    else
+                    {
+                        heatmap.writePgm(file, command.channel);
+                    }
+                    if (!file.flush())
+                    {
+                        fail("Unable to write the heatmap file.\n");
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, GroupCommand>)
+            {
+                using Action = GroupCommand::Action;
+                if (command.action == Action::List)
+                {
+                    const ScopedStage stage{m_impl->output_ns};
+                    if (m_impl->groups.empty())
+                    {
+                        output << "No groups.\n";
+                    }
+                    m_impl->groups.forEach(
+                        [&output](std::string_view name, auto members)
+                        { output << name << ": " << members.size() << " robots\n"; });
+                }
+                else if (command.action == Action::Create)
+                {
+                    if (!createGroup(command.name))
+                    {
+                        fail("Unable to create the group; a robot or group has that name.\n");
+                    }
+                }
+                else if (command.action == Action::Delete)
+                {
+                    if (!deleteGroup(command.name))
+                    {
+                        fail(inTransaction() ? "Groups cannot be deleted inside a transaction.\n"
+                                             : "No such group.\n");
+                    }
+                }
+                else if (!m_impl->groups.find(command.name))
+                {
+                    fail("No such group.\n");
+                }
+                else
+                {
+                    bool found{true};
+                    for (const auto &member : command.members)
+                    {
+                        found &= addToGroup(command.name, member) != 0;
+                    }
+                    if (!found)
+                    {
+                        fail("No matching robot was found.\n");
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, RecordCommand>)
+            {
+                using Action = RecordCommand::Action;
+                const auto &trajectory = m_impl->trajectory;
+                if (command.action == Action::Start)
+                {
+                    if (!startRecording(command.path, command.chunk_records))
+                    {
+                        fail("Unable to open the recording file.\n");
+                    }
+                }
+                else if (command.action == Action::Stop)
+                {
+                    if (!trajectory.active())
+                    {
+                        fail("No recording is running.\n");
+                    }
+                    else if (!stopRecording())
+                    {
+                        fail("Unable to write the recording file.\n");
+                    }
+                }
+                else
+                {
+                    const ScopedStage stage{m_impl->output_ns};
+                    if (trajectory.active())
+                    {
+                        output << "Recording: " << trajectory.recorded() << " records, "
+                               << trajectory.bytesWritten() << " bytes written\n";
+                    }
+                    else
+                    {
+                        output << "Recording: off\n";
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<Type, QuitCommand>)
+            {
+                return false;
+            }
+            if constexpr (!std::is_same_v<Type, QuitCommand>)
+            {
+                return true;
+            }
+        },
+        *parsed.command);
+    m_impl->recordHashTrail();
+    m_impl->recordCommand(parsed.command->index(), parse_ns, dispatch_start);
+    return running;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::place(RobotFactory::GroundRobotType type,
+                                      RobotFactory::RobotLocation location, std::string_view name)
+{
+    const TraceSpan span{"RobotSimulator::place"};
+    if (name.empty() || m_impl->robots_by_name.find(name, m_impl->robots) != 0 ||
+        (!m_impl->groups.empty() && m_impl->groups.find(canonicalName(name))))
+    {
+        return false;
+    }
+    if (m_impl->memory_limit != 0 &&
+        !m_impl->fitsLimit(m_impl->placementUsage(m_impl->memoryUsage(), type, 1,
+                                                  RobotHandleTable::nameBytes(name.size()))))
+    {
+        return false;
+    }
+
+    const auto id = m_impl->robots.acquire();
+    const auto &placed = m_impl->robots.emplace(id, type, location, canonicalName(name));
+    if (!m_impl->addToGrid(placed))
+    {
+        m_impl->robots.revert(id);
+        return false;
+    }
+    if (!m_impl->robots_by_name.insert(placed, m_impl->robots))
+    {
+        // Undo the grid, then the handle, which destroys the robot and leaves its ID unused.
+        m_impl->grid.remove(placed);
+        m_impl->robots.revert(id);
+        return false;
+    }
+    m_impl->recordPlace(placed);
+    return true;
+}
+
+template <GridStorage Grid>
+std::size_t
+BasicRobotSimulator<Grid>::placeBulk(RobotFactory::GroundRobotType type,
+                                     std::span<const RobotFactory::RobotLocation> locations)
+{
+    const TraceSpan span{"RobotSimulator::placeBulk"};
+    auto location = locations.begin();
+    return m_impl->placeBatch(type, locations.size(), locations.size(),
+                              [&location] { return *location++; });
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::populate(std::size_t count, PopulationPattern pattern,
+                                                std::uint64_t seed)
+{
+    const TraceSpan span{"RobotSimulator::populate"};
+    constexpr std::size_t attempts_per_robot{4};
+    constexpr std::size_t minimum_attempts{64};
+    PopulationGenerator generator{pattern, count, m_impl->grid.size(), seed};
+    const auto attempts = count > (std::numeric_limits<std::size_t>::max() - minimum_attempts) /
+                                      attempts_per_robot
+                              ? std::numeric_limits<std::size_t>::max()
+                              : (count * attempts_per_robot) + minimum_attempts;
+    return m_impl->placeBatch(RobotFactory::GroundRobotType::Bipedal, count, attempts,
+                              [&generator] { return generator.next(); });
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::move(std::string_view name, std::uint32_t blocks)
+{
+    const TraceSpan span{"RobotSimulator::move"};
+    auto *robot = m_impl->find(name);
+    return robot != nullptr && m_impl->move(*robot, blocks, m_impl->in_transaction);
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::move(RobotFactory::RobotId id, std::uint32_t blocks)
+{
+    const TraceSpan span{"RobotSimulator::move"};
+    auto *robot = m_impl->find(id);
+    return robot != nullptr && m_impl->move(*robot, blocks, m_impl->in_transaction);
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::moveAll(std::uint32_t blocks)
+{
+    const TraceSpan span{"RobotSimulator::moveAll"};
+    const EventBatch batch{m_impl->events};
+    const auto stage = m_impl->gridStage();
+    std::size_t moved{0};
+    m_impl->robots.forEach([this, blocks, &moved](RobotFactory::Robot &robot)
+                           { moved += m_impl->move(robot, blocks) ? 1U : 0U; });
+    return moved;
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::moveWhere(const RobotFilter &filter, std::uint32_t blocks)
+{
+    const TraceSpan span{"RobotSimulator::moveWhere"};
+    const EventBatch batch{m_impl->events};
+    const auto stage = m_impl->gridStage();
+    RobotQuery{filter}.select(m_impl->robots, m_impl->selected);
+    std::size_t moved{0};
+    for (auto *robot : m_impl->selected)
+    {
+        moved += m_impl->move(*robot, blocks) ? 1U : 0U;
+    }
+    return moved;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::rotate(std::string_view name, RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotate"};
+    auto *robot = m_impl->find(name);
+    if (robot == nullptr)
+    {
+        return false;
+    }
+    m_impl->rotate(*robot, rotation);
+    return true;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::rotate(RobotFactory::RobotId id, RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotate"};
+    auto *robot = m_impl->find(id);
+    if (robot == nullptr)
+    {
+        return false;
+    }
+    m_impl->rotate(*robot, rotation);
+    return true;
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::rotateAll(RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotateAll"};
+    const EventBatch batch{m_impl->events};
+    m_impl->robots.forEach([this, rotation](RobotFactory::Robot &robot)
+                           { m_impl->rotate(robot, rotation); });
+    return m_impl->robots.size();
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::rotateWhere(const RobotFilter &filter,
+                                                   RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotateWhere"};
+    const EventBatch batch{m_impl->events};
+    RobotQuery{filter}.select(m_impl->robots, m_impl->selected);
+    for (auto *robot : m_impl->selected)
+    {
+        m_impl->rotate(*robot, rotation);
+    }
+    return m_impl->selected.size();
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::remove(std::string_view name)
+{
+    const TraceSpan span{"RobotSimulator::remove"};
+    auto *robot = m_impl->find(name);
+    return robot != nullptr && m_impl->erase(*robot);
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::remove(RobotFactory::RobotId id)
+{
+    const TraceSpan span{"RobotSimulator::remove"};
+    auto *robot = m_impl->find(id);
+    return robot != nullptr && m_impl->erase(*robot);
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::removeAll()
+{
+    const TraceSpan span{"RobotSimulator::removeAll"};
+    const EventBatch batch{m_impl->events};
+    const auto count = m_impl->robots.size();
+    if (m_impl->in_transaction)
+    {
+        std::vector<RobotFactory::Robot *> doomed;
+        doomed.reserve(count);
+        m_impl->robots.forEach([&doomed](RobotFactory::Robot &robot) { doomed.push_back(&robot); });
+        for (auto *robot : doomed)
+        {
+            static_cast<void>(m_impl->erase(*robot));
+        }
+        return count;
+    }
+    m_impl->clear(m_impl->grid.size());
+    return count;
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::move(const NamePattern &pattern, std::uint32_t blocks)
 {
-  public:
-    explicit Impl(GridSize size) : grid{size} {}
+    const TraceSpan span{"RobotSimulator::movePattern"};
+    const EventBatch batch{m_impl->events};
+    const auto stage = m_impl->gridStage();
+    m_impl->selectMatching(pattern);
+    std::size_t moved{0};
+    for (auto *robot : m_impl->selected)
+    {
+        moved += m_impl->move(*robot, blocks) ? 1U : 0U;
+    }
+    return moved;
+}
 
-  private:
-    friend class RobotSimulator;
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::rotate(const NamePattern &pattern,
+                                              RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotatePattern"};
+    const EventBatch batch{m_impl->events};
+    m_impl->selectMatching(pattern);
+    for (auto *robot : m_impl->selected)
+    {
+        m_impl->rotate(*robot, rotation);
+    }
+    return m_impl->selected.size();
+}
 
-    RobotGrid grid;
-    std::unordered_map<std::string, std::unique_ptr<RobotFactory::Robot>> robots_by_name;
-    std::unordered_map<RobotFactory::RobotId, RobotFactory::Robot *> robots_by_id;
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::remove(const NamePattern &pattern)
+{
+    const TraceSpan span{"RobotSimulator::removePattern"};
+    const EventBatch batch{m_impl->events};
+    m_impl->selectMatching(pattern);
+    for (auto *robot : m_impl->selected)
+    {
+        static_cast<void>(m_impl->erase(*robot));
+    }
+    const auto removed = m_impl->selected.size();
+    m_impl->selected.clear();
+    return removed;
+}
 
-    [[nodiscard]] RobotFactory::Robot *find(std::string_view name)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::createGroup(std::string_view name)
+{
+    auto canonical = canonicalName(name);
+    if (canonical.empty() || canonical == "ALL" || canonical.starts_with('@') ||
+        canonical.find_first_of("*?") != std::string::npos ||
+        m_impl->robots_by_name.find(canonical, m_impl->robots) != 0)
     {
-        const auto robot = robots_by_name.find(canonicalName(name));
-        return robot == robots_by_name.end() ? nullptr : robot->second.get();
+        return false;
     }
+    return m_impl->groups.create(std::move(canonical)).has_value();
+}
 
-    [[nodiscard]] const RobotFactory::Robot *find(std::string_view name) const
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::deleteGroup(std::string_view name)
+{
+    return !m_impl->in_transaction && m_impl->groups.erase(canonicalName(name));
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::addToGroup(std::string_view group, const RobotTarget &target)
+{
+    const TraceSpan span{"RobotSimulator::addToGroup"};
+    const auto joined = m_impl->groups.find(canonicalName(group));
+    if (!joined)
+    {
+        return 0;
+    }
+    m_impl->select(target);
+    for (const auto *robot : m_impl->selected)
+    {
+        m_impl->groups.add(*joined, robot->id());
+    }
+    return m_impl->selected.size();
+}
+
+template <GridStorage Grid>
+const RobotGroups &BasicRobotSimulator<Grid>::groups() const noexcept
+{
+    return m_impl->groups;
+}
+
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::move(const GroupName &group, std::uint32_t blocks)
+{
+    const TraceSpan span{"RobotSimulator::moveGroup"};
+    const auto found = m_impl->groups.find(group.name);
+    if (!found)
+    {
+        return 0;
+    }
+    const EventBatch batch{m_impl->events};
+    const auto stage = m_impl->gridStage();
+    std::size_t moved{0};
+    for (const auto id : m_impl->groups.members(*found))
     {
-        const auto robot = robots_by_name.find(canonicalName(name));
-        return robot == robots_by_name.end() ? nullptr : robot->second.get();
+        moved += m_impl->move(*m_impl->robots.find(id), blocks) ? 1U : 0U;
     }
+    return moved;
+}
 
-    [[nodiscard]] RobotFactory::Robot *find(RobotFactory::RobotId id)
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::rotate(const GroupName &group,
+                                              RobotFactory::Rotation rotation)
+{
+    const TraceSpan span{"RobotSimulator::rotateGroup"};
+    const auto found = m_impl->groups.find(group.name);
+    if (!found)
+    {
+        return 0;
+    }
+    const EventBatch batch{m_impl->events};
+    const auto members = m_impl->groups.members(*found);
+    for (const auto id : members)
     {
-        const auto robot = robots_by_id.find(id);
-        return robot == robots_by_id.end() ? nullptr : robot->second;
+        m_impl->rotate(*m_impl->robots.find(id), rotation);
     }
+    return members.size();
+}
 
-    [[nodiscard]] const RobotFactory::Robot *find(RobotFactory::RobotId id) const
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::remove(const GroupName &group)
+{
+    const TraceSpan span{"RobotSimulator::removeGroup"};
+    const EventBatch batch{m_impl->events};
+    // Each removal shrinks the group, so its members are copied out first.
+    m_impl->selectGroup(group.name);
+    for (auto *robot : m_impl->selected)
     {
-        const auto robot = robots_by_id.find(id);
-        return robot == robots_by_id.end() ? nullptr : robot->second;
+        static_cast<void>(m_impl->erase(*robot));
     }
+    const auto removed = m_impl->selected.size();
+    m_impl->selected.clear();
+    return removed;
+}
 
-    [[nodiscard]] bool move(RobotFactory::Robot &robot, std::uint32_t blocks)
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::removeWhere(const RobotFilter &filter)
+{
+    const TraceSpan span{"RobotSimulator::removeWhere"};
+    const EventBatch batch{m_impl->events};
+    RobotQuery{filter}.select(m_impl->robots, m_impl->selected);
+    for (auto *robot : m_impl->selected)
     {
-        const auto previous = robot.location();
-        robot.move(blocks);
-        if (grid.isOffGrid(robot.location()) || grid.isOccupied(robot.location()))
+        static_cast<void>(m_impl->erase(*robot));
+    }
+    const auto removed = m_impl->selected.size();
+    m_impl->selected.clear();
+    return removed;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::resize(GridSize size)
+{
+    const TraceSpan span{"RobotSimulator::resize"};
+    m_impl->settle();
+    const auto previous = m_impl->grid.size();
+    if (m_impl->memory_limit != 0)
+    {
+        auto usage = m_impl->memoryUsage();
+        usage.grid = m_impl->grid.memoryBytesAfterResize(size);
+        if (m_impl->heatmap.active())
+        {
+            usage.heatmap = m_impl->heatmap.memoryBytesAfterResize(size);
+        }
+        if (!m_impl->fitsLimit(usage))
         {
-            robot.setLocation(previous);
             return false;
         }
-        grid.updateLocation(previous, robot);
-        return true;
     }
-
-    [[nodiscard]] bool erase(RobotFactory::Robot &robot)
+    if (!m_impl->grid.resize(size))
     {
-        const auto name = canonicalName(robot.model());
-        grid.remove(robot);
-        robots_by_id.erase(robot.id());
-        return robots_by_name.erase(name) == 1;
+        return false;
     }
-};
-
-RobotSimulator::RobotSimulator() : RobotSimulator{default_grid_size} {}
-
-RobotSimulator::RobotSimulator(GridSize size) : m_impl{std::make_unique<Impl>(size)} {}
-
-RobotSimulator::~RobotSimulator() = default;
-RobotSimulator::RobotSimulator(RobotSimulator &&) noexcept = default;
-RobotSimulator &RobotSimulator::operator=(RobotSimulator &&) noexcept = default;
+    m_impl->heatmap.resize(size);
+    m_impl->hash ^= gridHash(previous);
+    m_impl->hash ^= gridHash(size);
+    if (m_impl->in_transaction)
+    {
+        m_impl->log({.kind = UndoEntry::Kind::Resize,
+                     .id = 0,
+                     .previous = {.x = previous.width, .y = previous.height},
+                     .location = {}});
+    }
+    return true;
+}
 
-void RobotSimulator::start()
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::setTerrain(TerrainMap terrain)
 {
-    run(std::cin, std::cout, std::cerr);
+    const TraceSpan span{"RobotSimulator::setTerrain"};
+    if (m_impl->in_transaction)
+    {
+        return false;
+    }
+    bool blocked{false};
+    m_impl->robots.forEach(
+        [&terrain, &blocked](const RobotFactory::Robot &robot)
+        { blocked = blocked || terrain.at(robot.location()) == terrain_blocked; });
+    if (blocked)
+    {
+        return false;
+    }
+    m_impl->terrain = std::move(terrain);
+    return true;
 }
 
-void RobotSimulator::run(std::istream &input, std::ostream &output, std::ostream &errors)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::loadMap(const WorldMap &map)
 {
-    Menu::showUsage(output);
-    for (std::string line; std::getline(input, line);)
+    const TraceSpan span{"RobotSimulator::loadMap"};
+    if (m_impl->in_transaction)
     {
-        if (!executeLine(line, output, errors))
+        return false;
+    }
+    if constexpr (!std::is_same_v<Grid, RobotGrid>)
+    {
+        // A fixed grid's resize() only checks the size.
+        if (!m_impl->grid.resize(map.size()))
         {
-            break;
+            return false;
         }
-        output << "> ";
     }
+    TerrainMap::Builder builder;
+    map.buildTerrain(builder);
+    auto terrain = std::move(builder).build();
+    const auto count = map.robotCount();
+    if (m_impl->memory_limit != 0)
+    {
+        // The world after the load: a new grid and terrain, the map's robots, and indexes that
+        // keep what clear() leaves them.
+        const auto &grid = m_impl->grid;
+        const auto &robots = m_impl->robots;
+        const auto reused = std::min(count, robots.capacity());
+        const MemoryUsage loaded{
+            .grid = Grid::memoryBytesFor(map.size(), grid.layout(), grid.tracksLineOfSight()),
+            .robots = count * RobotFactory::RobotAssembly::footprint(
+                                  RobotFactory::GroundRobotType::Bipedal),
+            .ids = robots.memoryBytesFor(count),
+            .names = m_impl->robots_by_name.memoryBytesFor(count),
+            .strings = reused * RobotHandleTable::nameBytes(max_bulk_name),
+            .terrain = terrain.memoryBytes(),
+            .transaction = 0,
+            .events = m_impl->events.memoryBytes(),
+            .heatmap = m_impl->heatmap.active() ? Heatmap::memoryBytesFor(map.size()) : 0,
+            .groups = m_impl->groups.memoryBytes(),
+            .trajectory = m_impl->trajectory.memoryBytes()};
+        if (!m_impl->fitsLimit(loaded))
+        {
+            return false;
+        }
+    }
+    if (m_impl->heatmap.active())
+    {
+        m_impl->heatmap.start(map.size(), m_impl->heatmap.width());
+    }
+    m_impl->clear(map.size());
+    m_impl->terrain = std::move(terrain);
+    WorldMap::RobotCursor markers{map};
+    static_cast<void>(m_impl->placeBatch(RobotFactory::GroundRobotType::Bipedal, count, count,
+                                         [&markers] { return markers.next().value(); }));
+    return true;
 }
 
-bool RobotSimulator::executeLine(std::string_view line, std::ostream &output, std::ostream &errors)
+template <GridStorage Grid>
+const TerrainMap &BasicRobotSimulator<Grid>::terrain() const noexcept
 {
-    const auto parsed = CommandParser::parse(line);
-    if (!parsed)
+    return m_impl->terrain;
+}
+
+template <GridStorage Grid>
+std::optional<RobotFactory::Coordinate> BasicRobotSimulator<Grid>::scan(std::string_view name)
+{
+    const TraceSpan span{"RobotSimulator::scan"};
+    m_impl->settle();
+    const auto *robot = m_impl->find(name);
+    if (robot == nullptr)
     {
-        errors << "Error: " << parsed.error << '\n';
-        return true;
+        return std::nullopt;
     }
+    m_impl->grid.trackLineOfSight();
+    return m_impl->grid.clearance(robot->location());
+}
 
-    return std::visit(
-        [this, &output, &errors](const auto &command) -> bool
-        {
-            using Type = std::decay_t<decltype(command)>;
-            if constexpr (std::is_same_v<Type, PlaceCommand>)
-            {
-                if (!place(RobotFactory::GroundRobotType::Bipedal, command.location, command.name))
-                {
-                    errors << "Unable to place robot; name or location is already in use.\n";
-                }
-            }
-            else if constexpr (std::is_same_v<Type, MoveCommand>)
-            {
-                const auto moved = command.target
-                                       ? std::visit([this, &command](const auto &target)
-                                                    { return this->move(target, command.blocks); },
-                                                    command.target->value)
-                                       : moveAll(command.blocks) > 0;
-                if (!moved)
-                {
-                    errors << "No robot could be moved.\n";
-                }
-            }
-            else if constexpr (std::is_same_v<Type, RotateCommand>)
-            {
-                const auto rotated =
-                    command.target ? std::visit([this, &command](const auto &target)
-                                                { return this->rotate(target, command.rotation); },
-                                                command.target->value)
-                                   : rotateAll(command.rotation) > 0;
-                if (!rotated)
-                {
-                    errors << "No matching robot was found.\n";
-                }
-            }
-            else if constexpr (std::is_same_v<Type, RemoveCommand>)
-            {
-                const auto removed = command.target ? std::visit([this](const auto &target)
-                                                                 { return this->remove(target); },
-                                                                 command.target->value)
-                                                    : removeAll() > 0;
-                if (!removed)
-                {
-                    errors << "No matching robot was found.\n";
-                }
-            }
-            else if constexpr (std::is_same_v<Type, ResizeCommand>)
-            {
-                if (!resize(command.size))
-                {
-                    errors << "Grid dimensions cannot shrink.\n";
-                }
-            }
-            else if constexpr (std::is_same_v<Type, ReportCommand>)
-            {
-                report(output);
-            }
-            else if constexpr (std::is_same_v<Type, MenuCommand>)
-            {
-                Menu::showUsage(output);
-            }
-            else if constexpr (std::is_same_v<Type, QuitCommand>)
-            {
-                return false;
-            }
-            if constexpr (!std::is_same_v<Type, QuitCommand>)
-            {
-                return true;
-            }
-        },
-        *parsed.command);
+template <GridStorage Grid>
+std::optional<RobotFactory::Coordinate> BasicRobotSimulator<Grid>::scan(RobotFactory::RobotId id)
+{
+    const TraceSpan span{"RobotSimulator::scan"};
+    m_impl->settle();
+    const auto *robot = m_impl->find(id);
+    if (robot == nullptr)
+    {
+        return std::nullopt;
+    }
+    m_impl->grid.trackLineOfSight();
+    return m_impl->grid.clearance(robot->location());
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::scanAll(std::vector<ScanResult> &results)
+{
+    const TraceSpan span{"RobotSimulator::scanAll"};
+    m_impl->settle();
+    m_impl->grid.trackLineOfSight();
+    results.clear();
+    results.reserve(m_impl->robots.size());
+    const auto &grid = m_impl->grid;
+    m_impl->robots.forEach(
+        [&grid, &results](const RobotFactory::Robot &robot)
+        { results.push_back({.id = robot.id(), .distance = grid.clearance(robot.location())}); });
 }
 
-bool RobotSimulator::place(RobotFactory::GroundRobotType type, RobotFactory::RobotLocation location,
-                           std::string_view name)
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::scan(const NamePattern &pattern, std::vector<ScanResult> &results)
 {
-    const std::string key = canonicalName(name);
-    if (key.empty() || m_impl->robots_by_name.contains(key))
+    const TraceSpan span{"RobotSimulator::scanPattern"};
+    m_impl->settle();
+    m_impl->grid.trackLineOfSight();
+    m_impl->selectMatching(pattern);
+    results.clear();
+    for (const auto *robot : m_impl->selected)
     {
-        return false;
+        results.push_back(
+            {.id = robot->id(), .distance = m_impl->grid.clearance(robot->location())});
+    }
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::scan(const GroupName &group, std::vector<ScanResult> &results)
+{
+    const TraceSpan span{"RobotSimulator::scanGroup"};
+    m_impl->settle();
+    results.clear();
+    const auto found = m_impl->groups.find(group.name);
+    if (!found)
+    {
+        return;
     }
+    m_impl->grid.trackLineOfSight();
+    for (const auto id : m_impl->groups.members(*found))
+    {
+        results.push_back(
+            {.id = id, .distance = m_impl->grid.clearance(m_impl->robots.find(id)->location())});
+    }
+}
 
-    auto robot = RobotFactory::RobotAssembly::create(type, location, key);
-    if (!robot || !m_impl->grid.addRobot(*robot))
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::attach(RobotFactory::RobotId id, RobotBehavior behavior)
+{
+    if (m_impl->robots.find(id) == nullptr)
     {
         return false;
     }
-    auto *raw_robot = robot.get();
-    m_impl->robots_by_id.emplace(robot->id(), raw_robot);
-    m_impl->robots_by_name.emplace(key, std::move(robot));
+    m_impl->behaviors.attach(id, std::move(behavior));
     return true;
 }
 
-bool RobotSimulator::move(std::string_view name, std::uint32_t blocks)
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::tick()
 {
-    auto *robot = m_impl->find(name);
-    return robot != nullptr && m_impl->move(*robot, blocks);
+    const TraceSpan span{"RobotSimulator::tick"};
+    m_impl->settle();
+    const EventBatch batch{m_impl->events};
+    const auto stage = m_impl->gridStage();
+    const auto resumed = m_impl->behaviors.tick();
+    ++m_impl->behavior_ticks;
+    return resumed;
 }
 
-bool RobotSimulator::move(RobotFactory::RobotId id, std::uint32_t blocks)
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::behaviorCount() const noexcept
 {
-    auto *robot = m_impl->find(id);
-    return robot != nullptr && m_impl->move(*robot, blocks);
+    return m_impl->behaviors.size();
 }
 
-std::size_t RobotSimulator::moveAll(std::uint32_t blocks)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::begin()
 {
-    std::size_t moved{0};
-    for (auto &[name, robot] : m_impl->robots_by_name)
+    const TraceSpan span{"RobotSimulator::begin"};
+    if (m_impl->in_transaction)
     {
-        static_cast<void>(name);
-        moved += m_impl->move(*robot, blocks) ? 1U : 0U;
+        return false;
     }
-    return moved;
+    m_impl->in_transaction = true;
+    m_impl->transaction_hash = m_impl->hash;
+    return true;
 }
 
-bool RobotSimulator::rotate(std::string_view name, RobotFactory::Rotation rotation)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::commit()
 {
-    auto *robot = m_impl->find(name);
-    if (robot == nullptr)
+    const TraceSpan span{"RobotSimulator::commit"};
+    if (!m_impl->in_transaction)
+    {
+        return false;
+    }
+    if (m_impl->transaction_failed || !m_impl->settle())
     {
+        m_impl->rollback();
         return false;
     }
-    robot->rotate(rotation);
+    m_impl->endTransaction();
     return true;
 }
 
-bool RobotSimulator::rotate(RobotFactory::RobotId id, RobotFactory::Rotation rotation)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::abort()
 {
-    auto *robot = m_impl->find(id);
-    if (robot == nullptr)
+    const TraceSpan span{"RobotSimulator::abort"};
+    if (!m_impl->in_transaction)
     {
         return false;
     }
-    robot->rotate(rotation);
+    m_impl->rollback();
     return true;
 }
 
-std::size_t RobotSimulator::rotateAll(RobotFactory::Rotation rotation)
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::inTransaction() const noexcept
+{
+    return m_impl->in_transaction;
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::report(std::ostream &output) const
+{
+    const TraceSpan span{"RobotSimulator::report"};
+    const auto size = m_impl->grid.size();
+    output << "Grid: " << size.width << 'x' << size.height
+           << "\nRobots: " << m_impl->robots.size() << '\n';
+    m_impl->robots.forEach([&output](const RobotFactory::Robot &robot)
+                           { Menu::showDetails(robot, output); });
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::report(std::ostream &output, const RobotFilter &filter) const
 {
-    for (auto &[name, robot] : m_impl->robots_by_name)
+    const TraceSpan span{"RobotSimulator::report"};
+    std::vector<RobotFactory::Robot *> matches;
+    RobotQuery{filter}.select(m_impl->robots, matches);
+    const auto size = m_impl->grid.size();
+    output << "Grid: " << size.width << 'x' << size.height << "\nRobots: " << matches.size()
+           << " of " << m_impl->robots.size() << '\n';
+    for (const auto *robot : matches)
     {
-        static_cast<void>(name);
-        robot->rotate(rotation);
+        Menu::showDetails(*robot, output);
     }
-    return m_impl->robots_by_name.size();
 }
 
-bool RobotSimulator::remove(std::string_view name)
+template <GridStorage Grid>
+const RobotFactory::Robot *BasicRobotSimulator<Grid>::findRobot(std::string_view name) const
 {
-    auto *robot = m_impl->find(name);
-    return robot != nullptr && m_impl->erase(*robot);
+    return m_impl->find(name);
 }
 
-bool RobotSimulator::remove(RobotFactory::RobotId id)
+template <GridStorage Grid>
+const RobotFactory::Robot *BasicRobotSimulator<Grid>::findRobot(RobotFactory::RobotId id) const
 {
-    auto *robot = m_impl->find(id);
-    return robot != nullptr && m_impl->erase(*robot);
+    return m_impl->find(id);
 }
 
-std::size_t RobotSimulator::removeAll()
+template <GridStorage Grid>
+GridSize BasicRobotSimulator<Grid>::gridSize() const noexcept
 {
-    const auto count = m_impl->robots_by_name.size();
-    m_impl->robots_by_id.clear();
-    m_impl->robots_by_name.clear();
-    m_impl->grid = RobotGrid{m_impl->grid.size()};
-    return count;
+    return m_impl->grid.size();
 }
 
-bool RobotSimulator::resize(GridSize size)
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::robotCount() const noexcept
 {
-    return m_impl->grid.resize(size);
+    return m_impl->robots.size();
 }
 
-void RobotSimulator::report(std::ostream &output) const
+template <GridStorage Grid>
+const SimulatorStatistics &BasicRobotSimulator<Grid>::statistics() const noexcept
 {
-    const auto size = m_impl->grid.size();
-    output << "Grid: " << size.width << 'x' << size.height
-           << "\nRobots: " << m_impl->robots_by_name.size() << '\n';
-    for (const auto &[name, robot] : m_impl->robots_by_name)
+    return m_impl->statistics;
+}
+
+template <GridStorage Grid>
+EventRing &BasicRobotSimulator<Grid>::events() noexcept
+{
+    return m_impl->events;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::startRecording(const std::filesystem::path &path,
+                                               std::size_t chunk_records)
+{
+    return m_impl->trajectory.start(path, chunk_records);
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::startRecording(std::ostream &output, std::size_t chunk_records)
+{
+    m_impl->trajectory.start(output, chunk_records);
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::stopRecording()
+{
+    return m_impl->trajectory.stop();
+}
+
+template <GridStorage Grid>
+const TrajectoryRecorder &BasicRobotSimulator<Grid>::trajectory() const noexcept
+{
+    return m_impl->trajectory;
+}
+
+template <GridStorage Grid>
+bool BasicRobotSimulator<Grid>::startHeatmap(Heatmap::Width width)
+{
+    const TraceSpan span{"RobotSimulator::startHeatmap"};
+    auto usage = m_impl->memoryUsage();
+    usage.heatmap = Heatmap::memoryBytesFor(m_impl->grid.size());
+    if (!m_impl->fitsLimit(usage))
     {
-        static_cast<void>(name);
-        Menu::showDetails(*robot, output);
+        return false;
     }
+    m_impl->heatmap.start(m_impl->grid.size(), width);
+    return true;
 }
 
-const RobotFactory::Robot *RobotSimulator::findRobot(std::string_view name) const
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::stopHeatmap() noexcept
 {
-    return m_impl->find(name);
+    m_impl->heatmap.stop();
 }
 
-const RobotFactory::Robot *RobotSimulator::findRobot(RobotFactory::RobotId id) const
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::resetHeatmap() noexcept
 {
-    return m_impl->find(id);
+    m_impl->heatmap.reset();
 }
 
-GridSize RobotSimulator::gridSize() const noexcept
+template <GridStorage Grid>
+const Heatmap &BasicRobotSimulator<Grid>::heatmap() const noexcept
 {
-    return m_impl->grid.size();
+    return m_impl->heatmap;
+}
+
+template <GridStorage Grid>
+MemoryUsage BasicRobotSimulator<Grid>::memoryUsage() const noexcept
+{
+    return m_impl->memoryUsage();
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::setMemoryLimit(std::size_t bytes) noexcept
+{
+    m_impl->memory_limit = bytes;
 }
 
-std::size_t RobotSimulator::robotCount() const noexcept
+template <GridStorage Grid>
+std::size_t BasicRobotSimulator<Grid>::memoryLimit() const noexcept
 {
-    return m_impl->robots_by_name.size();
+    return m_impl->memory_limit;
 }
 
+template <GridStorage Grid>
+WorldHash BasicRobotSimulator<Grid>::worldHash() const noexcept
+{
+    return m_impl->hash;
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::startHashTrail(std::uint32_t every)
+{
+    m_impl->hash_trail.clear();
+    m_impl->hash_trail_every = every == 0 ? 1 : every;
+    m_impl->hash_trail_active = true;
+    m_impl->hash_trail_commands = 0;
+}
+
+template <GridStorage Grid>
+void BasicRobotSimulator<Grid>::stopHashTrail() noexcept
+{
+    m_impl->hash_trail_active = false;
+}
+
+template <GridStorage Grid>
+std::span<const WorldHash> BasicRobotSimulator<Grid>::hashTrail() const noexcept
+{
+    return m_impl->hash_trail;
+}
+
+template <GridStorage Grid>
+std::uint32_t BasicRobotSimulator<Grid>::hashTrailInterval() const noexcept
+{
+    return m_impl->hash_trail_every;
+}
+
+template class BasicRobotSimulator<RobotGrid>;
+template class BasicRobotSimulator<FixedRobotGrid<10, 10>>;
+template class BasicRobotSimulator<FixedRobotGrid<1000, 1000>>;
+
 } // namespace Simulator
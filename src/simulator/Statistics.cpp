@@ -0,0 +1,213 @@
+#include "marvin/simulator/Statistics.h"
+
+#include "marvin/command/Command.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::uint64_t sub_bucket_bits{3};
+constexpr std::uint64_t sub_bucket_count{std::uint64_t{1} << sub_bucket_bits};
+constexpr std::uint64_t max_exponent{40};
+constexpr std::size_t bucket_count{sub_bucket_count +
+                                   ((max_exponent - sub_bucket_bits + 1) * sub_bucket_count)};
+
+constexpr std::array<std::string_view, stage_count> stage_names{"parse", "dispatch", "grid",
+                                                                "output"};
+
+[[nodiscard]] std::size_t bucketIndex(std::uint64_t value) noexcept
+{
+    if (value < sub_bucket_count)
+    {
+        return static_cast<std::size_t>(value);
+    }
+    const auto exponent = static_cast<std::uint64_t>(std::bit_width(value)) - 1;
+    if (exponent > max_exponent)
+    {
+        return bucket_count - 1;
+    }
+    const auto shift = exponent - sub_bucket_bits;
+    const auto sub_bucket = (value >> shift) - sub_bucket_count;
+    return static_cast<std::size_t>(sub_bucket_count + (shift * sub_bucket_count) + sub_bucket);
+}
+
+[[nodiscard]] std::uint64_t bucketUpperBound(std::size_t bucket) noexcept
+{
+    if (bucket < sub_bucket_count)
+    {
+        return bucket;
+    }
+    const auto shift = (bucket - sub_bucket_count) / sub_bucket_count;
+    const auto sub_bucket = (bucket - sub_bucket_count) % sub_bucket_count;
+    const auto lower = (sub_bucket_count + sub_bucket) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+void writeTextRow(std::ostream &output, std::string_view verb, std::uint64_t count,
+                  std::string_view stage, const LatencyHistogram &histogram)
+{
+    output << std::left << std::setw(10) << verb << std::right << std::setw(10) << count << "  "
+           << std::left << std::setw(10) << stage << std::right << std::setw(12)
+           << histogram.percentile(0.50) << std::setw(12) << histogram.percentile(0.99)
+           << std::setw(12) << histogram.percentile(0.999) << std::setw(12) << histogram.max()
+           << '\n';
+}
+
+} // namespace
+
+void LatencyHistogram::record(std::uint64_t nanoseconds)
+{
+    if (m_buckets.empty())
+    {
+        m_buckets.resize(bucket_count);
+    }
+    ++m_buckets.at(bucketIndex(nanoseconds));
+    ++m_count;
+    m_max = std::max(m_max, nanoseconds);
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    std::ranges::fill(m_buckets, 0);
+    m_count = 0;
+    m_max = 0;
+}
+
+std::uint64_t LatencyHistogram::count() const noexcept
+{
+    return m_count;
+}
+
+std::uint64_t LatencyHistogram::max() const noexcept
+{
+    return m_max;
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const noexcept
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_count))));
+    std::uint64_t seen{0};
+    for (std::size_t bucket = 0; bucket < m_buckets.size(); ++bucket)
+    {
+        seen += m_buckets.at(bucket);
+        if (seen >= rank)
+        {
+            return std::min(bucketUpperBound(bucket), m_max);
+        }
+    }
+    return m_max;
+}
+
+SimulatorStatistics::SimulatorStatistics() : m_commands(command_kind_count + 1) {}
+
+void SimulatorStatistics::record(std::size_t verb,
+                                 const std::array<std::uint64_t, stage_count> &stages)
+{
+    if constexpr (statistics_enabled)
+    {
+        auto &command = m_commands.at(std::min(verb, command_kind_count));
+        ++command.count;
+        for (std::size_t stage = 0; stage < stage_count; ++stage)
+        {
+            command.latency.at(stage).record(stages.at(stage));
+        }
+    }
+}
+
+void SimulatorStatistics::reset()
+{
+    for (auto &command : m_commands)
+    {
+        command.count = 0;
+        for (auto &histogram : command.latency)
+        {
+            histogram.reset();
+        }
+    }
+    m_counters = {};
+}
+
+const CommandStatistics &SimulatorStatistics::command(std::size_t verb) const
+{
+    return m_commands.at(std::min(verb, command_kind_count));
+}
+
+const SimulatorCounters &SimulatorStatistics::counters() const noexcept
+{
+    return m_counters;
+}
+
+void SimulatorStatistics::writeText(std::ostream &output) const
+{
+    output << std::left << std::setw(10) << "Command" << std::right << std::setw(10) << "Count"
+           << "  " << std::left << std::setw(10) << "Stage" << std::right << std::setw(12)
+           << "p50 ns" << std::setw(12) << "p99 ns" << std::setw(12) << "p999 ns"
+           << std::setw(12) << "max ns" << '\n';
+    for (std::size_t verb = 0; verb < m_commands.size(); ++verb)
+    {
+        const auto &command = m_commands.at(verb);
+        if (command.count == 0)
+        {
+            continue;
+        }
+        for (std::size_t stage = 0; stage < stage_count; ++stage)
+        {
+            writeTextRow(output, commandVerb(verb), command.count, stage_names.at(stage),
+                         command.latency.at(stage));
+        }
+    }
+    output << "Collisions: " << m_counters.collisions
+           << "\nOff-grid rejections: " << m_counters.off_grid
+           << "\nObstacle rejections: " << m_counters.obstacles
+           << "\nTerrain cost: " << m_counters.terrain_cost
+           << "\nLookups: " << m_counters.lookups << " (misses: " << m_counters.lookup_misses
+           << ")\n";
+}
+
+void SimulatorStatistics::writeJson(std::ostream &output) const
+{
+    output << R"({"commands":[)";
+    bool first_command{true};
+    for (std::size_t verb = 0; verb < m_commands.size(); ++verb)
+    {
+        const auto &command = m_commands.at(verb);
+        if (command.count == 0)
+        {
+            continue;
+        }
+        output << (first_command ? "" : ",") << R"({"verb":")" << commandVerb(verb)
+               << R"(","count":)" << command.count << R"(,"stages":{)";
+        first_command = false;
+        for (std::size_t stage = 0; stage < stage_count; ++stage)
+        {
+            const auto &histogram = command.latency.at(stage);
+            output << (stage == 0 ? "" : ",") << '"' << stage_names.at(stage) << R"(":{"p50":)"
+                   << histogram.percentile(0.50) << R"(,"p99":)" << histogram.percentile(0.99)
+                   << R"(,"p999":)" << histogram.percentile(0.999) << R"(,"max":)"
+                   << histogram.max() << '}';
+        }
+        output << "}}";
+    }
+    output << R"(],"counters":{"collisions":)" << m_counters.collisions << R"(,"off_grid":)"
+           << m_counters.off_grid << R"(,"lookups":)" << m_counters.lookups
+           << R"(,"lookup_misses":)" << m_counters.lookup_misses << R"(,"obstacles":)"
+           << m_counters.obstacles << R"(,"terrain_cost":)" << m_counters.terrain_cost << "}}\n";
+}
+
+} // namespace Simulator
@@ -0,0 +1,203 @@
+#include "marvin/simulator/TerrainMap.h"
+
+#include "marvin/robot/Robot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr auto max_coordinate = RobotFactory::Coordinate{std::numeric_limits<std::uint32_t>::max()};
+
+[[nodiscard]] std::uint32_t column(RobotFactory::Coordinate value)
+{
+    if (value < 0 || value > max_coordinate)
+    {
+        throw std::invalid_argument{"Terrain coordinate is out of range."};
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+} // namespace
+
+void TerrainMap::Builder::startRow(RobotFactory::Coordinate y)
+{
+    if (y < 0 || y >= max_coordinate)
+    {
+        throw std::invalid_argument{"Terrain coordinate is out of range."};
+    }
+    const auto row = static_cast<std::size_t>(y);
+    if (row + 1 < m_row_begin.size())
+    {
+        throw std::invalid_argument{"Terrain rows must be added in increasing order."};
+    }
+    if (row + 1 > m_row_begin.size())
+    {
+        m_row_begin.resize(row + 1, static_cast<std::uint32_t>(m_runs.size()));
+        m_row_end = 0;
+    }
+}
+
+void TerrainMap::Builder::addRun(RobotFactory::Coordinate y, RobotFactory::Coordinate begin,
+                                 RobotFactory::Coordinate end, TerrainCode code)
+{
+    const auto first = column(begin);
+    const auto last = column(end);
+    if (last < first)
+    {
+        throw std::invalid_argument{"Terrain run ends before it begins."};
+    }
+    startRow(y);
+    if (first < m_row_end)
+    {
+        throw std::invalid_argument{"Terrain runs must not overlap."};
+    }
+    m_row_end = std::max(m_row_end, last);
+    if (first == last || code == terrain_open)
+    {
+        return;
+    }
+    const bool same_row = m_runs.size() > m_row_begin.back();
+    if (same_row && m_runs.back().end == first && m_runs.back().code == code)
+    {
+        m_runs.back().end = last;
+        return;
+    }
+    if (m_runs.size() >= std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::length_error{"Terrain has too many runs."};
+    }
+    m_runs.push_back({.begin = first, .end = last, .code = code});
+}
+
+void TerrainMap::Builder::addRow(RobotFactory::Coordinate y, std::span<const TerrainCode> cells)
+{
+    startRow(y);
+    if (cells.size() > static_cast<std::size_t>(max_coordinate))
+    {
+        throw std::invalid_argument{"Terrain coordinate is out of range."};
+    }
+    std::size_t begin{0};
+    while (begin < cells.size())
+    {
+        const auto code = cells[begin];
+        auto end = begin + 1;
+        while (end < cells.size() && cells[end] == code)
+        {
+            ++end;
+        }
+        addRun(y, static_cast<RobotFactory::Coordinate>(begin),
+               static_cast<RobotFactory::Coordinate>(end), code);
+        begin = end;
+    }
+}
+
+TerrainMap TerrainMap::Builder::build() &&
+{
+    TerrainMap map;
+    if (!m_runs.empty())
+    {
+        // Trailing rows without runs need no index entries.
+        while (m_row_begin.back() == m_runs.size())
+        {
+            m_row_begin.pop_back();
+        }
+        m_row_begin.push_back(static_cast<std::uint32_t>(m_runs.size()));
+        m_runs.shrink_to_fit();
+        m_row_begin.shrink_to_fit();
+        map.m_row_begin = std::move(m_row_begin);
+        map.m_runs = std::move(m_runs);
+    }
+    m_row_begin.clear();
+    m_runs.clear();
+    m_row_end = 0;
+    return map;
+}
+
+std::span<const TerrainMap::Run> TerrainMap::row(RobotFactory::Coordinate y) const noexcept
+{
+    if (y < 0 || static_cast<std::uint64_t>(y) + 1 >= m_row_begin.size())
+    {
+        return {};
+    }
+    const auto index = static_cast<std::size_t>(y);
+    const std::span runs{m_runs};
+    return runs.subspan(m_row_begin[index], m_row_begin[index + 1] - m_row_begin[index]);
+}
+
+TerrainCode TerrainMap::at(RobotFactory::RobotLocation location) const noexcept
+{
+    if (location.x < 0 || location.x > max_coordinate)
+    {
+        return terrain_open;
+    }
+    const auto runs = row(location.y);
+    const auto x = static_cast<std::uint32_t>(location.x);
+    const auto run =
+        std::ranges::partition_point(runs, [x](const Run &run) { return run.end <= x; });
+    return run != runs.end() && run->begin <= x ? run->code : terrain_open;
+}
+
+std::optional<std::uint64_t> TerrainMap::pathCost(RobotFactory::RobotLocation from,
+                                                  RobotFactory::RobotLocation to) const
+{
+    if (from.y != to.y)
+    {
+        // Columns cross one run list per row, so they are walked cell by cell.
+        const auto step = from.y < to.y ? 1 : -1;
+        std::uint64_t cost{0};
+        for (auto y = from.y; y != to.y;)
+        {
+            y += step;
+            const auto code = at({.x = to.x, .y = y, .direction = to.direction});
+            if (code == terrain_blocked)
+            {
+                return std::nullopt;
+            }
+            cost += terrainCost(code);
+        }
+        return cost;
+    }
+
+    // The cells entered along a row, as an inclusive range.
+    const auto first = from.x < to.x ? from.x + 1 : to.x;
+    const auto last = from.x < to.x ? to.x : from.x - 1;
+    std::uint64_t cost = last >= first ? static_cast<std::uint64_t>(last - first) + 1 : 0;
+    const auto runs = row(to.y);
+    auto run = std::ranges::partition_point(
+        runs, [first](const Run &run) { return RobotFactory::Coordinate{run.end} <= first; });
+    for (; run != runs.end() && RobotFactory::Coordinate{run->begin} <= last; ++run)
+    {
+        if (run->code == terrain_blocked)
+        {
+            return std::nullopt;
+        }
+        const auto overlap = std::min<RobotFactory::Coordinate>(last + 1, run->end) -
+                             std::max<RobotFactory::Coordinate>(first, run->begin);
+        cost += static_cast<std::uint64_t>(overlap) * run->code;
+    }
+    return cost;
+}
+
+std::size_t TerrainMap::runCount() const noexcept
+{
+    return m_runs.size();
+}
+
+std::size_t TerrainMap::memoryBytes() const noexcept
+{
+    return sizeof(*this) + m_row_begin.capacity() * sizeof(std::uint32_t) +
+           m_runs.capacity() * sizeof(Run);
+}
+
+} // namespace Simulator
@@ -0,0 +1,319 @@
+#include "marvin/simulator/Tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Simulator
+{
+
+struct TraceEvent
+{
+    std::string_view name;
+    std::uint64_t start{0};
+    std::uint64_t duration{0};
+};
+
+// Single-producer, single-consumer ring: the owning thread pushes, the writer thread drains.
+class TraceBuffer
+{
+  public:
+    explicit TraceBuffer(std::uint32_t thread_id) : m_thread_id{thread_id} {}
+
+    [[nodiscard]] bool push(const TraceEvent &event) noexcept
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= capacity)
+        {
+            return false;
+        }
+        m_events.at(head % capacity) = event;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Consumer> void drain(Consumer &&consume)
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail)
+        {
+            consume(m_events.at(tail % capacity));
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    [[nodiscard]] std::uint32_t threadId() const noexcept
+    {
+        return m_thread_id;
+    }
+
+    // Called by the owning thread as it exits, after its last push.
+    void retire() noexcept
+    {
+        m_retired.store(true, std::memory_order_release);
+    }
+
+    // Whether the owning thread has exited and every event it pushed has been drained.
+    [[nodiscard]] bool reusable() const noexcept
+    {
+        return m_retired.load(std::memory_order_acquire) &&
+               m_tail.load(std::memory_order_relaxed) == m_head.load(std::memory_order_relaxed);
+    }
+
+    // Hands a reusable buffer to a new thread. Caller holds the session mutex.
+    void adopt(std::uint32_t thread_id) noexcept
+    {
+        m_thread_id = thread_id;
+        m_retired.store(false, std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::size_t capacity{4096};
+
+    std::array<TraceEvent, capacity> m_events{};
+    alignas(64) std::atomic<std::uint64_t> m_head{0};
+    alignas(64) std::atomic<std::uint64_t> m_tail{0};
+    std::atomic<bool> m_retired{false};
+    std::uint32_t m_thread_id;
+};
+
+namespace
+{
+
+constexpr auto flush_interval = std::chrono::milliseconds{10};
+
+struct Session
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    std::ofstream output;
+    bool first_event{true};
+    std::uint64_t epoch{0};
+    std::atomic<std::uint32_t> sample_every{1};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint32_t> next_thread_id{1};
+    std::condition_variable_any wake;
+    std::jthread writer;
+};
+
+struct ThreadState
+{
+    ThreadState() = default;
+    ThreadState(const ThreadState &) = delete;
+    ThreadState &operator=(const ThreadState &) = delete;
+    ThreadState(ThreadState &&) = delete;
+    ThreadState &operator=(ThreadState &&) = delete;
+    ~ThreadState()
+    {
+        if (buffer)
+        {
+            buffer->retire();
+        }
+    }
+
+    std::shared_ptr<TraceBuffer> buffer;
+    std::uint64_t counter{0};
+    std::uint32_t depth{0};
+    bool sampled{false};
+};
+
+thread_local ThreadState thread_state; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+[[nodiscard]] Session &session()
+{
+    static Session instance;
+    return instance;
+}
+
+[[nodiscard]] std::uint64_t now() noexcept
+{
+    const auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+// Registers a buffer for the calling thread, reusing one whose thread has exited once the writer
+// has drained it, so threads that come and go (pipelined parsers) do not grow the session.
+[[nodiscard]] TraceBuffer *threadBuffer() noexcept
+{
+    if (!thread_state.buffer)
+    {
+        try
+        {
+            auto &state = session();
+            const auto thread_id = state.next_thread_id.fetch_add(1);
+            const std::scoped_lock lock{state.mutex};
+            const auto reusable = std::ranges::find_if(
+                state.buffers, [](const auto &buffer) { return buffer->reusable(); });
+            if (reusable != state.buffers.end())
+            {
+                (*reusable)->adopt(thread_id);
+                thread_state.buffer = *reusable;
+            }
+            else
+            {
+                thread_state.buffer = std::make_shared<TraceBuffer>(thread_id);
+                state.buffers.push_back(thread_state.buffer);
+            }
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+    return thread_state.buffer.get();
+}
+
+void writeMicroseconds(std::ostream &output, std::uint64_t nanoseconds)
+{
+    output << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000
+           << std::setfill(' ');
+}
+
+// Caller holds the session mutex.
+void drainBuffers(Session &state)
+{
+    for (const auto &buffer : state.buffers)
+    {
+        buffer->drain(
+            [&state, thread_id = buffer->threadId()](const TraceEvent &event)
+            {
+                const auto start = event.start > state.epoch ? event.start - state.epoch : 0;
+                state.output << (state.first_event ? "\n" : ",\n") << R"({"name":")" << event.name
+                             << R"(","ph":"X","pid":1,"tid":)" << thread_id << R"(,"ts":)";
+                writeMicroseconds(state.output, start);
+                state.output << R"(,"dur":)";
+                writeMicroseconds(state.output, event.duration);
+                state.output << '}';
+                state.first_event = false;
+            });
+    }
+    state.output.flush();
+}
+
+void discardBuffers(Session &state)
+{
+    for (const auto &buffer : state.buffers)
+    {
+        buffer->drain([](const TraceEvent &event) { static_cast<void>(event); });
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_active{false};
+
+bool Tracer::start(const std::filesystem::path &path, std::uint32_t sample_every)
+{
+    if constexpr (!tracing_enabled)
+    {
+        static_cast<void>(path);
+        static_cast<void>(sample_every);
+        return false;
+    }
+    else
+    {
+        stop();
+        auto &state = session();
+        {
+            const std::scoped_lock lock{state.mutex};
+            state.output.open(path, std::ios::out | std::ios::trunc);
+            if (!state.output)
+            {
+                return false;
+            }
+            discardBuffers(state);
+            state.output << R"({"displayTimeUnit":"ns","traceEvents":[)";
+            state.first_event = true;
+            state.epoch = now();
+            state.dropped.store(0, std::memory_order_relaxed);
+            state.sample_every.store(sample_every == 0 ? 1 : sample_every,
+                                     std::memory_order_relaxed);
+        }
+        state.writer = std::jthread{[&state](const std::stop_token &token)
+                                    {
+                                        std::unique_lock lock{state.mutex};
+                                        while (!token.stop_requested())
+                                        {
+                                            drainBuffers(state);
+                                            state.wake.wait_for(lock, token, flush_interval,
+                                                                [] { return false; });
+                                        }
+                                    }};
+        s_active.store(true, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+void Tracer::stop()
+{
+    auto &state = session();
+    s_active.store(false, std::memory_order_relaxed);
+    if (state.writer.joinable())
+    {
+        state.writer.request_stop();
+        state.writer.join();
+    }
+    const std::scoped_lock lock{state.mutex};
+    if (state.output.is_open())
+    {
+        drainBuffers(state);
+        state.output << "\n]}\n";
+        state.output.close();
+    }
+}
+
+std::uint64_t Tracer::dropped() noexcept
+{
+    return session().dropped.load(std::memory_order_relaxed);
+}
+
+std::size_t Tracer::threadBuffers()
+{
+    auto &state = session();
+    const std::scoped_lock lock{state.mutex};
+    return state.buffers.size();
+}
+
+void TraceSpan::begin(std::string_view name) noexcept
+{
+    if (thread_state.depth == 0)
+    {
+        const auto sample_every = session().sample_every.load(std::memory_order_relaxed);
+        thread_state.sampled = ++thread_state.counter % sample_every == 0;
+    }
+    ++thread_state.depth;
+    m_open = true;
+    if (thread_state.sampled)
+    {
+        m_buffer = threadBuffer();
+        m_name = name;
+        m_start = now();
+    }
+}
+
+void TraceSpan::end() noexcept
+{
+    --thread_state.depth;
+    if (m_buffer != nullptr &&
+        !m_buffer->push({.name = m_name, .start = m_start, .duration = now() - m_start}))
+    {
+        session().dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Simulator
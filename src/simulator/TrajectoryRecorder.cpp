@@ -0,0 +1,260 @@
+#include "marvin/simulator/TrajectoryRecorder.h"
+
+#include "marvin/robot/Robot.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+namespace
+{
+
+constexpr std::size_t column_count{5};
+constexpr std::uint8_t last_direction{static_cast<std::uint8_t>(RobotFactory::Direction::West)};
+
+void appendVarint(std::vector<std::uint8_t> &bytes, std::uint64_t value)
+{
+    while (value >= 0x80U)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80U));
+        value >>= 7U;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+[[nodiscard]] std::optional<std::uint64_t> readVarint(std::istream &input)
+{
+    std::uint64_t value{0};
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        const auto byte = input.get();
+        if (byte == std::istream::traits_type::eof())
+        {
+            return std::nullopt;
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+// Decodes one zigzag varint from the front of `bytes` and drops it.
+[[nodiscard]] std::optional<std::uint64_t> takeDelta(std::span<const std::uint8_t> &bytes)
+{
+    std::uint64_t value{0};
+    for (unsigned shift = 0; shift < 64 && !bytes.empty(); shift += 7)
+    {
+        const auto byte = bytes.front();
+        bytes = bytes.subspan(1);
+        value |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0)
+        {
+            return (value >> 1U) ^ (0U - (value & 1U));
+        }
+    }
+    return std::nullopt;
+}
+
+void write(std::ostream &output, std::span<const std::uint8_t> bytes)
+{
+    output.write(reinterpret_cast<const char *>(bytes.data()), // NOLINT(*-reinterpret-cast)
+                 static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    stop();
+}
+
+void TrajectoryRecorder::start(std::ostream &output, std::size_t chunk_records)
+{
+    stop();
+    m_output = &output;
+    m_chunk_records = std::clamp<std::size_t>(chunk_records, 1, max_chunk_records);
+    m_recorded = 0;
+    m_failed = false;
+    m_output->write(trajectory_magic.data(), trajectory_magic.size());
+    m_bytes_written = trajectory_magic.size();
+}
+
+bool TrajectoryRecorder::start(const std::filesystem::path &path, std::size_t chunk_records)
+{
+    auto file = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+    if (!*file)
+    {
+        return false;
+    }
+    start(*file, chunk_records);
+    m_file = std::move(file);
+    return true;
+}
+
+bool TrajectoryRecorder::stop()
+{
+    if (m_output == nullptr)
+    {
+        return true;
+    }
+    if (m_chunk_size != 0)
+    {
+        writeChunk();
+    }
+    m_failed |= !m_output->flush();
+    m_output = nullptr;
+    m_file.reset();
+    for (auto *column : {&m_ticks, &m_ids, &m_xs, &m_ys, &m_directions, &m_header})
+    {
+        *column = std::vector<std::uint8_t>{};
+    }
+    return !m_failed;
+}
+
+std::uint64_t TrajectoryRecorder::recorded() const noexcept
+{
+    return m_recorded;
+}
+
+std::uint64_t TrajectoryRecorder::bytesWritten() const noexcept
+{
+    return m_bytes_written;
+}
+
+std::size_t TrajectoryRecorder::memoryBytes() const noexcept
+{
+    return m_ticks.capacity() + m_ids.capacity() + m_xs.capacity() + m_ys.capacity() +
+           m_directions.capacity() + m_header.capacity();
+}
+
+void TrajectoryRecorder::writeChunk()
+{
+    m_header.clear();
+    appendVarint(m_header, m_chunk_size);
+    const std::array<const std::vector<std::uint8_t> *, column_count> columns{
+        &m_ticks, &m_ids, &m_xs, &m_ys, &m_directions};
+    for (const auto *column : columns)
+    {
+        appendVarint(m_header, column->size());
+    }
+    write(*m_output, m_header);
+    m_bytes_written += m_header.size();
+    for (const auto *column : columns)
+    {
+        write(*m_output, *column);
+        m_bytes_written += column->size();
+    }
+    m_failed |= !*m_output;
+    // Capacity is kept, so a steady recording stops allocating after its first chunk.
+    for (auto *column : {&m_ticks, &m_ids, &m_xs, &m_ys, &m_directions})
+    {
+        column->clear();
+    }
+    m_chunk_size = 0;
+    m_previous = {};
+}
+
+TrajectoryReader::TrajectoryReader(std::istream &input) : m_input{input}
+{
+    std::array<char, trajectory_magic.size()> magic{};
+    m_valid = static_cast<bool>(m_input.read(magic.data(), magic.size())) &&
+              magic == trajectory_magic;
+}
+
+bool TrajectoryReader::next(std::vector<TrajectoryRecord> &records)
+{
+    records.clear();
+    if (!m_valid || m_input.peek() == std::istream::traits_type::eof())
+    {
+        return false;
+    }
+    m_valid = false;
+    const auto count = readVarint(m_input);
+    if (!count || *count > TrajectoryRecorder::max_chunk_records)
+    {
+        return false;
+    }
+    std::array<std::size_t, column_count> sizes{};
+    std::size_t total{0};
+    for (auto &size : sizes)
+    {
+        const auto bytes = readVarint(m_input);
+        // No column can use more than ten bytes per record.
+        if (!bytes || *bytes > *count * 10)
+        {
+            return false;
+        }
+        size = static_cast<std::size_t>(*bytes);
+        total += size;
+    }
+    if (sizes.back() != *count)
+    {
+        return false;
+    }
+    m_columns.resize(total);
+    if (!m_input.read(reinterpret_cast<char *>(m_columns.data()), // NOLINT(*-reinterpret-cast)
+                      static_cast<std::streamsize>(total)))
+    {
+        return false;
+    }
+
+    std::array<std::span<const std::uint8_t>, column_count> columns;
+    std::size_t offset{0};
+    for (std::size_t column = 0; column < column_count; ++column)
+    {
+        columns.at(column) = std::span{m_columns}.subspan(offset, sizes.at(column));
+        offset += sizes.at(column);
+    }
+    auto &[ticks, ids, xs, ys, directions] = columns;
+    records.resize(static_cast<std::size_t>(*count));
+    TrajectoryRecord previous;
+    for (std::size_t record = 0; record < records.size(); ++record)
+    {
+        const auto tick = takeDelta(ticks);
+        const auto id = takeDelta(ids);
+        const auto x = takeDelta(xs);
+        const auto y = takeDelta(ys);
+        const auto direction = directions[record];
+        if (!tick || !id || !x || !y || direction > last_direction)
+        {
+            records.clear();
+            return false;
+        }
+        previous.tick += *tick;
+        previous.id += *id;
+        previous.location.x = static_cast<RobotFactory::Coordinate>(
+            static_cast<std::uint64_t>(previous.location.x) + *x);
+        previous.location.y = static_cast<RobotFactory::Coordinate>(
+            static_cast<std::uint64_t>(previous.location.y) + *y);
+        previous.location.direction = static_cast<RobotFactory::Direction>(direction);
+        records[record] = previous;
+    }
+    m_valid = ticks.empty() && ids.empty() && xs.empty() && ys.empty();
+    if (!m_valid)
+    {
+        records.clear();
+    }
+    return m_valid;
+}
+
+bool TrajectoryReader::valid() const noexcept
+{
+    return m_valid;
+}
+
+} // namespace Simulator
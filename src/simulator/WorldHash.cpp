@@ -0,0 +1,38 @@
+#include "marvin/simulator/WorldHash.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+
+namespace Simulator
+{
+
+std::ostream &operator<<(std::ostream &stream, const WorldHash &hash)
+{
+    const auto flags = stream.flags();
+    const auto fill = stream.fill('0');
+    stream << std::hex << std::setw(16) << hash.high << std::setw(16) << hash.low;
+    stream.fill(fill);
+    stream.flags(flags);
+    return stream;
+}
+
+std::optional<std::size_t> firstDivergence(std::span<const WorldHash> first,
+                                           std::span<const WorldHash> second)
+{
+    const auto common = std::min(first.size(), second.size());
+    const auto indices = std::views::iota(std::size_t{0}, common);
+    const auto divergent = std::ranges::partition_point(
+        indices, [first, second](std::size_t index) { return first[index] == second[index]; });
+    if (divergent == indices.end())
+    {
+        return std::nullopt;
+    }
+    return *divergent;
+}
+
+} // namespace Simulator
@@ -0,0 +1,295 @@
+#include "marvin/simulator/WorldHost.h"
+
+#include "marvin/simulator/PageAllocator.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/RobotSimulator.h"
+#include "marvin/simulator/Tracer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Simulator
+{
+
+struct WorldHost::World
+{
+    struct Batch
+    {
+        std::pmr::string script;
+        std::promise<BatchResult> done;
+    };
+
+    World(GridSize size, std::pmr::memory_resource *upstream)
+        : arena{upstream}, simulator{build(arena, size)}
+    {
+    }
+
+    // Submitters allocate batches from the arena while the running worker's simulator does.
+    std::pmr::synchronized_pool_resource arena;
+    // Guards the mailbox and `scheduled`, which submitters and the running worker share. A
+    // scheduled world is in a worker queue or running, and must not be queued again.
+    std::mutex mutex;
+    std::pmr::deque<Batch> mailbox{&arena};
+    bool scheduled{false};
+
+    // Touched only by the worker running the world. `offset` is the progress through the batch at
+    // the head of the mailbox.
+    RobotSimulator simulator;
+    std::size_t offset{0};
+    std::ostringstream output;
+    std::ostringstream errors;
+    std::size_t executed{0};
+
+    [[nodiscard]] static RobotSimulator build(std::pmr::memory_resource &arena, GridSize size)
+    {
+        const PageArenaScope scope{&arena};
+        return RobotSimulator{size};
+    }
+};
+
+WorldHost::WorldHost(unsigned threads, std::size_t quantum, std::pmr::memory_resource *upstream)
+    : m_quantum{std::max<std::size_t>(quantum, 1)}, m_upstream{upstream}
+{
+    const auto count = std::max(threads, 1U);
+    m_workers.reserve(count);
+    for (unsigned worker = 0; worker < count; ++worker)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(count);
+    for (std::size_t worker = 0; worker < count; ++worker)
+    {
+        m_threads.emplace_back([this, worker] { work(worker); });
+    }
+}
+
+WorldHost::~WorldHost()
+{
+    wait();
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+}
+
+WorldId WorldHost::create(GridSize size)
+{
+    auto world = std::make_shared<World>(size, m_upstream);
+    const std::scoped_lock lock{m_mutex};
+    const auto id = m_next_world++;
+    m_worlds.emplace(id, std::move(world));
+    return id;
+}
+
+bool WorldHost::destroy(WorldId world)
+{
+    // Queues keep their own reference, so batches already submitted still run.
+    const std::scoped_lock lock{m_mutex};
+    return m_worlds.erase(world) > 0;
+}
+
+std::future<BatchResult> WorldHost::submit(WorldId world, std::string_view script)
+{
+    std::shared_ptr<World> target;
+    std::size_t worker{0};
+    {
+        const std::scoped_lock lock{m_mutex};
+        const auto found = m_worlds.find(world);
+        if (found == m_worlds.end())
+        {
+            return {};
+        }
+        target = found->second;
+        worker = m_next_worker++ % m_workers.size();
+        ++m_outstanding;
+    }
+
+    std::future<BatchResult> result;
+    bool idle{false};
+    {
+        const std::scoped_lock lock{target->mutex};
+        auto &batch = target->mailbox.emplace_back(std::pmr::string{script, &target->arena},
+                                                   std::promise<BatchResult>{});
+        result = batch.done.get_future();
+        idle = !std::exchange(target->scheduled, true);
+    }
+    if (idle)
+    {
+        schedule(std::move(target), worker);
+    }
+    return result;
+}
+
+void WorldHost::wait()
+{
+    std::unique_lock lock{m_mutex};
+    m_idle.wait(lock, [this] { return m_outstanding == 0; });
+}
+
+std::size_t WorldHost::worldCount() const
+{
+    const std::scoped_lock lock{m_mutex};
+    return m_worlds.size();
+}
+
+unsigned WorldHost::threadCount() const noexcept
+{
+    return static_cast<unsigned>(m_threads.size());
+}
+
+void WorldHost::schedule(std::shared_ptr<World> world, std::size_t worker)
+{
+    {
+        auto &queue = *m_workers.at(worker);
+        const std::scoped_lock lock{queue.mutex};
+        queue.worlds.push_back(std::move(world));
+    }
+    {
+        const std::scoped_lock lock{m_mutex};
+        ++m_queued;
+    }
+    m_wake.notify_one();
+}
+
+std::shared_ptr<WorldHost::World> WorldHost::take(std::size_t self)
+{
+    for (;;)
+    {
+        // The worker's own queue first, oldest world first; then the newest world of another.
+        for (std::size_t step = 0; step < m_workers.size(); ++step)
+        {
+            auto &queue = *m_workers.at((self + step) % m_workers.size());
+            std::unique_lock lock{queue.mutex};
+            if (queue.worlds.empty())
+            {
+                continue;
+            }
+            std::shared_ptr<World> world;
+            if (step == 0)
+            {
+                world = std::move(queue.worlds.front());
+                queue.worlds.pop_front();
+            }
+            else
+            {
+                world = std::move(queue.worlds.back());
+                queue.worlds.pop_back();
+            }
+            lock.unlock();
+            const std::scoped_lock count{m_mutex};
+            --m_queued;
+            return world;
+        }
+        std::unique_lock lock{m_mutex};
+        m_wake.wait(lock, [this] { return m_queued > 0 || m_stopping; });
+        if (m_queued == 0)
+        {
+            return nullptr;
+        }
+    }
+}
+
+void WorldHost::work(std::size_t self)
+{
+    while (auto world = take(self))
+    {
+        if (run(*world))
+        {
+            schedule(std::move(world), self);
+        }
+    }
+}
+
+bool WorldHost::run(World &world)
+{
+    const TraceSpan span{"WorldHost::run"};
+    const PageArenaScope arena{&world.arena};
+    for (std::size_t budget = m_quantum; budget > 0;)
+    {
+        World::Batch *batch{nullptr};
+        {
+            const std::scoped_lock lock{world.mutex};
+            if (world.mailbox.empty())
+            {
+                world.scheduled = false;
+                return false;
+            }
+            // References to deque elements survive pushes at the back.
+            batch = &world.mailbox.front();
+        }
+
+        const std::string_view script{batch->script};
+        bool finished{false};
+        bool quit{false};
+        try
+        {
+            while (budget > 0 && world.offset < script.size())
+            {
+                const auto end = std::min(script.find('\n', world.offset), script.size());
+                const auto line = script.substr(world.offset, end - world.offset);
+                world.offset = end + 1;
+                if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+                {
+                    continue;
+                }
+                --budget;
+                ++world.executed;
+                if (!world.simulator.executeLine(line, world.output, world.errors))
+                {
+                    quit = true;
+                    break;
+                }
+            }
+            finished = quit || world.offset >= script.size();
+            if (finished)
+            {
+                batch->done.set_value({.output = std::move(world.output).str(),
+                                       .errors = std::move(world.errors).str(),
+                                       .executed = world.executed,
+                                       .quit = quit});
+            }
+        }
+        catch (...)
+        {
+            batch->done.set_exception(std::current_exception());
+            finished = true;
+        }
+
+        if (finished)
+        {
+            world.offset = 0;
+            world.executed = 0;
+            world.output.str({});
+            world.errors.str({});
+            {
+                const std::scoped_lock lock{world.mutex};
+                world.mailbox.pop_front();
+            }
+            bool idle{false};
+            {
+                const std::scoped_lock lock{m_mutex};
+                idle = --m_outstanding == 0;
+            }
+            if (idle)
+            {
+                m_idle.notify_all();
+            }
+        }
+    }
+    const std::scoped_lock lock{world.mutex};
+    world.scheduled = !world.mailbox.empty();
+    return world.scheduled;
+}
+
+} // namespace Simulator
@@ -0,0 +1,389 @@
+#include "marvin/simulator/WorldMap.h"
+
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+#include "marvin/simulator/TerrainMap.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MARVIN_HAS_MMAP 1
+#endif
+
+namespace Simulator
+{
+namespace
+{
+
+// Terrain runs store 32-bit columns.
+constexpr auto max_width = RobotFactory::Coordinate{std::numeric_limits<std::uint32_t>::max()};
+
+struct AsciiCell
+{
+    bool valid{false};
+    bool robot{false};
+    TerrainCode terrain{terrain_open};
+    RobotFactory::Direction direction{RobotFactory::Direction::North};
+};
+
+// Indexed by the unsigned value of a map character, so each cell is classified with one load.
+constexpr auto ascii_cells = []
+{
+    std::array<AsciiCell, 256> cells{};
+    const auto set = [&cells](char character, AsciiCell cell)
+    { cells.at(static_cast<unsigned char>(character)) = cell; };
+    set('.', {.valid = true, .robot = false, .terrain = terrain_open, .direction = {}});
+    set(' ', {.valid = true, .robot = false, .terrain = terrain_open, .direction = {}});
+    set('#', {.valid = true, .robot = false, .terrain = terrain_blocked, .direction = {}});
+    for (char digit = '1'; digit <= '9'; ++digit)
+    {
+        set(digit, {.valid = true,
+                    .robot = false,
+                    .terrain = static_cast<TerrainCode>(digit - '0'),
+                    .direction = {}});
+    }
+    const auto robot = [](RobotFactory::Direction direction) -> AsciiCell
+    { return {.valid = true, .robot = true, .terrain = terrain_open, .direction = direction}; };
+    set('^', robot(RobotFactory::Direction::North));
+    set('>', robot(RobotFactory::Direction::East));
+    set('v', robot(RobotFactory::Direction::South));
+    set('<', robot(RobotFactory::Direction::West));
+    return cells;
+}();
+
+[[nodiscard]] const AsciiCell &asciiCell(char character) noexcept
+{
+    return ascii_cells[static_cast<unsigned char>(character)]; // NOLINT(*-constant-array-index)
+}
+
+[[nodiscard]] std::string_view withoutCarriageReturn(std::string_view line) noexcept
+{
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+// Emits the runs of equal cells in `cells` as terrain codes.
+template <typename Code>
+void addRuns(TerrainMap::Builder &builder, RobotFactory::Coordinate y, std::string_view cells,
+             Code &&code)
+{
+    std::size_t begin{0};
+    while (begin < cells.size())
+    {
+        const auto cell = cells[begin];
+        auto end = begin + 1;
+        while (end < cells.size() && cells[end] == cell)
+        {
+            ++end;
+        }
+        builder.addRun(y, static_cast<RobotFactory::Coordinate>(begin),
+                       static_cast<RobotFactory::Coordinate>(end), code(cell));
+        begin = end;
+    }
+}
+
+// Reads whitespace-separated header fields of a PGM file, skipping '#' comments.
+class PgmHeader
+{
+  public:
+    explicit PgmHeader(std::string_view data) noexcept : m_data{data} {}
+
+    [[nodiscard]] std::optional<std::uint64_t> number()
+    {
+        skipSpace();
+        std::uint64_t value{0};
+        const auto first = m_offset;
+        while (m_offset < m_data.size() &&
+               std::isdigit(static_cast<unsigned char>(m_data[m_offset])) != 0 &&
+               value <= std::numeric_limits<std::uint32_t>::max())
+        {
+            value = value * 10 + static_cast<std::uint64_t>(m_data[m_offset++] - '0');
+        }
+        if (m_offset == first)
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Pixels start after exactly one whitespace character following the maximum value.
+    [[nodiscard]] std::optional<std::size_t> pixels() const noexcept
+    {
+        if (m_offset >= m_data.size() ||
+            std::isspace(static_cast<unsigned char>(m_data[m_offset])) == 0)
+        {
+            return std::nullopt;
+        }
+        return m_offset + 1;
+    }
+
+  private:
+    std::string_view m_data;
+    std::size_t m_offset{2}; // Past the magic number.
+
+    void skipSpace() noexcept
+    {
+        while (m_offset < m_data.size())
+        {
+            const auto character = m_data[m_offset];
+            if (character == '#')
+            {
+                const auto end = m_data.find('\n', m_offset);
+                m_offset = end == std::string_view::npos ? m_data.size() : end;
+            }
+            else if (std::isspace(static_cast<unsigned char>(character)) != 0)
+            {
+                ++m_offset;
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+};
+
+} // namespace
+
+WorldMap::WorldMap(const std::string &path)
+{
+#ifdef MARVIN_HAS_MMAP
+    if (const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); file >= 0)
+    {
+        struct stat status{};
+        if (::fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            const auto length = static_cast<std::size_t>(status.st_size);
+            auto *data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = {static_cast<const char *>(data), length};
+                m_mapped = true;
+            }
+        }
+        ::close(file);
+    }
+#endif
+    if (!m_mapped)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+        {
+            throw std::runtime_error{"Unable to open the map file."};
+        }
+        m_buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        m_data = {m_buffer.data(), m_buffer.size()};
+    }
+
+    try
+    {
+        if (m_data.starts_with("P5"))
+        {
+            m_format = Format::Pgm;
+            validatePgm();
+        }
+        else
+        {
+            validateAscii();
+        }
+    }
+    catch (...)
+    {
+#ifdef MARVIN_HAS_MMAP
+        if (m_mapped)
+        {
+            ::munmap(const_cast<char *>(m_data.data()), m_data.size()); // NOLINT(*-const-cast)
+        }
+#endif
+        throw;
+    }
+}
+
+WorldMap::~WorldMap()
+{
+#ifdef MARVIN_HAS_MMAP
+    if (m_mapped)
+    {
+        ::munmap(const_cast<char *>(m_data.data()), m_data.size()); // NOLINT(*-const-cast)
+    }
+#endif
+}
+
+WorldMap::Format WorldMap::format() const noexcept
+{
+    return m_format;
+}
+
+GridSize WorldMap::size() const noexcept
+{
+    return m_size;
+}
+
+std::size_t WorldMap::robotCount() const noexcept
+{
+    return m_robots;
+}
+
+std::size_t WorldMap::bytes() const noexcept
+{
+    return m_data.size();
+}
+
+void WorldMap::validateAscii()
+{
+    const auto end = asciiEnd();
+    if (end == 0)
+    {
+        throw std::runtime_error{"The map is empty."};
+    }
+    RobotFactory::Coordinate lines{1};
+    std::size_t line_start{0};
+    std::size_t width{0};
+    for (std::size_t offset = 0; offset <= end; ++offset)
+    {
+        offset = std::min(m_data.find('\n', offset), end);
+        const auto line = withoutCarriageReturn(m_data.substr(line_start, offset - line_start));
+        bool valid{true};
+        for (const auto character : line)
+        {
+            const auto &cell = asciiCell(character);
+            valid &= cell.valid;
+            m_robots += cell.robot ? 1U : 0U;
+        }
+        if (!valid)
+        {
+            throw std::runtime_error{"Map line " + std::to_string(lines) +
+                                     " has an unexpected character."};
+        }
+        width = std::max(width, line.size());
+        line_start = offset + 1;
+        lines += offset < end ? 1 : 0;
+    }
+    if (width == 0 || width > static_cast<std::size_t>(max_width))
+    {
+        throw std::runtime_error{"The map has no cells or is too wide."};
+    }
+    m_size = {.width = static_cast<RobotFactory::Coordinate>(width), .height = lines};
+}
+
+void WorldMap::validatePgm()
+{
+    PgmHeader header{m_data};
+    const auto width = header.number();
+    const auto height = header.number();
+    const auto max_grey = header.number();
+    const auto pixels = header.pixels();
+    if (!width || !height || !max_grey || !pixels || *width == 0 || *height == 0 ||
+        *width > static_cast<std::uint64_t>(max_width) ||
+        *height > static_cast<std::uint64_t>(max_width) || *max_grey == 0 || *max_grey > 255)
+    {
+        throw std::runtime_error{"The PGM header is malformed or unsupported."};
+    }
+    if ((m_data.size() - *pixels) / *width < *height)
+    {
+        throw std::runtime_error{"The PGM pixel data is truncated."};
+    }
+    m_size = {.width = static_cast<RobotFactory::Coordinate>(*width),
+              .height = static_cast<RobotFactory::Coordinate>(*height)};
+    m_pixels = *pixels;
+    m_max_grey = static_cast<std::uint32_t>(*max_grey);
+}
+
+std::size_t WorldMap::asciiEnd() const noexcept
+{
+    return m_data.ends_with('\n') ? m_data.size() - 1 : m_data.size();
+}
+
+std::string_view WorldMap::lineEndingAt(std::size_t end) const noexcept
+{
+    const auto previous = end == 0 ? std::string_view::npos : m_data.rfind('\n', end - 1);
+    const auto start = previous == std::string_view::npos ? 0 : previous + 1;
+    return m_data.substr(start, end - start);
+}
+
+void WorldMap::buildTerrain(TerrainMap::Builder &builder) const
+{
+    if (m_format == Format::Pgm)
+    {
+        const auto width = static_cast<std::size_t>(m_size.width);
+        const auto max_grey = m_max_grey;
+        const auto code = [max_grey](char pixel)
+        {
+            const auto grey = static_cast<std::uint32_t>(static_cast<unsigned char>(pixel));
+            return static_cast<TerrainCode>(255U - std::min(grey, max_grey) * 255U / max_grey);
+        };
+        for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+        {
+            const auto row = static_cast<std::size_t>(m_size.height - 1 - y);
+            addRuns(builder, y, m_data.substr(m_pixels + row * width, width), code);
+        }
+        return;
+    }
+
+    auto end = asciiEnd();
+    for (RobotFactory::Coordinate y = 0; y < m_size.height; ++y)
+    {
+        const auto line = lineEndingAt(end);
+        addRuns(builder, y, withoutCarriageReturn(line),
+                [](char cell) { return asciiCell(cell).terrain; });
+        end -= line.size() + 1;
+    }
+}
+
+WorldMap::RobotCursor::RobotCursor(const WorldMap &map) noexcept : m_map{&map}
+{
+    if (map.m_format == Format::Ascii && map.m_robots > 0)
+    {
+        m_line_end = map.asciiEnd();
+        m_line_start = m_line_end - map.lineEndingAt(m_line_end).size();
+        m_offset = m_line_start;
+    }
+}
+
+std::optional<RobotFactory::RobotLocation> WorldMap::RobotCursor::next() noexcept
+{
+    const auto data = m_map->m_data;
+    for (;;)
+    {
+        while (m_offset < m_line_end)
+        {
+            const auto offset = m_offset++;
+            if (const auto &cell = asciiCell(data[offset]); cell.robot)
+            {
+                return RobotFactory::RobotLocation{
+                    .x = static_cast<RobotFactory::Coordinate>(offset - m_line_start),
+                    .y = m_y,
+                    .direction = cell.direction};
+            }
+        }
+        if (m_line_start == 0)
+        {
+            return std::nullopt;
+        }
+        m_line_end = m_line_start - 1;
+        m_line_start = m_line_end - m_map->lineEndingAt(m_line_end).size();
+        m_offset = m_line_start;
+        ++m_y;
+    }
+}
+
+} // namespace Simulator
@@ -0,0 +1,124 @@
+#include "marvin/command/BinaryCommands.h"
+#include "marvin/command/Command.h"
+#include "marvin/command/CommandGenerator.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+TEST(BinaryCommands, DecodesToWhatTheParserMakesOfTheText)
+{
+    Simulator::CommandGenerator text_generator{21};
+    Simulator::CommandGenerator binary_generator{21};
+    std::string text;
+    std::string bytes{Simulator::binary_commands_magic.begin(),
+                      Simulator::binary_commands_magic.end()};
+    for (int line = 0; line < 2000; ++line)
+    {
+        text_generator.appendText(text);
+        binary_generator.appendBinary(bytes);
+    }
+    EXPECT_LT(bytes.size(), text.size());
+
+    std::istringstream lines{text};
+    std::istringstream records{bytes};
+    Simulator::BinaryCommandReader reader{records};
+    Simulator::ParseResult decoded;
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        ASSERT_TRUE(reader.next(decoded)) << line;
+        const auto parsed = Simulator::CommandParser::parse(line);
+        EXPECT_EQ(decoded.error, parsed.error) << line;
+        ASSERT_EQ(decoded.command.has_value(), parsed.command.has_value()) << line;
+        if (parsed.command)
+        {
+            // Re-encoding both is a field-by-field comparison of the commands.
+            std::string expected;
+            std::string actual;
+            ASSERT_TRUE(Simulator::appendBinaryCommand(*parsed.command, expected)) << line;
+            ASSERT_TRUE(Simulator::appendBinaryCommand(*decoded.command, actual)) << line;
+            EXPECT_EQ(actual, expected) << line;
+        }
+    }
+    EXPECT_FALSE(reader.next(decoded));
+    EXPECT_TRUE(reader.valid());
+}
+
+TEST(BinaryCommands, RejectsABadHeaderAndMalformedRecords)
+{
+    std::istringstream text{"PLACE A 0,0 NORTH\n"};
+    Simulator::BinaryCommandReader not_binary{text};
+    Simulator::ParseResult result;
+    EXPECT_FALSE(not_binary.next(result));
+    EXPECT_FALSE(not_binary.valid());
+
+    const std::string magic{Simulator::binary_commands_magic.begin(),
+                            Simulator::binary_commands_magic.end()};
+    // A MOVE of zero blocks, which the parser would reject, and a truncated PLACE.
+    for (const auto &record : {std::string{"\x01\x00\x00", 3}, std::string{"\x00\x01", 2}})
+    {
+        std::istringstream stream{magic + record};
+        Simulator::BinaryCommandReader reader{stream};
+        EXPECT_FALSE(reader.next(result));
+        EXPECT_FALSE(reader.valid());
+    }
+
+    // Commands without a record of their own travel as text.
+    std::string bytes{magic};
+    EXPECT_FALSE(Simulator::appendBinaryCommand(Simulator::MenuCommand{}, bytes));
+    EXPECT_EQ(bytes, magic);
+    Simulator::appendBinaryText("MENU", bytes);
+    std::istringstream stream{bytes};
+    Simulator::BinaryCommandReader reader{stream};
+    ASSERT_TRUE(reader.next(result));
+    ASSERT_TRUE(result.command);
+    EXPECT_TRUE(std::holds_alternative<Simulator::MenuCommand>(*result.command));
+}
+
+TEST(BinaryCommands, RunsAsTheSimulatorsInput)
+{
+    Simulator::CommandGenerator text_generator{8};
+    Simulator::CommandGenerator binary_generator{8};
+    std::string text;
+    std::string bytes{Simulator::binary_commands_magic.begin(),
+                      Simulator::binary_commands_magic.end()};
+    for (int line = 0; line < 2000; ++line)
+    {
+        text_generator.appendText(text);
+        binary_generator.appendBinary(bytes);
+    }
+    const auto run = [](const std::string &script, bool pipelined)
+    {
+        std::istringstream input{script};
+        std::ostringstream output;
+        std::ostringstream errors;
+        Simulator::RobotSimulator simulator;
+        if (pipelined)
+        {
+            simulator.runPipelined(input, output, errors, 2);
+        }
+        else
+        {
+            simulator.run(input, output, errors);
+        }
+        return output.str() + errors.str();
+    };
+
+    const auto expected = run(text, false);
+    EXPECT_EQ(run(bytes, false), expected);
+    EXPECT_EQ(run(bytes, true), expected);
+    // Text that starts like the header is still read as lines.
+    EXPECT_NE(run("MRVCMDS\nMR", false)
+                  .find("Unknown command: MRVCMDS.\nError: Unknown command: MR."),
+              std::string::npos);
+    EXPECT_NE(run(bytes.substr(0, bytes.size() - 1), false).find("malformed"), std::string::npos);
+}
+
+} // namespace
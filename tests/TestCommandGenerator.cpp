@@ -0,0 +1,79 @@
+#include "marvin/command/Command.h"
+#include "marvin/command/CommandGenerator.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+[[nodiscard]] std::vector<std::string> generate(std::uint64_t seed,
+                                                Simulator::CommandGeneratorOptions options = {})
+{
+    Simulator::CommandGenerator generator{seed, options};
+    std::vector<std::string> lines;
+    for (int line = 0; line < 500; ++line)
+    {
+        lines.push_back(generator.next());
+    }
+    return lines;
+}
+
+TEST(CommandGenerator, RepeatsItsLinesForTheSameSeed)
+{
+    EXPECT_EQ(generate(7), generate(7));
+    EXPECT_NE(generate(7), generate(8));
+}
+
+TEST(CommandGenerator, MixesStreamSeedsSoNearbySeedsShareNoStreams)
+{
+    using Simulator::CommandGenerator;
+    EXPECT_EQ(CommandGenerator::streamSeed(1, 1), CommandGenerator::streamSeed(1, 1));
+    EXPECT_NE(CommandGenerator::streamSeed(1, 1), CommandGenerator::streamSeed(2, 0));
+    EXPECT_NE(CommandGenerator::streamSeed(1, 0), CommandGenerator::streamSeed(0, 1));
+    EXPECT_NE(generate(CommandGenerator::streamSeed(1, 1)),
+              generate(CommandGenerator::streamSeed(2, 0)));
+}
+
+TEST(CommandGenerator, WritesLinesThatParseUnlessMalformed)
+{
+    Simulator::CommandGenerator generator{3};
+    for (int line = 0; line < 5000; ++line)
+    {
+        const auto text = generator.next();
+        const auto malformed = generator.kind() == Simulator::CommandGenerator::Kind::Malformed;
+        EXPECT_EQ(static_cast<bool>(Simulator::CommandParser::parse(text)), !malformed) << text;
+    }
+}
+
+TEST(CommandGenerator, FollowsTheMix)
+{
+    Simulator::CommandGeneratorOptions options;
+    options.mix = {.place = 1,
+                   .move = 1,
+                   .rotate = 0,
+                   .remove = 0,
+                   .resize = 0,
+                   .report = 0,
+                   .scan = 0,
+                   .hash = 0,
+                   .transaction = 0,
+                   .malformed = 0};
+    options.names = 0;
+    for (const auto &line : generate(5, options))
+    {
+        EXPECT_TRUE(line.starts_with("PLACE ") || line.starts_with("MOVE ")) << line;
+    }
+
+    options.mix.move = 0;
+    const auto places = generate(5, options);
+    EXPECT_EQ(places.front().substr(0, 9), "PLACE R0 ");
+    EXPECT_EQ(places.back().substr(0, 11), "PLACE R499 ");
+
+    options.first_name = 1000;
+    EXPECT_EQ(generate(5, options).front().substr(0, 12), "PLACE R1000 ");
+}
+
+} // namespace
@@ -32,6 +32,54 @@ TEST(CommandParser, ParsesIdTarget)
     EXPECT_EQ(command.blocks, 4U);
 }
 
+TEST(CommandParser, ParsesNamePatternTargets)
+{
+    const auto move = Simulator::CommandParser::parse("MOVE dock1_* 2");
+    const auto remove = Simulator::CommandParser::parse("REMOVE AISLE?_*");
+
+    ASSERT_TRUE(move && remove);
+    const auto &target = std::get<Simulator::MoveCommand>(*move.command).target;
+    ASSERT_TRUE(target.has_value());
+    const auto &pattern = std::get<Simulator::NamePattern>(target->value);
+    EXPECT_EQ(pattern.pattern, "DOCK1_*");
+    EXPECT_EQ(pattern.prefix(), "DOCK1_");
+    EXPECT_TRUE(pattern.matches("DOCK1_"));
+    EXPECT_TRUE(pattern.matches("DOCK1_A7"));
+    EXPECT_FALSE(pattern.matches("DOCK10_A"));
+    const auto &wildcard = std::get<Simulator::NamePattern>(
+        std::get<Simulator::RemoveCommand>(*remove.command).target->value);
+    EXPECT_EQ(wildcard.prefix(), "AISLE");
+    EXPECT_TRUE(wildcard.matches("AISLE7_NORTH"));
+    EXPECT_FALSE(wildcard.matches("AISLE77"));
+    EXPECT_TRUE(Simulator::NamePattern{"*_A*B"}.matches("X_AAB"));
+    EXPECT_FALSE(Simulator::NamePattern{"*_A*B"}.matches("X_ABA"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("PLACE DOCK* 0,0 NORTH"));
+}
+
+TEST(CommandParser, ParsesGroupCommands)
+{
+    const auto create = Simulator::CommandParser::parse("GROUP CREATE pickers");
+    const auto add = Simulator::CommandParser::parse("group add Pickers @101 R2D2 DOCK*");
+
+    ASSERT_TRUE(create && add);
+    const auto &created = std::get<Simulator::GroupCommand>(*create.command);
+    EXPECT_EQ(created.action, Simulator::GroupCommand::Action::Create);
+    EXPECT_EQ(created.name, "PICKERS");
+    const auto &added = std::get<Simulator::GroupCommand>(*add.command);
+    EXPECT_EQ(added.action, Simulator::GroupCommand::Action::Add);
+    EXPECT_EQ(added.name, "PICKERS");
+    ASSERT_EQ(added.members.size(), 3U);
+    EXPECT_EQ(std::get<RobotFactory::RobotId>(added.members[0].value), 101U);
+    EXPECT_EQ(std::get<std::string>(added.members[1].value), "R2D2");
+    EXPECT_EQ(std::get<Simulator::NamePattern>(added.members[2].value).pattern, "DOCK*");
+    EXPECT_TRUE(Simulator::CommandParser::parse("GROUP"));
+    EXPECT_TRUE(Simulator::CommandParser::parse("GROUP DELETE pickers"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("GROUP ADD pickers"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("GROUP CREATE pick*"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("GROUP CREATE @12"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("GROUP ADD pickers ALL"));
+}
+
 TEST(CommandParser, RejectsMalformedNumbers)
 {
     EXPECT_FALSE(Simulator::CommandParser::parse("MOVE R2D2 nope"));
@@ -39,10 +87,180 @@ TEST(CommandParser, RejectsMalformedNumbers)
     EXPECT_FALSE(Simulator::CommandParser::parse("RESIZE 0 10"));
 }
 
+TEST(CommandParser, ParsesStatisticsOptions)
+{
+    const auto result = Simulator::CommandParser::parse("stats json");
+
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(std::get<Simulator::StatsCommand>(*result.command).json);
+    EXPECT_TRUE(std::get<Simulator::StatsCommand>(
+                    *Simulator::CommandParser::parse("STATS RESET").command)
+                    .reset);
+    EXPECT_FALSE(Simulator::CommandParser::parse("STATS VERBOSE"));
+}
+
+TEST(CommandParser, ParsesTraceStartAndStop)
+{
+    const auto started = Simulator::CommandParser::parse("TRACE run.json 100");
+    const auto stopped = Simulator::CommandParser::parse("trace stop");
+
+    ASSERT_TRUE(started);
+    ASSERT_TRUE(stopped);
+    EXPECT_EQ(std::get<Simulator::TraceCommand>(*started.command).path, "run.json");
+    EXPECT_EQ(std::get<Simulator::TraceCommand>(*started.command).sample_every, 100U);
+    EXPECT_TRUE(std::get<Simulator::TraceCommand>(*stopped.command).path.empty());
+    EXPECT_FALSE(Simulator::CommandParser::parse("TRACE run.json 0"));
+}
+
+TEST(CommandParser, ParsesLoadMap)
+{
+    const auto result = Simulator::CommandParser::parse("loadmap maps/dock.pgm");
+
+    ASSERT_TRUE(result);
+    EXPECT_EQ(std::get<Simulator::LoadMapCommand>(*result.command).path, "maps/dock.pgm");
+    EXPECT_FALSE(Simulator::CommandParser::parse("LOADMAP"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("LOADMAP a.txt b.txt"));
+}
+
+TEST(CommandParser, ParsesMemoryLimits)
+{
+    const auto show = Simulator::CommandParser::parse("memory");
+    const auto limit = Simulator::CommandParser::parse("MEMORY LIMIT 64k");
+    const auto off = Simulator::CommandParser::parse("MEMORY limit off");
+
+    ASSERT_TRUE(show && limit && off);
+    EXPECT_EQ(std::get<Simulator::MemoryCommand>(*show.command).action,
+              Simulator::MemoryCommand::Action::Show);
+    EXPECT_EQ(std::get<Simulator::MemoryCommand>(*limit.command).limit, 64U * 1024U);
+    EXPECT_EQ(std::get<Simulator::MemoryCommand>(*off.command).limit, 0U);
+    EXPECT_FALSE(Simulator::CommandParser::parse("MEMORY LIMIT"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("MEMORY LIMIT 0"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("MEMORY LIMIT 12T"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("MEMORY LIMIT 99999999999999999999G"));
+}
+
+TEST(CommandParser, ParsesHeatmapCommands)
+{
+    const auto start = Simulator::CommandParser::parse("heatmap on 16");
+    const auto pgm = Simulator::CommandParser::parse("HEATMAP PGM out.pgm blocked");
+    const auto csv = Simulator::CommandParser::parse("HEATMAP CSV out.csv");
+
+    ASSERT_TRUE(start && pgm && csv);
+    EXPECT_EQ(std::get<Simulator::HeatmapCommand>(*start.command).width,
+              Simulator::Heatmap::Width::Bits16);
+    const auto &image = std::get<Simulator::HeatmapCommand>(*pgm.command);
+    EXPECT_EQ(image.action, Simulator::HeatmapCommand::Action::ExportPgm);
+    EXPECT_EQ(image.channel, Simulator::Heatmap::Channel::Blocked);
+    EXPECT_EQ(image.path, "out.pgm");
+    EXPECT_EQ(std::get<Simulator::HeatmapCommand>(*csv.command).path, "out.csv");
+    EXPECT_FALSE(Simulator::CommandParser::parse("HEATMAP ON 8"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("HEATMAP CSV"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("HEATMAP PGM out.pgm HOT"));
+}
+
+TEST(CommandParser, ParsesRecordCommands)
+{
+    const auto start = Simulator::CommandParser::parse("record run.trj 512");
+    const auto stop = Simulator::CommandParser::parse("RECORD stop");
+
+    ASSERT_TRUE(start && stop);
+    const auto &recording = std::get<Simulator::RecordCommand>(*start.command);
+    EXPECT_EQ(recording.action, Simulator::RecordCommand::Action::Start);
+    EXPECT_EQ(recording.path, "run.trj");
+    EXPECT_EQ(recording.chunk_records, 512U);
+    EXPECT_EQ(std::get<Simulator::RecordCommand>(*stop.command).action,
+              Simulator::RecordCommand::Action::Stop);
+    EXPECT_TRUE(Simulator::CommandParser::parse("RECORD"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("RECORD run.trj 0"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("RECORD STOP now"));
+}
+
+TEST(CommandParser, ParsesPopulation)
+{
+    const auto result = Simulator::CommandParser::parse("POPULATE 1000 clustered 9");
+
+    ASSERT_TRUE(result);
+    const auto &command = std::get<Simulator::PopulateCommand>(*result.command);
+    EXPECT_EQ(command.count, 1000U);
+    EXPECT_EQ(command.pattern, Simulator::PopulationPattern::Clustered);
+    EXPECT_EQ(command.seed, 9U);
+    EXPECT_FALSE(Simulator::CommandParser::parse("POPULATE 0 RANDOM"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("POPULATE 10 SPIRAL"));
+}
+
+TEST(CommandParser, ParsesHashTrailOptions)
+{
+    const auto show = Simulator::CommandParser::parse("hash");
+    const auto start = Simulator::CommandParser::parse("HASH TRAIL 100");
+    const auto stop = Simulator::CommandParser::parse("HASH TRAIL off");
+
+    ASSERT_TRUE(show);
+    ASSERT_TRUE(start);
+    ASSERT_TRUE(stop);
+    EXPECT_EQ(std::get<Simulator::HashCommand>(*show.command).action,
+              Simulator::HashCommand::Action::Show);
+    EXPECT_EQ(std::get<Simulator::HashCommand>(*start.command).every, 100U);
+    EXPECT_EQ(std::get<Simulator::HashCommand>(*stop.command).action,
+              Simulator::HashCommand::Action::StopTrail);
+    EXPECT_FALSE(Simulator::CommandParser::parse("HASH TRAIL 0"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("HASH NOW"));
+}
+
+TEST(CommandParser, ParsesWhereClauses)
+{
+    const auto result = Simulator::CommandParser::parse(
+        "MOVE ALL 2 WHERE direction=north|east AND y=100..200 x=..50 NAME=dock* ID=43..");
+
+    ASSERT_TRUE(result);
+    const auto &command = std::get<Simulator::MoveCommand>(*result.command);
+    ASSERT_TRUE(command.where);
+    EXPECT_EQ(command.blocks, 2U);
+    EXPECT_EQ(command.where->directions, 0b0011U);
+    EXPECT_EQ(command.where->y.first, 100);
+    EXPECT_EQ(command.where->y.last, 200);
+    EXPECT_EQ(command.where->x.last, 50);
+    EXPECT_EQ(command.where->id.first, 43U);
+    EXPECT_EQ(command.where->name_prefix, "DOCK");
+    EXPECT_TRUE(
+        std::get<Simulator::ReportCommand>(*Simulator::CommandParser::parse("REPORT WHERE X=3")
+                                                .command)
+            .where);
+    const auto counted = Simulator::CommandParser::parse("MOVE 2 WHERE DIRECTION=NORTH");
+    ASSERT_TRUE(counted) << counted.error;
+    const auto &move = std::get<Simulator::MoveCommand>(*counted.command);
+    EXPECT_FALSE(move.target);
+    EXPECT_EQ(move.blocks, 2U);
+    ASSERT_TRUE(move.where);
+    EXPECT_EQ(move.where->directions, 0b0001U);
+    EXPECT_FALSE(Simulator::CommandParser::parse("MOVE 0 WHERE X=1"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("REMOVE R2D2 WHERE X=1"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("ROTATE LEFT WHERE X=5..1"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("ROTATE LEFT WHERE SPEED=3"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("REMOVE WHERE"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("RESIZE 5 5 WHERE X=1"));
+}
+
+TEST(CommandParser, TreatsWhereAsANameOutsideAFilterClause)
+{
+    const auto place = Simulator::CommandParser::parse("PLACE where 1,1 NORTH");
+    ASSERT_TRUE(place) << place.error;
+    EXPECT_EQ(std::get<Simulator::PlaceCommand>(*place.command).name, "WHERE");
+
+    const auto move = Simulator::CommandParser::parse("MOVE where 2");
+    ASSERT_TRUE(move) << move.error;
+    const auto &command = std::get<Simulator::MoveCommand>(*move.command);
+    EXPECT_FALSE(command.where);
+    EXPECT_EQ(std::get<std::string>(command.target->value), "WHERE");
+    EXPECT_EQ(command.blocks, 2U);
+    EXPECT_TRUE(Simulator::CommandParser::parse("GROUP ADD DOCK where @43"));
+}
+
 TEST(CommandParser, RejectsUnknownCommandsAndExtraArguments)
 {
     EXPECT_FALSE(Simulator::CommandParser::parse("FLY R2D2"));
     EXPECT_FALSE(Simulator::CommandParser::parse("REPORT extra"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("COMMIT now"));
+    EXPECT_FALSE(Simulator::CommandParser::parse("SCAN R2D2 far"));
 }
 
 } // namespace
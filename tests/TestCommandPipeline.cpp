@@ -0,0 +1,100 @@
+#include "marvin/command/Command.h"
+#include "marvin/command/CommandPipeline.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <variant>
+
+namespace
+{
+
+TEST(CommandPipeline, HandsBackParsedLinesInInputOrder)
+{
+    std::string script;
+    for (std::size_t line = 0; line < 1000; ++line)
+    {
+        script += line % 7 == 0 ? "JUMP\n" : "MOVE A " + std::to_string(line + 1) + '\n';
+    }
+    std::istringstream input{script};
+    Simulator::CommandPipeline pipeline{input, 4, 3, 5};
+
+    std::size_t line{0};
+    for (auto chunk = pipeline.next(); !chunk.empty(); chunk = pipeline.next())
+    {
+        EXPECT_LE(chunk.size(), 3U);
+        for (const auto &parsed : chunk)
+        {
+            if (line % 7 == 0)
+            {
+                EXPECT_EQ(parsed.result.error, "Unknown command: JUMP.");
+            }
+            else
+            {
+                ASSERT_TRUE(parsed.result);
+                EXPECT_EQ(std::get<Simulator::MoveCommand>(*parsed.result.command).blocks,
+                          line + 1);
+            }
+            ++line;
+        }
+    }
+    EXPECT_EQ(line, 1000U);
+    EXPECT_TRUE(pipeline.next().empty());
+}
+
+TEST(CommandPipeline, StopsEarlyWithoutReadingPastTheWindow)
+{
+    std::string script;
+    for (std::size_t line = 0; line < 10'000; ++line)
+    {
+        script += "REPORT\n";
+    }
+    std::istringstream input{script};
+    {
+        Simulator::CommandPipeline pipeline{input, 2, 10, 4};
+        EXPECT_EQ(pipeline.next().size(), 10U);
+    }
+    EXPECT_FALSE(input.eof());
+    EXPECT_LE(input.tellg(), std::streampos{7 * 10 * 5});
+}
+
+TEST(CommandPipeline, PipelinedRunMatchesTheSequentialRun)
+{
+    const std::string script{"PLACE A 0,0 NORTH\n"
+                             "\n"
+                             "MOVE A 3\n"
+                             "PLACE B 0,3 EAST\n"
+                             "BEGIN\n"
+                             "MOVE B 20\n"
+                             "ROTATE A SIDEWAYS\n"
+                             "COMMIT\n"
+                             "RESIZE 0 4\n"
+                             "REPORT\n"
+                             "HASH\n"
+                             "QUIT\n"
+                             "REPORT\n"};
+    std::ostringstream expected_output;
+    std::ostringstream expected_errors;
+    {
+        std::istringstream input{script};
+        Simulator::RobotSimulator simulator;
+        simulator.run(input, expected_output, expected_errors);
+    }
+
+    for (const unsigned threads : {1U, 3U})
+    {
+        std::istringstream input{script};
+        std::ostringstream output;
+        std::ostringstream errors;
+        Simulator::RobotSimulator simulator;
+        simulator.runPipelined(input, output, errors, threads);
+        EXPECT_EQ(output.str(), expected_output.str());
+        EXPECT_EQ(errors.str(), expected_errors.str());
+    }
+    EXPECT_NE(expected_errors.str().find("Command is empty."), std::string::npos);
+}
+
+} // namespace
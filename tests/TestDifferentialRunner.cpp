@@ -0,0 +1,55 @@
+#include "marvin/command/CommandGenerator.h"
+#include "marvin/simulator/DifferentialRunner.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+TEST(DifferentialRunner, SimulatorsAgreeOnGeneratedCommands)
+{
+    Simulator::CommandGenerator generator{11};
+    Simulator::DifferentialRunner runner;
+    for (int line = 0; line < 3000; ++line)
+    {
+        const auto text = generator.next();
+        const auto divergence = runner.step(text);
+        ASSERT_FALSE(divergence) << text << "\nexpected:\n"
+                                 << divergence->expected << "actual:\n"
+                                 << divergence->actual;
+    }
+    EXPECT_EQ(runner.steps(), 3000U);
+}
+
+TEST(DifferentialRunner, ShrinksAFailingScriptToTheLinesThatMatter)
+{
+    std::vector<std::string> script;
+    for (int line = 0; line < 200; ++line)
+    {
+        script.push_back("LINE " + std::to_string(line));
+    }
+    // Fails only while lines 17 and 150 are both present, in order.
+    const auto fails = [](std::span<const std::string> candidate)
+    {
+        const auto first = std::find(candidate.begin(), candidate.end(), "LINE 17");
+        return first != candidate.end() && std::find(first, candidate.end(), "LINE 150") !=
+                                               candidate.end();
+    };
+
+    EXPECT_EQ(Simulator::DifferentialRunner::shrink(script, fails),
+              (std::vector<std::string>{"LINE 17", "LINE 150"}));
+}
+
+TEST(DifferentialRunner, ReportsNothingForAnAgreeingScript)
+{
+    const std::vector<std::string> script{"PLACE A 0,0 NORTH", "BEGIN", "MOVE A 3", "REMOVE ALL",
+                                          "ABORT", "SCAN ALL", "HASH", "REPORT"};
+    EXPECT_FALSE(Simulator::DifferentialRunner::run(script));
+}
+
+} // namespace
@@ -0,0 +1,151 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/EventRing.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+[[nodiscard]] Simulator::SimulatorEvent moved(RobotFactory::RobotId id)
+{
+    return {.kind = Simulator::EventKind::Moved, .count = 0, .id = id, .other = 0, .location = {}};
+}
+
+TEST(EventRing, DrainsInBatchesAndReportsOverruns)
+{
+    Simulator::EventRing ring{4};
+    EXPECT_FALSE(ring.active());
+    EXPECT_EQ(ring.memoryBytes(), 0U);
+    const auto fast = ring.subscribe();
+    const auto slow = ring.subscribe();
+    ASSERT_TRUE(ring.active());
+
+    std::vector<RobotFactory::RobotId> seen;
+    std::size_t batches{0};
+    const auto collect = [&seen, &batches](std::span<const Simulator::SimulatorEvent> events)
+    {
+        ++batches;
+        for (const auto &event : events)
+        {
+            seen.push_back(event.id);
+        }
+    };
+    for (RobotFactory::RobotId id = 1; id <= 3; ++id)
+    {
+        ring.publish(moved(id));
+    }
+    EXPECT_EQ(ring.drain(fast, collect).events, 3U);
+    for (RobotFactory::RobotId id = 4; id <= 7; ++id)
+    {
+        ring.publish(moved(id));
+    }
+    // The fast subscriber's events wrap around the end of the ring, so they come in two spans.
+    batches = 0;
+    const auto wrapped = ring.drain(fast, collect);
+    EXPECT_EQ(wrapped.events, 4U);
+    EXPECT_EQ(wrapped.lost, 0U);
+    EXPECT_EQ(batches, 2U);
+    EXPECT_EQ(seen, (std::vector<RobotFactory::RobotId>{1, 2, 3, 4, 5, 6, 7}));
+
+    seen.clear();
+    const auto overrun = ring.drain(slow, collect);
+    EXPECT_EQ(overrun.lost, 3U);
+    EXPECT_EQ(seen, (std::vector<RobotFactory::RobotId>{4, 5, 6, 7}));
+
+    ring.unsubscribe(fast);
+    ring.unsubscribe(slow);
+    EXPECT_FALSE(ring.active());
+}
+
+TEST(EventRing, BatchHeadersCountTheirEventsAndVanishWhenEmpty)
+{
+    Simulator::EventRing ring{16};
+    const auto subscriber = ring.subscribe();
+    {
+        const Simulator::EventBatch empty{ring};
+    }
+    EXPECT_EQ(ring.published(), 0U);
+    {
+        const Simulator::EventBatch batch{ring};
+        ring.publish(moved(1));
+        ring.publish(moved(2));
+    }
+    std::vector<Simulator::SimulatorEvent> events;
+    static_cast<void>(ring.drain(subscriber,
+                                 [&events](std::span<const Simulator::SimulatorEvent> batch)
+                                 { events.insert(events.end(), batch.begin(), batch.end()); }));
+    ASSERT_EQ(events.size(), 3U);
+    EXPECT_EQ(events.front().kind, Simulator::EventKind::Batch);
+    EXPECT_FALSE(events.front().truncated);
+    EXPECT_EQ(events.front().count, 2U);
+}
+
+TEST(EventRing, FlagsABatchThatOutgrewTheRing)
+{
+    Simulator::EventRing ring{4};
+    const auto subscriber = ring.subscribe();
+    {
+        const Simulator::EventBatch batch{ring};
+        for (RobotFactory::RobotId id = 1; id <= 10; ++id)
+        {
+            ring.publish(moved(id));
+        }
+    }
+    std::vector<Simulator::SimulatorEvent> events;
+    const auto result = ring.drain(subscriber,
+                                   [&events](std::span<const Simulator::SimulatorEvent> batch)
+                                   { events.insert(events.end(), batch.begin(), batch.end()); });
+
+    // Moves 1 to 7 never arrive; the header stands in for the seventh.
+    EXPECT_EQ(result.lost, 7U);
+    ASSERT_EQ(events.size(), 4U);
+    EXPECT_EQ(events.front().kind, Simulator::EventKind::Batch);
+    EXPECT_TRUE(events.front().truncated);
+    EXPECT_EQ(events.front().count, 3U);
+    EXPECT_EQ(events.at(1).id, 8U);
+    EXPECT_EQ(events.back().id, 10U);
+}
+
+TEST(EventRing, SimulatorPublishesTypedEventsOnlyWhenSubscribed)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    const RobotFactory::RobotLocation origin{
+        .x = 0, .y = 0, .direction = RobotFactory::Direction::North};
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal, origin, "A"));
+    EXPECT_EQ(simulator.events().published(), 0U);
+
+    const auto subscriber = simulator.events().subscribe();
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 1, .direction = RobotFactory::Direction::North},
+                                "B"));
+    EXPECT_FALSE(simulator.move("A"));
+    EXPECT_EQ(simulator.moveAll(), 1U);
+    EXPECT_EQ(simulator.removeAll(), 2U);
+
+    std::vector<Simulator::SimulatorEvent> events;
+    static_cast<void>(
+        simulator.events().drain(subscriber,
+                                 [&events](std::span<const Simulator::SimulatorEvent> batch)
+                                 { events.insert(events.end(), batch.begin(), batch.end()); }));
+    std::vector<Simulator::EventKind> kinds;
+    for (const auto &event : events)
+    {
+        kinds.push_back(event.kind);
+    }
+    // moveAll() goes in slot order: A is still blocked by B, which then moves on.
+    EXPECT_EQ(kinds, (std::vector<Simulator::EventKind>{
+                         Simulator::EventKind::Placed, Simulator::EventKind::Collided,
+                         Simulator::EventKind::Batch, Simulator::EventKind::Collided,
+                         Simulator::EventKind::Moved, Simulator::EventKind::Batch,
+                         Simulator::EventKind::Cleared}));
+    ASSERT_EQ(events.size(), 7U);
+    EXPECT_EQ(events.at(1).other, events.at(0).id);
+    EXPECT_EQ(events.at(2).count, 2U);
+}
+
+} // namespace
@@ -0,0 +1,89 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/Heatmap.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+[[nodiscard]] RobotFactory::RobotLocation at(RobotFactory::Coordinate x,
+                                             RobotFactory::Coordinate y)
+{
+    return {.x = x, .y = y, .direction = RobotFactory::Direction::North};
+}
+
+TEST(Heatmap, AllocatesTilesOnlyWhereMovesLand)
+{
+    Simulator::Heatmap heatmap;
+    heatmap.start({.width = 100, .height = 40}, Simulator::Heatmap::Width::Bits32);
+    const auto empty = heatmap.memoryBytes();
+
+    heatmap.countVisit(at(3, 4));
+    heatmap.countVisit(at(3, 4));
+    heatmap.countBlocked(at(3, 4));
+    heatmap.countVisit(at(99, 39));
+
+    EXPECT_EQ(heatmap.tileCount(), 7U * 3U);
+    EXPECT_EQ(heatmap.tilesInUse(), 2U);
+    EXPECT_GT(heatmap.memoryBytes(), empty);
+    EXPECT_EQ(heatmap.at(at(3, 4)).visits, 2U);
+    EXPECT_EQ(heatmap.at(at(3, 4)).blocked, 1U);
+    EXPECT_EQ(heatmap.at(at(4, 3)).visits, 0U);
+    EXPECT_EQ(heatmap.at(at(99, 39)).visits, 1U);
+    EXPECT_EQ(heatmap.at(at(50, 20)).visits, 0U);
+    EXPECT_EQ(heatmap.at(at(-1, 0)).visits, 0U);
+    ASSERT_TRUE(heatmap.hottest(Simulator::Heatmap::Channel::Visits));
+    EXPECT_EQ(heatmap.hottest(Simulator::Heatmap::Channel::Visits)->x, 3);
+    EXPECT_EQ(heatmap.hottest(Simulator::Heatmap::Channel::Blocked)->count, 1U);
+
+    heatmap.reset();
+    EXPECT_EQ(heatmap.tilesInUse(), 0U);
+    EXPECT_EQ(heatmap.at(at(3, 4)).visits, 0U);
+    EXPECT_FALSE(heatmap.hottest(Simulator::Heatmap::Channel::Visits));
+}
+
+TEST(Heatmap, SaturatesNarrowCountersAndKeepsCountsAcrossResizes)
+{
+    Simulator::Heatmap heatmap;
+    heatmap.start({.width = 20, .height = 20}, Simulator::Heatmap::Width::Bits16);
+    for (std::size_t visit = 0; visit < 70'000; ++visit)
+    {
+        heatmap.countVisit(at(17, 2));
+    }
+    heatmap.countBlocked(at(5, 18));
+
+    EXPECT_EQ(heatmap.at(at(17, 2)).visits, 65'535U);
+
+    heatmap.resize({.width = 40, .height = 10});
+    EXPECT_EQ(heatmap.at(at(17, 2)).visits, 65'535U);
+    EXPECT_EQ(heatmap.at(at(5, 18)).blocked, 0U);
+    EXPECT_EQ(heatmap.tilesInUse(), 1U);
+    heatmap.countVisit(at(39, 9));
+    EXPECT_EQ(heatmap.at(at(39, 9)).visits, 1U);
+}
+
+TEST(Heatmap, ExportsCsvAndPgm)
+{
+    Simulator::Heatmap heatmap;
+    heatmap.start({.width = 3, .height = 2}, Simulator::Heatmap::Width::Bits32);
+    heatmap.countVisit(at(2, 1));
+    heatmap.countVisit(at(2, 1));
+    heatmap.countVisit(at(0, 0));
+    heatmap.countBlocked(at(1, 0));
+
+    std::ostringstream csv;
+    heatmap.writeCsv(csv);
+    EXPECT_EQ(csv.str(), "x,y,visits,blocked\n0,0,1,0\n1,0,0,1\n2,1,2,0\n");
+
+    std::ostringstream pgm;
+    heatmap.writePgm(pgm, Simulator::Heatmap::Channel::Visits);
+    // The top row (y = 1) comes first; the busiest cell is white.
+    const std::string expected{"P5\n3 2\n255\n\0\0\xff\x7f\0\0", 17};
+    EXPECT_EQ(pgm.str(), expected);
+}
+
+} // namespace
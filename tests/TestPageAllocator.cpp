@@ -0,0 +1,201 @@
+#include "marvin/simulator/PageAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+// Restores the process-wide page options when a test ends.
+class PageOptionsGuard
+{
+  public:
+    PageOptionsGuard() : m_saved{Simulator::pageOptions()} {}
+    ~PageOptionsGuard()
+    {
+        Simulator::setPageOptions(m_saved);
+    }
+
+    PageOptionsGuard(const PageOptionsGuard &) = delete;
+    PageOptionsGuard &operator=(const PageOptionsGuard &) = delete;
+    PageOptionsGuard(PageOptionsGuard &&) = delete;
+    PageOptionsGuard &operator=(PageOptionsGuard &&) = delete;
+
+  private:
+    Simulator::PageOptions m_saved;
+};
+
+constexpr std::size_t large_count{(Simulator::PageBlock::large_block_bytes / 8) + 3};
+
+// Counts what is allocated through it and not yet returned.
+class CountingResource final : public std::pmr::memory_resource
+{
+  public:
+    [[nodiscard]] std::size_t outstanding() const noexcept
+    {
+        return m_outstanding;
+    }
+
+  private:
+    std::size_t m_outstanding{0};
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        m_outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *data, std::size_t bytes, std::size_t alignment) override
+    {
+        m_outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(data, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST(PageBuffer, ZeroFillsSmallAndLargeBuffers)
+{
+    const Simulator::PageBuffer<std::uint64_t> small{100};
+    const Simulator::PageBuffer<std::uint64_t> large{large_count};
+
+    EXPECT_TRUE(std::all_of(small.data(), small.data() + small.size(),
+                            [](std::uint64_t value) { return value == 0; }));
+    EXPECT_TRUE(std::all_of(large.data(), large.data() + large.size(),
+                            [](std::uint64_t value) { return value == 0; }));
+    EXPECT_THROW(static_cast<void>(small.at(100)), std::out_of_range);
+}
+
+TEST(PageBuffer, GrowKeepsContentsAndZeroFillsTail)
+{
+    Simulator::PageBuffer<std::uint64_t> buffer{1000};
+    buffer.at(999) = 42;
+
+    buffer.grow(large_count);
+    EXPECT_EQ(buffer.at(999), 42U);
+    EXPECT_EQ(buffer.at(large_count - 1), 0U);
+    buffer.at(large_count - 1) = 7;
+
+    buffer.grow(large_count * 3);
+    EXPECT_EQ(buffer.at(999), 42U);
+    EXPECT_EQ(buffer.at(large_count - 1), 7U);
+    EXPECT_EQ(buffer.at((large_count * 3) - 1), 0U);
+}
+
+TEST(PageBuffer, FallsBackWhenHugePagesAreUnavailable)
+{
+    const PageOptionsGuard guard;
+    for (const auto mode :
+         {Simulator::HugePages::Off, Simulator::HugePages::Transparent,
+          Simulator::HugePages::Explicit})
+    {
+        Simulator::setPageOptions({.huge_pages = mode, .first_touch_threads = 3});
+        Simulator::PageBuffer<std::uint64_t> buffer{large_count};
+        buffer.at(large_count - 1) = 1;
+        EXPECT_EQ(buffer.at(0), 0U);
+#ifdef __linux__
+        EXPECT_TRUE(buffer.block().mapped);
+        EXPECT_EQ(buffer.block().huge_pages, mode != Simulator::HugePages::Off);
+#endif
+    }
+}
+
+TEST(PageBuffer, GrowingAMappedBufferKeepsItHugePageAligned)
+{
+#ifndef __linux__
+    GTEST_SKIP() << "Only Linux maps large buffers directly.";
+#endif
+    const auto aligned = [](const void *data)
+    {
+        return reinterpret_cast<std::uintptr_t>(data) % // NOLINT(*-reinterpret-cast)
+                   Simulator::PageBlock::large_block_bytes ==
+               0;
+    };
+    Simulator::PageBuffer<std::uint64_t> buffer{large_count};
+    buffer.at(0) = 5;
+    std::vector<Simulator::PageBuffer<std::uint64_t>> neighbours;
+    for (std::size_t count = 2; count <= 6; ++count)
+    {
+        // A new mapping next to the buffer stops it from growing in place.
+        neighbours.emplace_back(large_count);
+        buffer.grow(large_count * count);
+        EXPECT_TRUE(aligned(buffer.data())) << count;
+        EXPECT_EQ(buffer.at(0), 5U);
+        EXPECT_EQ(buffer.at((large_count * count) - 1), 0U);
+    }
+}
+
+TEST(PageAllocator, BacksStandardContainers)
+{
+    std::vector<std::uint32_t, Simulator::PageAllocator<std::uint32_t>> values;
+    for (std::uint32_t value = 0; value < 1'000'000; ++value)
+    {
+        values.push_back(value);
+    }
+
+    EXPECT_EQ(values.at(999'999), 999'999U);
+    values.clear();
+    values.shrink_to_fit();
+    EXPECT_EQ(values.capacity(), 0U);
+}
+
+TEST(PageArenaScope, AllocatesFromTheArenaUntilBlocksAreReleased)
+{
+    CountingResource arena;
+    {
+        std::vector<std::uint32_t, Simulator::PageAllocator<std::uint32_t>> values;
+        Simulator::PageBuffer<std::uint64_t> small;
+        Simulator::PageBuffer<std::uint64_t> large;
+        Simulator::CellPool pool{24, 8};
+        {
+            const Simulator::PageArenaScope scope{&arena};
+            EXPECT_EQ(Simulator::pageArena(), &arena);
+            values = decltype(values){1000, 7};
+            small = Simulator::PageBuffer<std::uint64_t>{100};
+            large = Simulator::PageBuffer<std::uint64_t>{large_count};
+            static_cast<void>(pool.allocate());
+        }
+        EXPECT_EQ(Simulator::pageArena(), nullptr);
+        const auto before = arena.outstanding();
+        EXPECT_GE(before, (large_count + 100) * 8);
+        EXPECT_FALSE(large.block().mapped);
+        EXPECT_EQ(large.block().bytes, Simulator::pageBlock(nullptr, large_count * 8).bytes);
+
+        // Blocks grow where they came from, outside the scope too.
+        large.grow(large_count * 2);
+        EXPECT_GT(arena.outstanding(), before);
+        EXPECT_EQ(large.at((large_count * 2) - 1), 0U);
+        values.resize(100'000);
+        EXPECT_EQ(values.get_allocator().arena(), &arena);
+    }
+    EXPECT_EQ(arena.outstanding(), 0U);
+}
+
+TEST(CellPool, ReusesFreedCellsBeforeGrowing)
+{
+    Simulator::CellPool pool{20, 8};
+    EXPECT_EQ(pool.cellBytes(), 24U);
+
+    auto *first = pool.allocate();
+    auto *second = pool.allocate();
+    EXPECT_NE(first, second);
+    EXPECT_EQ(pool.cellsInUse(), 2U);
+    const auto bytes = pool.memoryBytes();
+    pool.deallocate(first);
+    EXPECT_EQ(pool.allocate(), first);
+    EXPECT_EQ(pool.memoryBytes(), bytes);
+
+    EXPECT_EQ(pool.memoryBytesFor(1000), bytes + (998 * 24));
+    pool.reserve(1000 - pool.cellsInUse());
+    EXPECT_EQ(pool.memoryBytes(), bytes + (998 * 24));
+    EXPECT_THROW((Simulator::CellPool{8, 3}), std::invalid_argument);
+}
+
+} // namespace
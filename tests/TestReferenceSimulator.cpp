@@ -0,0 +1,67 @@
+#include "marvin/simulator/ReferenceSimulator.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+struct Results
+{
+    std::string output;
+    std::string errors;
+};
+
+[[nodiscard]] Results execute(Simulator::ReferenceSimulator &simulator, std::string_view line)
+{
+    std::ostringstream output;
+    std::ostringstream errors;
+    EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    return {.output = output.str(), .errors = errors.str()};
+}
+
+TEST(ReferenceSimulator, ReusesFreedSlotsWithTheNextGeneration)
+{
+    Simulator::ReferenceSimulator simulator;
+    EXPECT_TRUE(execute(simulator, "PLACE A 0,0 NORTH").errors.empty());
+    EXPECT_TRUE(execute(simulator, "PLACE B 0,2 SOUTH").errors.empty());
+    EXPECT_EQ(execute(simulator, "PLACE A 4,4 NORTH").errors,
+              "Unable to place robot; name or location is already in use.\n");
+    EXPECT_EQ(execute(simulator, "MOVE A 2").errors, "No robot could be moved.\n");
+    EXPECT_EQ(execute(simulator, "SCAN A").output, "1\n");
+    EXPECT_EQ(execute(simulator, "SCAN ALL").output, "A: 1\nB: 1\n");
+
+    // REMOVE ALL frees the highest slot first, so the lowest comes back first.
+    EXPECT_TRUE(execute(simulator, "REMOVE ALL").errors.empty());
+    EXPECT_TRUE(execute(simulator, "PLACE C 5,5 EAST").errors.empty());
+    EXPECT_EQ(execute(simulator, "REPORT").output,
+              "Grid: 10x10\nRobots: 1\n\nName: C\nID: 4294967339\nLocation: (5,5), facing EAST\n");
+    EXPECT_EQ(execute(simulator, "REMOVE @43").errors, "No matching robot was found.\n");
+}
+
+TEST(ReferenceSimulator, RollsBackAFailedTransaction)
+{
+    Simulator::ReferenceSimulator simulator;
+    EXPECT_TRUE(execute(simulator, "PLACE A 1,1 NORTH").errors.empty());
+    const auto before = simulator.worldHash();
+
+    EXPECT_TRUE(execute(simulator, "BEGIN").errors.empty());
+    EXPECT_TRUE(execute(simulator, "RESIZE 20 20").errors.empty());
+    EXPECT_TRUE(execute(simulator, "PLACE B 15,15 WEST").errors.empty());
+    EXPECT_EQ(execute(simulator, "MOVE A 30").errors, "No robot could be moved.\n");
+    // Skipped once the transaction has failed.
+    EXPECT_TRUE(execute(simulator, "REPORT").output.empty());
+    EXPECT_EQ(execute(simulator, "COMMIT").errors,
+              "Transaction rolled back; a command inside it failed.\n");
+
+    EXPECT_FALSE(simulator.inTransaction());
+    EXPECT_EQ(simulator.size(), 1U);
+    EXPECT_EQ(simulator.worldHash(), before);
+    EXPECT_EQ(execute(simulator, "MENU").errors,
+              "The reference simulator does not support MENU.\n");
+}
+
+} // namespace
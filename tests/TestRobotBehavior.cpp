@@ -0,0 +1,123 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/RobotBehavior.h"
+#include "marvin/simulator/RobotSimulator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+
+Simulator::RobotBehavior patrol(std::size_t turns)
+{
+    for (std::size_t turn = 0; turn < turns;)
+    {
+        if (!co_await Simulator::Behavior::move())
+        {
+            co_await Simulator::Behavior::rotate(RobotFactory::Rotation::Right);
+            ++turn;
+        }
+    }
+}
+
+Simulator::RobotBehavior enterWhenFree(RobotFactory::RobotLocation cell)
+{
+    co_await Simulator::Behavior::untilFree(cell);
+    co_await Simulator::Behavior::move();
+}
+
+Simulator::RobotBehavior fail()
+{
+    co_await Simulator::Behavior::move();
+    throw std::runtime_error{"behaviour failed"};
+}
+
+[[nodiscard]] bool place(Simulator::RobotSimulator &simulator, RobotFactory::Coordinate x,
+                         RobotFactory::Coordinate y, RobotFactory::Direction direction,
+                         const char *name)
+{
+    return simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                           {.x = x, .y = y, .direction = direction}, name);
+}
+
+TEST(RobotBehavior, PatrolsUntilFinished)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    ASSERT_TRUE(place(simulator, 0, 0, RobotFactory::Direction::North, "A"));
+    const auto id = simulator.findRobot("A")->id();
+    ASSERT_TRUE(simulator.attach(id, patrol(2)));
+    EXPECT_FALSE(simulator.attach(id + 1, patrol(1)));
+
+    // Two moves north, a failed move and a turn, then two moves east and the final turn.
+    std::size_t ticks{0};
+    while (simulator.behaviorCount() > 0)
+    {
+        static_cast<void>(simulator.tick());
+        ++ticks;
+    }
+
+    EXPECT_EQ(ticks, 9U);
+    const auto location = simulator.findRobot(id)->location();
+    EXPECT_EQ(location.x, 2);
+    EXPECT_EQ(location.y, 2);
+    EXPECT_EQ(location.direction, RobotFactory::Direction::South);
+}
+
+TEST(RobotBehavior, ParksOnOccupiedCellUntilItIsVacated)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    ASSERT_TRUE(place(simulator, 0, 0, RobotFactory::Direction::North, "A"));
+    ASSERT_TRUE(place(simulator, 0, 1, RobotFactory::Direction::East, "B"));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("A")->id(), enterWhenFree({.x = 0, .y = 1})));
+
+    EXPECT_EQ(simulator.tick(), 1U);
+    EXPECT_EQ(simulator.tick(), 0U);
+    EXPECT_EQ(simulator.tick(), 0U);
+
+    ASSERT_TRUE(simulator.move("B"));
+    EXPECT_EQ(simulator.tick(), 1U);
+    EXPECT_EQ(simulator.findRobot("A")->location().y, 1);
+    EXPECT_EQ(simulator.tick(), 1U);
+    EXPECT_EQ(simulator.behaviorCount(), 0U);
+}
+
+TEST(RobotBehavior, EndsWhenRobotIsRemovedAndReportsExceptions)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    ASSERT_TRUE(place(simulator, 0, 0, RobotFactory::Direction::North, "A"));
+    ASSERT_TRUE(place(simulator, 2, 0, RobotFactory::Direction::North, "B"));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("A")->id(), patrol(100)));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("B")->id(), fail()));
+
+    EXPECT_EQ(simulator.tick(), 2U);
+    ASSERT_TRUE(simulator.remove("A"));
+    EXPECT_THROW(static_cast<void>(simulator.tick()), std::runtime_error);
+    EXPECT_EQ(simulator.behaviorCount(), 0U);
+}
+
+TEST(RobotBehavior, RemovingARobotDestroysItsParkedBehaviour)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    ASSERT_TRUE(place(simulator, 0, 0, RobotFactory::Direction::North, "A"));
+    ASSERT_TRUE(place(simulator, 0, 1, RobotFactory::Direction::East, "B"));
+    ASSERT_TRUE(place(simulator, 2, 0, RobotFactory::Direction::North, "C"));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("A")->id(), enterWhenFree({.x = 0, .y = 1})));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("C")->id(), enterWhenFree({.x = 0, .y = 1})));
+    ASSERT_TRUE(simulator.attach(simulator.findRobot("C")->id(), patrol(100)));
+    EXPECT_EQ(simulator.tick(), 3U);
+    EXPECT_EQ(simulator.behaviorCount(), 3U);
+
+    // A's behaviour is parked on B's cell, so no tick would ever look at it again.
+    ASSERT_TRUE(simulator.remove("A"));
+    EXPECT_EQ(simulator.behaviorCount(), 2U);
+
+    EXPECT_EQ(simulator.removeAll(), 2U);
+    EXPECT_EQ(simulator.behaviorCount(), 0U);
+    EXPECT_EQ(simulator.tick(), 0U);
+}
+
+} // namespace
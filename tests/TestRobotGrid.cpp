@@ -1,9 +1,14 @@
 #include "marvin/robot/Marvin.h"
 #include "marvin/robot/Robot.h"
+#include "marvin/simulator/FixedRobotGrid.h"
 #include "marvin/simulator/RobotGrid.h"
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 namespace
 {
 
@@ -50,12 +55,150 @@ TEST(RobotGrid, PreservesRobotsWhenExpanded)
     EXPECT_EQ(grid.robotIdAt(robot.location()), robot.id());
 }
 
-TEST(RobotGrid, RejectsShrinking)
+TEST(RobotGrid, MortonLayoutPreservesRobotsWhenExpanded)
+{
+    Simulator::RobotGrid grid{{.width = 20, .height = 3}, Simulator::GridLayout::Morton};
+    const RobotFactory::Marvin first{
+        RobotFactory::RobotLocation{.x = 19, .y = 2, .direction = RobotFactory::Direction::North}};
+    const RobotFactory::Marvin second{
+        RobotFactory::RobotLocation{.x = 3, .y = 1, .direction = RobotFactory::Direction::North}};
+    ASSERT_TRUE(grid.addRobot(first));
+    ASSERT_TRUE(grid.addRobot(second));
+
+    ASSERT_TRUE(grid.resize({.width = 40, .height = 33}));
+    EXPECT_EQ(grid.layout(), Simulator::GridLayout::Morton);
+    EXPECT_EQ(grid.robotIdAt(first.location()), first.id());
+    EXPECT_EQ(grid.robotIdAt(second.location()), second.id());
+    EXPECT_FALSE(grid.isOccupied({.x = 19, .y = 1}));
+    EXPECT_FALSE(grid.isOccupied({.x = 3, .y = 2}));
+}
+
+TEST(RobotGrid, MortonLayoutMapsEveryCellUniquely)
+{
+    Simulator::RobotGrid grid{{.width = 21, .height = 18}, Simulator::GridLayout::Morton};
+    std::vector<std::unique_ptr<RobotFactory::Marvin>> robots;
+    for (RobotFactory::Coordinate y = 0; y < 18; ++y)
+    {
+        for (RobotFactory::Coordinate x = 0; x < 21; ++x)
+        {
+            robots.push_back(std::make_unique<RobotFactory::Marvin>(
+                RobotFactory::RobotLocation{.x = x, .y = y}));
+            ASSERT_TRUE(grid.addRobot(*robots.back()));
+        }
+    }
+
+    for (const auto &robot : robots)
+    {
+        EXPECT_EQ(grid.robotIdAt(robot->location()), robot->id());
+    }
+}
+
+TEST(RobotGrid, ShrinksOnlyWhenEveryRobotStaysOnGrid)
+{
+    Simulator::RobotGrid grid{{.width = 6, .height = 6}};
+    RobotFactory::Marvin robot{
+        RobotFactory::RobotLocation{.x = 4, .y = 1, .direction = RobotFactory::Direction::West}};
+    ASSERT_TRUE(grid.addRobot(robot));
+
+    EXPECT_FALSE(grid.resize({.width = 4, .height = 6}));
+    EXPECT_TRUE(grid.resize({.width = 5, .height = 2}));
+    EXPECT_TRUE(grid.isOffGrid({.x = 0, .y = 2}));
+
+    const auto previous = robot.location();
+    robot.move(4);
+    grid.updateLocation(previous, robot);
+    EXPECT_TRUE(grid.resize({.width = 1, .height = 2}));
+    EXPECT_EQ(grid.robotIdAt({.x = 0, .y = 1}), robot.id());
+    EXPECT_TRUE(grid.resize({.width = 6, .height = 6}));
+    EXPECT_FALSE(grid.isOccupied({.x = 4, .y = 1}));
+}
+
+TEST(RobotGrid, GrowsGeometricallyWithinCapacity)
+{
+    Simulator::RobotGrid grid{{.width = 100, .height = 100}, Simulator::GridLayout::Morton};
+    const RobotFactory::Marvin robot{
+        RobotFactory::RobotLocation{.x = 99, .y = 99, .direction = RobotFactory::Direction::North}};
+    ASSERT_TRUE(grid.addRobot(robot));
+
+    ASSERT_TRUE(grid.resize({.width = 101, .height = 101}));
+    const auto capacity = grid.capacity();
+    EXPECT_GE(capacity.width, 150);
+    EXPECT_GE(capacity.height, 150);
+    for (RobotFactory::Coordinate extent = 102; extent <= 150; ++extent)
+    {
+        ASSERT_TRUE(grid.resize({.width = extent, .height = extent}));
+    }
+    EXPECT_EQ(grid.capacity().width, capacity.width);
+    EXPECT_EQ(grid.robotIdAt(robot.location()), robot.id());
+}
+
+TEST(RobotGrid, ScansToNearestRobotOrEdgeAcrossWords)
 {
-    Simulator::RobotGrid grid{{.width = 4, .height = 3}};
+    Simulator::RobotGrid grid{{.width = 200, .height = 150}};
+    RobotFactory::Marvin scout{
+        RobotFactory::RobotLocation{.x = 10, .y = 5, .direction = RobotFactory::Direction::East}};
+    const RobotFactory::Marvin east{
+        RobotFactory::RobotLocation{.x = 140, .y = 5, .direction = RobotFactory::Direction::North}};
+    const RobotFactory::Marvin north{
+        RobotFactory::RobotLocation{.x = 10, .y = 70, .direction = RobotFactory::Direction::North}};
+    ASSERT_TRUE(grid.addRobot(scout));
+    ASSERT_TRUE(grid.addRobot(east));
+    ASSERT_TRUE(grid.addRobot(north));
+    EXPECT_EQ(grid.clearance(scout.location()), 129);
+    grid.trackLineOfSight();
+
+    auto location = scout.location();
+    EXPECT_EQ(grid.clearance(location), 129);
+    location.direction = RobotFactory::Direction::North;
+    EXPECT_EQ(grid.clearance(location), 64);
+    location.direction = RobotFactory::Direction::South;
+    EXPECT_EQ(grid.clearance(location), 5);
+    location.direction = RobotFactory::Direction::West;
+    EXPECT_EQ(grid.clearance(location), 10);
+    EXPECT_EQ(grid.clearance(east.location()), 144);
+    EXPECT_EQ(grid.clearance({.x = 150, .y = 5, .direction = RobotFactory::Direction::West}), 9);
+
+    const auto previous = scout.location();
+    scout.move(100);
+    grid.updateLocation(previous, scout);
+    ASSERT_TRUE(grid.resize({.width = 400, .height = 300}));
+    EXPECT_EQ(grid.clearance(scout.location()), 29);
+    EXPECT_EQ(grid.clearance(north.location()), 229);
+    EXPECT_EQ(grid.clearance({.x = 399, .y = 5, .direction = RobotFactory::Direction::West}),
+              258);
+}
+
+TEST(FixedRobotGrid, PadsRowsToPowerOfTwoStride)
+{
+    using Grid = Simulator::FixedRobotGrid<10, 3>;
+
+    static_assert(Grid::stride == 16);
+    static_assert(Grid{}.isOffGrid({.x = 10, .y = 0}));
+    static_assert(!Grid{}.isOffGrid({.x = 9, .y = 2}));
+    EXPECT_EQ(Grid{}.size().width, 10);
+}
+
+TEST(FixedRobotGrid, MatchesDynamicGridBehaviour)
+{
+    Simulator::FixedRobotGrid<3, 5> grid;
+    RobotFactory::Marvin robot{
+        RobotFactory::RobotLocation{.x = 2, .y = 4, .direction = RobotFactory::Direction::West}};
+    const RobotFactory::Marvin blocker{
+        RobotFactory::RobotLocation{.x = 2, .y = 4, .direction = RobotFactory::Direction::North}};
+    const RobotFactory::Marvin outside{
+        RobotFactory::RobotLocation{.x = -1, .y = 0, .direction = RobotFactory::Direction::North}};
+
+    ASSERT_TRUE(grid.addRobot(robot));
+    EXPECT_FALSE(grid.addRobot(blocker));
+    EXPECT_FALSE(grid.addRobot(outside));
 
-    EXPECT_FALSE(grid.resize({.width = 3, .height = 3}));
-    EXPECT_EQ(grid.size().width, 4);
+    const auto previous = robot.location();
+    robot.move(2);
+    grid.updateLocation(previous, robot);
+    EXPECT_FALSE(grid.isOccupied(previous));
+    EXPECT_EQ(grid.robotIdAt({.x = 0, .y = 4}), robot.id());
+    EXPECT_THROW(static_cast<void>(grid.robotIdAt({.x = 3, .y = 0})), std::out_of_range);
+    EXPECT_FALSE(grid.resize({.width = 4, .height = 5}));
 }
 
 } // namespace
@@ -0,0 +1,74 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGroups.h"
+
+#include <gtest/gtest.h>
+
+#include <span>
+#include <vector>
+
+namespace
+{
+
+[[nodiscard]] std::vector<RobotFactory::RobotId> members(std::span<const RobotFactory::RobotId> ids)
+{
+    return {ids.begin(), ids.end()};
+}
+
+TEST(RobotGroups, RemovedRobotLeavesEveryGroupInPlace)
+{
+    Simulator::RobotGroups groups;
+    const auto pickers = groups.create("PICKERS");
+    const auto loaders = groups.create("LOADERS");
+    ASSERT_TRUE(pickers && loaders);
+    EXPECT_FALSE(groups.create("PICKERS"));
+
+    for (const RobotFactory::RobotId id : {43, 44, 45, 46})
+    {
+        EXPECT_TRUE(groups.add(*pickers, id));
+    }
+    EXPECT_FALSE(groups.add(*pickers, 44));
+    EXPECT_TRUE(groups.add(*loaders, 44));
+    EXPECT_TRUE(groups.add(*loaders, 45));
+
+    const auto left = groups.leaveAll(44);
+    EXPECT_EQ(left.size(), 2U);
+    // The last member fills the hole, so the rest keep their positions.
+    EXPECT_EQ(members(groups.members(*pickers)), (std::vector<RobotFactory::RobotId>{43, 46, 45}));
+    EXPECT_EQ(members(groups.members(*loaders)), (std::vector<RobotFactory::RobotId>{45}));
+    EXPECT_TRUE(groups.leaveAll(44).empty());
+
+    // The moved member's membership followed it.
+    static_cast<void>(groups.leaveAll(46));
+    EXPECT_EQ(members(groups.members(*pickers)), (std::vector<RobotFactory::RobotId>{43, 45}));
+}
+
+TEST(RobotGroups, DeletingAGroupKeepsOtherMemberships)
+{
+    Simulator::RobotGroups groups;
+    const auto first = *groups.create("FIRST");
+    const auto second = *groups.create("SECOND");
+    for (const RobotFactory::RobotId id : {43, 44})
+    {
+        groups.add(first, id);
+        groups.add(second, id);
+    }
+
+    EXPECT_TRUE(groups.erase("FIRST"));
+    EXPECT_FALSE(groups.erase("FIRST"));
+    EXPECT_FALSE(groups.find("FIRST"));
+    EXPECT_EQ(groups.size(), 1U);
+    EXPECT_EQ(groups.leaveAll(43).size(), 1U);
+    EXPECT_EQ(members(groups.members(second)), (std::vector<RobotFactory::RobotId>{44}));
+
+    // A new group reuses the deleted one's storage.
+    const auto third = *groups.create("THIRD");
+    EXPECT_EQ(third, first);
+    EXPECT_TRUE(groups.add(third, 44));
+    EXPECT_EQ(members(groups.members(third)), (std::vector<RobotFactory::RobotId>{44}));
+
+    groups.clearMembers();
+    EXPECT_TRUE(groups.members(second).empty());
+    EXPECT_EQ(groups.size(), 2U);
+}
+
+} // namespace
@@ -0,0 +1,174 @@
+#include "marvin/robot/Marvin.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotHandleTable.h"
+#include "marvin/simulator/RobotNameIndex.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+TEST(RobotHandleTable, HandsOutSequentialIdsFromFirstId)
+{
+    Simulator::RobotHandleTable table;
+
+    EXPECT_EQ(table.acquire(), 43U);
+    EXPECT_EQ(table.acquire(), 44U);
+    EXPECT_EQ(table.find(42), nullptr);
+    EXPECT_EQ(table.find(45), nullptr);
+}
+
+TEST(RobotHandleTable, DetectsStaleHandlesAfterSlotReuse)
+{
+    Simulator::RobotHandleTable table;
+    const auto first_id = table.acquire();
+    table.bind(first_id, std::make_unique<RobotFactory::Marvin>(
+                             RobotFactory::RobotLocation{}, "FIRST", first_id));
+    ASSERT_NE(table.find(first_id), nullptr);
+
+    table.release(first_id);
+    const auto second_id = table.acquire();
+    const auto &second = table.bind(second_id, std::make_unique<RobotFactory::Marvin>(
+                                                   RobotFactory::RobotLocation{}, "SECOND",
+                                                   second_id));
+
+    EXPECT_NE(second_id, first_id);
+    EXPECT_EQ(table.capacity(), 1U);
+    EXPECT_EQ(table.size(), 1U);
+    EXPECT_EQ(table.find(first_id), nullptr);
+    EXPECT_EQ(table.find(second_id), &second);
+}
+
+TEST(RobotHandleTable, ReusesUnboundSlotsWithoutNewGeneration)
+{
+    Simulator::RobotHandleTable table;
+    const auto id = table.acquire();
+
+    table.release(id);
+
+    EXPECT_EQ(table.acquire(), id);
+}
+
+TEST(RobotHandleTable, EmplacedRobotsSurviveTakeAndRestore)
+{
+    Simulator::RobotHandleTable table;
+    const auto id = table.acquire();
+    const auto &robot = table.emplace(id, RobotFactory::GroundRobotType::Bipedal,
+                                      {.x = 2, .y = 3, .direction = RobotFactory::Direction::East},
+                                      "POOLED");
+    EXPECT_EQ(robot.id(), id);
+    EXPECT_EQ(table.robotBytes(), sizeof(RobotFactory::Marvin));
+
+    auto taken = table.take(id);
+    ASSERT_TRUE(taken);
+    EXPECT_EQ(table.find(id), nullptr);
+    EXPECT_EQ(table.robotBytes(), 0U);
+    table.restore(id, std::move(taken));
+
+    ASSERT_NE(table.find(id), nullptr);
+    EXPECT_EQ(table.find(id)->model(), "POOLED");
+    EXPECT_EQ(table.find(id)->location().x, 2);
+    table.release(id);
+    EXPECT_EQ(table.size(), 0U);
+}
+
+TEST(RobotNameIndex, InsertAllReportsTakenNames)
+{
+    Simulator::RobotHandleTable table;
+    Simulator::RobotNameIndex index;
+    std::vector<RobotFactory::RobotId> ids;
+    for (const auto *name : {"ALPHA", "BRAVO", "alpha", "CHARLIE"})
+    {
+        ids.push_back(table.acquire());
+        static_cast<void>(table.emplace(ids.back(), RobotFactory::GroundRobotType::Bipedal, {},
+                                        name));
+    }
+    std::vector<RobotFactory::RobotId> clashes;
+
+    index.insertAll(ids, table, clashes);
+
+    EXPECT_EQ(clashes, std::vector<RobotFactory::RobotId>{ids.at(2)});
+    EXPECT_EQ(index.size(), 3U);
+    EXPECT_EQ(index.find("charlie", table), ids.at(3));
+}
+
+TEST(RobotNameIndex, FindsNamesCaseInsensitivelyAndSurvivesErasure)
+{
+    Simulator::RobotHandleTable table;
+    Simulator::RobotNameIndex index;
+    for (const auto *name : {"ALPHA", "BRAVO", "CHARLIE", "DELTA"})
+    {
+        const auto id = table.acquire();
+        ASSERT_TRUE(index.insert(
+            table.bind(id, std::make_unique<RobotFactory::Marvin>(RobotFactory::RobotLocation{},
+                                                                  name, id)),
+            table));
+    }
+    const auto bravo = index.find("bravo", table);
+    ASSERT_NE(bravo, 0U);
+
+    index.erase(*table.find(bravo));
+
+    EXPECT_EQ(index.find("Bravo", table), 0U);
+    EXPECT_NE(index.find("alpha", table), 0U);
+    EXPECT_NE(index.find("charlie", table), 0U);
+    EXPECT_NE(index.find("DELTA", table), 0U);
+    EXPECT_EQ(index.size(), 3U);
+}
+
+TEST(RobotNameIndex, RejectsDuplicateNames)
+{
+    Simulator::RobotHandleTable table;
+    Simulator::RobotNameIndex index;
+    const auto first = table.acquire();
+    const auto second = table.acquire();
+    ASSERT_TRUE(index.insert(table.bind(first, std::make_unique<RobotFactory::Marvin>(
+                                                   RobotFactory::RobotLocation{}, "R2D2", first)),
+                             table));
+
+    EXPECT_FALSE(index.insert(table.bind(second, std::make_unique<RobotFactory::Marvin>(
+                                                     RobotFactory::RobotLocation{}, "R2D2",
+                                                     second)),
+                              table));
+    EXPECT_EQ(index.find("r2d2", table), first);
+}
+
+TEST(RobotNameIndex, VisitsOnlyNamesWithThePrefixInOrder)
+{
+    Simulator::RobotHandleTable table;
+    Simulator::RobotNameIndex index;
+    const auto add = [&table, &index](const char *name)
+    {
+        const auto id = table.acquire();
+        ASSERT_TRUE(index.insert(
+            table.bind(id, std::make_unique<RobotFactory::Marvin>(RobotFactory::RobotLocation{},
+                                                                  name, id)),
+            table));
+    };
+    add("DOCK1_B");
+    add("AISLE7_A");
+    index.trackPrefixes(table);
+    add("DOCK1_A");
+    add("DOCK10_A");
+    add("DOCK2_A");
+    const auto before = index.memoryBytes();
+    index.erase(*table.find(index.find("dock1_b", table)));
+
+    std::vector<std::string> names;
+    index.forEachPrefixed("DOCK1", [&names](std::string_view name, RobotFactory::RobotId)
+                          { names.emplace_back(name); });
+    EXPECT_EQ(names, (std::vector<std::string>{"DOCK10_A", "DOCK1_A"}));
+    EXPECT_LT(index.memoryBytes(), before);
+    names.clear();
+    index.clear();
+    index.forEachPrefixed("", [&names](std::string_view name, RobotFactory::RobotId)
+                          { names.emplace_back(name); });
+    EXPECT_TRUE(names.empty());
+}
+
+} // namespace
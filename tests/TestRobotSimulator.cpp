@@ -1,3 +1,5 @@
+#include "marvin/command/CommandGenerator.h"
+#include "marvin/robot/Marvin.h"
 #include "marvin/robot/Robot.h"
 #include "marvin/robot/RobotAssembly.h"
 #include "marvin/simulator/RobotSimulator.h"
@@ -5,7 +7,10 @@
 #include <gtest/gtest.h>
 
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace
 {
@@ -40,6 +45,59 @@ TEST(RobotSimulator, SupportsIdTargeting)
     EXPECT_EQ(simulator.findRobot(id), nullptr);
 }
 
+TEST(RobotSimulator, AllocatesIdsPerSimulatorAndRejectsStaleIds)
+{
+    Simulator::RobotSimulator first;
+    Simulator::RobotSimulator second;
+    ASSERT_TRUE(first.place(RobotFactory::GroundRobotType::Bipedal, {.x = 0, .y = 0}, "A"));
+    ASSERT_TRUE(second.place(RobotFactory::GroundRobotType::Bipedal, {.x = 0, .y = 0}, "B"));
+    EXPECT_EQ(first.findRobot("A")->id(), 43U);
+    EXPECT_EQ(second.findRobot("B")->id(), 43U);
+
+    ASSERT_TRUE(first.remove(43));
+    ASSERT_TRUE(first.place(RobotFactory::GroundRobotType::Bipedal, {.x = 1, .y = 1}, "C"));
+    EXPECT_EQ(first.findRobot(43), nullptr);
+    EXPECT_FALSE(first.move(43));
+    EXPECT_EQ(first.findRobot(first.findRobot("C")->id())->model(), "C");
+}
+
+TEST(RobotSimulator, PlacesBulkLocationsSkippingCollisions)
+{
+    Simulator::RobotSimulator simulator{{.width = 4, .height = 4}};
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 1, .y = 1}, "R44"));
+    const std::vector<RobotFactory::RobotLocation> locations{
+        {.x = 0, .y = 0}, {.x = 1, .y = 1}, {.x = 0, .y = 0}, {.x = 9, .y = 0}, {.x = 3, .y = 3}};
+
+    EXPECT_EQ(simulator.placeBulk(RobotFactory::GroundRobotType::Bipedal, locations), 2U);
+    EXPECT_EQ(simulator.robotCount(), 3U);
+    EXPECT_EQ(simulator.findRobot("R44")->location().x, 1);
+}
+
+TEST(RobotSimulator, PopulatesEveryPatternWithDistinctCells)
+{
+    for (const auto pattern :
+         {Simulator::PopulationPattern::Random, Simulator::PopulationPattern::Lattice,
+          Simulator::PopulationPattern::Clustered})
+    {
+        Simulator::RobotSimulator simulator{{.width = 50, .height = 40}};
+
+        EXPECT_EQ(simulator.populate(500, pattern, 7), 500U);
+        EXPECT_EQ(simulator.robotCount(), 500U);
+        EXPECT_EQ(simulator.moveAll(0), 0U);
+    }
+}
+
+TEST(RobotSimulator, ReportsPopulationShortfall)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    EXPECT_TRUE(simulator.executeLine("POPULATE 20 LATTICE", output, errors));
+    EXPECT_EQ(simulator.robotCount(), 9U);
+    EXPECT_NE(errors.str().find("Placed 9 of 20"), std::string::npos);
+}
+
 TEST(RobotSimulator, PreventsCollisionsDuringMoveAll)
 {
     Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
@@ -92,4 +150,461 @@ TEST(RobotSimulator, RunsCommandLoopUntilQuit)
     EXPECT_NE(output.str().find("Robots: 1"), std::string::npos);
 }
 
+TEST(RobotSimulator, CountsCommandsAndCollisionsInStatistics)
+{
+    if constexpr (!Simulator::statistics_enabled)
+    {
+        GTEST_SKIP() << "Statistics are compiled out.";
+    }
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    std::istringstream input{"PLACE A 0,0 NORTH\nPLACE B 0,1 SOUTH\nMOVE A\nSTATS\nQUIT\n"};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    simulator.run(input, output, errors);
+
+    EXPECT_EQ(simulator.statistics().command(0).count, 2U);
+    EXPECT_EQ(simulator.statistics().counters().collisions, 1U);
+    EXPECT_NE(output.str().find("Collisions: 1"), std::string::npos);
+}
+
+TEST(RobotSimulator, AbortRestoresPositionsNamesAndIds)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 0, .direction = RobotFactory::Direction::North},
+                                "A"));
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 4, .y = 4, .direction = RobotFactory::Direction::South},
+                                "B"));
+    const auto removed_id = simulator.findRobot("B")->id();
+
+    ASSERT_TRUE(simulator.begin());
+    EXPECT_TRUE(simulator.resize({.width = 8, .height = 8}));
+    EXPECT_TRUE(simulator.move("A", 2));
+    EXPECT_TRUE(simulator.rotate("A", RobotFactory::Rotation::Right));
+    EXPECT_TRUE(simulator.remove("B"));
+    EXPECT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 7, .y = 7, .direction = RobotFactory::Direction::West},
+                                "C"));
+    EXPECT_EQ(simulator.populate(3, Simulator::PopulationPattern::Lattice), 3U);
+    EXPECT_EQ(simulator.removeAll(), 5U);
+    ASSERT_TRUE(simulator.abort());
+
+    EXPECT_FALSE(simulator.inTransaction());
+    EXPECT_EQ(simulator.gridSize().width, 5);
+    EXPECT_EQ(simulator.robotCount(), 2U);
+    EXPECT_EQ(simulator.findRobot("C"), nullptr);
+    const auto first = simulator.findRobot("A")->location();
+    EXPECT_EQ(first.y, 0);
+    EXPECT_EQ(first.direction, RobotFactory::Direction::North);
+    ASSERT_NE(simulator.findRobot(removed_id), nullptr);
+    EXPECT_EQ(simulator.findRobot(removed_id)->model(), "B");
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 4, .y = 4}, "D"));
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 0, .y = 0}, "D"));
+    EXPECT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 0, .y = 2}, "D"));
+}
+
+TEST(RobotSimulator, FailedCommandRollsBackTransactionOnCommit)
+{
+    Simulator::RobotSimulator simulator{{.width = 3, .height = 3}};
+    std::istringstream input{"PLACE A 0,0 NORTH\nBEGIN\nMOVE A\nMOVE A 5\nPLACE B 2,2 EAST\n"
+                             "COMMIT\nBEGIN\nMOVE A\nCOMMIT\nQUIT\n"};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    simulator.run(input, output, errors);
+
+    EXPECT_NE(errors.str().find("rolled back"), std::string::npos);
+    EXPECT_EQ(simulator.findRobot("B"), nullptr);
+    EXPECT_EQ(simulator.findRobot("A")->location().y, 1);
+    EXPECT_FALSE(simulator.inTransaction());
+}
+
+TEST(RobotSimulator, ChecksDeferredMovesInOrderWhenTheTransactionSettles)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    std::ostringstream output;
+    std::ostringstream errors;
+    for (const auto *line : {"PLACE A 0,0 NORTH", "PLACE B 0,2 EAST", "BEGIN", "MOVE B",
+                             "MOVE A 2", "COMMIT"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+    EXPECT_TRUE(errors.str().empty());
+    EXPECT_EQ(simulator.findRobot("A")->location().y, 2);
+
+    // A reaches B's cell before B leaves it: the moves are replayed in order when REPORT needs
+    // the grid, so A's collides there, and it and every later move are undone.
+    for (const auto *line : {"BEGIN", "RIGHT A", "MOVE A", "MOVE B 2", "REPORT"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+    EXPECT_EQ(errors.str(), "No robot could be moved.\n");
+    EXPECT_EQ(simulator.findRobot("A")->location().x, 0);
+    EXPECT_EQ(simulator.findRobot("A")->location().direction, RobotFactory::Direction::East);
+    EXPECT_EQ(simulator.findRobot("B")->location().x, 1);
+    EXPECT_TRUE(simulator.executeLine("COMMIT", output, errors));
+    EXPECT_NE(errors.str().find("rolled back"), std::string::npos);
+    EXPECT_EQ(simulator.findRobot("A")->location().direction, RobotFactory::Direction::North);
+
+    // The grid never saw the undone moves.
+    EXPECT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 3, .y = 2}, "C"));
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 1, .y = 2}, "D"));
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal, {.x = 0, .y = 2}, "D"));
+}
+
+TEST(RobotSimulator, AppliesWhereClausesToMatchingRobotsOnly)
+{
+    Simulator::RobotSimulator simulator{{.width = 10, .height = 10}};
+    std::istringstream input{"PLACE DOCK1 0,0 NORTH\nPLACE DOCK2 5,0 NORTH\nPLACE YARD 6,0 EAST\n"
+                             "MOVE ALL 3 WHERE NAME=DOCK* X=..5\n"
+                             "ROTATE RIGHT WHERE DIRECTION=EAST\nREMOVE WHERE Y=3 X=5\n"
+                             "REPORT WHERE DIRECTION=SOUTH\nMOVE WHERE NAME=NOBODY\nQUIT\n"};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    simulator.run(input, output, errors);
+
+    EXPECT_EQ(simulator.robotCount(), 2U);
+    EXPECT_EQ(simulator.findRobot("DOCK1")->location().y, 3);
+    EXPECT_EQ(simulator.findRobot("DOCK2"), nullptr);
+    EXPECT_EQ(simulator.findRobot("YARD")->location().direction, RobotFactory::Direction::South);
+    EXPECT_NE(output.str().find("Robots: 1 of 2"), std::string::npos);
+    EXPECT_NE(errors.str().find("No robot could be moved."), std::string::npos);
+}
+
+TEST(RobotSimulator, ScansDistanceToNearestObstacle)
+{
+    Simulator::RobotSimulator simulator{{.width = 10, .height = 10}};
+    std::istringstream input{
+        "PLACE A 0,0 EAST\nPLACE B 4,0 NORTH\nSCAN A\nSCAN ALL\nSCAN C\nQUIT\n"};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    simulator.run(input, output, errors);
+
+    EXPECT_NE(output.str().find("> 3\n"), std::string::npos);
+    EXPECT_NE(output.str().find("A: 3\nB: 9\n"), std::string::npos);
+    EXPECT_NE(errors.str().find("No matching robot was found."), std::string::npos);
+    std::vector<Simulator::ScanResult> results;
+    simulator.scanAll(results);
+    ASSERT_EQ(results.size(), 2U);
+    EXPECT_EQ(results.at(1).distance, 9);
+    EXPECT_EQ(simulator.scan("B"), 9);
+}
+
+TEST(RobotSimulator, KeepsRobotsOffBlockedTerrain)
+{
+    Simulator::RobotSimulator simulator{{.width = 10, .height = 10}};
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 0, .direction = RobotFactory::Direction::North},
+                                "A"));
+    Simulator::TerrainMap::Builder under_robot;
+    under_robot.addRun(0, 0, 1, Simulator::terrain_blocked);
+    EXPECT_FALSE(simulator.setTerrain(std::move(under_robot).build()));
+
+    Simulator::TerrainMap::Builder builder;
+    builder.addRun(2, 0, 10, 4);
+    builder.addRun(5, 0, 10, Simulator::terrain_blocked);
+    ASSERT_TRUE(simulator.setTerrain(std::move(builder).build()));
+
+    EXPECT_TRUE(simulator.move("A", 3));
+    EXPECT_FALSE(simulator.move("A", 2));
+    EXPECT_EQ(simulator.findRobot("A")->location().y, 3);
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                 {.x = 4, .y = 5, .direction = RobotFactory::Direction::North},
+                                 "B"));
+    if constexpr (Simulator::statistics_enabled)
+    {
+        EXPECT_EQ(simulator.statistics().counters().obstacles, 2U);
+        EXPECT_EQ(simulator.statistics().counters().terrain_cost, 3U + 4U);
+    }
+}
+
+TEST(RobotSimulator, AccountsForRobotsNamesAndIndexes)
+{
+    Simulator::RobotSimulator simulator{{.width = 10, .height = 10}};
+    const auto empty = simulator.memoryUsage();
+    EXPECT_EQ(empty.robots, 0U);
+    EXPECT_GE(empty.grid, 100U * sizeof(RobotFactory::RobotId));
+
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 0, .direction = RobotFactory::Direction::North},
+                                "A"));
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 1, .y = 0, .direction = RobotFactory::Direction::North},
+                                std::string(40, 'B')));
+    const auto placed = simulator.memoryUsage();
+    EXPECT_EQ(placed.robots, 2 * sizeof(RobotFactory::Marvin));
+    EXPECT_EQ(placed.strings, 41U);
+    EXPECT_GT(placed.ids, 0U);
+    EXPECT_GT(placed.names, 0U);
+
+    // A robot removed inside a transaction is still held until the transaction ends.
+    ASSERT_TRUE(simulator.begin());
+    ASSERT_TRUE(simulator.remove(std::string(40, 'B')));
+    EXPECT_EQ(simulator.memoryUsage().robots, sizeof(RobotFactory::Marvin));
+    EXPECT_GE(simulator.memoryUsage().transaction, sizeof(RobotFactory::Marvin) + 41U);
+    ASSERT_TRUE(simulator.abort());
+    EXPECT_EQ(simulator.memoryUsage().robots, placed.robots);
+    EXPECT_EQ(simulator.memoryUsage().strings, placed.strings);
+
+    EXPECT_EQ(simulator.removeAll(), 2U);
+    EXPECT_EQ(simulator.memoryUsage().robots, 0U);
+    EXPECT_EQ(simulator.memoryUsage().strings, 0U);
+}
+
+TEST(RobotSimulator, RejectsChangesPastTheMemoryLimit)
+{
+    Simulator::RobotSimulator simulator{{.width = 10, .height = 10}};
+    simulator.setMemoryLimit(simulator.memoryUsage().total() + 1024);
+
+    EXPECT_FALSE(simulator.resize({.width = 1000, .height = 1000}));
+    EXPECT_EQ(simulator.gridSize().width, 10);
+    EXPECT_EQ(simulator.populate(50, Simulator::PopulationPattern::Lattice), 0U);
+    EXPECT_EQ(simulator.robotCount(), 0U);
+    EXPECT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 0, .direction = RobotFactory::Direction::North},
+                                "A"));
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                 {.x = 1, .y = 0, .direction = RobotFactory::Direction::North},
+                                 std::string(4096, 'B')));
+    EXPECT_LE(simulator.memoryUsage().total(), simulator.memoryLimit());
+
+    std::ostringstream output;
+    std::ostringstream errors;
+    EXPECT_TRUE(simulator.executeLine("RESIZE 1000 1000", output, errors));
+    EXPECT_EQ(errors.str(), "Unable to resize; the memory limit would be exceeded.\n");
+    EXPECT_TRUE(simulator.executeLine("MEMORY LIMIT OFF", output, errors));
+    EXPECT_TRUE(simulator.executeLine("RESIZE 1000 1000", output, errors));
+    EXPECT_TRUE(simulator.executeLine("MEMORY", output, errors));
+    EXPECT_NE(output.str().find("Limit: none"), std::string::npos);
+    EXPECT_EQ(simulator.gridSize().width, 1000);
+}
+
+TEST(RobotSimulator, HeatmapCountsVisitsAndCollisions)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    std::ostringstream output;
+    std::ostringstream errors;
+    for (const auto *line : {"HEATMAP ON", "PLACE A 0,0 NORTH", "PLACE B 0,2 SOUTH", "MOVE A",
+                             "MOVE A", "MOVE B", "MOVE B"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+
+    const auto &heatmap = simulator.heatmap();
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 1, .direction = {}}).visits, 1U);
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 1, .direction = {}}).blocked, 2U);
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 2, .direction = {}}).blocked, 1U);
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 2, .direction = {}}).visits, 0U);
+    EXPECT_GT(simulator.memoryUsage().heatmap, 0U);
+
+    output.str({});
+    EXPECT_TRUE(simulator.executeLine("HEATMAP", output, errors));
+    EXPECT_EQ(output.str(), "Heatmap: 32-bit counters, 1 of 1 tiles in use\n"
+                            "Most visited: (0,1), 1 times\n"
+                            "Most blocked: (0,1), 2 times\n");
+    EXPECT_TRUE(simulator.executeLine("HEATMAP OFF", output, errors));
+    EXPECT_TRUE(simulator.executeLine("HEATMAP CSV heatmap.csv", output, errors));
+    EXPECT_EQ(errors.str(), "No robot could be moved.\n"
+                            "No robot could be moved.\n"
+                            "No robot could be moved.\n"
+                            "The heatmap is not running; start it with HEATMAP ON.\n");
+    EXPECT_EQ(simulator.memoryUsage().heatmap, 0U);
+}
+
+TEST(RobotSimulator, HeatmapCountsDeferredMovesOnlyOnceTheySettle)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    std::ostringstream output;
+    std::ostringstream errors;
+    // A lands on B's cell before B leaves it, which only settle() finds out.
+    for (const auto *line : {"HEATMAP ON", "PLACE A 0,0 NORTH", "PLACE B 0,2 EAST", "BEGIN",
+                             "MOVE A 2", "MOVE B", "REPORT", "COMMIT", "BEGIN", "MOVE B",
+                             "MOVE A", "COMMIT"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+
+    const auto &heatmap = simulator.heatmap();
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 2, .direction = {}}).visits, 0U);
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 2, .direction = {}}).blocked, 1U);
+    EXPECT_EQ(heatmap.at({.x = 1, .y = 2, .direction = {}}).visits, 1U);
+    EXPECT_EQ(heatmap.at({.x = 0, .y = 1, .direction = {}}).visits, 1U);
+}
+
+TEST(RobotSimulator, TargetsRobotsByNamePattern)
+{
+    Simulator::RobotSimulator simulator;
+    std::ostringstream output;
+    std::ostringstream errors;
+    for (const auto *line : {"PLACE DOCK1_A 0,0 NORTH", "PLACE dock1_b 1,0 NORTH",
+                             "PLACE DOCK10_A 2,0 NORTH", "PLACE AISLE7_A 3,0 NORTH",
+                             "MOVE Dock1_* 2", "ROTATE DOCK1? RIGHT", "SCAN DOCK1*"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+
+    EXPECT_EQ(simulator.findRobot("DOCK1_A")->location().y, 2);
+    EXPECT_EQ(simulator.findRobot("DOCK1_B")->location().y, 2);
+    EXPECT_EQ(simulator.findRobot("DOCK10_A")->location().y, 0);
+    EXPECT_EQ(output.str(), "DOCK10_A: 9\nDOCK1_A: 7\nDOCK1_B: 7\n");
+    EXPECT_EQ(errors.str(), "No matching robot was found.\n");
+
+    EXPECT_EQ(simulator.remove(Simulator::NamePattern{"DOCK*"}), 3U);
+    EXPECT_EQ(simulator.robotCount(), 1U);
+    EXPECT_TRUE(simulator.executeLine("MOVE DOCK*", output, errors));
+    EXPECT_NE(errors.str().find("No robot could be moved."), std::string::npos);
+}
+
+TEST(RobotSimulator, TargetsNamedGroups)
+{
+    Simulator::RobotSimulator simulator;
+    std::ostringstream output;
+    std::ostringstream errors;
+    for (const auto *line :
+         {"PLACE A 0,0 NORTH", "PLACE B 1,0 NORTH", "PLACE C 2,0 NORTH", "GROUP CREATE pickers",
+          "GROUP ADD pickers A @45", "GROUP ADD PICKERS a", "MOVE pickers 3", "ROTATE pickers LEFT",
+          "GROUP CREATE others", "GROUP ADD others pickers B", "GROUP"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+
+    EXPECT_EQ(simulator.findRobot("A")->location().y, 3);
+    EXPECT_EQ(simulator.findRobot("B")->location().y, 0);
+    EXPECT_EQ(simulator.findRobot("C")->location().direction, RobotFactory::Direction::West);
+    EXPECT_EQ(output.str(), "OTHERS: 3 robots\nPICKERS: 2 robots\n");
+    EXPECT_TRUE(errors.str().empty());
+
+    // Names are shared with robots, and a removed robot leaves every group it was in.
+    EXPECT_FALSE(simulator.createGroup("b"));
+    EXPECT_FALSE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                 {.x = 5, .y = 5, .direction = RobotFactory::Direction::North},
+                                 "Pickers"));
+    ASSERT_TRUE(simulator.begin());
+    EXPECT_EQ(simulator.remove(Simulator::GroupName{"PICKERS"}), 2U);
+    const auto others = *simulator.groups().find("OTHERS");
+    EXPECT_EQ(simulator.groups().members(others).size(), 1U);
+    EXPECT_FALSE(simulator.deleteGroup("PICKERS"));
+    ASSERT_TRUE(simulator.abort());
+    EXPECT_EQ(simulator.groups().members(others).size(), 3U);
+    EXPECT_EQ(simulator.groups().members(*simulator.groups().find("PICKERS")).size(), 2U);
+
+    output.str("");
+    EXPECT_TRUE(simulator.executeLine("SCAN pickers", output, errors));
+    // Members rejoined newest removal first.
+    EXPECT_EQ(output.str(), "C: 1\nA: 0\n");
+    EXPECT_TRUE(simulator.executeLine("GROUP ADD nobody A", output, errors));
+    EXPECT_TRUE(simulator.executeLine("GROUP DELETE pickers", output, errors));
+    EXPECT_TRUE(simulator.executeLine("MOVE pickers", output, errors));
+    EXPECT_EQ(errors.str(), "No such group.\nNo robot could be moved.\n");
+}
+
+TEST(RobotSimulator, RecordsTrajectoriesWithCommandTicks)
+{
+    Simulator::RobotSimulator simulator;
+    std::ostringstream recording;
+    std::ostringstream output;
+    std::ostringstream errors;
+    simulator.startRecording(recording, 2);
+    for (const auto *line : {"PLACE A 1,1 NORTH", "MOVE A 2", "MOVE A 99", "BEGIN",
+                             "ROTATE A LEFT", "ABORT", "RECORD"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+    EXPECT_EQ(output.str(), "Recording: 4 records, 40 bytes written\n");
+    EXPECT_TRUE(simulator.stopRecording());
+    EXPECT_TRUE(simulator.executeLine("RECORD STOP", output, errors));
+    EXPECT_EQ(errors.str(), "No robot could be moved.\nNo recording is running.\n");
+
+    std::istringstream input{recording.str()};
+    Simulator::TrajectoryReader reader{input};
+    std::vector<Simulator::TrajectoryRecord> records;
+    std::vector<Simulator::TrajectoryRecord> chunk;
+    while (reader.next(chunk))
+    {
+        records.insert(records.end(), chunk.begin(), chunk.end());
+    }
+    EXPECT_TRUE(reader.valid());
+    // The failed move records nothing; the rollback records the robot turning back.
+    ASSERT_EQ(records.size(), 4U);
+    EXPECT_EQ(records[0].tick, 0U);
+    EXPECT_EQ(records[1].location.y, 3);
+    EXPECT_EQ(records[1].tick, 1U);
+    EXPECT_EQ(records[2].location.direction, RobotFactory::Direction::West);
+    EXPECT_EQ(records[2].tick, 4U);
+    EXPECT_EQ(records[3].location.direction, RobotFactory::Direction::North);
+    EXPECT_EQ(records[3].tick, 5U);
+}
+
+TEST(RobotSimulator, TrajectoryTicksKeepRisingAcrossAHashTrailStart)
+{
+    Simulator::RobotSimulator simulator;
+    std::ostringstream recording;
+    std::ostringstream output;
+    std::ostringstream errors;
+    simulator.startRecording(recording);
+    for (const auto *line : {"PLACE A 1,1 NORTH", "MOVE A", "MOVE A", "HASH TRAIL 2", "MOVE A",
+                             "MOVE A", "HASH TRAIL"})
+    {
+        EXPECT_TRUE(simulator.executeLine(line, output, errors));
+    }
+    static_cast<void>(simulator.tick());
+    ASSERT_TRUE(simulator.rotate("A", RobotFactory::Rotation::Left));
+    EXPECT_TRUE(simulator.stopRecording());
+    EXPECT_EQ(errors.str(), "");
+    // The trail still counts from its own start, which is its first command.
+    EXPECT_EQ(simulator.hashTrail().size(), 2U);
+    EXPECT_EQ(output.str().substr(0, 2), "2 ");
+
+    std::istringstream input{recording.str()};
+    Simulator::TrajectoryReader reader{input};
+    std::vector<Simulator::TrajectoryRecord> records;
+    std::vector<Simulator::TrajectoryRecord> chunk;
+    while (reader.next(chunk))
+    {
+        records.insert(records.end(), chunk.begin(), chunk.end());
+    }
+    ASSERT_EQ(records.size(), 6U);
+    std::vector<std::uint64_t> ticks;
+    for (const auto &record : records)
+    {
+        ticks.push_back(record.tick);
+    }
+    EXPECT_EQ(ticks, (std::vector<std::uint64_t>{0, 1, 2, 4, 5, 8}));
+}
+
+TEST(RobotSimulator, RunsOverAFixedGrid)
+{
+    Simulator::RobotSimulator dynamic;
+    Simulator::FixedRobotSimulator<10, 10> fixed;
+    EXPECT_EQ(fixed.gridSize().width, 10);
+    EXPECT_EQ(fixed.gridSize().height, 10);
+
+    // RESIZE is left out: a fixed grid rejects every size but its own.
+    Simulator::CommandGeneratorOptions options;
+    options.mix.resize = 0;
+    Simulator::CommandGenerator generator{3, options};
+    std::ostringstream dynamic_output;
+    std::ostringstream dynamic_errors;
+    std::ostringstream fixed_output;
+    std::ostringstream fixed_errors;
+    for (int line = 0; line < 5000; ++line)
+    {
+        const auto command = generator.next();
+        EXPECT_EQ(dynamic.executeLine(command, dynamic_output, dynamic_errors),
+                  fixed.executeLine(command, fixed_output, fixed_errors));
+    }
+    EXPECT_EQ(fixed_output.str(), dynamic_output.str());
+    EXPECT_EQ(fixed_errors.str(), dynamic_errors.str());
+    EXPECT_EQ(fixed.worldHash(), dynamic.worldHash());
+
+    EXPECT_FALSE(fixed.resize({.width = 20, .height = 20}));
+    EXPECT_TRUE(fixed.resize({.width = 10, .height = 10}));
+    EXPECT_THROW((Simulator::FixedRobotSimulator<10, 10>{{.width = 5, .height = 5}}),
+                 std::invalid_argument);
+}
+
 } // namespace
@@ -0,0 +1,72 @@
+#include "marvin/command/Command.h"
+#include "marvin/simulator/Statistics.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+TEST(LatencyHistogram, ReportsPercentilesWithinBucketPrecision)
+{
+    Simulator::LatencyHistogram histogram;
+    for (std::uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.record(value);
+    }
+
+    EXPECT_EQ(histogram.count(), 1000U);
+    EXPECT_EQ(histogram.max(), 1000U);
+    EXPECT_GE(histogram.percentile(0.50), 500U);
+    EXPECT_LE(histogram.percentile(0.50), 500U + (500U / 8));
+    EXPECT_GE(histogram.percentile(0.99), 990U);
+    EXPECT_EQ(histogram.percentile(1.0), 1000U);
+}
+
+TEST(LatencyHistogram, ResetClearsSamples)
+{
+    Simulator::LatencyHistogram histogram;
+    histogram.record(42);
+    histogram.reset();
+
+    EXPECT_EQ(histogram.count(), 0U);
+    EXPECT_EQ(histogram.percentile(0.5), 0U);
+}
+
+TEST(NestedStage, OnlyTheOutermostScopeIsTimed)
+{
+    std::uint64_t outer{0};
+    std::uint64_t inner{0};
+    bool open{false};
+    {
+        const Simulator::NestedStage stage{outer, open};
+        EXPECT_EQ(open, Simulator::statistics_enabled);
+        const Simulator::NestedStage nested{inner, open};
+        static_cast<void>(nested);
+    }
+    EXPECT_FALSE(open);
+    EXPECT_EQ(inner, 0U);
+}
+
+TEST(SimulatorStatistics, WritesPerVerbJson)
+{
+    if constexpr (!Simulator::statistics_enabled)
+    {
+        GTEST_SKIP() << "Statistics are compiled out.";
+    }
+    Simulator::SimulatorStatistics statistics;
+    statistics.record(0, std::array<std::uint64_t, Simulator::stage_count>{10, 20, 30, 40});
+    statistics.countCollision();
+    std::ostringstream output;
+
+    statistics.writeJson(output);
+
+    EXPECT_NE(output.str().find(R"("verb":"PLACE","count":1)"), std::string::npos);
+    EXPECT_NE(output.str().find(R"("collisions":1)"), std::string::npos);
+}
+
+} // namespace
@@ -0,0 +1,68 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/TerrainMap.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+
+[[nodiscard]] RobotFactory::RobotLocation at(RobotFactory::Coordinate x,
+                                             RobotFactory::Coordinate y)
+{
+    return {.x = x, .y = y, .direction = RobotFactory::Direction::North};
+}
+
+TEST(TerrainMap, StoresOnlyRunsThatAreNotOpen)
+{
+    Simulator::TerrainMap::Builder builder;
+    const std::array<Simulator::TerrainCode, 8> row{0, 0, 3, 3, 3, 255, 0, 0};
+    builder.addRow(2, row);
+    builder.addRun(4, 0, 1'000'000, Simulator::terrain_blocked);
+    builder.addRun(4, 1'000'000, 2'000'000, Simulator::terrain_blocked);
+
+    const auto terrain = std::move(builder).build();
+
+    EXPECT_EQ(terrain.runCount(), 3U);
+    EXPECT_EQ(terrain.at(at(1, 2)), Simulator::terrain_open);
+    EXPECT_EQ(terrain.at(at(2, 2)), 3);
+    EXPECT_EQ(terrain.at(at(5, 2)), Simulator::terrain_blocked);
+    EXPECT_EQ(terrain.at(at(1'999'999, 4)), Simulator::terrain_blocked);
+    EXPECT_EQ(terrain.at(at(2'000'000, 4)), Simulator::terrain_open);
+    EXPECT_EQ(terrain.at(at(0, 3)), Simulator::terrain_open);
+    EXPECT_EQ(terrain.at(at(-1, 4)), Simulator::terrain_open);
+    EXPECT_EQ(terrain.at(at(0, 9)), Simulator::terrain_open);
+    EXPECT_LT(terrain.memoryBytes(), 256U);
+}
+
+TEST(TerrainMap, CostsPathsAndStopsAtBlockedCells)
+{
+    Simulator::TerrainMap::Builder builder;
+    builder.addRun(0, 2, 4, 3);
+    builder.addRun(1, 2, 3, Simulator::terrain_blocked);
+    const auto terrain = std::move(builder).build();
+
+    EXPECT_EQ(terrain.pathCost(at(0, 0), at(5, 0)), 5U + 2U * 3U);
+    EXPECT_EQ(terrain.pathCost(at(5, 0), at(3, 0)), 2U + 3U);
+    EXPECT_EQ(terrain.pathCost(at(0, 1), at(1, 1)), 1U);
+    EXPECT_EQ(terrain.pathCost(at(0, 1), at(4, 1)), std::nullopt);
+    EXPECT_EQ(terrain.pathCost(at(3, 3), at(3, 0)), 1U + 1U + 4U);
+    EXPECT_EQ(terrain.pathCost(at(2, 0), at(2, 2)), std::nullopt);
+}
+
+TEST(TerrainMap, RejectsRunsOutOfOrder)
+{
+    Simulator::TerrainMap::Builder builder;
+    builder.addRun(3, 5, 8, 1);
+
+    EXPECT_THROW(builder.addRun(3, 6, 9, 1), std::invalid_argument);
+    EXPECT_THROW(builder.addRun(2, 0, 1, 1), std::invalid_argument);
+    EXPECT_THROW(builder.addRun(4, 3, 2, 1), std::invalid_argument);
+    EXPECT_THROW(builder.addRun(-1, 0, 1, 1), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,113 @@
+#include "marvin/simulator/RobotSimulator.h"
+#include "marvin/simulator/Tracer.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+[[nodiscard]] std::string readFile(const std::filesystem::path &path)
+{
+    std::ifstream input{path};
+    return {std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+}
+
+TEST(Tracer, WritesCompleteEventsForExecutedCommands)
+{
+    if constexpr (!Simulator::tracing_enabled)
+    {
+        GTEST_SKIP() << "Tracing is compiled out.";
+    }
+    const auto path = std::filesystem::temp_directory_path() / "marvin-tracer-test.json";
+    Simulator::RobotSimulator simulator;
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    ASSERT_TRUE(Simulator::Tracer::start(path));
+    EXPECT_TRUE(simulator.executeLine("PLACE R2D2 0,0 NORTH", output, errors));
+    EXPECT_TRUE(simulator.executeLine("MOVE ALL", output, errors));
+    Simulator::Tracer::stop();
+
+    const auto trace = readFile(path);
+    std::filesystem::remove(path);
+    EXPECT_NE(trace.find(R"("name":"RobotSimulator::executeLine","ph":"X")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"CommandParser::parse")"), std::string::npos);
+    EXPECT_NE(trace.find(R"("name":"RobotSimulator::moveAll")"), std::string::npos);
+    EXPECT_EQ(trace.back(), '\n');
+    EXPECT_EQ(Simulator::Tracer::dropped(), 0U);
+}
+
+TEST(Tracer, SamplesWholeCommands)
+{
+    if constexpr (!Simulator::tracing_enabled)
+    {
+        GTEST_SKIP() << "Tracing is compiled out.";
+    }
+    const auto path = std::filesystem::temp_directory_path() / "marvin-tracer-sampled.json";
+    Simulator::RobotSimulator simulator;
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    ASSERT_TRUE(Simulator::Tracer::start(path, 4));
+    for (int command = 0; command < 8; ++command)
+    {
+        EXPECT_TRUE(simulator.executeLine("REPORT", output, errors));
+    }
+    Simulator::Tracer::stop();
+
+    const auto trace = readFile(path);
+    std::filesystem::remove(path);
+    std::size_t commands{0};
+    std::size_t reports{0};
+    for (auto position = trace.find("executeLine"); position != std::string::npos;
+         position = trace.find("executeLine", position + 1))
+    {
+        ++commands;
+    }
+    for (auto position = trace.find("RobotSimulator::report"); position != std::string::npos;
+         position = trace.find("RobotSimulator::report", position + 1))
+    {
+        ++reports;
+    }
+    EXPECT_EQ(commands, 2U);
+    EXPECT_EQ(reports, 2U);
+}
+
+TEST(Tracer, ReusesTheBuffersOfExitedThreads)
+{
+    if constexpr (!Simulator::tracing_enabled)
+    {
+        GTEST_SKIP() << "Tracing is compiled out.";
+    }
+    const auto path = std::filesystem::temp_directory_path() / "marvin-tracer-threads.json";
+    const auto traceOnThread = []
+    {
+        std::thread{[] { const Simulator::TraceSpan span{"TestTracer::thread"}; }}.join();
+    };
+
+    ASSERT_TRUE(Simulator::Tracer::start(path));
+    traceOnThread();
+    Simulator::Tracer::stop();
+    const auto buffers = Simulator::Tracer::threadBuffers();
+    for (int run = 0; run < 8; ++run)
+    {
+        // Stopping drains every buffer, so the exited thread's buffer is free for the next.
+        ASSERT_TRUE(Simulator::Tracer::start(path));
+        traceOnThread();
+        Simulator::Tracer::stop();
+    }
+    const auto trace = readFile(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(Simulator::Tracer::threadBuffers(), buffers);
+    EXPECT_NE(trace.find("TestTracer::thread"), std::string::npos);
+}
+
+} // namespace
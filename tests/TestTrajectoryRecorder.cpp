@@ -0,0 +1,112 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/TrajectoryRecorder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+[[nodiscard]] std::vector<Simulator::TrajectoryRecord> readAll(const std::string &bytes,
+                                                               bool &valid)
+{
+    std::istringstream input{bytes};
+    Simulator::TrajectoryReader reader{input};
+    std::vector<Simulator::TrajectoryRecord> all;
+    for (std::vector<Simulator::TrajectoryRecord> chunk; reader.next(chunk);)
+    {
+        all.insert(all.end(), chunk.begin(), chunk.end());
+    }
+    valid = reader.valid();
+    return all;
+}
+
+TEST(TrajectoryRecorder, RoundTripsRecordsAcrossChunks)
+{
+    std::vector<Simulator::TrajectoryRecord> written;
+    for (std::uint64_t tick = 0; tick < 10; ++tick)
+    {
+        const auto step = static_cast<RobotFactory::Coordinate>(tick);
+        const auto direction = static_cast<RobotFactory::Direction>(tick % 4);
+        written.push_back(
+            {.tick = tick,
+             .id = 43 + (tick % 3),
+             .location = {.x = 5 - step, .y = step * 1'000'000, .direction = direction}});
+    }
+    // Generational IDs and extreme coordinates wrap through the deltas.
+    written.push_back({.tick = 10,
+                       .id = (RobotFactory::RobotId{7} << 32U) | 43U,
+                       .location = {.x = -4'000'000'000'000, .y = 0}});
+    written.push_back({.tick = 10, .id = 44, .location = {.x = 3, .y = -1}});
+
+    std::ostringstream output;
+    Simulator::TrajectoryRecorder recorder;
+    recorder.start(output, 4);
+    for (const auto &record : written)
+    {
+        recorder.record(record.tick, record.id, record.location);
+    }
+    EXPECT_EQ(recorder.recorded(), written.size());
+    EXPECT_TRUE(recorder.stop());
+    EXPECT_FALSE(recorder.active());
+    EXPECT_EQ(recorder.bytesWritten(), output.view().size());
+
+    bool valid{false};
+    const auto read = readAll(output.str(), valid);
+    EXPECT_TRUE(valid);
+    ASSERT_EQ(read.size(), written.size());
+    for (std::size_t index = 0; index < read.size(); ++index)
+    {
+        EXPECT_EQ(read[index].tick, written[index].tick);
+        EXPECT_EQ(read[index].id, written[index].id);
+        EXPECT_EQ(read[index].location.x, written[index].location.x);
+        EXPECT_EQ(read[index].location.y, written[index].location.y);
+        EXPECT_EQ(read[index].location.direction, written[index].location.direction);
+    }
+}
+
+TEST(TrajectoryRecorder, SmallStepsTakeAFewBytesPerRecord)
+{
+    std::ostringstream output;
+    Simulator::TrajectoryRecorder recorder;
+    recorder.start(output);
+    for (std::uint64_t tick = 0; tick < 1000; ++tick)
+    {
+        recorder.record(tick, 43, {.x = static_cast<RobotFactory::Coordinate>(tick), .y = 7});
+    }
+    EXPECT_GT(recorder.memoryBytes(), 0U);
+    EXPECT_TRUE(recorder.stop());
+    EXPECT_EQ(recorder.memoryBytes(), 0U);
+    // One byte per column after the first record.
+    EXPECT_LT(output.view().size(), 5U * 1000U + 32U);
+}
+
+TEST(TrajectoryReader, RejectsBadHeadersAndTruncatedChunks)
+{
+    std::ostringstream output;
+    Simulator::TrajectoryRecorder recorder;
+    recorder.start(output);
+    recorder.record(1, 43, {.x = 1, .y = 2});
+    recorder.record(2, 43, {.x = 1, .y = 3});
+    EXPECT_TRUE(recorder.stop());
+    const auto bytes = output.str();
+
+    bool valid{true};
+    EXPECT_TRUE(readAll("MRVTRAJ0", valid).empty());
+    EXPECT_FALSE(valid);
+    EXPECT_TRUE(readAll(bytes.substr(0, bytes.size() - 1), valid).empty());
+    EXPECT_FALSE(valid);
+    auto bad_direction = bytes;
+    bad_direction.back() = 9;
+    EXPECT_TRUE(readAll(bad_direction, valid).empty());
+    EXPECT_FALSE(valid);
+    EXPECT_TRUE(readAll(bytes.substr(0, 8), valid).empty());
+    EXPECT_TRUE(valid);
+}
+
+} // namespace
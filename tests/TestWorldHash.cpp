@@ -0,0 +1,104 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/robot/RobotAssembly.h"
+#include "marvin/simulator/RobotSimulator.h"
+#include "marvin/simulator/WorldHash.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+[[nodiscard]] Simulator::WorldHash recomputeHash(const Simulator::RobotSimulator &simulator,
+                                                 const std::vector<std::string> &names)
+{
+    auto hash = Simulator::gridHash(simulator.gridSize());
+    for (const auto &name : names)
+    {
+        const auto *robot = simulator.findRobot(name);
+        hash ^= Simulator::robotHash(robot->id(), robot->location());
+    }
+    return hash;
+}
+
+TEST(WorldHash, MatchesFullRecomputationAfterEachChange)
+{
+    Simulator::RobotSimulator simulator{{.width = 5, .height = 5}};
+    const auto empty = simulator.worldHash();
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 1, .y = 1, .direction = RobotFactory::Direction::North},
+                                "A"));
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 3, .y = 3, .direction = RobotFactory::Direction::East},
+                                "B"));
+    EXPECT_EQ(simulator.worldHash(), recomputeHash(simulator, {"A", "B"}));
+
+    ASSERT_TRUE(simulator.move("A", 2));
+    ASSERT_TRUE(simulator.rotate("B", RobotFactory::Rotation::Left));
+    ASSERT_TRUE(simulator.resize({.width = 6, .height = 5}));
+    EXPECT_EQ(simulator.worldHash(), recomputeHash(simulator, {"A", "B"}));
+
+    ASSERT_TRUE(simulator.remove("A"));
+    EXPECT_EQ(simulator.worldHash(), recomputeHash(simulator, {"B"}));
+    EXPECT_EQ(simulator.removeAll(), 1U);
+    EXPECT_NE(simulator.worldHash(), empty);
+    EXPECT_EQ(simulator.worldHash(), Simulator::gridHash({.width = 6, .height = 5}));
+}
+
+TEST(WorldHash, ReturnsToEarlierValueWhenStateIsRestored)
+{
+    Simulator::RobotSimulator simulator;
+    ASSERT_TRUE(simulator.place(RobotFactory::GroundRobotType::Bipedal,
+                                {.x = 0, .y = 0, .direction = RobotFactory::Direction::North},
+                                "A"));
+    const auto start = simulator.worldHash();
+
+    for (int turn = 0; turn < 4; ++turn)
+    {
+        ASSERT_TRUE(simulator.rotate("A", RobotFactory::Rotation::Right));
+        EXPECT_EQ(simulator.worldHash() == start, turn == 3);
+    }
+    ASSERT_TRUE(simulator.begin());
+    ASSERT_TRUE(simulator.move("A", 3));
+    ASSERT_TRUE(simulator.remove("A"));
+    ASSERT_TRUE(simulator.abort());
+    EXPECT_EQ(simulator.worldHash(), start);
+}
+
+TEST(WorldHash, TrailLocatesFirstDivergentInterval)
+{
+    const auto run = [](const std::string &script)
+    {
+        Simulator::RobotSimulator simulator;
+        std::istringstream input{"HASH TRAIL 2\n" + script};
+        std::ostringstream output;
+        std::ostringstream errors;
+        simulator.run(input, output, errors);
+        return std::vector<Simulator::WorldHash>{simulator.hashTrail().begin(),
+                                                 simulator.hashTrail().end()};
+    };
+    const auto expected = run("PLACE A 0,0 NORTH\nMOVE A\nMOVE A\nRIGHT A\nMOVE A\nMOVE A\n");
+    const auto diverged = run("PLACE A 0,0 NORTH\nMOVE A\nMOVE A\nLEFT A\nMOVE A\nMOVE A\n");
+
+    ASSERT_EQ(expected.size(), 3U);
+    EXPECT_EQ(Simulator::firstDivergence(expected, expected), std::nullopt);
+    EXPECT_EQ(Simulator::firstDivergence(expected, diverged), 2U);
+}
+
+TEST(WorldHash, PrintsThirtyTwoHexDigits)
+{
+    Simulator::RobotSimulator simulator;
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    EXPECT_TRUE(simulator.executeLine("HASH", output, errors));
+    EXPECT_EQ(output.str().size(), 33U);
+    std::ostringstream expected;
+    expected << simulator.worldHash() << '\n';
+    EXPECT_EQ(output.str(), expected.str());
+}
+
+} // namespace
@@ -0,0 +1,136 @@
+#include "marvin/simulator/WorldHost.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+TEST(WorldHost, RunsEachWorldsBatchesInOrder)
+{
+    Simulator::WorldHost host{4};
+    std::vector<Simulator::WorldId> worlds;
+    for (std::size_t world = 0; world < 8; ++world)
+    {
+        worlds.push_back(host.create({.width = 1, .height = 201}));
+        ASSERT_TRUE(host.submit(worlds.back(), "PLACE A 0,0 NORTH").valid());
+    }
+    std::vector<std::jthread> submitters;
+    for (std::size_t thread = 0; thread < 4; ++thread)
+    {
+        submitters.emplace_back(
+            [&host, &worlds]
+            {
+                for (std::size_t batch = 0; batch < 25; ++batch)
+                {
+                    for (const auto world : worlds)
+                    {
+                        static_cast<void>(host.submit(world, "MOVE A\nMOVE A"));
+                    }
+                }
+            });
+    }
+    submitters.clear();
+
+    for (const auto world : worlds)
+    {
+        const auto result = host.submit(world, "REPORT\nQUIT\nMOVE A").get();
+        EXPECT_NE(result.output.find("Location: (0,200)"), std::string::npos) << result.output;
+        EXPECT_EQ(result.executed, 2U);
+        EXPECT_TRUE(result.quit);
+    }
+}
+
+TEST(WorldHost, TimeSlicesBusyWorlds)
+{
+    Simulator::WorldHost host{1, 16};
+    const auto busy = host.create({.width = 10, .height = 10});
+    const auto quiet = host.create();
+    std::string script{"PLACE A 0,0 NORTH"};
+    for (std::size_t command = 0; command < 200'000; ++command)
+    {
+        script += "\nROTATE A LEFT";
+    }
+
+    auto slow = host.submit(busy, script);
+    auto fast = host.submit(quiet, "PLACE B 1,1 EAST\nREPORT");
+
+    EXPECT_NE(fast.get().output.find("Name: B"), std::string::npos);
+    EXPECT_EQ(slow.wait_for(std::chrono::seconds{0}), std::future_status::timeout);
+    EXPECT_EQ(slow.get().executed, 200'001U);
+}
+
+TEST(WorldHost, DestroyedWorldsFinishQueuedBatchesAndRejectNewOnes)
+{
+    Simulator::WorldHost host{2};
+    const auto world = host.create();
+    auto queued = host.submit(world, "PLACE A 0,0 NORTH\nMOVE A\nMOVE B");
+
+    EXPECT_TRUE(host.destroy(world));
+    EXPECT_FALSE(host.destroy(world));
+    EXPECT_FALSE(host.submit(world, "REPORT").valid());
+    EXPECT_EQ(host.worldCount(), 0U);
+    const auto result = queued.get();
+    EXPECT_EQ(result.executed, 3U);
+    EXPECT_NE(result.errors.find("No robot could be moved."), std::string::npos);
+    host.wait();
+}
+
+// Counts what is allocated through it and not yet returned; worlds allocate from many threads.
+class CountingResource final : public std::pmr::memory_resource
+{
+  public:
+    [[nodiscard]] std::size_t outstanding() const
+    {
+        const std::scoped_lock lock{m_mutex};
+        return m_outstanding;
+    }
+
+  private:
+    mutable std::mutex m_mutex;
+    std::size_t m_outstanding{0};
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *data, std::size_t bytes, std::size_t alignment) override
+    {
+        const std::scoped_lock lock{m_mutex};
+        m_outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(data, bytes, alignment);
+    }
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST(WorldHost, WorldsAllocateTheirSimulatorsFromTheirOwnArena)
+{
+    CountingResource upstream;
+    {
+        Simulator::WorldHost host{2, Simulator::WorldHost::default_quantum, &upstream};
+        const auto world = host.create({.width = 1000, .height = 1000});
+        // The cells of a million-cell grid.
+        const auto created = upstream.outstanding();
+        EXPECT_GE(created, std::size_t{1000} * 1000 * 4);
+
+        const auto result = host.submit(world, "POPULATE 50000 RANDOM 3\nREPORT").get();
+        EXPECT_EQ(result.errors, "");
+        EXPECT_GT(upstream.outstanding(), created);
+    }
+    EXPECT_EQ(upstream.outstanding(), 0U);
+}
+
+} // namespace
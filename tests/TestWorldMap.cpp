@@ -0,0 +1,113 @@
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotSimulator.h"
+#include "marvin/simulator/TerrainMap.h"
+#include "marvin/simulator/WorldMap.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+[[nodiscard]] std::filesystem::path writeMap(std::string_view name, std::string_view contents)
+{
+    const auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream output{path, std::ios::binary};
+    output << contents;
+    return path;
+}
+
+[[nodiscard]] RobotFactory::RobotLocation at(RobotFactory::Coordinate x,
+                                             RobotFactory::Coordinate y)
+{
+    return {.x = x, .y = y, .direction = RobotFactory::Direction::North};
+}
+
+TEST(WorldMap, LoadsAsciiRobotsAndTerrainWithTheTopLineNorthernmost)
+{
+    const auto path = writeMap("marvin-map-test.txt", "#..v\r\n.3>\n^..#\n");
+    Simulator::RobotSimulator simulator;
+    {
+        const Simulator::WorldMap map{path.string()};
+        EXPECT_EQ(map.size().width, 4);
+        EXPECT_EQ(map.size().height, 3);
+        EXPECT_EQ(map.robotCount(), 3U);
+        ASSERT_TRUE(simulator.loadMap(map));
+    }
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(simulator.gridSize().height, 3);
+    EXPECT_EQ(simulator.robotCount(), 3U);
+    const auto *first = simulator.findRobot(43);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->location().x, 0);
+    EXPECT_EQ(first->location().y, 0);
+    EXPECT_EQ(simulator.findRobot(44)->location().direction, RobotFactory::Direction::East);
+    EXPECT_EQ(simulator.findRobot(45)->location().y, 2);
+    EXPECT_EQ(simulator.terrain().at(at(0, 2)), Simulator::terrain_blocked);
+    EXPECT_EQ(simulator.terrain().at(at(3, 0)), Simulator::terrain_blocked);
+    EXPECT_EQ(simulator.terrain().at(at(1, 1)), 3);
+    EXPECT_EQ(simulator.terrain().at(at(3, 1)), Simulator::terrain_open);
+}
+
+TEST(WorldMap, LoadsPgmGreysAsTerrain)
+{
+    std::string pgm{"P5\n# layout\n3 2\n255\n"};
+    pgm += std::string{'\xff', '\x00', '\x80', '\xff', '\xff', '\x00'};
+    const auto path = writeMap("marvin-map-test.pgm", pgm);
+    Simulator::TerrainMap::Builder builder;
+    {
+        const Simulator::WorldMap map{path.string()};
+        EXPECT_EQ(map.format(), Simulator::WorldMap::Format::Pgm);
+        EXPECT_EQ(map.size().width, 3);
+        EXPECT_EQ(map.robotCount(), 0U);
+        map.buildTerrain(builder);
+    }
+    std::filesystem::remove(path);
+    const auto terrain = std::move(builder).build();
+
+    EXPECT_EQ(terrain.at(at(0, 1)), Simulator::terrain_open);
+    EXPECT_EQ(terrain.at(at(1, 1)), Simulator::terrain_blocked);
+    EXPECT_EQ(terrain.at(at(2, 1)), 127);
+    EXPECT_EQ(terrain.at(at(2, 0)), Simulator::terrain_blocked);
+}
+
+TEST(WorldMap, RejectsMalformedMaps)
+{
+    const auto ascii = writeMap("marvin-map-bad.txt", "..\n.x\n");
+    const auto pgm = writeMap("marvin-map-bad.pgm", "P5 4 4 255\n\x01");
+
+    EXPECT_THROW(Simulator::WorldMap{ascii.string()}, std::runtime_error);
+    EXPECT_THROW(Simulator::WorldMap{pgm.string()}, std::runtime_error);
+    EXPECT_THROW(Simulator::WorldMap{"/nonexistent/marvin.map"}, std::runtime_error);
+    std::filesystem::remove(ascii);
+    std::filesystem::remove(pgm);
+}
+
+TEST(WorldMap, LoadmapCommandReportsThroughput)
+{
+    const auto path = writeMap("marvin-map-command.txt", "..#\n^..\n");
+    Simulator::RobotSimulator simulator;
+    std::istringstream input{"PLACE OLD 5,5 NORTH\nLOADMAP " + path.string() +
+                             "\nMOVE ALL\nREPORT\nLOADMAP missing.txt\nQUIT\n"};
+    std::ostringstream output;
+    std::ostringstream errors;
+
+    simulator.run(input, output, errors);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(simulator.findRobot("OLD"), nullptr);
+    EXPECT_EQ(simulator.robotCount(), 1U);
+    EXPECT_NE(output.str().find("Location: (0,1), facing NORTH"), std::string::npos);
+    EXPECT_NE(output.str().find("Loaded 3x2 map with 1 robots"), std::string::npos);
+    EXPECT_NE(output.str().find("MB/s"), std::string::npos);
+    EXPECT_NE(errors.str().find("Unable to load the map"), std::string::npos);
+}
+
+} // namespace
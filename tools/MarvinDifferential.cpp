@@ -0,0 +1,137 @@
+// Drives RobotSimulator and the reference simulator with seeded random command streams and stops
+// at the first line on which they disagree, printing the smallest script that still disagrees.
+//
+// Usage: MarvinDifferential [--commands N] [--seed S] [--length L]
+//
+// The stream is cut into episodes of L lines (default 2000), each on fresh simulators with a
+// generator seed mixed from S and the episode's number, so a failing episode replays on its own
+// and shrinks quickly, and runs with different seeds share no episodes.
+
+#include "marvin/command/CommandGenerator.h"
+#include "marvin/simulator/DifferentialRunner.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+struct Options
+{
+    std::uint64_t commands{1'000'000};
+    std::uint64_t seed{1};
+    std::uint64_t length{2000};
+};
+
+[[nodiscard]] std::optional<std::uint64_t> parseCount(std::string_view text)
+{
+    std::uint64_t value{0};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+[[nodiscard]] std::optional<Options> parseOptions(std::span<char *> arguments)
+{
+    Options options;
+    for (std::size_t index = 1; index < arguments.size(); index += 2)
+    {
+        const std::string_view name{arguments[index]};
+        const auto value = index + 1 < arguments.size()
+                               ? parseCount(arguments[index + 1])
+                               : std::nullopt;
+        if (!value)
+        {
+            return std::nullopt;
+        }
+        if (name == "--commands")
+        {
+            options.commands = *value;
+        }
+        else if (name == "--seed")
+        {
+            options.seed = *value;
+        }
+        else if (name == "--length" && *value > 0)
+        {
+            options.length = *value;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+[[nodiscard]] std::string_view layoutName(Simulator::GridLayout layout)
+{
+    return layout == Simulator::GridLayout::Morton ? "Morton" : "row-major";
+}
+
+void printDivergence(const Simulator::Divergence &divergence)
+{
+    std::cout << "Reference simulator:\n"
+              << divergence.expected << "\nRobotSimulator (" << layoutName(divergence.layout)
+              << " grid):\n"
+              << divergence.actual;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const auto options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+    {
+        std::cerr << "Usage: MarvinDifferential [--commands N] [--seed S] [--length L]\n";
+        return 2;
+    }
+
+    std::uint64_t run{0};
+    for (std::uint64_t episode = 0; run < options->commands; ++episode)
+    {
+        const auto seed = Simulator::CommandGenerator::streamSeed(options->seed, episode);
+        Simulator::CommandGenerator generator{seed};
+        Simulator::DifferentialRunner runner;
+        std::vector<std::string> script;
+        for (std::uint64_t line = 0; line < options->length && run < options->commands;
+             ++line, ++run)
+        {
+            script.push_back(generator.next());
+            const auto divergence = runner.step(script.back());
+            if (!divergence)
+            {
+                continue;
+            }
+            std::cout << "Divergence at line " << line + 1 << " of episode " << episode
+                      << " (generator seed " << seed << ").\n";
+            const auto minimal = Simulator::DifferentialRunner::shrink(
+                std::move(script), [](std::span<const std::string> candidate)
+                { return Simulator::DifferentialRunner::run(candidate).has_value(); });
+            std::cout << "Shrunk to " << minimal.size() << " lines:\n\n";
+            for (const auto &command : minimal)
+            {
+                std::cout << command << '\n';
+            }
+            std::cout << "\nAfter its last line:\n";
+            printDivergence(*Simulator::DifferentialRunner::run(minimal));
+            return 1;
+        }
+    }
+    std::cout << run << " commands from seed " << options->seed
+              << ": the simulators agreed after every one.\n";
+    return 0;
+}
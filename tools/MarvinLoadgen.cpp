@@ -0,0 +1,417 @@
+// Writes reproducible synthetic command streams for load-testing Marvin and
+// RobotSimulator::executeLine(), then reports the mix it generated on stderr.
+//
+// Usage: marvin_loadgen [--lines N] [--seed S] [--robots N] [--grid WxH] [--collisions RATE]
+//                       [--mix verb=weight,...] [--targets kind=weight,...]
+//                       [--output FILE] [--binary] [--threads N]
+//
+// --robots sets how many robot names the stream uses, 0 for a new name per PLACE. --grid starts
+// the stream with a RESIZE. --mix weighs PLACE, MOVE, ROTATE, REMOVE, RESIZE, REPORT, SCAN, HASH,
+// TRANSACTION and MALFORMED, and --targets NAME, ID, ALL and PATTERN; kinds left out of either
+// list are not generated. --binary writes the binary command format instead of text lines.
+//
+// The stream is written in blocks of 65536 commands, each drawn by a generator of its own seeded
+// by mixing the seed with the block's number, so --threads blocks are generated at once, the
+// stream is the same for any number of threads, and nearby seeds do not give shifted streams.
+
+#include "marvin/command/BinaryCommands.h"
+#include "marvin/command/Command.h"
+#include "marvin/command/CommandGenerator.h"
+#include "marvin/robot/Robot.h"
+#include "marvin/simulator/RobotGrid.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Kind = Simulator::CommandGenerator::Kind;
+using Target = Simulator::CommandGenerator::Target;
+
+constexpr std::array<std::string_view, Simulator::CommandGenerator::kind_count> kind_names{
+    "PLACE", "MOVE", "ROTATE", "REMOVE", "RESIZE", "REPORT", "SCAN", "HASH", "TRANSACTION",
+    "MALFORMED"};
+constexpr std::array<std::string_view, Simulator::CommandGenerator::target_count> target_names{
+    "NAME", "ID", "ALL", "PATTERN"};
+constexpr std::uint64_t block_lines{std::uint64_t{1} << 16};
+
+struct Options
+{
+    std::uint64_t lines{1'000'000};
+    std::uint64_t seed{1};
+    std::string output; // Empty for stdout.
+    bool binary{false};
+    bool resize{false}; // Whether --grid asked for a starting RESIZE.
+    unsigned threads{std::max(1U, std::thread::hardware_concurrency())};
+    Simulator::CommandGeneratorOptions generator;
+};
+
+// Commands and targets generated, summed over blocks.
+struct Tally
+{
+    std::array<std::uint64_t, Simulator::CommandGenerator::kind_count> kinds{};
+    std::array<std::uint64_t, Simulator::CommandGenerator::target_count> targets{};
+
+    void add(const Simulator::CommandGenerator &generator)
+    {
+        for (std::size_t kind = 0; kind < kinds.size(); ++kind)
+        {
+            kinds.at(kind) += generator.generated(static_cast<Kind>(kind));
+        }
+        for (std::size_t target = 0; target < targets.size(); ++target)
+        {
+            targets.at(target) += generator.targeted(static_cast<Target>(target));
+        }
+    }
+
+    void add(const Tally &other)
+    {
+        for (std::size_t kind = 0; kind < kinds.size(); ++kind)
+        {
+            kinds.at(kind) += other.kinds.at(kind);
+        }
+        for (std::size_t target = 0; target < targets.size(); ++target)
+        {
+            targets.at(target) += other.targets.at(target);
+        }
+    }
+};
+
+template <typename Value> [[nodiscard]] std::optional<Value> parseNumber(std::string_view text)
+{
+    Value value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+[[nodiscard]] std::string uppercase(std::string_view text)
+{
+    std::string result{text};
+    for (auto &character : result)
+    {
+        if (character >= 'a' && character <= 'z')
+        {
+            character = static_cast<char>(character - 'a' + 'A');
+        }
+    }
+    return result;
+}
+
+// Parses `name=weight,...` over `names`; names left out get zero.
+template <std::size_t Size>
+[[nodiscard]] std::optional<std::array<std::uint32_t, Size>>
+parseWeights(std::string_view text, const std::array<std::string_view, Size> &names)
+{
+    std::array<std::uint32_t, Size> weights{};
+    while (!text.empty())
+    {
+        const auto comma = text.find(',');
+        const auto entry = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        const auto equals = entry.find('=');
+        if (equals == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        const auto name = uppercase(entry.substr(0, equals));
+        const auto weight = parseNumber<std::uint32_t>(entry.substr(equals + 1));
+        std::size_t index{0};
+        while (index < Size && names.at(index) != name)
+        {
+            ++index;
+        }
+        if (index == Size || !weight)
+        {
+            return std::nullopt;
+        }
+        weights.at(index) = *weight;
+    }
+    return weights;
+}
+
+[[nodiscard]] bool parseOption(std::string_view name, std::string_view value, Options &options)
+{
+    auto &generator = options.generator;
+    if (name == "--lines" || name == "--seed")
+    {
+        const auto number = parseNumber<std::uint64_t>(value);
+        (name == "--lines" ? options.lines : options.seed) = number.value_or(0);
+        return number.has_value();
+    }
+    if (name == "--robots")
+    {
+        const auto robots = parseNumber<std::size_t>(value);
+        generator.names = robots.value_or(0);
+        return robots.has_value();
+    }
+    if (name == "--grid")
+    {
+        const auto separator = value.find_first_of("xX");
+        using Coordinate = RobotFactory::Coordinate;
+        const auto width = parseNumber<Coordinate>(value.substr(0, separator));
+        const auto height = separator == std::string_view::npos
+                                ? std::nullopt
+                                : parseNumber<Coordinate>(value.substr(separator + 1));
+        if (!width || !height || *width <= 0 || *height <= 0)
+        {
+            return false;
+        }
+        generator.grid = {.width = *width, .height = *height};
+        options.resize = true;
+        return true;
+    }
+    if (name == "--collisions")
+    {
+        const auto rate = parseNumber<double>(value);
+        generator.collisions = rate.value_or(-1.0);
+        return rate && *rate >= 0.0 && *rate <= 1.0;
+    }
+    if (name == "--mix")
+    {
+        const auto weights = parseWeights(value, kind_names);
+        if (weights)
+        {
+            const auto &mix = *weights;
+            generator.mix = {.place = mix[0],
+                             .move = mix[1],
+                             .rotate = mix[2],
+                             .remove = mix[3],
+                             .resize = mix[4],
+                             .report = mix[5],
+                             .scan = mix[6],
+                             .hash = mix[7],
+                             .transaction = mix[8],
+                             .malformed = mix[9]};
+        }
+        return weights.has_value();
+    }
+    if (name == "--targets")
+    {
+        const auto weights = parseWeights(value, target_names);
+        if (weights)
+        {
+            const auto &mix = *weights;
+            generator.targets = {.name = mix[0], .id = mix[1], .all = mix[2], .pattern = mix[3]};
+        }
+        return weights.has_value();
+    }
+    if (name == "--threads")
+    {
+        const auto threads = parseNumber<unsigned>(value);
+        options.threads = threads.value_or(0);
+        return threads && *threads > 0;
+    }
+    if (name == "--output")
+    {
+        options.output = value;
+        return !value.empty();
+    }
+    return false;
+}
+
+[[nodiscard]] std::optional<Options> parseOptions(std::span<char *> arguments)
+{
+    Options options;
+    for (std::size_t index = 1; index < arguments.size(); ++index)
+    {
+        const std::string_view name{arguments[index]};
+        if (name == "--binary")
+        {
+            options.binary = true;
+        }
+        else if (index + 1 == arguments.size() ||
+                 !parseOption(name, arguments[index + 1], options))
+        {
+            return std::nullopt;
+        }
+        else
+        {
+            ++index;
+        }
+    }
+    return options;
+}
+
+// Replaces `buffer` with block `block` of the stream and adds what it generated to `tally`.
+void generateBlock(const Options &options, std::uint64_t block, std::string &buffer, Tally &tally)
+{
+    auto generator_options = options.generator;
+    generator_options.first_name = block * block_lines;
+    Simulator::CommandGenerator generator{
+        Simulator::CommandGenerator::streamSeed(options.seed, block), generator_options};
+    const auto lines = std::min(block_lines, options.lines - block * block_lines);
+    buffer.clear();
+    for (std::uint64_t line = 0; line < lines; ++line)
+    {
+        if (options.binary)
+        {
+            generator.appendBinary(buffer);
+        }
+        else
+        {
+            generator.appendText(buffer);
+        }
+    }
+    tally.add(generator);
+}
+
+void reportMix(const Tally &tally, const Options &options, std::uint64_t bytes, double seconds,
+               std::ostream &report)
+{
+    const auto share = [](std::uint64_t count, std::uint64_t total)
+    { return total == 0 ? 0.0 : 100.0 * static_cast<double>(count) / static_cast<double>(total); };
+    report << std::fixed << std::setprecision(1) << "Generated " << options.lines << " commands ("
+           << static_cast<double>(bytes) / 1e6 << " MB"
+           << (options.binary ? ", binary" : "") << ") from seed " << options.seed << " on "
+           << options.threads << (options.threads == 1 ? " thread" : " threads") << " in "
+           << std::setprecision(3) << seconds << " s: " << std::setprecision(1)
+           << static_cast<double>(options.lines) / seconds / 1e6 << " M commands/s.\n";
+    if (options.resize)
+    {
+        report << "The stream starts with RESIZE " << options.generator.grid.width << ' '
+               << options.generator.grid.height << ", not counted below.\n";
+    }
+    report << "Commands:\n";
+    for (std::size_t kind = 0; kind < kind_names.size(); ++kind)
+    {
+        const auto count = tally.kinds.at(kind);
+        report << "  " << std::left << std::setw(12) << kind_names.at(kind) << std::right
+               << std::setw(12) << count << std::setw(8) << share(count, options.lines) << "%\n";
+    }
+    std::uint64_t targets{0};
+    for (const auto count : tally.targets)
+    {
+        targets += count;
+    }
+    report << "Targets of MOVE, ROTATE, REMOVE and SCAN:\n";
+    for (std::size_t target = 0; target < target_names.size(); ++target)
+    {
+        const auto count = tally.targets.at(target);
+        report << "  " << std::left << std::setw(12) << target_names.at(target) << std::right
+               << std::setw(12) << count << std::setw(8) << share(count, targets) << "%\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const auto options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+    {
+        std::cerr << "Usage: marvin_loadgen [--lines N] [--seed S] [--robots N] [--grid WxH]\n"
+                     "                      [--collisions RATE] [--mix verb=weight,...]\n"
+                     "                      [--targets kind=weight,...] [--output FILE] "
+                     "[--binary]\n"
+                     "                      [--threads N]\n";
+        return 2;
+    }
+
+    std::ios::sync_with_stdio(false);
+    std::ofstream file;
+    if (!options->output.empty())
+    {
+        file.open(options->output, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Unable to open " << options->output << ".\n";
+            return 1;
+        }
+    }
+    auto &output = options->output.empty() ? std::cout : static_cast<std::ostream &>(file);
+
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+        static_cast<void>(Simulator::CommandGenerator{options->seed, options->generator});
+    }
+    catch (const std::invalid_argument &error)
+    {
+        std::cerr << error.what() << '\n';
+        return 2;
+    }
+    std::string header;
+    if (options->binary)
+    {
+        header.append(Simulator::binary_commands_magic.data(),
+                      Simulator::binary_commands_magic.size());
+    }
+    if (options->resize)
+    {
+        const Simulator::Command resize{Simulator::ResizeCommand{.size = options->generator.grid}};
+        if (options->binary)
+        {
+            static_cast<void>(Simulator::appendBinaryCommand(resize, header));
+        }
+        else
+        {
+            header += "RESIZE " + std::to_string(options->generator.grid.width) + ' ' +
+                      std::to_string(options->generator.grid.height) + '\n';
+        }
+    }
+    output.write(header.data(), static_cast<std::streamsize>(header.size()));
+    std::uint64_t bytes{header.size()};
+
+    // Each round generates one block per thread, then writes them in order.
+    const auto blocks = (options->lines + block_lines - 1) / block_lines;
+    std::vector<std::string> buffers(options->threads);
+    std::vector<Tally> tallies(options->threads);
+    for (std::uint64_t first = 0; first < blocks && output; first += options->threads)
+    {
+        const auto count = std::min<std::uint64_t>(options->threads, blocks - first);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(count);
+            for (std::uint64_t index = 0; index < count; ++index)
+            {
+                workers.emplace_back(
+                    [&options, &buffers, &tallies, first, index]
+                    {
+                        generateBlock(*options, first + index, buffers.at(index),
+                                      tallies.at(index));
+                    });
+            }
+        }
+        for (std::uint64_t index = 0; index < count; ++index)
+        {
+            const auto &buffer = buffers.at(index);
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            bytes += buffer.size();
+        }
+    }
+    output.flush();
+    if (!output)
+    {
+        std::cerr << "Unable to write the command stream.\n";
+        return 1;
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    Tally tally;
+    for (const auto &part : tallies)
+    {
+        tally.add(part);
+    }
+    reportMix(tally, *options, bytes, elapsed.count(), std::cerr);
+    return 0;
+}